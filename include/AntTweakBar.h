@@ -133,10 +133,18 @@ typedef enum ETwType
     TW_TYPE_QUAT4F = TW_TYPE_CDSTRING+2, // 4 floats encoding a quaternion {qx,qy,qz,qs}
     TW_TYPE_QUAT4D,     // 4 doubles encoding a quaternion {qx,qy,qz,qs}
     TW_TYPE_DIR3F,      // direction vector represented by 3 floats
-    TW_TYPE_DIR3D       // direction vector represented by 3 doubles
+    TW_TYPE_DIR3D,      // direction vector represented by 3 doubles
+    TW_TYPE_STRINGVIEW  // string owned by the client and described by a TwStringView
 } TwType;
 #define TW_TYPE_CSSTRING(n) ((TwType)(0x30000000+((n)&0xfffffff))) // Null-terminated C Static String of size n (defined as char[n], with n<2^28)
 
+typedef struct CTwStringView
+{
+    const char *    Str;        // does not need to be null-terminated
+    size_t          Length;
+    unsigned int    Generation; // must be changed by the client each time Str or the chars it points to change
+} TwStringView;
+
 typedef void (TW_CALL * TwSetVarCallback)(const void *value, void *clientData);
 typedef void (TW_CALL * TwGetVarCallback)(void *value, void *clientData);
 typedef void (TW_CALL * TwButtonCallback)(void *clientData);
@@ -146,6 +154,10 @@ TW_API int      TW_CALL TwAddVarRO(TwBar *bar, const char *name, TwType type, co
 TW_API int      TW_CALL TwAddVarCB(TwBar *bar, const char *name, TwType type, TwSetVarCallback setCallback, TwGetVarCallback getCallback, void *clientData, const char *def);
 TW_API int      TW_CALL TwAddButton(TwBar *bar, const char *name, TwButtonCallback callback, void *clientData, const char *def);
 TW_API int      TW_CALL TwAddSeparator(TwBar *bar, const char *name, const char *def);
+TW_API int      TW_CALL TwAddVarArrayRW(TwBar *bar, const char *name, TwType elementType, void *array, unsigned int count, size_t stride, const char *def); // stride in bytes, 0 if elements are contiguous
+TW_API int      TW_CALL TwAddVarArrayRO(TwBar *bar, const char *name, TwType elementType, const void *array, unsigned int count, size_t stride, const char *def);
+TW_API int      TW_CALL TwAddVarPlot(TwBar *bar, const char *name, TwType type, const void *var, unsigned int historySize, const char *def); // graph of the last historySize samples of var
+TW_API int      TW_CALL TwAddVarPlotCB(TwBar *bar, const char *name, TwType type, TwGetVarCallback getCallback, void *clientData, unsigned int historySize, const char *def);
 TW_API int      TW_CALL TwRemoveVar(TwBar *bar, const char *name);
 TW_API int      TW_CALL TwRemoveAllVars(TwBar *bar);
 
@@ -166,6 +178,9 @@ typedef void (TW_CALL * TwSummaryCallback)(char *summaryString, size_t summaryMa
 TW_API int      TW_CALL TwDefine(const char *def);
 TW_API TwType   TW_CALL TwDefineEnum(const char *name, const TwEnumVal *enumValues, unsigned int nbValues);
 TW_API TwType   TW_CALL TwDefineEnumFromString(const char *name, const char *enumString);
+typedef unsigned int (TW_CALL * TwGetEnumCountCallback)(void *clientData);
+typedef void (TW_CALL * TwGetEnumValCallback)(unsigned int index, TwEnumVal *enumVal, void *clientData); // enumVal->Label is copied when the callback returns
+TW_API TwType   TW_CALL TwDefineEnumCB(const char *name, TwGetEnumCountCallback countCallback, TwGetEnumValCallback valCallback, const unsigned int *generation, void *clientData); // entries are queried again when *generation changes (at each use if generation is NULL)
 TW_API TwType   TW_CALL TwDefineStruct(const char *name, const TwStructMember *structMembers, unsigned int nbMembers, size_t structSize, TwSummaryCallback summaryCallback, void *summaryClientData);
 
 typedef void (TW_CALL * TwCopyCDStringToClient)(char **destinationClientStringPtr, const char *sourceString);
@@ -177,6 +192,11 @@ TW_API void     TW_CALL TwCopyStdStringToClientFunc(TwCopyStdStringToClient copy
 TW_API void     TW_CALL TwCopyStdStringToLibrary(std::string& destinationLibraryString, const std::string& sourceClientString);
 #endif // __cplusplus
 
+// Strings are UTF-8 encoded. Glyphs missing from the built-in fonts are requested from this callback:
+// it writes an 8-bit alpha bitmap of maxWidth x height pixels and returns the glyph width (0 if unavailable).
+typedef int (TW_CALL * TwRasterizeGlyph)(unsigned int codePoint, unsigned char *alphaBitmap, int maxWidth, int height, void *clientData);
+TW_API void     TW_CALL TwRasterizeGlyphFunc(TwRasterizeGlyph rasterizeGlyphFunc, void *clientData);
+
 typedef enum ETwParamValueType
 {
     TW_PARAM_INT32,
@@ -187,6 +207,26 @@ typedef enum ETwParamValueType
 TW_API int      TW_CALL TwGetParam(TwBar *bar, const char *varName, const char *paramName, TwParamValueType paramValueType, unsigned int outValueMaxCount, void *outValues);
 TW_API int      TW_CALL TwSetParam(TwBar *bar, const char *varName, const char *paramName, TwParamValueType paramValueType, unsigned int inValueCount, const void *inValues);
 
+// Binary snapshot of the writable var values of all bars (only valid for the platform that saved it)
+TW_API const void * TW_CALL TwSaveState(size_t *stateSize); // returned data is valid until the next call
+TW_API int      TW_CALL TwLoadState(const void *state, size_t stateSize); // only the vars whose value differs are set
+TW_API int      TW_CALL TwSavePreset(const char *fileName);   // writes the state to a file
+TW_API int      TW_CALL TwApplyPreset(const char *fileName);  // maps a file written by TwSavePreset and loads its state
+
+// Edits of the vars defined with coalesce=true (or commit=ondraw) are applied once per TwDraw with their last value.
+// With commit=onrelease or commit=throttle:<ms>, edits made while a mouse button is down are applied
+// when it is released, or at most once per throttle period.
+typedef struct CTwChange
+{
+    TwBar *       Bar;
+    const char *  VarName;
+    TwType        Type;
+    const void *  Value;    // new value, valid during the callback only
+} TwChange;
+typedef void (TW_CALL * TwChangeStreamCallback)(const TwChange *changes, unsigned int changeCount, void *clientData);
+TW_API void     TW_CALL TwChangeStreamFunc(TwChangeStreamCallback changeStreamFunc, void *clientData); // receives each batch of coalesced changes
+TW_API int      TW_CALL TwFlushChanges();   // applies the coalesced changes now rather than at the next TwDraw
+
 
 // ----------------------------------------------------------------------------
 //  Management functions and definitions
@@ -207,6 +247,34 @@ TW_API int      TW_CALL TwTerminate();
 
 TW_API int      TW_CALL TwDraw();
 TW_API int      TW_CALL TwDrawContext(void *context);
+TW_API int      TW_CALL TwRecord();                 // record draw commands without graphic API calls
+TW_API int      TW_CALL TwSubmit(void *context);    // replay the last recorded commands, possibly on another thread than TwRecord
+
+typedef struct CTwFrameStats
+{
+    unsigned int  Frame;            // frame index (number of TwDraw calls)
+    double        DrawTime;         // TwDraw total time in ms
+    double        UpdateTime;       // time spent refreshing values and computing bar layouts in ms
+    double        TextTime;         // time spent tessellating texts in ms
+    double        SubmitTime;       // time spent issuing draw calls in ms
+    int           NbUpdates;        // number of bar updates
+    int           NbGlyphs;         // number of glyphs tessellated
+    int           NbDrawCalls;      // number of draw calls issued to the graphic API
+    int           NbUploadedBytes;  // vertex data sent to the graphic API (OpenGL and Direct3D9 only)
+    int           NbAllocs;         // number of memory blocks allocated through the library allocator
+    size_t        LiveBytes;        // memory allocated through the library allocator at the end of the frame
+} TwFrameStats;
+typedef void (TW_CALL * TwFrameStatsCallback)(const TwFrameStats *frameStats, void *clientData);
+
+TW_API int      TW_CALL TwGetFrameStats(TwFrameStats *frameStats, int maxCount); // copies the last frames stats (oldest first) and returns their number
+TW_API int      TW_CALL TwSetFrameStatsCallback(TwFrameStatsCallback callback, void *clientData); // callback called at the end of each frame
+
+typedef void * (TW_CALL * TwAllocCallback)(size_t size, void *clientData);
+typedef void   (TW_CALL * TwFreeCallback)(void *ptr, void *clientData);
+// The allocator receives the bars and their variables, the text objects and their vertex arrays, the string pool
+// tables, the glyph maps of the fonts and the recorded command lists. The characters of std::string (labels,
+// values, names), the font textures and the other manager tables (enums, types, shortcuts) use the default heap.
+TW_API int      TW_CALL TwSetAllocator(TwAllocCallback allocFunc, TwFreeCallback freeFunc, void *clientData); // to be called before TwInit, NULL restores malloc/free
 TW_API int      TW_CALL TwWindowSize(int width, int height);
 
 TW_API int      TW_CALL TwSetCurrentWindow(int windowID); // multi-windows support
@@ -277,6 +345,25 @@ TW_API int      TW_CALL TwMouseButton(TwMouseAction action, TwMouseButtonID butt
 TW_API int      TW_CALL TwMouseMotion(int mouseX, int mouseY);
 TW_API int      TW_CALL TwMouseWheel(int pos);
 
+typedef enum ETwEventType
+{
+    TW_EVENT_MOUSE_MOTION,  // uses MouseX, MouseY
+    TW_EVENT_MOUSE_BUTTON,  // uses Action, Button
+    TW_EVENT_MOUSE_WHEEL,   // uses WheelPos
+    TW_EVENT_KEY_PRESSED    // uses Key, Modifiers
+} TwEventType;
+typedef struct CTwEvent
+{
+    TwEventType     Type;
+    int             MouseX, MouseY;
+    TwMouseAction   Action;
+    TwMouseButtonID Button;
+    int             WheelPos;
+    int             Key, Modifiers;
+} TwEvent;
+
+TW_API int      TW_CALL TwProcessEvents(const TwEvent *events, int count); // returns the number of handled events
+
 TW_API const char * TW_CALL TwGetLastError();
 typedef void (TW_CALL * TwErrorHandler)(const char *errorMessage);
 TW_API void     TW_CALL TwHandleErrors(TwErrorHandler errorHandler);
@@ -302,6 +389,7 @@ TW_API void     TW_CALL TwHandleErrors(TwErrorHandler errorHandler);
 
 // For libSDL event loop
 TW_API int      TW_CALL TwEventSDL(const void *sdlEvent, unsigned char sdlMajorVersion, unsigned char sdlMinorVersion);
+TW_API int      TW_CALL TwEventSDLBatch(const void *sdlEvents, int count, int eventSize, unsigned char sdlMajorVersion, unsigned char sdlMinorVersion);
 
 // For GLFW event callbacks
 // You should define GLFW_CDECL before including AntTweakBar.h if your version of GLFW uses cdecl calling convensions
@@ -342,10 +430,12 @@ typedef void (TW_GLUT_CALL *GLUTspecialfun)(int glutKey, int mouseX, int mouseY)
 
 // For SFML event loop
 TW_API int      TW_CALL TwEventSFML(const void *sfmlEvent, unsigned char sfmlMajorVersion, unsigned char sfmlMinorVersion);
+TW_API int      TW_CALL TwEventSFMLBatch(const void *sfmlEvents, int count, int eventSize, unsigned char sfmlMajorVersion, unsigned char sfmlMinorVersion);
 
 // For X11 event loop
 #if defined(_UNIX)
     TW_API int TW_CDECL_CALL TwEventX11(void *xevent);
+    TW_API int TW_CDECL_CALL TwEventX11Batch(void *xevents, int count);
 #endif
 
 // ----------------------------------------------------------------------------
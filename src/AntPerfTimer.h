@@ -35,19 +35,27 @@
 #else // !_WIN (-> LINUX)
 
     #include <sys/time.h>
+    #include <time.h>
     #include <unistd.h>
 
+    // Uses the monotonic clock (nanosecond resolution, not affected by system 
+    // time changes) when available, gettimeofday otherwise.
     struct PerfTimer
     {
         inline        PerfTimer()   { Reset(); }
-        inline void   Reset()       { gettimeofday(&Start, &TZ); }
-        inline double GetTime()     { gettimeofday(&End,&TZ); 
-                                      double t1 = (double)Start.tv_sec + (double)Start.tv_usec/(1000*1000);
-                                      double t2 = (double)End.tv_sec + (double)End.tv_usec/(1000*1000);
-                                      return t2-t1; }
+        inline void   Reset()       { Start = Now(); }
+        inline double GetTime()     { return Now()-Start; }
+        static inline double Now()  {
+                                    #if defined(CLOCK_MONOTONIC)
+                                      struct timespec ts;
+                                      if( clock_gettime(CLOCK_MONOTONIC, &ts)==0 )
+                                          return (double)ts.tv_sec + (double)ts.tv_nsec/(1000*1000*1000);
+                                    #endif
+                                      struct timeval tv;
+                                      gettimeofday(&tv, NULL);
+                                      return (double)tv.tv_sec + (double)tv.tv_usec/(1000*1000); }
     protected:
-        struct timeval Start, End;
-        struct timezone TZ;
+        double Start;
     };
 
 #endif // _WIN
@@ -328,6 +328,18 @@ ANT_GL_CORE_IMPL(glFramebufferTexture)
     }
 #endif
 
+// GL 3.0 glGetStringi, GL_ARB_map_buffer_range, GL_ARB_sync, GL_ARB_buffer_storage
+// these are optional and loaded explicitely by LoadOptionalFunctions (NULL if not available)
+namespace GLCore
+{
+    PFNglGetStringi _glGetStringi = NULL;
+    PFNglMapBufferRange _glMapBufferRange = NULL;
+    PFNglFenceSync _glFenceSync = NULL;
+    PFNglClientWaitSync _glClientWaitSync = NULL;
+    PFNglDeleteSync _glDeleteSync = NULL;
+    PFNglBufferStorage _glBufferStorage = NULL;
+}
+
 #if defined(ANT_WINDOWS)
     ANT_GL_CORE_IMPL(wglGetProcAddress)
 #endif
@@ -336,6 +348,30 @@ namespace GLCore { PFNGLGetProcAddress _glGetProcAddress = NULL; }
 
 //  ---------------------------------------------------------------------------
 
+static void LoadOptionalFunctions()
+{
+    // _glGetProcAddress may return a non-NULL pointer for unsupported functions:
+    // callers must also check that the corresponding extension is supported.
+    _glGetStringi = reinterpret_cast<PFNglGetStringi>(_glGetProcAddress("glGetStringi"));
+    _glMapBufferRange = reinterpret_cast<PFNglMapBufferRange>(_glGetProcAddress("glMapBufferRange"));
+    _glFenceSync = reinterpret_cast<PFNglFenceSync>(_glGetProcAddress("glFenceSync"));
+    _glClientWaitSync = reinterpret_cast<PFNglClientWaitSync>(_glGetProcAddress("glClientWaitSync"));
+    _glDeleteSync = reinterpret_cast<PFNglDeleteSync>(_glGetProcAddress("glDeleteSync"));
+    _glBufferStorage = reinterpret_cast<PFNglBufferStorage>(_glGetProcAddress("glBufferStorage"));
+}
+
+static void UnloadOptionalFunctions()
+{
+    _glGetStringi = NULL;
+    _glMapBufferRange = NULL;
+    _glFenceSync = NULL;
+    _glClientWaitSync = NULL;
+    _glDeleteSync = NULL;
+    _glBufferStorage = NULL;
+}
+
+//  ---------------------------------------------------------------------------
+
 #if defined(ANT_WINDOWS)
 
     //  ---------------------------------------------------------------------------
@@ -379,6 +415,8 @@ namespace GLCore { PFNGLGetProcAddress _glGetProcAddress = NULL; }
                     }
         
                 }
+            if( _glGetProcAddress!=NULL )
+                LoadOptionalFunctions();
 
             return Res;
         }
@@ -407,6 +445,7 @@ namespace GLCore { PFNGLGetProcAddress _glGetProcAddress = NULL; }
             assert(strlen(g_OGLCoreFuncRec[i].m_Name)>0);
             *(g_OGLCoreFuncRec[i].m_FuncPtr) = NULL;
         }
+        UnloadOptionalFunctions();
         if( FreeLibrary(g_OGLCoreModule) )
         {
             // Info(VERB_LOW, "OpenGL library unloaded");
@@ -464,12 +503,14 @@ namespace GLCore { PFNGLGetProcAddress _glGetProcAddress = NULL; }
             fprintf(stderr, "AntTweakBar: OpenGL Core Profile functions cannot be loaded.\n");
             return 0;
         }
-        else
-            return 1;
+
+        LoadOptionalFunctions();
+        return 1;
     }
     
     int UnloadOpenGLCore()
     {
+        UnloadOptionalFunctions();
         return 1;
     }
     
@@ -521,11 +562,13 @@ namespace GLCore { PFNGLGetProcAddress _glGetProcAddress = NULL; }
 			}
         }
         
+        LoadOptionalFunctions();
         return 1;
     }
 
     int UnloadOpenGLCore() 
     {
+       UnloadOptionalFunctions();
        if (gl_dyld) 
        {
            dlclose(gl_dyld);
@@ -365,6 +365,21 @@ ANT_GL_CORE_DECL_NO_FORWARD(void, glBindVertexArray, (GLuint array))
 ANT_GL_CORE_DECL_NO_FORWARD(void, glDeleteVertexArrays, (GLsizei n, const GLuint *arrays))
 ANT_GL_CORE_DECL_NO_FORWARD(void, glGenVertexArrays, (GLsizei n, GLuint *arrays))
 ANT_GL_CORE_DECL_NO_FORWARD(GLboolean, glIsVertexArray, (GLuint array))
+// GL 3.0 glGetStringi, GL_ARB_map_buffer_range, GL_ARB_sync, GL_ARB_buffer_storage (optional: NULL if not available)
+#ifndef GL_VERSION_3_2
+    typedef struct __GLsync *GLsync;
+#endif
+#if defined(_MSC_VER)
+    typedef unsigned __int64 ANT_GLuint64;
+#else
+    typedef unsigned long long ANT_GLuint64;
+#endif
+ANT_GL_CORE_DECL_NO_FORWARD(const GLubyte *, glGetStringi, (GLenum name, GLuint index))
+ANT_GL_CORE_DECL_NO_FORWARD(GLvoid*, glMapBufferRange, (GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access))
+ANT_GL_CORE_DECL_NO_FORWARD(GLsync, glFenceSync, (GLenum condition, GLbitfield flags))
+ANT_GL_CORE_DECL_NO_FORWARD(GLenum, glClientWaitSync, (GLsync sync, GLbitfield flags, ANT_GLuint64 timeout))
+ANT_GL_CORE_DECL_NO_FORWARD(void, glDeleteSync, (GLsync sync))
+ANT_GL_CORE_DECL_NO_FORWARD(void, glBufferStorage, (GLenum target, GLsizeiptr size, const GLvoid *data, GLbitfield flags))
 
 
 #ifdef ANT_WINDOWS
@@ -410,6 +425,29 @@ ANT_GL_CORE_DECL(PROC, wglGetProcAddress, (LPCSTR))
 #ifndef GL_BGRA
 #   define GL_BGRA              0x80E1
 #endif
+#ifndef GL_STREAM_DRAW
+#   define GL_STREAM_DRAW       0x88E0
+#endif
+#ifndef GL_NUM_EXTENSIONS
+#   define GL_NUM_EXTENSIONS    0x821D
+#endif
+#ifndef GL_MAP_WRITE_BIT
+#   define GL_MAP_WRITE_BIT             0x0002
+#   define GL_MAP_INVALIDATE_RANGE_BIT  0x0004
+#   define GL_MAP_UNSYNCHRONIZED_BIT    0x0020
+#endif
+#ifndef GL_MAP_PERSISTENT_BIT
+#   define GL_MAP_PERSISTENT_BIT        0x0040
+#   define GL_MAP_COHERENT_BIT          0x0080
+#endif
+#ifndef GL_SYNC_GPU_COMMANDS_COMPLETE
+#   define GL_SYNC_GPU_COMMANDS_COMPLETE    0x9117
+#   define GL_SYNC_FLUSH_COMMANDS_BIT       0x00000001
+#   define GL_ALREADY_SIGNALED              0x911A
+#   define GL_TIMEOUT_EXPIRED               0x911B
+#   define GL_CONDITION_SATISFIED           0x911C
+#   define GL_WAIT_FAILED                   0x911D
+#endif
 
 
 #endif // !defined ANT_LOAD_OGL_CORE_INCLUDED
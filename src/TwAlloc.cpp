@@ -0,0 +1,81 @@
+//  ---------------------------------------------------------------------------
+//
+//  @file       TwAlloc.cpp
+//  @author     Philippe Decaudin
+//  @license    This file is part of the AntTweakBar library.
+//              For conditions of distribution and use, see License.txt
+//
+//  ---------------------------------------------------------------------------
+
+
+#include "TwPrecomp.h"
+#include "TwAlloc.h"
+
+using namespace std;
+
+
+size_t g_TwAllocLiveBytes = 0;
+unsigned int g_TwAllocCount = 0;
+
+static void * TW_CALL DefaultAlloc(size_t _Size, void * /*_ClientData*/)
+{
+    return malloc(_Size);
+}
+
+static void TW_CALL DefaultFree(void *_Ptr, void * /*_ClientData*/)
+{
+    free(_Ptr);
+}
+
+static TwAllocCallback  s_AllocFunc = DefaultAlloc;
+static TwFreeCallback   s_FreeFunc = DefaultFree;
+static void *           s_AllocClientData = NULL;
+
+// Each block is prefixed by its size, the header keeps the block 16-byte aligned
+static const size_t ALLOC_HEADER_SIZE = 16;
+
+//  ---------------------------------------------------------------------------
+
+void *TwAllocMem(size_t _Size)
+{
+    unsigned char *Block = (unsigned char *)s_AllocFunc(_Size + ALLOC_HEADER_SIZE, s_AllocClientData);
+    if( Block==NULL )
+        throw bad_alloc();
+    *(size_t *)Block = _Size;
+    g_TwAllocLiveBytes += _Size;
+    ++g_TwAllocCount;
+    return Block + ALLOC_HEADER_SIZE;
+}
+
+//  ---------------------------------------------------------------------------
+
+void TwFreeMem(void *_Ptr)
+{
+    if( _Ptr==NULL )
+        return;
+    unsigned char *Block = (unsigned char *)_Ptr - ALLOC_HEADER_SIZE;
+    assert( g_TwAllocLiveBytes>=*(size_t *)Block );
+    g_TwAllocLiveBytes -= *(size_t *)Block;
+    s_FreeFunc(Block, s_AllocClientData);
+}
+
+//  ---------------------------------------------------------------------------
+
+bool TwSetAllocMem(TwAllocCallback _AllocFunc, TwFreeCallback _FreeFunc, void *_ClientData)
+{
+    if( g_TwAllocLiveBytes!=0 )
+        return false;   // blocks must be freed by the allocator which allocated them
+    if( _AllocFunc==NULL || _FreeFunc==NULL )
+    {
+        s_AllocFunc = DefaultAlloc;
+        s_FreeFunc = DefaultFree;
+        s_AllocClientData = NULL;
+    }
+    else
+    {
+        s_AllocFunc = _AllocFunc;
+        s_FreeFunc = _FreeFunc;
+        s_AllocClientData = _ClientData;
+    }
+    return true;
+}
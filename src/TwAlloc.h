@@ -0,0 +1,84 @@
+//  ---------------------------------------------------------------------------
+//
+//  @file       TwAlloc.h
+//  @brief      Memory allocation of the library objects and containers
+//  @author     Philippe Decaudin
+//  @license    This file is part of the AntTweakBar library.
+//              For conditions of distribution and use, see License.txt
+//
+//  note:       Private header
+//              Memory is obtained through the callbacks set by
+//              TwSetAllocator (malloc and free by default). Classes derived
+//              from CTwAllocated and containers using TTwAllocator are
+//              allocated this way: bar and variable containers, string
+//              pool tables, glyph maps, text vertices and recorded
+//              commands. std::string buffers are not.
+//
+//  ---------------------------------------------------------------------------
+
+
+#if !defined ANT_TW_ALLOC_INCLUDED
+#define ANT_TW_ALLOC_INCLUDED
+
+#include <AntTweakBar.h>
+#include <cstddef>
+#include <new>
+#include <utility>
+
+
+void *          TwAllocMem(size_t _Size);   // throws std::bad_alloc if the allocator fails
+void            TwFreeMem(void *_Ptr);
+bool            TwSetAllocMem(TwAllocCallback _AllocFunc, TwFreeCallback _FreeFunc, void *_ClientData);
+
+extern size_t       g_TwAllocLiveBytes;     // bytes currently allocated by TwAllocMem
+extern unsigned int g_TwAllocCount;         // number of TwAllocMem calls since startup
+
+
+//  ---------------------------------------------------------------------------
+
+struct CTwAllocated
+{
+    static void *   operator new(size_t _Size)              { return TwAllocMem(_Size); }
+    static void     operator delete(void *_Ptr)             { TwFreeMem(_Ptr); }
+    static void *   operator new(size_t, void *_Where)      { return _Where; }
+    static void     operator delete(void *, void *)         {}
+};
+
+//  ---------------------------------------------------------------------------
+
+template <typename _T>
+struct TTwAllocator
+{
+    typedef _T              value_type;
+    typedef _T *            pointer;
+    typedef const _T *      const_pointer;
+    typedef _T&             reference;
+    typedef const _T&       const_reference;
+    typedef size_t          size_type;
+    typedef ptrdiff_t       difference_type;
+    template <typename _U>  struct rebind { typedef TTwAllocator<_U> other; };
+
+                            TTwAllocator() {}
+    template <typename _U>  TTwAllocator(const TTwAllocator<_U>&) {}
+    pointer                 address(reference _X) const { return &_X; }
+    const_pointer           address(const_reference _X) const { return &_X; }
+    pointer                 allocate(size_type _N, const void * =0) { return static_cast<pointer>(TwAllocMem(_N*sizeof(_T))); }
+    void                    deallocate(pointer _P, size_type) { TwFreeMem(_P); }
+    size_type               max_size() const { return ((size_type)-1)/sizeof(_T); }
+#if __cplusplus>=201103L
+    template <typename _U, typename... _Args> void construct(_U *_P, _Args&&... _Vals) { ::new((void *)_P) _U(std::forward<_Args>(_Vals)...); }
+    template <typename _U>  void destroy(_U *_P) { _P->~_U(); }
+#else
+    void                    construct(pointer _P, const _T& _Val) { ::new((void *)_P) _T(_Val); }
+    void                    destroy(pointer _P) { _P->~_T(); }
+#endif
+};
+
+template <typename _T, typename _U> inline bool operator==(const TTwAllocator<_T>&, const TTwAllocator<_U>&) { return true; }
+template <typename _T, typename _U> inline bool operator!=(const TTwAllocator<_T>&, const TTwAllocator<_U>&) { return false; }
+
+
+//  ---------------------------------------------------------------------------
+
+
+#endif // !defined ANT_TW_ALLOC_INCLUDED
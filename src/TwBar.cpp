@@ -13,6 +13,7 @@
 #include "TwMgr.h"
 #include "TwBar.h"
 #include "TwColors.h"
+#include "TwGraphRecorder.h"
   
 using namespace std;
 
@@ -25,10 +26,6 @@ const char *g_ErrBadValue       = "Bad value";
 const char *g_ErrUnknownType    = "Unknown type";
 const char *g_ErrNotEnum        = "Must be of type Enum";
 
-#undef PERF         // comment to print benchs
-#define PERF(cmd)
-
-
 PerfTimer g_BarTimer;
 
 #define ANT_SET_CURSOR(_Name)       g_TwMgr->SetCursor(g_TwMgr->m_Cursor##_Name)
@@ -36,6 +33,7 @@ PerfTimer g_BarTimer;
 
 #if !defined(ANT_WINDOWS)
 #   define _stricmp strcasecmp
+#   define _strnicmp strncasecmp
 #   define _strdup  strdup
 #endif  // defined(ANT_WINDOWS)
 
@@ -64,6 +62,78 @@ bool IsEnumType(int _Type)
 
 //  ---------------------------------------------------------------------------
 
+CTwVarArena::CTwVarArena()
+{
+    for( int i=0; i<NB_SIZE_CLASSES; ++i )
+    {
+        m_FreeSlots[i] = NULL;
+        m_ChunkSlots[i] = MIN_CHUNK_SLOTS;
+    }
+    m_NbUsedSlots = 0;
+}
+
+CTwVarArena::~CTwVarArena()
+{
+    assert( m_NbUsedSlots==0 );
+    for( size_t i=0; i<m_Chunks.size(); ++i )
+        TwFreeMem(m_Chunks[i]);
+}
+
+void *CTwVarArena::Alloc(CTwVarArena *_Arena, size_t _Size)
+{
+    int Class = (int)((_Size+SLOT_ALIGN-1)/SLOT_ALIGN);
+    if( _Arena==NULL || Class>=NB_SIZE_CLASSES )
+    {
+        CSlotHeader *Slot = (CSlotHeader *)TwAllocMem(sizeof(CSlotHeader)+_Size);
+        Slot->m_Info.m_Arena = NULL;
+        Slot->m_Info.m_SizeClass = Class;
+        return Slot+1;
+    }
+
+    if( _Arena->m_FreeSlots[Class]==NULL )
+    {
+        // add a chunk, its slots are linked so that they are used in address order
+        int NbSlots = _Arena->m_ChunkSlots[Class];
+        size_t SlotSize = sizeof(CSlotHeader) + Class*SLOT_ALIGN;
+        unsigned char *Chunk = (unsigned char *)TwAllocMem(NbSlots*SlotSize);
+        _Arena->m_Chunks.push_back(Chunk);
+        for( int i=NbSlots-1; i>=0; --i )
+        {
+            CSlotHeader *Slot = (CSlotHeader *)(Chunk + i*SlotSize);
+            Slot->m_Info.m_Arena = _Arena;
+            Slot->m_Info.m_SizeClass = Class;
+            *(void **)(Slot+1) = _Arena->m_FreeSlots[Class];
+            _Arena->m_FreeSlots[Class] = Slot+1;
+        }
+        if( NbSlots<MAX_CHUNK_SLOTS )
+            _Arena->m_ChunkSlots[Class] = 2*NbSlots;
+    }
+
+    void *Ptr = _Arena->m_FreeSlots[Class];
+    _Arena->m_FreeSlots[Class] = *(void **)Ptr;
+    ++_Arena->m_NbUsedSlots;
+    return Ptr;
+}
+
+void CTwVarArena::Free(void *_Ptr)
+{
+    if( _Ptr==NULL )
+        return;
+    CSlotHeader *Slot = (CSlotHeader *)_Ptr - 1;
+    CTwVarArena *Arena = Slot->m_Info.m_Arena;
+    if( Arena==NULL )
+        TwFreeMem(Slot);
+    else
+    {
+        int Class = Slot->m_Info.m_SizeClass;
+        *(void **)_Ptr = Arena->m_FreeSlots[Class];
+        Arena->m_FreeSlots[Class] = _Ptr;
+        --Arena->m_NbUsedSlots;
+    }
+}
+
+//  ---------------------------------------------------------------------------
+
 CTwVar::CTwVar()
 { 
     m_IsRoot = false; 
@@ -93,6 +163,10 @@ CTwVarAtom::CTwVarAtom()
 
 CTwVarAtom::~CTwVarAtom()
 {
+    if( g_TwMgr!=NULL && (m_KeyIncr[0]>0 || m_KeyDecr[0]>0) )
+        g_TwMgr->RemoveShortcuts(this);
+    if( g_TwMgr!=NULL && m_SetCallback==CTwMgr::CChangeProxy::SetCB )
+        g_TwMgr->RemoveChangeProxy(static_cast<CTwMgr::CChangeProxy *>(m_ClientData));  // a pending edit is dropped
     if( m_Type==TW_TYPE_BOOL8 || m_Type==TW_TYPE_BOOL16 || m_Type==TW_TYPE_BOOL32 || m_Type==TW_TYPE_BOOLCPP )
     {
         if( m_Val.m_Bool.m_FreeTrueString && m_Val.m_Bool.m_TrueString!=NULL )
@@ -106,6 +180,11 @@ CTwVarAtom::~CTwVarAtom()
             m_Val.m_Bool.m_FalseString = NULL;
         }
     }
+    else if( m_Type==TW_TYPE_STRINGVIEW && m_Val.m_StringView.m_Line!=NULL )
+    {
+        delete m_Val.m_StringView.m_Line;
+        m_Val.m_StringView.m_Line = NULL;
+    }
     else if( m_Type==TW_TYPE_CDSTDSTRING && m_GetCallback==CTwMgr::CCDStdString::GetCB && m_ClientData!=NULL && g_TwMgr!=NULL )
     {
         // delete corresponding g_TwMgr->m_CDStdStrings element
@@ -457,6 +536,7 @@ void CTwVarAtom::ValueToString(string *_Str) const
                 Val = *(unsigned int *)m_Ptr;
 
             CTwMgr::CEnum& e = g_TwMgr->m_Enums[m_Type-TW_TYPE_ENUM_BASE];
+            e.Sync();
             CTwMgr::CEnum::CEntries::iterator It = e.m_Entries.find(Val);
             if( It!=e.m_Entries.end() )
                 *_Str = It->second;
@@ -497,6 +577,12 @@ void CTwVarAtom::ValueToString(string *_Str) const
             else
                 *_Str = "";
         }
+        else if( m_Type==TW_TYPE_STRINGVIEW )
+        {
+            TwStringView View;
+            GetStringView(&View);
+            _Str->assign(View.Str, View.Length);
+        }
         else if( IsCustom() ) // m_Type>=TW_TYPE_CUSTOM_BASE && m_Type<TW_TYPE_CUSTOM_BASE+(int)g_TwMgr->m_Customs.size() )
         {
             *_Str = "";
@@ -511,6 +597,35 @@ void CTwVarAtom::ValueToString(string *_Str) const
 
 //  ---------------------------------------------------------------------------
 
+void CTwVarAtom::GetStringView(TwStringView *_View) const
+{
+    assert( m_Type==TW_TYPE_STRINGVIEW );
+    _View->Str = NULL;
+    _View->Length = 0;
+    _View->Generation = 0;
+    if( m_GetCallback!=NULL )
+        m_GetCallback(_View, m_ClientData);
+    else if( m_Ptr!=NULL )
+        *_View = *static_cast<const TwStringView *>(m_Ptr);
+    if( _View->Str==NULL )
+        _View->Length = 0;
+}
+
+void CTwVarAtom::SetStringView(const char *_Str, size_t _Length)
+{
+    assert( m_Type==TW_TYPE_STRINGVIEW );
+    if( m_SetCallback!=NULL )   // a view is never written through m_Ptr: the client owns the chars
+    {
+        TwStringView View;
+        View.Str = _Str;
+        View.Length = _Length;
+        View.Generation = 0;
+        m_SetCallback(&View, m_ClientData);
+    }
+}
+
+//  ---------------------------------------------------------------------------
+
 double CTwVarAtom::ValueToDouble() const
 {
     if( m_Ptr==NULL && m_GetCallback==NULL )
@@ -935,9 +1050,19 @@ void CTwVarAtom::MinMaxStepToDouble(double *_Min, double *_Max, double *_Step) c
 
 //  ---------------------------------------------------------------------------
 
-const CTwVar *CTwVarAtom::Find(const char *_Name, CTwVarGroup **_Parent, int *_Index) const
+const CTwVar *CTwVar::Find(const char *_Name, CTwVarGroup **_Parent, int *_Index) const
 {
-    if( strcmp(_Name, m_Name.c_str())==0 )
+    CTwIString::Id NameId;
+    if( _Name==NULL || _Name[0]=='\0' || !CTwIString::FindId(_Name, &NameId) )
+        return NULL;    // no var has this name
+    return Find(NameId, _Parent, _Index);
+}
+
+//  ---------------------------------------------------------------------------
+
+const CTwVar *CTwVarAtom::Find(CTwIString::Id _Name, CTwVarGroup **_Parent, int *_Index) const
+{
+    if( _Name==m_Name.GetId() )
     {
         if( _Parent!=NULL )
             *_Parent = NULL;
@@ -1094,7 +1219,7 @@ int CTwVar::SetAttrib(int _AttribID, const char *_Value, TwBar *_Bar, struct CTw
 					Grp = static_cast<CTwVarGroup *>(v);
 					if (Grp == NULL)
 					{
-						Grp = new CTwVarGroup;
+						Grp = new(&_Bar->m_VarArena) CTwVarGroup;
 						Grp->m_Name = grpName;
 						Grp->m_Open = true;
 						Grp->m_SummaryCallback = NULL;
@@ -1276,7 +1401,9 @@ enum EVarAtomAttribs
     VA_TRUE,
     VA_FALSE,
     VA_ENUM,
-    VA_VALUE
+    VA_VALUE,
+    VA_COALESCE,
+    VA_COMMIT
 };
 
 int CTwVarAtom::HasAttrib(const char *_Attrib, bool *_HasValue) const
@@ -1310,10 +1437,59 @@ int CTwVarAtom::HasAttrib(const char *_Attrib, bool *_HasValue) const
         return VA_ENUM;
     else if( _stricmp(_Attrib, "value")==0 )
         return VA_VALUE;
+    else if( _stricmp(_Attrib, "coalesce")==0 )
+        return VA_COALESCE;
+    else if( _stricmp(_Attrib, "commit")==0 )
+        return VA_COMMIT;
 
     return CTwVar::HasAttrib(_Attrib, _HasValue);
 }
 
+//  ---------------------------------------------------------------------------
+
+// Parses "immediate", "ondraw", "onrelease" or "throttle:<period>" (period in ms, or in s with a 's' suffix)
+static int ParseCommitMode(const char *_Value, int *_Mode, double *_ThrottlePeriod)
+{
+    *_ThrottlePeriod = 0;
+    if( _Value==NULL )
+        return 0;
+    if( _stricmp(_Value, "immediate")==0 )
+        *_Mode = CTwMgr::COMMIT_IMMEDIATE;
+    else if( _stricmp(_Value, "ondraw")==0 )
+        *_Mode = CTwMgr::COMMIT_ONDRAW;
+    else if( _stricmp(_Value, "onrelease")==0 )
+        *_Mode = CTwMgr::COMMIT_ONRELEASE;
+    else if( _strnicmp(_Value, "throttle:", 9)==0 )
+    {
+        char *End = NULL;
+        double Period = strtod(_Value+9, &End);
+        if( End==_Value+9 || Period<0 )
+            return 0;
+        if( _stricmp(End, "s")==0 )
+            *_ThrottlePeriod = Period;
+        else if( *End=='\0' || _stricmp(End, "ms")==0 )
+            *_ThrottlePeriod = 0.001*Period;
+        else
+            return 0;
+        *_Mode = CTwMgr::COMMIT_THROTTLE;
+    }
+    else
+        return 0;
+    return 1;
+}
+
+static void CommitModeString(std::ostringstream& _String, int _Mode, double _ThrottlePeriod)
+{
+    if( _Mode==CTwMgr::COMMIT_ONDRAW )
+        _String << "ondraw";
+    else if( _Mode==CTwMgr::COMMIT_ONRELEASE )
+        _String << "onrelease";
+    else if( _Mode==CTwMgr::COMMIT_THROTTLE )
+        _String << "throttle:" << 1000.0*_ThrottlePeriod << "ms";
+    else
+        _String << "immediate";
+}
+
 int CTwVarAtom::SetAttrib(int _AttribID, const char *_Value, TwBar *_Bar, struct CTwVarGroup *_VarParent, int _VarIndex)
 {
     switch( _AttribID )
@@ -1324,8 +1500,11 @@ int CTwVarAtom::SetAttrib(int _AttribID, const char *_Value, TwBar *_Bar, struct
             int Mod = 0;
             if( TwGetKeyCode(&Key, &Mod, _Value) )
             {
+                g_TwMgr->RemoveShortcuts(this);
                 m_KeyIncr[0] = Key;
                 m_KeyIncr[1] = Mod;
+                if( _Bar!=NULL )
+                    g_TwMgr->AddShortcuts(this, _Bar);
                 return 1;
             }
             else
@@ -1337,8 +1516,11 @@ int CTwVarAtom::SetAttrib(int _AttribID, const char *_Value, TwBar *_Bar, struct
             int Mod = 0;
             if( TwGetKeyCode(&Key, &Mod, _Value) )
             {
+                g_TwMgr->RemoveShortcuts(this);
                 m_KeyDecr[0] = Key;
                 m_KeyDecr[1] = Mod;
+                if( _Bar!=NULL )
+                    g_TwMgr->AddShortcuts(this, _Bar);
                 return 1;
             }
             else
@@ -1541,6 +1723,11 @@ int CTwVarAtom::SetAttrib(int _AttribID, const char *_Value, TwBar *_Bar, struct
             }
         }
     case VA_ENUM:
+        if( IsEnumType(m_Type) && g_TwMgr->m_Enums[m_Type-TW_TYPE_ENUM_BASE].m_CountCallback!=NULL )
+        {
+            g_TwMgr->SetLastError(g_ErrInvalidAttrib); // entries are provided by the client callbacks
+            return 0;
+        }
         if( _Value && strlen(_Value)>0 && IsEnumType(m_Type) )
         {
             const char *s = _Value;
@@ -1548,6 +1735,7 @@ int CTwVarAtom::SetAttrib(int _AttribID, const char *_Value, TwBar *_Bar, struct
             unsigned int u;
             bool Cont;
             g_TwMgr->m_Enums[m_Type-TW_TYPE_ENUM_BASE].m_Entries.clear(); // anyway reset entries
+            ++g_TwMgr->m_Enums[m_Type-TW_TYPE_ENUM_BASE].m_Version;
             do
             {
                 Cont = false;
@@ -1575,15 +1763,12 @@ int CTwVarAtom::SetAttrib(int _AttribID, const char *_Value, TwBar *_Bar, struct
                         //UVal::CEnumVal::CEntries::value_type v(u, "");
                         CTwMgr::CEnum::CEntries::value_type v(u, "");
                         if( i>0 )
-                            v.second.assign(s, i);
+                            v.second = string(s, i);
                         //m_Val.m_Enum.m_Entries->insert(v);
                         pair<CTwMgr::CEnum::CEntries::iterator, bool> ret;
                         ret = g_TwMgr->m_Enums[m_Type-TW_TYPE_ENUM_BASE].m_Entries.insert(v);
                         if( !ret.second ) // force overwrite if element already exists
-                        {
-                            g_TwMgr->m_Enums[m_Type-TW_TYPE_ENUM_BASE].m_Entries.erase(ret.first);
-                            g_TwMgr->m_Enums[m_Type-TW_TYPE_ENUM_BASE].m_Entries.insert(v);
-                        }
+                            ret.first->second = v.second;
 
                         s += i+1;
                         i = 0;
@@ -1614,12 +1799,43 @@ int CTwVarAtom::SetAttrib(int _AttribID, const char *_Value, TwBar *_Bar, struct
             return 0;
         }
         break;
+    case VA_COALESCE:
+        if( _Value!=NULL && (_stricmp(_Value, "true")==0 || _stricmp(_Value, "1")==0) )
+            return g_TwMgr->SetCommitMode(this, _Bar, CTwMgr::COMMIT_ONDRAW, 0);
+        else if( _Value!=NULL && (_stricmp(_Value, "false")==0 || _stricmp(_Value, "0")==0) )
+            return g_TwMgr->SetCommitMode(this, _Bar, CTwMgr::COMMIT_IMMEDIATE, 0);
+        else
+        {
+            g_TwMgr->SetLastError(g_ErrBadValue);
+            return 0;
+        }
+    case VA_COMMIT:
+        {
+            int Mode;
+            double Period;
+            if( !ParseCommitMode(_Value, &Mode, &Period) )
+            {
+                g_TwMgr->SetLastError(g_ErrBadValue);
+                return 0;
+            }
+            return g_TwMgr->SetCommitMode(this, _Bar, Mode, Period);
+        }
     case VA_VALUE:
         if( _Value!=NULL && strlen(_Value)>0 ) // do not check ReadOnly here.
         {
             if( !( m_Type==TW_TYPE_BUTTON || IsCustom() ) ) // || (m_Type>=TW_TYPE_CUSTOM_BASE && m_Type<TW_TYPE_CUSTOM_BASE+(int)g_TwMgr->m_Customs.size()) ) )
             {
-                if( m_Type==TW_TYPE_CDSTRING || m_Type==TW_TYPE_CDSTDSTRING )
+                if( m_Type==TW_TYPE_STRINGVIEW )
+                {
+                    if( m_SetCallback!=NULL )
+                    {
+                        SetStringView(_Value, strlen(_Value));
+                        if( g_TwMgr!=NULL ) // Mgr might have been destroyed by the client inside a callback call
+                            _Bar->NotUpToDate();
+                        return 1;
+                    }
+                }
+                else if( m_Type==TW_TYPE_CDSTRING || m_Type==TW_TYPE_CDSTDSTRING )
                 {
                     if( m_SetCallback!=NULL )
                     {
@@ -1806,19 +2022,20 @@ ERetType CTwVarAtom::GetAttrib(int _AttribID, TwBar *_Bar, CTwVarGroup *_VarPare
     case VA_ENUM:
         if( IsEnumType(m_Type) )
         {
+            g_TwMgr->m_Enums[m_Type-TW_TYPE_ENUM_BASE].Sync();
             CTwMgr::CEnum::CEntries::iterator it = g_TwMgr->m_Enums[m_Type-TW_TYPE_ENUM_BASE].m_Entries.begin();
             for( ; it != g_TwMgr->m_Enums[m_Type-TW_TYPE_ENUM_BASE].m_Entries.end(); ++it )
             {
                 if( it != g_TwMgr->m_Enums[m_Type-TW_TYPE_ENUM_BASE].m_Entries.begin() )
                     outString << ',';
                 outString << it->first << ' ';
-                if( it->second.find_first_of("{}")==std::string::npos )
+                if( it->second.Str().find_first_of("{}")==std::string::npos )
                     outString << '{' << it->second << '}';
-                else if ( it->second.find_first_of("<>")==std::string::npos )
+                else if ( it->second.Str().find_first_of("<>")==std::string::npos )
                     outString << '<' << it->second << '>';
-                else if ( it->second.find_first_of("()")==std::string::npos )
+                else if ( it->second.Str().find_first_of("()")==std::string::npos )
                     outString << '(' << it->second << ')';
-                else if ( it->second.find_first_of("[]")==std::string::npos )
+                else if ( it->second.Str().find_first_of("[]")==std::string::npos )
                     outString << '[' << it->second << ']';
                 else
                     outString << '{' << it->second << '}'; // should not occured (use braces)
@@ -1827,10 +2044,22 @@ ERetType CTwVarAtom::GetAttrib(int _AttribID, TwBar *_Bar, CTwVarGroup *_VarPare
         }
         g_TwMgr->SetLastError(g_ErrInvalidAttrib);
         return RET_ERROR;
+    case VA_COALESCE:
+        outDoubles.push_back( m_SetCallback==CTwMgr::CChangeProxy::SetCB );
+        return RET_DOUBLE;
+    case VA_COMMIT:
+        if( m_SetCallback==CTwMgr::CChangeProxy::SetCB )
+        {
+            const CTwMgr::CChangeProxy *Proxy = static_cast<const CTwMgr::CChangeProxy *>(m_ClientData);
+            CommitModeString(outString, Proxy->m_CommitMode, Proxy->m_ThrottlePeriod);
+        }
+        else
+            CommitModeString(outString, CTwMgr::COMMIT_IMMEDIATE, 0);
+        return RET_STRING;
     case VA_VALUE:
         if( !( m_Type==TW_TYPE_BUTTON || IsCustom() ) ) // || (m_Type>=TW_TYPE_CUSTOM_BASE && m_Type<TW_TYPE_CUSTOM_BASE+(int)g_TwMgr->m_Customs.size()) ) )
         {
-            if( m_Type==TW_TYPE_CDSTRING || m_Type==TW_TYPE_CDSTDSTRING || IsCSStringType(m_Type) )
+            if( m_Type==TW_TYPE_CDSTRING || m_Type==TW_TYPE_CDSTDSTRING || m_Type==TW_TYPE_STRINGVIEW || IsCSStringType(m_Type) )
             {
                 string str;
                 ValueToString(&str);
@@ -2249,6 +2478,7 @@ void CTwVarAtom::Increment(int _Step)
             else if( m_GetCallback!=NULL )
                 m_GetCallback(&v, m_ClientData);
             CTwMgr::CEnum& e = g_TwMgr->m_Enums[m_Type-TW_TYPE_ENUM_BASE];
+            e.Sync();
             CTwMgr::CEnum::CEntries::iterator It = e.m_Entries.find(v);
             if( It==e.m_Entries.end() )
                 It = e.m_Entries.begin();
@@ -2356,6 +2586,7 @@ void CTwVarAtom::SetDefaults()
         break;
     case TW_TYPE_CDSTRING:
     case TW_TYPE_STDSTRING:
+    case TW_TYPE_STRINGVIEW:
         m_NoSlider = true;
         break;
     /*
@@ -2425,6 +2656,9 @@ enum EVarGroupAttribs
     VG_AXISZ,       // tw_type_quat* only
     VG_SHOWVAL,     // tw_type_quat* only
     VG_ROWS,        // tw_type_quat* only
+    VG_PAGESIZE,    // array only
+    VG_RATE,        // plot only
+    VG_RANGE,       // plot only
 };
 
 int CTwVarGroup::HasAttrib(const char *_Attrib, bool *_HasValue) const
@@ -2507,6 +2741,21 @@ int CTwVarGroup::HasAttrib(const char *_Attrib, bool *_HasValue) const
         *_HasValue = true;
         return VG_SHOWVAL;
     }
+    else if( _stricmp(_Attrib, "pagesize")==0 )
+    {
+        *_HasValue = true;
+        return VG_PAGESIZE;
+    }
+    else if( _stricmp(_Attrib, "rate")==0 )
+    {
+        *_HasValue = true;
+        return VG_RATE;
+    }
+    else if( _stricmp(_Attrib, "range")==0 )
+    {
+        *_HasValue = true;
+        return VG_RANGE;
+    }
 
     return CTwVar::HasAttrib(_Attrib, _HasValue);
 }
@@ -2578,6 +2827,17 @@ int CTwVarGroup::SetAttrib(int _AttribID, const char *_Value, TwBar *_Bar, struc
             return 0;
         }
     case VG_ROWS:
+        if( m_PlotProxy!=NULL )
+        {
+            int n = 0;
+            if( _Value==NULL || sscanf(_Value, "%d", &n)!=1 || n<=0 )
+            {
+                g_TwMgr->SetLastError(g_ErrBadValue);
+                return 0;
+            }
+            return g_TwMgr->SetPlotRows(m_PlotProxy, (unsigned int)n);
+        }
+        else
         {
             if (_Value == NULL)
             {
@@ -2807,6 +3067,54 @@ int CTwVarGroup::SetAttrib(int _AttribID, const char *_Value, TwBar *_Bar, struc
         }
         else
             return 0;
+    case VG_PAGESIZE:
+        if( m_ArrayProxy!=NULL )
+        {
+            int n = 0;
+            if( _Value==NULL || sscanf(_Value, "%d", &n)!=1 || n<=0 )
+            {
+                g_TwMgr->SetLastError(g_ErrBadValue);
+                return 0;
+            }
+            return g_TwMgr->SetArrayPageSize(m_ArrayProxy, (unsigned int)n);
+        }
+        g_TwMgr->SetLastError(g_ErrInvalidAttrib);
+        return 0;
+    case VG_RATE:
+        if( m_PlotProxy!=NULL )
+        {
+            double Rate = 0;
+            if( _Value==NULL || sscanf(_Value, "%lf", &Rate)!=1 || Rate<0 )
+            {
+                g_TwMgr->SetLastError(g_ErrBadValue);
+                return 0;
+            }
+            m_PlotProxy->m_Period = (Rate>0) ? 1.0/Rate : 0;
+            return 1;
+        }
+        g_TwMgr->SetLastError(g_ErrInvalidAttrib);
+        return 0;
+    case VG_RANGE:
+        if( m_PlotProxy!=NULL )
+        {
+            double Min = 0, Max = 0;
+            if( _Value!=NULL && _stricmp(_Value, "auto")==0 )
+                m_PlotProxy->m_AutoRange = true;
+            else if( _Value!=NULL && sscanf(_Value, "%lf %lf", &Min, &Max)==2 && Min<Max )
+            {
+                m_PlotProxy->m_AutoRange = false;
+                m_PlotProxy->m_RangeMin = Min;
+                m_PlotProxy->m_RangeMax = Max;
+            }
+            else
+            {
+                g_TwMgr->SetLastError(g_ErrBadValue);
+                return 0;
+            }
+            return 1;
+        }
+        g_TwMgr->SetLastError(g_ErrInvalidAttrib);
+        return 0;
     default:
         return CTwVar::SetAttrib(_AttribID, _Value, _Bar, _VarParent, _VarIndex);
     }
@@ -2911,6 +3219,43 @@ ERetType CTwVarGroup::GetAttrib(int _AttribID, TwBar *_Bar, struct CTwVarGroup *
         }
         g_TwMgr->SetLastError(g_ErrInvalidAttrib);
         return RET_ERROR;
+    case VG_PAGESIZE:
+        if( m_ArrayProxy!=NULL )
+        {
+            outDoubles.push_back( m_ArrayProxy->m_PageSize );
+            return RET_DOUBLE;
+        }
+        g_TwMgr->SetLastError(g_ErrInvalidAttrib);
+        return RET_ERROR;
+    case VG_ROWS:
+        if( m_PlotProxy!=NULL )
+        {
+            outDoubles.push_back( (double)m_PlotProxy->m_Group->m_Vars.size() );
+            return RET_DOUBLE;
+        }
+        return CTwVar::GetAttrib(_AttribID, _Bar, _VarParent, _VarIndex, outDoubles, outString);
+    case VG_RATE:
+        if( m_PlotProxy!=NULL )
+        {
+            outDoubles.push_back( (m_PlotProxy->m_Period>0) ? 1.0/m_PlotProxy->m_Period : 0 );
+            return RET_DOUBLE;
+        }
+        g_TwMgr->SetLastError(g_ErrInvalidAttrib);
+        return RET_ERROR;
+    case VG_RANGE:
+        if( m_PlotProxy!=NULL )
+        {
+            if( m_PlotProxy->m_AutoRange )
+            {
+                outString << "auto";
+                return RET_STRING;
+            }
+            outDoubles.push_back( m_PlotProxy->m_RangeMin );
+            outDoubles.push_back( m_PlotProxy->m_RangeMax );
+            return RET_DOUBLE;
+        }
+        g_TwMgr->SetLastError(g_ErrInvalidAttrib);
+        return RET_ERROR;
     default:
         return CTwVar::GetAttrib(_AttribID, _Bar, _VarParent, _VarIndex, outDoubles, outString);
     }
@@ -2918,9 +3263,9 @@ ERetType CTwVarGroup::GetAttrib(int _AttribID, TwBar *_Bar, struct CTwVarGroup *
 
 //  ---------------------------------------------------------------------------
 
-const CTwVar *CTwVarGroup::Find(const char *_Name, CTwVarGroup **_Parent, int *_Index) const
+const CTwVar *CTwVarGroup::Find(CTwIString::Id _Name, CTwVarGroup **_Parent, int *_Index) const
 {
-    if( strcmp(_Name, m_Name.c_str())==0 )
+    if( _Name==m_Name.GetId() )
     {
         if( _Parent!=NULL )
             *_Parent = NULL;
@@ -2979,6 +3324,8 @@ size_t CTwVar::GetDataSize(TwType _Type)
         return 8;
     case TW_TYPE_CDSTRING:
         return sizeof(char *);
+    case TW_TYPE_STRINGVIEW:
+        return sizeof(TwStringView);
     case TW_TYPE_STDSTRING:
         return (g_TwMgr!=0) ? g_TwMgr->m_ClientStdStringStructSize : sizeof(std::string);
     default:
@@ -3054,6 +3401,8 @@ CTwBar::CTwBar(const char *_Name)
     m_FirstLine = 0;
     m_LastUpdateTime = 0;
     m_UpdatePeriod = 2;
+    for( int t=0; t<FRAME_NB_TIMES; ++t )
+        m_FrameTimes[t] = m_LastFrameTimes[t] = 0;
     m_ScrollYW = 0;
     m_ScrollYH = 0;
     m_ScrollY0 = 0;
@@ -3099,6 +3448,8 @@ CTwBar::CTwBar(const char *_Name)
     m_HighlightLabelsHeader = false;
     m_HighlightValuesHeader = false;
     m_ButtonAlign = g_TwMgr->m_ButtonAlign;
+    m_CommitMode = CTwMgr::COMMIT_IMMEDIATE;
+    m_ThrottlePeriod = 0;
 
     m_IsMinimized = false;
     m_MinNumber = 0;
@@ -3109,6 +3460,8 @@ CTwBar::CTwBar(const char *_Name)
     m_IsPopupList = false;
     m_VarEnumLinkedToPopupList = NULL;
     m_BarLinkedToPopupList = NULL;
+    m_PopupValue = 0;
+    m_PopupVersion = 0;
 
     m_Resizable = true;
     m_Movable = true;
@@ -3137,6 +3490,15 @@ CTwBar::~CTwBar()
 {
     if( m_IsMinimized )
         g_TwMgr->Maximize(this);
+    if( g_TwMgr->m_Recorder!=NULL )
+        g_TwMgr->m_Recorder->Discard(); // recorded draws may reference the deleted text objects
+    if( g_TwMgr->m_HoverBar==this )
+        g_TwMgr->m_HoverBar = NULL;
+    if( g_TwMgr->m_DraggingBar==this )
+        g_TwMgr->m_DraggingBar = NULL;
+    if( g_TwMgr->m_HighlightBar==this )
+        g_TwMgr->m_HighlightBar = NULL;
+    g_TwMgr->m_HitIndexDirty = true;
     if( m_TitleTextObj )
         g_TwMgr->m_Graph->DeleteTextObj(m_TitleTextObj);
     if( m_LabelsTextObj )
@@ -3158,7 +3520,22 @@ const CTwVar *CTwBar::Find(const char *_Name, CTwVarGroup **_Parent, int *_Index
 
 CTwVar *CTwBar::Find(const char *_Name, CTwVarGroup **_Parent, int *_Index)
 {
-    return const_cast<CTwVar *>(const_cast<const CTwBar *>(this)->Find(_Name, _Parent, _Index));
+    CTwVar *Var = const_cast<CTwVar *>(const_cast<const CTwBar *>(this)->Find(_Name, _Parent, _Index));
+    if( Var==NULL && _Name!=NULL )
+    {
+        // the var may be a member of a struct var whose members are not created yet
+        const char *Dot = strrchr(_Name, '.');
+        if( Dot!=NULL && Dot!=_Name )
+        {
+            CTwVar *Struct = Find(string(_Name, Dot-_Name).c_str());
+            if( Struct!=NULL && Struct->IsGroup() && static_cast<CTwVarGroup *>(Struct)->m_StructPending )
+            {
+                TwExpandStructVar(this, static_cast<CTwVarGroup *>(Struct));
+                Var = const_cast<CTwVar *>(const_cast<const CTwBar *>(this)->Find(_Name, _Parent, _Index));
+            }
+        }
+    }
+    return Var;
 }
 
 //  ---------------------------------------------------------------------------
@@ -3192,7 +3569,9 @@ enum EBarAttribs
     BAR_ALWAYS_BOTTOM,
     BAR_COLOR_SCHEME,
     BAR_CONTAINED,
-    BAR_BUTTON_ALIGN
+    BAR_BUTTON_ALIGN,
+    BAR_FRAME_TIMES,
+    BAR_COMMIT
 };
 
 int CTwBar::HasAttrib(const char *_Attrib, bool *_HasValue) const
@@ -3248,6 +3627,10 @@ int CTwBar::HasAttrib(const char *_Attrib, bool *_HasValue) const
         return BAR_CONTAINED;
     else if( _stricmp(_Attrib, "buttonalign")==0 )
         return BAR_BUTTON_ALIGN;
+    else if( _stricmp(_Attrib, "frametimes")==0 )
+        return BAR_FRAME_TIMES;
+    else if( _stricmp(_Attrib, "commit")==0 )
+        return BAR_COMMIT;
 
     *_HasValue = false;
     if( _stricmp(_Attrib, "show")==0 ) // for backward compatibility
@@ -3363,6 +3746,7 @@ int CTwBar::SetAttrib(int _AttribID, const char *_Value)
                 m_Width = sx;
                 m_Height = sy;
                 NotUpToDate();
+                g_TwMgr->m_HitIndexDirty = true;
                 return 1;
             }
             else
@@ -3386,6 +3770,7 @@ int CTwBar::SetAttrib(int _AttribID, const char *_Value)
                 m_PosX = x;
                 m_PosY = y;
                 NotUpToDate();
+                g_TwMgr->m_HitIndexDirty = true;
                 return 1;
             }
             else
@@ -3524,11 +3909,13 @@ int CTwBar::SetAttrib(int _AttribID, const char *_Value)
             if( _stricmp(_Value, "1")==0 || _stricmp(_Value, "true")==0 )
             {
                 m_Iconifiable = true;
+                g_TwMgr->m_HitIndexDirty = true;
                 return 1;
             }
             else if( _stricmp(_Value, "0")==0 || _stricmp(_Value, "false")==0 )
             {
                 m_Iconifiable = false;
+                g_TwMgr->m_HitIndexDirty = true;
                 return 1;
             }
             else
@@ -3703,12 +4090,45 @@ int CTwBar::SetAttrib(int _AttribID, const char *_Value)
             g_TwMgr->SetLastError(g_ErrNoValue);
             return 0;
         }
+    case BAR_COMMIT:
+        {
+            int Mode;
+            double Period;
+            if( !ParseCommitMode(_Value, &Mode, &Period) )
+            {
+                g_TwMgr->SetLastError(g_ErrBadValue);
+                return 0;
+            }
+            m_CommitMode = Mode;
+            m_ThrottlePeriod = Period;
+            SetCommitMode(&m_VarRoot);
+            return 1;
+        }
     default:
         g_TwMgr->SetLastError(g_ErrUnknownAttrib);
         return 0;
     }
 }
 
+// Applies the bar commit mode to the vars that can be deferred, others are left unchanged
+void CTwBar::SetCommitMode(CTwVarGroup *_Grp)
+{
+    for( size_t i=0; i<_Grp->m_Vars.size(); ++i )
+    {
+        CTwVar *Var = _Grp->m_Vars[i];
+        if( Var==NULL )
+            continue;
+        if( Var->IsGroup() )
+            SetCommitMode(static_cast<CTwVarGroup *>(Var));
+        else
+        {
+            CTwVarAtom *Atom = static_cast<CTwVarAtom *>(Var);
+            if( !Atom->m_ReadOnly && Atom->m_Type!=TW_TYPE_BUTTON && CTwMgr::CanDeferChanges(Atom) )
+                g_TwMgr->SetCommitMode(Atom, this, m_CommitMode, m_ThrottlePeriod);
+        }
+    }
+}
+
 ERetType CTwBar::GetAttrib(int _AttribID, std::vector<double>& outDoubles, std::ostringstream& outString) const
 {
     outDoubles.clear();
@@ -3806,6 +4226,13 @@ ERetType CTwBar::GetAttrib(int _AttribID, std::vector<double>& outDoubles, std::
         else
             outString << "right";
         return RET_STRING;
+    case BAR_FRAME_TIMES: // read-only: update, text and submit times of the last frame in ms
+        for( int t=0; t<FRAME_NB_TIMES; ++t )
+            outDoubles.push_back(m_LastFrameTimes[t]);
+        return RET_DOUBLE;
+    case BAR_COMMIT:
+        CommitModeString(outString, m_CommitMode, m_ThrottlePeriod);
+        return RET_STRING;
     default:
         g_TwMgr->SetLastError(g_ErrUnknownAttrib);
         return RET_ERROR;
@@ -3993,13 +4420,31 @@ void CTwBar::UpdateColors()
 
 CTwVarGroup::~CTwVarGroup()
 {
-    for( vector<CTwVar*>::iterator it= m_Vars.begin(); it!=m_Vars.end(); ++it )
+    for( CVars::iterator it= m_Vars.begin(); it!=m_Vars.end(); ++it )
         if( *it != NULL )
         {
             CTwVar *Var = *it;
             delete Var;
             *it = NULL;
         }
+    if( m_ArrayProxy!=NULL && g_TwMgr!=NULL )
+        g_TwMgr->RemoveArrayProxy(m_ArrayProxy);
+    if( m_PlotProxy!=NULL && g_TwMgr!=NULL )
+        g_TwMgr->RemovePlotProxy(m_PlotProxy);
+}
+
+void CTwVarGroup::SetReadOnly(bool _ReadOnly)
+{
+    m_StructReadOnly = _ReadOnly;
+    for( size_t i=0; i<m_Vars.size(); ++i )
+        if( m_Vars[i]!=NULL )
+        {
+            if( m_ArrayProxy!=NULL && !m_Vars[i]->IsGroup() && static_cast<CTwVarAtom *>(m_Vars[i])->m_GetCallback==CTwMgr::CArrayProxy::PageGetCB )
+                continue;   // the page of an array can always be changed
+            if( m_PlotProxy!=NULL && !m_Vars[i]->IsGroup() && static_cast<CTwVarAtom *>(m_Vars[i])->m_Val.m_Button.m_Plot!=NULL )
+                continue;   // the rows of a plot are not buttons
+            m_Vars[i]->SetReadOnly(_ReadOnly);
+        }
 }
 
 //  ---------------------------------------------------------------------------
@@ -4009,6 +4454,11 @@ static inline int IncrBtnWidth(int _CharHeight)
     return ((2*_CharHeight)/3+2)&0xfffe; // force even value 
 }
 
+static inline bool IsPlotRow(const CTwVar *_Var, const CTwMgr::CPlotProxy *_Plot)
+{
+    return !_Var->IsGroup() && static_cast<const CTwVarAtom *>(_Var)->m_Type==TW_TYPE_BUTTON && static_cast<const CTwVarAtom *>(_Var)->m_Val.m_Button.m_Plot==_Plot;
+}
+
 //  ---------------------------------------------------------------------------
 
 void CTwBar::BrowseHierarchy(int *_CurrLine, int _CurrLevel, const CTwVar *_Var, int _First, int _Last)
@@ -4037,7 +4487,7 @@ void CTwBar::BrowseHierarchy(int *_CurrLine, int _CurrLevel, const CTwVar *_Var,
     {
         const CTwVarGroup *Grp = static_cast<const CTwVarGroup *>(_Var);
         if( Grp->m_Open )
-            for( vector<CTwVar*>::const_iterator it=Grp->m_Vars.begin(); it!=Grp->m_Vars.end(); ++it )
+            for( CTwVarGroup::CVars::const_iterator it=Grp->m_Vars.begin(); it!=Grp->m_Vars.end(); ++it )
                 if( (*it)->m_Visible )
                     BrowseHierarchy(_CurrLine, _CurrLevel+1, *it, _First, _Last);
         if( m_HierTags.size()>0 )
@@ -4047,13 +4497,51 @@ void CTwBar::BrowseHierarchy(int *_CurrLine, int _CurrLevel, const CTwVar *_Var,
 
 //  ---------------------------------------------------------------------------
 
-void CTwBar::ListLabels(vector<string>& _Labels, vector<color32>& _Colors, vector<color32>& _BgColors, bool *_HasBgColors, const CTexFont *_Font, int _AtomWidthMax, int _GroupWidthMax)
+// Creates the members of the opened struct vars that have not been expanded yet
+void CTwBar::ExpandOpenStructs(CTwVarGroup *_Grp)
+{
+    assert(_Grp!=NULL);
+    if( _Grp->m_StructPending )
+        TwExpandStructVar(this, _Grp);
+    for( size_t i=0; i<_Grp->m_Vars.size(); ++i )  // members may be appended while browsing
+        if( _Grp->m_Vars[i]!=NULL && _Grp->m_Vars[i]->IsGroup() && static_cast<CTwVarGroup *>(_Grp->m_Vars[i])->m_Open )
+            ExpandOpenStructs(static_cast<CTwVarGroup *>(_Grp->m_Vars[i]));
+}
+
+//  ---------------------------------------------------------------------------
+
+void CTwBar::RecycleLines(CLines& _Lines)
+{
+    for( size_t i=0; i<_Lines.size(); ++i )
+    {
+        m_LinePool.push_back(string());
+        m_LinePool.back().swap(_Lines[i]);
+    }
+    _Lines.resize(0);
+}
+
+//  ---------------------------------------------------------------------------
+
+string& CTwBar::PushLine(CLines& _Lines)
+{
+    _Lines.push_back(string());
+    if( !m_LinePool.empty() )
+    {
+        _Lines.back().swap(m_LinePool.back());
+        m_LinePool.pop_back();
+        _Lines.back().resize(0);
+    }
+    return _Lines.back();
+}
+
+//  ---------------------------------------------------------------------------
+
+void CTwBar::ListLabels(CLines& _Labels, CLineColors& _Colors, CLineColors& _BgColors, bool *_HasBgColors, const CTexFont *_Font, int _AtomWidthMax, int _GroupWidthMax)
 {
     const int NbEtc = 2;
     string ValStr;
-    int Len, i, x, Etc, s;
+    int Len, i, i0, g, x, Etc, s;
     const unsigned char *Text;
-    unsigned char ch;
     int WidthMax;
     
     int Space = _Font->m_CharWidth[(int)' '];
@@ -4072,7 +4560,7 @@ void CTwBar::ListLabels(vector<string>& _Labels, vector<color32>& _Colors, vecto
         }
         x = 0;
         Etc = 0;
-        _Labels.push_back("");  // add a new text line
+        PushLine(_Labels);  // add a new text line
         if( !m_HierTags[h].m_Var->IsGroup() && static_cast<const CTwVarAtom *>(m_HierTags[h].m_Var)->m_Type==TW_TYPE_BUTTON && static_cast<const CTwVarAtom *>(m_HierTags[h].m_Var)->m_ReadOnly && static_cast<const CTwVarAtom *>(m_HierTags[h].m_Var)->m_Val.m_Button.m_Callback!=NULL )
             _Colors.push_back(m_ColValTextRO); // special case for read-only buttons
         else
@@ -4107,18 +4595,28 @@ void CTwBar::ListLabels(vector<string>& _Labels, vector<color32>& _Colors, vecto
                     x += Space;
                 }
             if( x+(NbEtc+2)*_Font->m_CharWidth[(int)'.']<WidthMax || m_HierTags[h].m_Var->m_DontClip)
-                for( i=0; i<Len; ++i )
+                for( i=0; i<Len; )
                 {
-                    ch = (Etc==0) ? Text[i] : '.';
-                    CurrentLabel += ch;
-                    x += _Font->m_CharWidth[(int)ch];
+                    if( Etc==0 )
+                    {
+                        i0 = i;
+                        g = _Font->NextGlyph(Text, Len, &i);
+                        CurrentLabel.append((const char *)(Text+i0), i-i0);
+                    }
+                    else
+                    {
+                        g = '.';
+                        CurrentLabel += '.';
+                        ++i;
+                    }
+                    x += _Font->m_CharWidth[g];
                     if( Etc>0 )
                     {
                         ++Etc;
                         if( Etc>NbEtc )
                             break;
                     }
-                    else if( i<Len-2 && x+(NbEtc+2)*_Font->m_CharWidth[(int)'.']>=WidthMax && !(m_HierTags[h].m_Var->m_DontClip))
+                    else if( i<Len-1 && x+(NbEtc+2)*_Font->m_CharWidth[(int)'.']>=WidthMax && !(m_HierTags[h].m_Var->m_DontClip))
                         Etc = 1;
                 }       
         }
@@ -4127,16 +4625,16 @@ void CTwBar::ListLabels(vector<string>& _Labels, vector<color32>& _Colors, vecto
 
 //  ---------------------------------------------------------------------------
 
-void CTwBar::ListValues(vector<string>& _Values, vector<color32>& _Colors, vector<color32>& _BgColors, const CTexFont *_Font, int _WidthMax)
+void CTwBar::ListValues(CLines& _Values, CLineColors& _Colors, CLineColors& _BgColors, const CTexFont *_Font, int _WidthMax)
 {
     CTwFPU fpu; // force fpu precision
 
     const int NbEtc = 2;
     const CTwVarAtom *Atom = NULL;
+    CStringViewLine *ViewLine = NULL;
     string ValStr;
-    int Len, i, x, Etc;
+    int Len, i, i0, g, x, Etc;
     const unsigned char *Text;
-    unsigned char ch;
     bool ReadOnly;
     bool IsMax;
     bool IsMin;
@@ -4158,10 +4656,32 @@ void CTwBar::ListValues(vector<string>& _Values, vector<color32>& _Colors, vecto
             IsROText = false;
             HasBgColor = true;
             AcceptEdit = false;
+            ViewLine = NULL;
             if( !m_HierTags[h].m_Var->IsGroup() )
             {
                 Atom = static_cast<const CTwVarAtom *>(m_HierTags[h].m_Var);
-                Atom->ValueToString(&ValStr);
+                if( Atom->m_Type==TW_TYPE_STRINGVIEW )
+                {
+                    // the client string is only read if its generation has changed
+                    TwStringView View;
+                    Atom->GetStringView(&View);
+                    ViewLine = Atom->m_Val.m_StringView.m_Line;
+                    if( ViewLine==NULL )
+                    {
+                        ViewLine = new CStringViewLine;
+                        ViewLine->m_Valid = false;
+                        const_cast<CTwVarAtom *>(Atom)->m_Val.m_StringView.m_Line = ViewLine;
+                    }
+                    if( ViewLine->m_Valid && ViewLine->m_Generation!=View.Generation )
+                        ViewLine->m_Valid = false;
+                    ViewLine->m_Generation = View.Generation;
+                    if( ViewLine->m_Valid )
+                        ValStr.clear();
+                    else
+                        ValStr.assign(View.Str, View.Length);
+                }
+                else
+                    Atom->ValueToString(&ValStr);
                 if( !m_IsHelpBar || (Atom->m_Type==TW_TYPE_SHORTCUT && (Atom->m_Val.m_Shortcut.m_Incr[0]>0 || Atom->m_Val.m_Shortcut.m_Decr[0]>0)) )
                     ReadOnly = Atom->m_ReadOnly;
                 if( !Atom->m_NoSlider )
@@ -4180,7 +4700,7 @@ void CTwBar::ListValues(vector<string>& _Values, vector<color32>& _Colors, vecto
                         ValStr = " -"; //"\x97"; // uncheck sign
                 }
                 if(    (Atom->m_Type==TW_TYPE_CDSTRING && Atom->m_SetCallback==NULL && g_TwMgr->m_CopyCDStringToClient==NULL)
-                    || (Atom->m_Type==TW_TYPE_CDSTDSTRING && Atom->m_SetCallback==NULL)
+                    || ((Atom->m_Type==TW_TYPE_CDSTDSTRING || Atom->m_Type==TW_TYPE_STRINGVIEW) && Atom->m_SetCallback==NULL)
                     || (Atom->m_Type==TW_TYPE_STDSTRING && Atom->m_SetCallback==NULL && g_TwMgr->m_CopyStdStringToClient==NULL) )
                     IsROText = true;
                 if( Atom->m_Type==TW_TYPE_HELP_ATOM || Atom->m_Type==TW_TYPE_HELP_GRP || Atom->m_Type==TW_TYPE_BUTTON || Atom->IsCustom() ) // (Atom->m_Type>=TW_TYPE_CUSTOM_BASE && Atom->m_Type<TW_TYPE_CUSTOM_BASE+(int)g_TwMgr->m_Customs.size()) )
@@ -4211,7 +4731,7 @@ void CTwBar::ListValues(vector<string>& _Values, vector<color32>& _Colors, vecto
             Text = (const unsigned char *)(ValStr.c_str());
             x = 0;
             Etc = 0;
-            _Values.push_back("");  // add a new text line
+            PushLine(_Values);  // add a new text line
             if( ReadOnly || (IsMin && IsMax) || IsROText )
                 _Colors.push_back(m_ColValTextRO);
             else if( IsMin )
@@ -4246,24 +4766,58 @@ void CTwBar::ListValues(vector<string>& _Values, vector<color32>& _Colors, vecto
                 wmax -= 1*IncrBtnWidth(m_Font->m_CharHeight);
             else if( m_HighlightedLine==h && m_DrawBoolBtn )
                 wmax -= 1*IncrBtnWidth(m_Font->m_CharHeight);
-            for( i=0; i<Len; ++i )
+            if( ViewLine!=NULL )
             {
-                ch = (Etc==0) ? Text[i] : '.';
-                CurrentValue += ch;
-                x += _Font->m_CharWidth[(int)ch];
+                if( ViewLine->m_Valid && ViewLine->m_WidthMax==wmax && ViewLine->m_Font==_Font && ViewLine->m_FontGeneration==g_TwFontGeneration )
+                {
+                    CurrentValue = ViewLine->m_Text;
+                    continue;
+                }
+                if( ViewLine->m_Valid ) // only the width or the font has changed
+                {
+                    TwStringView View;
+                    Atom->GetStringView(&View);
+                    ValStr.assign(View.Str, View.Length);
+                    Len = (int)ValStr.length();
+                    Text = (const unsigned char *)(ValStr.c_str());
+                }
+            }
+            for( i=0; i<Len; )
+            {
+                if( Etc==0 )
+                {
+                    i0 = i;
+                    g = _Font->NextGlyph(Text, Len, &i);
+                    CurrentValue.append((const char *)(Text+i0), i-i0);
+                }
+                else
+                {
+                    g = '.';
+                    CurrentValue += '.';
+                    ++i;
+                }
+                x += _Font->m_CharWidth[g];
                 if( Etc>0 )
                 {
                     ++Etc;
                     if( Etc>NbEtc )
                         break;
                 }
-                else if( i<Len-2 && x+(NbEtc+2)*(_Font->m_CharWidth[(int)'.'])>=wmax )
+                else if( i<Len-1 && x+(NbEtc+2)*(_Font->m_CharWidth[(int)'.'])>=wmax )
                     Etc = 1;
             }
+            if( ViewLine!=NULL )
+            {
+                ViewLine->m_Text = CurrentValue;
+                ViewLine->m_WidthMax = wmax;
+                ViewLine->m_Font = _Font;
+                ViewLine->m_FontGeneration = g_TwFontGeneration;
+                ViewLine->m_Valid = true;
+            }
         }
         else
         {
-            _Values.push_back("");  // add a new empty line
+            PushLine(_Values);  // add a new empty line
             _Colors.push_back(COLOR32_BLACK);
             _BgColors.push_back(0x00000000);
         }
@@ -4273,7 +4827,7 @@ void CTwBar::ListValues(vector<string>& _Values, vector<color32>& _Colors, vecto
 
 int CTwBar::ComputeLabelsWidth(const CTexFont *_Font)
 {
-    int Len, i, x, s;
+    int Len, x, s;
     const unsigned char *Text;
     int LabelsWidth = 0;    
     int Space = _Font->m_CharWidth[(int)' '];
@@ -4297,8 +4851,7 @@ int CTwBar::ComputeLabelsWidth(const CTexFont *_Font)
             if( Space>0 )
                 for( s=0; s<m_HierTags[h].m_Level*LevelSpace; s+=Space )
                     x += Space;
-            for( i=0; i<Len; ++i )
-                x += _Font->m_CharWidth[(int)Text[i]];
+            x += _Font->TextWidth((const char *)Text, Len);
             x += 3*Space; // add little margin
         }
         if (x > LabelsWidth)
@@ -4314,9 +4867,8 @@ int CTwBar::ComputeValuesWidth(const CTexFont *_Font)
 
     const CTwVarAtom *Atom = NULL;
     string ValStr;
-    int Len, i, x;
+    int x;
     int Space = _Font->m_CharWidth[(int)' '];
-    const unsigned char *Text;
     int ValuesWidth = 0;
 
     int nh = (int)m_HierTags.size();
@@ -4326,11 +4878,7 @@ int CTwBar::ComputeValuesWidth(const CTexFont *_Font)
             Atom = static_cast<const CTwVarAtom *>(m_HierTags[h].m_Var);
             Atom->ValueToString(&ValStr);
 
-            Len = (int)ValStr.length();
-            Text = (const unsigned char *)(ValStr.c_str());
-            x = 0;
-            for( i=0; i<Len; ++i )
-                x += _Font->m_CharWidth[(int)Text[i]];
+            x = _Font->TextWidth(ValStr.c_str(), (int)ValStr.length());
             x += 2*Space; // add little margin
             if (x > ValuesWidth)
                 ValuesWidth = x;
@@ -4344,15 +4892,16 @@ int CTwBar::ComputeValuesWidth(const CTexFont *_Font)
 static int ClampText(string& _Text, const CTexFont *_Font, int _WidthMax)
 {
     int Len = (int)_Text.length();
-    unsigned char ch;
+    const unsigned char *Text = (const unsigned char *)_Text.c_str();
     int Width = 0;
-    int i;
-    for( i=0; i<Len; ++i )
+    int i, Next;
+    for( i=0; i<Len; i=Next )
     {
-        ch = _Text.at(i);
-        if( i<Len-1 && Width+_Font->m_CharWidth[(int)'.']>=_WidthMax )
+        Next = i;
+        int g = _Font->NextGlyph(Text, Len, &Next);
+        if( Next<Len && Width+_Font->m_CharWidth[(int)'.']>=_WidthMax )
             break;
-        Width += _Font->m_CharWidth[ch];
+        Width += _Font->m_CharWidth[g];
     }
     if( i<Len ) // clamp
     {
@@ -4375,6 +4924,11 @@ void CTwBar::Update()
     if( g_TwMgr->m_WndWidth<=0 || g_TwMgr->m_WndHeight<=0 )
         return; // graphic window is not ready
 
+    PerfTimer UpdateTimer;
+    m_GlyphUses.Clear();
+    ExpandOpenStructs(&m_VarRoot);
+    double PrevTextTime = m_FrameTimes[FRAME_TEXT];
+
     bool DoEndDraw = false;
     if( !Gr->IsDrawing() )
     {
@@ -4396,6 +4950,7 @@ void CTwBar::Update()
     vph = g_TwMgr->m_WndHeight;
     if( !m_IsMinimized && vpw>0 && vph>0 )
     {
+        int PrevPosX = m_PosX, PrevWidth = m_Width, PrevHeight = m_Height;
         bool Modif = false;
         if( m_Resizable )
         {
@@ -4433,6 +4988,8 @@ void CTwBar::Update()
         }
         m_ScrollY0 += m_PosY-PrevPosY;
         m_ScrollY1 += m_PosY-PrevPosY;
+        if( m_PosX!=PrevPosX || m_PosY!=PrevPosY || m_Width!=PrevWidth || m_Height!=PrevHeight )
+            g_TwMgr->m_HitIndexDirty = true;
         if( m_ValuesWidth<2*m_Font->m_CharHeight )
         {
             m_ValuesWidth = 2*m_Font->m_CharHeight;
@@ -4494,11 +5051,16 @@ void CTwBar::Update()
         NbLines = 1;
     if( !m_IsMinimized )
     {
-        int LineNum = 0;
-        BrowseHierarchy(&LineNum, 0, &m_VarRoot, m_FirstLine, m_FirstLine+NbLines); // add a dummy tag at the end to avoid wrong 'tag-closing' problems
-        if( (int)m_HierTags.size()>NbLines )
-            m_HierTags.resize(NbLines); // remove the last dummy tag
-        m_NbHierLines = LineNum;
+        if( m_IsPopupList )
+            BindPopupRows(NbLines);
+        else
+        {
+            int LineNum = 0;
+            BrowseHierarchy(&LineNum, 0, &m_VarRoot, m_FirstLine, m_FirstLine+NbLines); // add a dummy tag at the end to avoid wrong 'tag-closing' problems
+            if( (int)m_HierTags.size()>NbLines )
+                m_HierTags.resize(NbLines); // remove the last dummy tag
+            m_NbHierLines = LineNum;
+        }
         m_NbDisplayedLines = (int)m_HierTags.size();
 
         if( ValuesWidthFit )
@@ -4554,21 +5116,24 @@ void CTwBar::Update()
     else
         Title = m_Name;
     m_TitleWidth = ClampText(Title, m_Font, (!m_IsMinimized)?(m_Width-5*m_Font->m_CharHeight):(16*m_Font->m_CharHeight));
-    Gr->BuildText(m_TitleTextObj, &Title, NULL, NULL, 1, m_Font, 0, 0);
+    BuildText(m_TitleTextObj, &Title, NULL, NULL, 1, m_Font, 0, 0);
 
     if( !m_IsMinimized )
     {
         // Build labels
-        vector<string>  Labels;
-        vector<color32> Colors;
-        vector<color32> BgColors;
+        CLines& Labels = m_Lines;
+        CLineColors& Colors = m_LineColors;
+        CLineColors& BgColors = m_LineBgColors;
+        RecycleLines(Labels);
+        Colors.resize(0);
+        BgColors.resize(0);
         bool HasBgColors = false;
         ListLabels(Labels, Colors, BgColors, &HasBgColors, m_Font, m_VarX1-m_VarX0, m_VarX2-m_VarX0);
         assert( Labels.size()==Colors.size() && Labels.size()==BgColors.size() );
         if( Labels.size()>0 )
-            Gr->BuildText(m_LabelsTextObj, &(Labels[0]), &(Colors[0]), &(BgColors[0]), (int)Labels.size(), m_Font, m_LineSep, HasBgColors ? m_VarX1-m_VarX0-m_Font->m_CharHeight+2 : 0);
+            BuildText(m_LabelsTextObj, &(Labels[0]), &(Colors[0]), &(BgColors[0]), (int)Labels.size(), m_Font, m_LineSep, HasBgColors ? m_VarX1-m_VarX0-m_Font->m_CharHeight+2 : 0);
         else
-            Gr->BuildText(m_LabelsTextObj, NULL, NULL, NULL, 0, m_Font, m_LineSep, 0);
+            BuildText(m_LabelsTextObj, NULL, NULL, NULL, 0, m_Font, m_LineSep, 0);
 
         // Should draw click button?
         m_DrawClickBtn    = ( m_VarX2-m_VarX1>4*IncrBtnWidth(m_Font->m_CharHeight)
@@ -4623,16 +5188,16 @@ void CTwBar::Update()
         */
 
         // Build values
-        vector<string>& Values = Labels;    // reuse
-        Values.resize(0);
+        CLines& Values = Labels;    // reuse
+        RecycleLines(Values);
         Colors.resize(0);
         BgColors.resize(0);
         ListValues(Values, Colors, BgColors, m_Font, m_VarX2-m_VarX1);
         assert( BgColors.size()==Values.size() && Colors.size()==Values.size() );
         if( Values.size()>0 )
-            Gr->BuildText(m_ValuesTextObj, &(Values[0]), &(Colors[0]), &(BgColors[0]), (int)Values.size(), m_Font, m_LineSep, m_VarX2-m_VarX1);
+            BuildText(m_ValuesTextObj, &(Values[0]), &(Colors[0]), &(BgColors[0]), (int)Values.size(), m_Font, m_LineSep, m_VarX2-m_VarX1);
         else
-            Gr->BuildText(m_ValuesTextObj, NULL, NULL, NULL, 0, m_Font, m_LineSep, m_VarX2-m_VarX1);
+            BuildText(m_ValuesTextObj, NULL, NULL, NULL, 0, m_Font, m_LineSep, m_VarX2-m_VarX1);
 
         // Build key shortcut text
         string Shortcut;
@@ -4659,13 +5224,13 @@ void CTwBar::Update()
             }
         }
         ClampText(Shortcut, m_Font, m_Width-3*m_Font->m_CharHeight);
-        Gr->BuildText(m_ShortcutTextObj, &Shortcut, NULL, NULL, 1, m_Font, 0, 0);
+        BuildText(m_ShortcutTextObj, &Shortcut, NULL, NULL, 1, m_Font, 0, 0);
 
         // build headers text
         if (m_HighlightLabelsHeader || m_HighlightValuesHeader) {
             std::string HeadersText = "Fit column content";
             ClampText(HeadersText, m_Font, m_Width-3*m_Font->m_CharHeight);
-            Gr->BuildText(m_HeadersTextObj, &HeadersText, NULL, NULL, 1, m_Font, 0, 0);
+            BuildText(m_HeadersTextObj, &HeadersText, NULL, NULL, 1, m_Font, 0, 0);
         }
     }
 
@@ -4674,6 +5239,33 @@ void CTwBar::Update()
 
     m_UpToDate = true;
     m_LastUpdateTime = float(g_BarTimer.GetTime());
+
+    // texts are accounted separately by BuildText
+    double DT = 1000.0*UpdateTimer.GetTime() - (m_FrameTimes[FRAME_TEXT]-PrevTextTime);
+    m_FrameTimes[FRAME_UPDATE] += DT;
+    g_TwMgr->m_CurFrameStats.UpdateTime += DT;
+    g_TwMgr->m_CurFrameStats.NbUpdates++;
+}
+
+//  ---------------------------------------------------------------------------
+
+void CTwBar::BuildText(void *_TextObj, const std::string *_TextLines, color32 *_LineColors, color32 *_LineBgColors, int _NbLines, const CTexFont *_Font, int _Sep, int _BgWidth)
+{
+    PerfTimer Timer;
+    CTwGlyphUses *PrevGlyphUses = g_TwGlyphUses;
+    g_TwGlyphUses = &m_GlyphUses;
+    g_TwMgr->m_Graph->BuildText(_TextObj, _TextLines, _LineColors, _LineBgColors, _NbLines, _Font, _Sep, _BgWidth);
+    g_TwGlyphUses = PrevGlyphUses;
+    double DT = 1000.0*Timer.GetTime();
+    m_FrameTimes[FRAME_TEXT] += DT;
+    g_TwMgr->m_CurFrameStats.TextTime += DT;
+
+    int NbGlyphs = 0;
+    for( int l=0; l<_NbLines; ++l )
+        for( size_t c=0; c<_TextLines[l].size(); ++c )
+            if( (_TextLines[l][c]&0xC0)!=0x80 ) // do not count UTF-8 continuation bytes
+                ++NbGlyphs;
+    g_TwMgr->m_CurFrameStats.NbGlyphs += NbGlyphs;
 }
 
 //  ---------------------------------------------------------------------------
@@ -4898,7 +5490,6 @@ void CTwBar::DrawHierHandle()
 
 void CTwBar::Draw(int _DrawPart)
 {
-    PERF( PerfTimer Timer; double DT; )
 
     assert(m_Font);
     ITwGraph *Gr = g_TwMgr->m_Graph;
@@ -4917,6 +5508,17 @@ void CTwBar::Draw(int _DrawPart)
     if( m_IsHelpBar && g_TwMgr->m_HelpBarNotUpToDate )
         g_TwMgr->UpdateHelpBar();
 
+    // a glyph of the texts has been evicted from the font cache
+    if( m_UpToDate && m_GlyphUses.Evicted() )
+    {
+        NotUpToDate();
+        if( m_IsHelpBar )
+        {
+            g_TwMgr->m_KeyPressedBuildText = true;
+            g_TwMgr->m_InfoBuildText = true;
+        }
+    }
+
     if( !m_UpToDate )
         Update();
 
@@ -4942,7 +5544,6 @@ void CTwBar::Draw(int _DrawPart)
         // Draw title
         if( !m_IsPopupList )
         {
-            PERF( Timer.Reset(); )
             if( _DrawPart&DRAW_BG )
             {
                 //Gr->DrawRect(m_PosX, m_PosY, m_PosX+m_Width-1, m_PosY+m_Font->m_CharHeight+1, (m_HighlightTitle||m_MouseDragTitle) ? m_ColTitleHighBg : (m_DrawHandles ? m_ColTitleBg : m_ColTitleUnactiveBg));
@@ -4966,11 +5567,9 @@ void CTwBar::Draw(int _DrawPart)
             if( _DrawPart&DRAW_CONTENT && m_DrawHandles )
                 Gr->DrawLine(m_PosX, y, m_PosX+m_Width-1, y, 0x30ffffff); // 0x80afafaf);
             y++;
-            PERF( DT = Timer.GetTime(); printf("Title=%.4fms ", 1000.0*DT); )
         }
 
         // Draw background
-        PERF( Timer.Reset(); )
         if( _DrawPart&DRAW_BG )
         {
             Gr->DrawRect(m_PosX, y, m_PosX+m_Width-1, m_PosY+m_Height-1, colBg2, colBg1, colBg1, colBg);
@@ -5015,24 +5614,17 @@ void CTwBar::Draw(int _DrawPart)
             Gr->DrawRect(m_PosX+m_Width, m_PosY+m_Height, m_PosX+m_Width+dshad, m_PosY+m_Height+dshad, cshad, 0, 0, 0);
             Gr->DrawRect(m_PosX+m_Width, m_PosY, m_PosX+m_Width+dshad, m_PosY+dshad, 0, 0, cshad, 0);
             Gr->DrawRect(m_PosX+m_Width, m_PosY+dshad+1, m_PosX+m_Width+dshad, m_PosY+m_Height-1, cshad, 0, cshad, 0);
-            PERF( DT = Timer.GetTime(); printf("Bg=%.4fms ", 1000.0*DT); )
 
             // Draw hierarchy handle
-            PERF( Timer.Reset(); )
             DrawHierHandle();
-            PERF( DT = Timer.GetTime(); printf("Handles=%.4fms ", 1000.0*DT); )
 
             // Draw labels
-            PERF( Timer.Reset(); )
             Gr->DrawText(m_LabelsTextObj, m_PosX+LevelSpace+6, m_PosY+m_VarY0, 0 /*m_ColLabelText*/, 0);
-            PERF( DT = Timer.GetTime(); printf("Labels=%.4fms ", 1000.0*DT); )
 
             // Draw values
             if( !m_IsPopupList )
             {
-                PERF( Timer.Reset(); )
                 Gr->DrawText(m_ValuesTextObj, m_PosX+m_VarX1, m_PosY+m_VarY0, 0 /*m_ColValText*/, 0 /*m_ColValBg*/);
-                PERF( DT = Timer.GetTime(); printf("Values=%.4fms ", 1000.0*DT); )
             }
 
             // Draw preview for color values and draw buttons and custom types
@@ -5124,6 +5716,32 @@ void CTwBar::Draw(int _DrawPart)
                         int LevelSpace = max(m_Font->m_CharHeight-6, 4); // space used by DrawHierHandles
                         Gr->DrawLine(m_PosX+m_VarX0+m_HierTags[h].m_Level*LevelSpace, yh+m_Font->m_CharHeight/2, m_PosX+m_VarX2, yh+m_Font->m_CharHeight/2, m_ColSeparator );
                     }
+                    else if( static_cast<CTwVarAtom *>(m_HierTags[h].m_Var)->m_Val.m_Button.m_Plot!=NULL )
+                    {
+                        // draw the plot once over all its visible rows; the hidden ones shift its origin
+                        CTwMgr::CPlotProxy *Plot = static_cast<CTwVarAtom *>(m_HierTags[h].m_Var)->m_Val.m_Button.m_Plot;
+                        if( h==0 || !IsPlotRow(m_HierTags[h-1].m_Var, Plot) )
+                        {
+                            int LineHeight = m_Font->m_CharHeight+m_LineSep;
+                            int NbRows = (int)Plot->m_Group->m_Vars.size();
+                            int Slot = 0;
+                            while( Slot<NbRows && Plot->m_Group->m_Vars[Slot]!=m_HierTags[h].m_Var )
+                                ++Slot;
+                            int NbVisible = 1;
+                            while( h+NbVisible<nh && IsPlotRow(m_HierTags[h+NbVisible].m_Var, Plot) )
+                                ++NbVisible;
+                            int px0 = m_PosX + m_VarX0 + m_HierTags[h].m_Level*LevelSpace;
+                            int px1 = m_PosX + m_VarX2 - 2;
+                            int py0 = yh + 1;
+                            int py1 = yh + NbVisible*LineHeight - 2;
+                            if( px0<px1 && py0<py1 )
+                            {
+                                Gr->ChangeViewport(px0, py0, px1-px0+1, py1-py0+1, 0, -Slot*LineHeight);
+                                Plot->Draw(Gr, px1-px0, NbRows*LineHeight-2, m_ColValText, m_ColValBg);
+                                Gr->RestoreViewport();
+                            }
+                        }
+                    }
                 }
                 else if( m_HierTags[h].m_Var->IsCustom() ) //static_cast<CTwVarAtom *>(m_HierTags[h].m_Var)->m_Type>=TW_TYPE_CUSTOM_BASE && static_cast<CTwVarAtom *>(m_HierTags[h].m_Var)->m_Type<TW_TYPE_CUSTOM_BASE+(int)g_TwMgr->m_Customs.size() )
                 {   // record custom types
@@ -5315,10 +5933,8 @@ void CTwBar::Draw(int _DrawPart)
             // Draw key shortcut text
             if( m_HighlightedLine>=0 && m_HighlightedLine==m_ShortcutLine && !m_IsPopupList && !m_EditInPlace.m_Active )
             {
-                PERF( Timer.Reset(); )  
                 Gr->DrawRect(m_PosX+m_Font->m_CharHeight-2, m_PosY+m_VarY1+1, m_PosX+m_Width-m_Font->m_CharHeight-2, m_PosY+m_VarY1+1+m_Font->m_CharHeight, m_ColShortcutBg);
                 Gr->DrawText(m_ShortcutTextObj, m_PosX+m_Font->m_CharHeight, m_PosY+m_VarY1+1, m_ColShortcutText, 0);
-                PERF( DT = Timer.GetTime(); printf("Shortcut=%.4fms ", 1000.0*DT); )
             }
             else if( (m_HighlightLabelsHeader || m_HighlightValuesHeader) && !m_IsPopupList && !m_EditInPlace.m_Active )
             {
@@ -5333,16 +5949,14 @@ void CTwBar::Draw(int _DrawPart)
                     {
                         string Str = g_TwMgr->m_KeyPressedStr;
                         ClampText(Str, m_Font, m_Width-2*m_Font->m_CharHeight);
-                        g_TwMgr->m_Graph->BuildText(g_TwMgr->m_KeyPressedTextObj, &Str, NULL, NULL, 1, g_TwMgr->m_HelpBar->m_Font, 0, 0);
+                        BuildText(g_TwMgr->m_KeyPressedTextObj, &Str, NULL, NULL, 1, g_TwMgr->m_HelpBar->m_Font, 0, 0);
                         g_TwMgr->m_KeyPressedBuildText = false;
                         g_TwMgr->m_KeyPressedTime = (float)g_BarTimer.GetTime();
                     }
                     if( (float)g_BarTimer.GetTime()>g_TwMgr->m_KeyPressedTime+1.0f ) // draw key pressed at least 1 second
                         g_TwMgr->m_KeyPressedStr = "";
-                    PERF( Timer.Reset(); )  
                     Gr->DrawRect(m_PosX+m_Font->m_CharHeight-2, m_PosY+m_VarY1+1, m_PosX+m_Width-m_Font->m_CharHeight-2, m_PosY+m_VarY1+1+m_Font->m_CharHeight, m_ColShortcutBg);
                     Gr->DrawText(g_TwMgr->m_KeyPressedTextObj, m_PosX+m_Font->m_CharHeight, m_PosY+m_VarY1+1, m_ColShortcutText, 0);
-                    PERF( DT = Timer.GetTime(); printf("KeyPressed=%.4fms ", 1000.0*DT); )  
                 }
                 else
                 {
@@ -5353,13 +5967,11 @@ void CTwBar::Draw(int _DrawPart)
                         sprintf(Ver, " %d.%02d", TW_VERSION/100, TW_VERSION%100);
                         Info += Ver;
                         ClampText(Info, m_Font, m_Width-2*m_Font->m_CharHeight);
-                        g_TwMgr->m_Graph->BuildText(g_TwMgr->m_InfoTextObj, &Info, NULL, NULL, 1, g_TwMgr->m_HelpBar->m_Font, 0, 0);
+                        BuildText(g_TwMgr->m_InfoTextObj, &Info, NULL, NULL, 1, g_TwMgr->m_HelpBar->m_Font, 0, 0);
                         g_TwMgr->m_InfoBuildText = false;
                     }
-                    PERF( Timer.Reset(); )  
                     Gr->DrawRect(m_PosX+m_Font->m_CharHeight-2, m_PosY+m_VarY1+1, m_PosX+m_Width-m_Font->m_CharHeight-2, m_PosY+m_VarY1+1+m_Font->m_CharHeight, m_ColShortcutBg);
                     Gr->DrawText(g_TwMgr->m_InfoTextObj, m_PosX+m_Font->m_CharHeight, m_PosY+m_VarY1+1, m_ColInfoText, 0);
-                    PERF( DT = Timer.GetTime(); printf("Info=%.4fms ", 1000.0*DT); )
                 }
             }
 
@@ -5398,6 +6010,7 @@ void CTwBar::Draw(int _DrawPart)
         }
 
         int MinXOffset = 0, MinYOffset = 0;
+        int PrevMinPosX = m_MinPosX, PrevMinPosY = m_MinPosY;
         if( g_TwMgr->m_IconPos==3 )         // top-right
         {
             if( g_TwMgr->m_IconAlign==1 )   // horizontal
@@ -5468,6 +6081,8 @@ void CTwBar::Draw(int _DrawPart)
                 MinXOffset = m_Font->m_CharHeight;
             }
         }
+        if( m_MinPosX!=PrevMinPosX || m_MinPosY!=PrevMinPosY )
+            g_TwMgr->m_HitIndexDirty = true;
 
         if( m_HighlightMaximize )
         {
@@ -5541,6 +6156,52 @@ void TwBar::CheckScrollbar(int NbHierLinesDelta)
 
 //  ---------------------------------------------------------------------------
 
+void CTwBar::GetHitRect(int *_X, int *_Y, int *_W, int *_H) const
+{
+    if( !m_IsMinimized )
+    {
+        *_X = m_PosX;
+        *_Y = m_PosY;
+        *_W = m_Width;
+        *_H = m_Height;
+    }
+    else if( m_Iconifiable ) // see the maximize test of MouseMotion
+    {
+        *_X = m_MinPosX+2;
+        *_Y = m_MinPosY+1;
+        *_W = m_Font->m_CharHeight-2;
+        *_H = m_Font->m_CharHeight-3;
+    }
+    else
+        *_X = *_Y = *_W = *_H = 0;
+}
+
+//  ---------------------------------------------------------------------------
+
+void CTwBar::SetMouseDrag(bool _Drag)
+{
+    m_MouseDrag = _Drag;
+    if( _Drag )
+        g_TwMgr->m_DraggingBar = this;
+    else if( g_TwMgr->m_DraggingBar==this )
+        g_TwMgr->m_DraggingBar = NULL;
+}
+
+//  ---------------------------------------------------------------------------
+
+void CTwBar::ClaimHighlight()
+{
+    CTwBar *Prev = g_TwMgr->m_HighlightBar;
+    if( Prev!=NULL && Prev!=this )
+    {
+        Prev->m_DrawHandles = false;
+        Prev->m_HighlightTitle = false;
+    }
+    g_TwMgr->m_HighlightBar = this;
+}
+
+//  ---------------------------------------------------------------------------
+
 bool CTwBar::MouseMotion(int _X, int _Y)
 {
     assert(g_TwMgr->m_Graph && g_TwMgr->m_WndHeight>0 && g_TwMgr->m_WndWidth>0);
@@ -5552,12 +6213,8 @@ bool CTwBar::MouseMotion(int _X, int _Y)
     if( !m_IsMinimized )
     {
         bool InBar = (_X>=m_PosX && _X<m_PosX+m_Width && _Y>=m_PosY && _Y<m_PosY+m_Height);
-        for( size_t ib=0; ib<g_TwMgr->m_Bars.size(); ++ib )
-            if( g_TwMgr->m_Bars[ib]!=NULL )
-            {
-                g_TwMgr->m_Bars[ib]->m_DrawHandles = false;
-                g_TwMgr->m_Bars[ib]->m_HighlightTitle = false;
-            }
+        ClaimHighlight();
+        m_HighlightTitle = false;
         m_DrawHandles = InBar;
         const int ContainedMargin = 32;
 
@@ -5783,6 +6440,7 @@ bool CTwBar::MouseMotion(int _X, int _Y)
                 m_ScrollY0 += m_PosY-y;
                 m_ScrollY1 += m_PosY-y;
                 ANT_SET_CURSOR(Move);
+                g_TwMgr->m_HitIndexDirty = true;
                 Handled = true;
             }
             else if( m_MouseDragValWidth )
@@ -5855,6 +6513,7 @@ bool CTwBar::MouseMotion(int _X, int _Y)
                 if (m_ValuesWidthRatio > 0) 
                     m_ValuesWidth = int(m_ValuesWidthRatio * m_Width + 0.5);
                 ANT_SET_CURSOR(TopLeft);
+                g_TwMgr->m_HitIndexDirty = true;
                 NotUpToDate();
                 if( m_IsHelpBar )
                 {
@@ -5899,6 +6558,7 @@ bool CTwBar::MouseMotion(int _X, int _Y)
                 if (m_ValuesWidthRatio > 0) 
                     m_ValuesWidth = int(m_ValuesWidthRatio * m_Width + 0.5);
                 ANT_SET_CURSOR(TopRight);
+                g_TwMgr->m_HitIndexDirty = true;
                 NotUpToDate();
                 if( m_IsHelpBar )
                 {
@@ -5943,6 +6603,7 @@ bool CTwBar::MouseMotion(int _X, int _Y)
                 if (m_ValuesWidthRatio > 0) 
                     m_ValuesWidth = int(m_ValuesWidthRatio * m_Width + 0.5);
                 ANT_SET_CURSOR(BottomLeft);
+                g_TwMgr->m_HitIndexDirty = true;
                 NotUpToDate();
                 if( m_IsHelpBar )
                 {
@@ -5982,6 +6643,7 @@ bool CTwBar::MouseMotion(int _X, int _Y)
                 if (m_ValuesWidthRatio > 0) 
                     m_ValuesWidth = int(m_ValuesWidthRatio * m_Width + 0.5);
                 ANT_SET_CURSOR(BottomRight);
+                g_TwMgr->m_HitIndexDirty = true;
                 NotUpToDate();
                 if( m_IsHelpBar )
                 {
@@ -6043,7 +6705,7 @@ bool CTwBar::MouseMotion(int _X, int _Y)
                 }
                 else if( sProxy!=NULL )
                 {
-                    sProxy->m_CustomCaptureFocus = false;   // force free focus, just in case.
+                    sProxy->SetCustomCaptureFocus(false);   // force free focus, just in case.
                     ANT_SET_CURSOR(Arrow);
                 }
             }
@@ -6076,7 +6738,7 @@ static void ANT_CALL PopupCallback(void *_ClientData)
 
     if( g_TwMgr!=NULL && g_TwMgr->m_PopupBar!=NULL )
     {
-        unsigned int Enum = *(unsigned int *)&_ClientData;
+        unsigned int Enum = (unsigned int)(size_t)_ClientData;
         CTwVarAtom *Var = g_TwMgr->m_PopupBar->m_VarEnumLinkedToPopupList;
         CTwBar *Bar = g_TwMgr->m_PopupBar->m_BarLinkedToPopupList;
         if( Bar!=NULL && Var!=NULL && !Var->m_ReadOnly && IsEnumType(Var->m_Type) )
@@ -6097,6 +6759,181 @@ static void ANT_CALL PopupCallback(void *_ClientData)
 
 //  ---------------------------------------------------------------------------
 
+// Binds the row buttons of a popup list to the entries visible from m_FirstLine.
+// Enums may have thousands of entries, so rows are created only for the lines
+// that fit in the popup and are reused when it is scrolled or filtered.
+void CTwBar::BindPopupRows(int _NbLines)
+{
+    assert( m_IsPopupList );
+    m_HierTags.resize(0);
+    m_NbHierLines = 0;
+    if( m_VarEnumLinkedToPopupList==NULL || !IsEnumType(m_VarEnumLinkedToPopupList->m_Type) )
+        return;
+    CTwMgr::CEnum& e = g_TwMgr->m_Enums[m_VarEnumLinkedToPopupList->m_Type-TW_TYPE_ENUM_BASE];
+    CTwBar *LinkedBar = (m_BarLinkedToPopupList!=NULL) ? m_BarLinkedToPopupList : this;
+    e.Sync();
+    if( e.m_Version!=m_PopupVersion )   // entries of a callback enum have changed
+    {
+        m_PopupRowsStack.clear();
+        FilterPopupRows(NULL);
+    }
+
+    bool Filtered = !m_PopupFilter.empty();
+    int NbRows = Filtered ? 1+(int)m_PopupRows.size() : (int)e.m_Entries.size();
+    if( m_FirstLine>NbRows-_NbLines )
+        m_FirstLine = NbRows-_NbLines;
+    if( m_FirstLine<0 )
+        m_FirstLine = 0;
+
+    while( (int)m_VarRoot.m_Vars.size()<_NbLines )
+    {
+        CTwVarAtom *Row = new(&m_VarArena) CTwVarAtom;
+        Row->m_Type = TW_TYPE_BUTTON;
+        Row->SetDefaults();
+        m_VarRoot.m_Vars.push_back(Row);
+    }
+
+    for( int i=0; i<_NbLines && m_FirstLine+i<NbRows; ++i )
+    {
+        int r = m_FirstLine+i;
+        CTwVarAtom *Row = static_cast<CTwVarAtom *>(m_VarRoot.m_Vars[i]);
+        Row->m_BgColorPtr = NULL;
+        if( Filtered && r==0 )
+        {
+            Row->m_Label = "> " + m_PopupFilter + "_";
+            Row->m_Val.m_Button.m_Callback = NULL;
+            Row->m_ClientData = NULL;
+            Row->m_ReadOnly = true;
+            Row->m_ColorPtr = &m_ColStaticText;
+        }
+        else
+        {
+            int Index = Filtered ? m_PopupRows[r-1] : r;
+            if( Index<0 || Index>=(int)e.m_Entries.size() )
+                break;  // entries redefined while the popup is opened
+            const CTwMgr::CEnum::CEntry& Entry = e.m_Entries[Index];
+            Row->m_Label = Entry.second;
+            Row->m_Val.m_Button.m_Callback = PopupCallback;
+            Row->m_ClientData = (void *)(size_t)Entry.first;
+            Row->m_ReadOnly = false;
+            if( Entry.first==m_PopupValue )
+            {
+                Row->m_ColorPtr = &LinkedBar->m_ColValTextNE;
+                Row->m_BgColorPtr = &LinkedBar->m_ColGrpBg;
+            }
+            else
+                Row->m_ColorPtr = &m_ColLabelText;
+        }
+        CHierTag Tag;
+        Tag.m_Var = Row;
+        Tag.m_Level = 0;
+        Tag.m_Closing = false;
+        m_HierTags.push_back(Tag);
+    }
+    if( m_HierTags.size()>0 )
+        m_HierTags[m_HierTags.size()-1].m_Closing = true;
+    m_NbHierLines = NbRows;
+}
+
+//  ---------------------------------------------------------------------------
+
+// Selects the popup entries whose label contains m_PopupFilter (case insensitive).
+// If _Prev is not NULL, the filter has been extended and only the entries
+// selected by the previous filter are tested, otherwise the whole lowercased
+// label index of the enum is searched.
+void CTwBar::FilterPopupRows(const std::vector<int> *_Prev)
+{
+    m_PopupRows.resize(0);
+    if( m_VarEnumLinkedToPopupList==NULL || !IsEnumType(m_VarEnumLinkedToPopupList->m_Type) )
+        return;
+    CTwMgr::CEnum& e = g_TwMgr->m_Enums[m_VarEnumLinkedToPopupList->m_Type-TW_TYPE_ENUM_BASE];
+    m_PopupVersion = e.m_Version;
+    if( m_PopupFilter.empty() )
+        return;
+    e.IndexLabels();
+    string Filter(m_PopupFilter);
+    for( size_t j=0; j<Filter.length(); ++j )
+        Filter[j] = (char)tolower((unsigned char)Filter[j]);
+    const char *Labels = e.m_LowerLabels.c_str();
+    const std::vector<unsigned int>& Starts = e.m_LowerLabelStarts;
+    int NbEntries = (int)e.m_Entries.size();
+    if( _Prev!=NULL )
+    {
+        for( size_t i=0; i<_Prev->size(); ++i )
+        {
+            int Index = (*_Prev)[i];
+            if( Index>=NbEntries )
+                continue;
+            const char *End = Labels+Starts[Index+1];
+            if( std::search(Labels+Starts[Index], End, Filter.begin(), Filter.end())!=End )
+                m_PopupRows.push_back(Index);
+        }
+    }
+    else
+    {
+        // labels are separated by '\n' which cannot be typed in the filter,
+        // so a match never spans two labels
+        const char *s = Labels;
+        int Index = 0;
+        while( (s=strstr(s, Filter.c_str()))!=NULL )
+        {
+            while( Labels+Starts[Index+1]<=s )  // matches are found in increasing order
+                ++Index;
+            m_PopupRows.push_back(Index);
+            s = Labels+Starts[Index+1];
+        }
+    }
+}
+
+//  ---------------------------------------------------------------------------
+
+// Type-ahead: printable keys and backspace edit the filter of a popup list
+bool CTwBar::PopupTypeAhead(int _Key, int _Modifiers)
+{
+    if( !m_IsPopupList || (_Modifiers&(TW_KMOD_CTRL|TW_KMOD_ALT))!=0 )
+        return false;
+    if( m_VarEnumLinkedToPopupList!=NULL && IsEnumType(m_VarEnumLinkedToPopupList->m_Type) 
+        && g_TwMgr->m_Enums[m_VarEnumLinkedToPopupList->m_Type-TW_TYPE_ENUM_BASE].m_Version!=m_PopupVersion )
+    {
+        // previous results refer to old entries
+        m_PopupRowsStack.clear();
+        FilterPopupRows(NULL);
+    }
+    if( _Key==TW_KEY_BACKSPACE )
+    {
+        if( m_PopupFilter.empty() )
+            return false;
+        m_PopupFilter.erase(m_PopupFilter.length()-1);
+        if( !m_PopupRowsStack.empty() )
+        {
+            m_PopupRows.swap(m_PopupRowsStack.back());
+            m_PopupRowsStack.pop_back();
+        }
+        else
+            FilterPopupRows(NULL);
+    }
+    else
+    {
+        if( _Key>' ' && _Key<127 )
+            m_PopupFilter += (char)_Key;
+        else if( _Key==' ' && !m_PopupFilter.empty() )
+            m_PopupFilter += ' ';
+        else
+            return false;
+        bool Refine = ( m_PopupFilter.length()>1 ); // m_PopupRows is empty for an empty filter
+        m_PopupRowsStack.push_back(std::vector<int>());
+        m_PopupRowsStack.back().swap(m_PopupRows);
+        FilterPopupRows(Refine ? &m_PopupRowsStack.back() : NULL);
+    }
+    m_FirstLine = 0;
+    m_HighlightedLine = ( m_PopupFilter.empty() || m_PopupRows.empty() ) ? -1 : 1;
+    m_HighlightedLineLastValid = m_HighlightedLine;
+    NotUpToDate();
+    return true;
+}
+
+//  ---------------------------------------------------------------------------
+
 bool CTwBar::MouseButton(ETwMouseButtonID _Button, bool _Pressed, int _X, int _Y)
 {
     assert(g_TwMgr->m_Graph && g_TwMgr->m_WndHeight>0 && g_TwMgr->m_WndWidth>0);
@@ -6138,7 +6975,7 @@ bool CTwBar::MouseButton(ETwMouseButtonID _Button, bool _Pressed, int _X, int _Y
             }
             else if( _Pressed && !m_MouseDrag )
             {
-                m_MouseDrag = true;
+                SetMouseDrag(true);
                 m_MouseDragVar = true;
                 m_MouseOriginX = _X;
                 m_MouseOriginY = _Y;
@@ -6151,7 +6988,7 @@ bool CTwBar::MouseButton(ETwMouseButtonID _Button, bool _Pressed, int _X, int _Y
                         RotoOnLButtonDown(m_PosX+m_VarX2-(1*IncrBtnWidth(m_Font->m_CharHeight))/2, _Y);
                     else
                         RotoOnLButtonDown(_X, _Y);
-                    m_MouseDrag = true;
+                    SetMouseDrag(true);
                     m_MouseDragVar = true;
                 }
                 else if( (Var->m_Type==TW_TYPE_BOOL8 || Var->m_Type==TW_TYPE_BOOL16 || Var->m_Type==TW_TYPE_BOOL32 || Var->m_Type==TW_TYPE_BOOLCPP) && !Var->m_ReadOnly && OnFocus )
@@ -6160,20 +6997,20 @@ bool CTwBar::MouseButton(ETwMouseButtonID _Button, bool _Pressed, int _X, int _Y
                     //m_HighlightClickBtn = true;
                     m_VarHasBeenIncr = true;
                     m_MouseDragVar = false;
-                    m_MouseDrag = false;
+                    SetMouseDrag(false);
                     NotUpToDate();
                 }
                 else if( Var->m_Type==TW_TYPE_BUTTON && !Var->m_ReadOnly )
                 {
                     m_HighlightClickBtn = true;
                     m_MouseDragVar = false;
-                    m_MouseDrag = false;
+                    SetMouseDrag(false);
                 }
                 //else if( (Var->m_Type==TW_TYPE_ENUM8 || Var->m_Type==TW_TYPE_ENUM16 || Var->m_Type==TW_TYPE_ENUM32) && !Var->m_ReadOnly )
                 else if( IsEnumType(Var->m_Type) && !Var->m_ReadOnly && !g_TwMgr->m_IsRepeatingMousePressed && OnFocus )
                 {
                     m_MouseDragVar = false;
-                    m_MouseDrag = false;
+                    SetMouseDrag(false);
                     if( g_TwMgr->m_PopupBar!=NULL )
                     {
                         TwDeleteBar(g_TwMgr->m_PopupBar);
@@ -6181,6 +7018,7 @@ bool CTwBar::MouseButton(ETwMouseButtonID _Button, bool _Pressed, int _X, int _Y
                     }
                     // popup list
                     CTwMgr::CEnum& e = g_TwMgr->m_Enums[Var->m_Type-TW_TYPE_ENUM_BASE];
+                    e.Sync();
                     g_TwMgr->m_PopupBar = TwNewBar("~ Enum Popup ~");
                     g_TwMgr->m_PopupBar->m_IsPopupList = true;
                     g_TwMgr->m_PopupBar->m_Color = m_Color;
@@ -6200,27 +7038,15 @@ bool CTwBar::MouseButton(ETwMouseButtonID _Button, bool _Pressed, int _X, int _Y
                     g_TwMgr->m_PopupBar->m_Height = popHeight;
                     g_TwMgr->m_PopupBar->m_VarEnumLinkedToPopupList = Var;
                     g_TwMgr->m_PopupBar->m_BarLinkedToPopupList = this;
-                    unsigned int CurrentEnumValue = (unsigned int)((int)Var->ValueToDouble());
-                    for( CTwMgr::CEnum::CEntries::iterator It=e.m_Entries.begin(); It!=e.m_Entries.end(); ++It )
-                    {
-                        char ID[64];
-                        sprintf(ID, "%u", It->first);
-                        //ultoa(It->first, ID, 10);
-                        TwAddButton(g_TwMgr->m_PopupBar, ID, PopupCallback, *(void**)&(It->first), NULL);
-                        CTwVar *Btn = g_TwMgr->m_PopupBar->Find(ID);
-                        if( Btn!=NULL )
-                        {
-                            Btn->m_Label = It->second.c_str();
-                            if( It->first==CurrentEnumValue )
-                            {
-                                Btn->m_ColorPtr = &m_ColValTextNE;
-                                Btn->m_BgColorPtr = &m_ColGrpBg;
-                            }
-                        }
-                    }
-                    g_TwMgr->m_HelpBarNotUpToDate = false;
+                    g_TwMgr->m_PopupBar->m_PopupValue = (unsigned int)((int)Var->ValueToDouble());
+                    g_TwMgr->m_PopupBar->m_PopupVersion = e.m_Version;
+                    // rows are bound to the entries by BindPopupRows; scroll to the current value
+                    CTwMgr::CEnum::CEntries::iterator It = e.m_Entries.find(g_TwMgr->m_PopupBar->m_PopupValue);
+                    if( It!=e.m_Entries.end() )
+                        g_TwMgr->m_PopupBar->m_FirstLine = max(0, (int)(It-e.m_Entries.begin()) - 2);
+                    g_TwMgr->m_PopupBar->NotUpToDate();
                 }
-                else if( (Var->m_ReadOnly && (Var->m_Type==TW_TYPE_CDSTRING || Var->m_Type==TW_TYPE_CDSTDSTRING || Var->m_Type==TW_TYPE_STDSTRING || IsCSStringType(Var->m_Type)) && EditInPlaceAcceptVar(Var))
+                else if( (Var->m_ReadOnly && (Var->m_Type==TW_TYPE_CDSTRING || Var->m_Type==TW_TYPE_CDSTDSTRING || Var->m_Type==TW_TYPE_STDSTRING || Var->m_Type==TW_TYPE_STRINGVIEW || IsCSStringType(Var->m_Type)) && EditInPlaceAcceptVar(Var))
                          || (!Var->m_ReadOnly && EditInPlaceAcceptVar(Var)) )
                     {
                         int dw = 0;
@@ -6231,13 +7057,13 @@ bool CTwBar::MouseButton(ETwMouseButtonID _Button, bool _Pressed, int _X, int _Y
                             EditInPlaceStart(Var, m_VarX1, m_VarY0+(m_HighlightedLine)*(m_Font->m_CharHeight+m_LineSep), m_VarX2-m_VarX1-dw-1);
                             if( EditInPlaceIsReadOnly() )
                                 EditInPlaceMouseMove(_X, _Y, false);
-                            m_MouseDrag = false;
+                            SetMouseDrag(false);
                             m_MouseDragVar = false;
                         }
                         else
                         {
                             EditInPlaceMouseMove(_X, _Y, false);
-                            m_MouseDrag = true;
+                            SetMouseDrag(true);
                             m_MouseDragVar = false;
                         }
                         EditInPlaceActive = m_EditInPlace.m_Active;
@@ -6256,7 +7082,7 @@ bool CTwBar::MouseButton(ETwMouseButtonID _Button, bool _Pressed, int _X, int _Y
             }
             else if ( !_Pressed && m_MouseDragVar )
             {
-                m_MouseDrag = false;
+                SetMouseDrag(false);
                 m_MouseDragVar = false;
                 if( !Handled )
                     m_DrawHandles = false;
@@ -6287,7 +7113,7 @@ bool CTwBar::MouseButton(ETwMouseButtonID _Button, bool _Pressed, int _X, int _Y
             {
                 m_HighlightClickBtn = false;
                 m_MouseDragVar = false;
-                m_MouseDrag = false;
+                SetMouseDrag(false);
                 Handled = true;
                 NotUpToDate();
                 if( !m_HierTags[m_HighlightedLine].m_Var->IsGroup() )
@@ -6304,7 +7130,7 @@ bool CTwBar::MouseButton(ETwMouseButtonID _Button, bool _Pressed, int _X, int _Y
             else if( !_Pressed )
             {
                 m_MouseDragVar = false;
-                m_MouseDrag = false;
+                SetMouseDrag(false);
                 CustomArea = true;
             }
         }
@@ -6312,22 +7138,23 @@ bool CTwBar::MouseButton(ETwMouseButtonID _Button, bool _Pressed, int _X, int _Y
                  && ( (_Button==TW_MOUSE_LEFT && _X>=m_PosX+2*m_Font->m_CharHeight && _X<m_PosX+m_Width-2*m_Font->m_CharHeight && _Y>=m_PosY && _Y<m_PosY+m_Font->m_CharHeight)
                       || (_Button==TW_MOUSE_MIDDLE && _X>=m_PosX && _X<m_PosX+m_Width && _Y>=m_PosY && _Y<m_PosY+m_Height) ) )
         {
-            m_MouseDrag = true;
+            SetMouseDrag(true);
             m_MouseDragTitle = true;
             m_MouseOriginX = _X;
             m_MouseOriginY = _Y;
+            ClaimHighlight();
             m_HighlightTitle = true;
             ANT_SET_CURSOR(Move);
         }
         else if( !_Pressed && m_MouseDragTitle )
         {
-            m_MouseDrag = false;
+            SetMouseDrag(false);
             m_MouseDragTitle = false;
             ANT_SET_CURSOR(Arrow);
         }
         else if( _Pressed && !m_MouseDrag && !m_IsPopupList && _Button==TW_MOUSE_LEFT && _X>=m_PosX+m_VarX1-3 && _X<m_PosX+m_VarX1+3 && _Y>m_PosY+m_Font->m_CharHeight && _Y<m_PosY+m_VarY0 )
         {
-            m_MouseDrag = true;
+            SetMouseDrag(true);
             m_MouseDragValWidth = true;
             m_MouseOriginX = _X;
             m_MouseOriginY = _Y;
@@ -6335,13 +7162,13 @@ bool CTwBar::MouseButton(ETwMouseButtonID _Button, bool _Pressed, int _X, int _Y
         }
         else if( !_Pressed && m_MouseDragValWidth )
         {
-            m_MouseDrag = false;
+            SetMouseDrag(false);
             m_MouseDragValWidth = false;
             ANT_SET_CURSOR(Arrow);
         }
         else if( _Pressed && !m_MouseDrag && m_NbDisplayedLines<m_NbHierLines && _Button==TW_MOUSE_LEFT && _X>=m_PosX+m_VarX2+2 && _X<m_PosX+m_Width-2 && _Y>=m_ScrollY0 && _Y<m_ScrollY1 )
         {
-            m_MouseDrag = true;
+            SetMouseDrag(true);
             m_MouseDragScroll = true;
             m_MouseOriginX = _X;
             m_MouseOriginY = _Y;
@@ -6354,7 +7181,7 @@ bool CTwBar::MouseButton(ETwMouseButtonID _Button, bool _Pressed, int _X, int _Y
         }
         else if( !_Pressed && m_MouseDragScroll )
         {
-            m_MouseDrag = false;
+            SetMouseDrag(false);
             m_MouseDragScroll = false;
             ANT_SET_CURSOR(Arrow);
         }
@@ -6376,7 +7203,7 @@ bool CTwBar::MouseButton(ETwMouseButtonID _Button, bool _Pressed, int _X, int _Y
         }
         else if( _Pressed && !m_MouseDrag && m_Resizable && !m_IsPopupList && _Button==TW_MOUSE_LEFT && _X>=m_PosX && _X<m_PosX+m_Font->m_CharHeight && _Y>=m_PosY && _Y<m_PosY+m_Font->m_CharHeight )
         {
-            m_MouseDrag = true;
+            SetMouseDrag(true);
             m_MouseDragResizeUL = true;
             m_MouseOriginX = _X;
             m_MouseOriginY = _Y;
@@ -6385,13 +7212,13 @@ bool CTwBar::MouseButton(ETwMouseButtonID _Button, bool _Pressed, int _X, int _Y
         }
         else if( !_Pressed && m_MouseDragResizeUL )
         {
-            m_MouseDrag = false;
+            SetMouseDrag(false);
             m_MouseDragResizeUL = false;
             ANT_SET_CURSOR(Arrow);
         }
         else if( _Pressed && !m_MouseDrag && m_Resizable && !m_IsPopupList && _Button==TW_MOUSE_LEFT && _X>=m_PosX+m_Width-m_Font->m_CharHeight && _X<m_PosX+m_Width && _Y>=m_PosY && _Y<m_PosY+m_Font->m_CharHeight )
         {
-            m_MouseDrag = true;
+            SetMouseDrag(true);
             m_MouseDragResizeUR = true;
             m_MouseOriginX = _X;
             m_MouseOriginY = _Y;
@@ -6400,13 +7227,13 @@ bool CTwBar::MouseButton(ETwMouseButtonID _Button, bool _Pressed, int _X, int _Y
         }
         else if( !_Pressed && m_MouseDragResizeUR )
         {
-            m_MouseDrag = false;
+            SetMouseDrag(false);
             m_MouseDragResizeUR = false;
             ANT_SET_CURSOR(Arrow);
         }
         else if( _Pressed && !m_MouseDrag && m_Resizable && !m_IsPopupList && _Button==TW_MOUSE_LEFT && _X>=m_PosX && _X<m_PosX+m_Font->m_CharHeight && _Y>=m_PosY+m_Height-m_Font->m_CharHeight && _Y<m_PosY+m_Height )
         {
-            m_MouseDrag = true;
+            SetMouseDrag(true);
             m_MouseDragResizeLL = true;
             m_MouseOriginX = _X;
             m_MouseOriginY = _Y;
@@ -6415,13 +7242,13 @@ bool CTwBar::MouseButton(ETwMouseButtonID _Button, bool _Pressed, int _X, int _Y
         }
         else if( !_Pressed && m_MouseDragResizeLL )
         {
-            m_MouseDrag = false;
+            SetMouseDrag(false);
             m_MouseDragResizeLL = false;
             ANT_SET_CURSOR(Arrow);
         }
         else if( _Pressed && !m_MouseDrag && m_Resizable && !m_IsPopupList && _Button==TW_MOUSE_LEFT && _X>=m_PosX+m_Width-m_Font->m_CharHeight && _X<m_PosX+m_Width && _Y>=m_PosY+m_Height-m_Font->m_CharHeight && _Y<m_PosY+m_Height )
         {
-            m_MouseDrag = true;
+            SetMouseDrag(true);
             m_MouseDragResizeLR = true;
             m_MouseOriginX = _X;
             m_MouseOriginY = _Y;
@@ -6430,7 +7257,7 @@ bool CTwBar::MouseButton(ETwMouseButtonID _Button, bool _Pressed, int _X, int _Y
         }
         else if( !_Pressed && m_MouseDragResizeLR )
         {
-            m_MouseDrag = false;
+            SetMouseDrag(false);
             m_MouseDragResizeLR = false;
             ANT_SET_CURSOR(Arrow);
         }
@@ -6550,14 +7377,14 @@ bool CTwBar::MouseButton(ETwMouseButtonID _Button, bool _Pressed, int _X, int _Y
                 {
                     if( sProxy->m_CustomCaptureFocus || (_X>=r.m_XMin && _X<r.m_XMax && _Y>=r.m_YMin && _Y<r.m_YMax) )
                     {
-                        sProxy->m_CustomCaptureFocus = _Pressed;
+                        sProxy->SetCustomCaptureFocus(_Pressed);
                         CustomHandled = sProxy->m_CustomMouseButtonCallback(_Button, _Pressed, _X-r.m_XMin, _Y-r.m_Y0, r.m_XMax-r.m_XMin, r.m_Y1-r.m_Y0, sProxy->m_StructExtData, sProxy->m_StructClientData, this, r.m_Var);
                         s = 2; // force s-loop exit
                     }
                 }
                 else if( sProxy!=NULL )
                 {
-                    sProxy->m_CustomCaptureFocus = false;   // force free focus, just in case.
+                    sProxy->SetCustomCaptureFocus(false);   // force free focus, just in case.
                     ANT_SET_CURSOR(Arrow);
                 }
             }
@@ -6604,56 +7431,6 @@ bool CTwBar::MouseWheel(int _Pos, int _PrevPos, int _MouseX, int _MouseY)
 
 //  ---------------------------------------------------------------------------
 
-CTwVarAtom *CTwVarGroup::FindShortcut(int _Key, int _Modifiers, bool *_DoIncr)
-{
-    CTwVarAtom *Atom;
-    int Mask = 0xffffffff;
-    if( _Key>' ' && _Key<256 ) // don't test SHIFT if _Key is a common key
-        Mask &= ~TW_KMOD_SHIFT;
-
-    // don't test KMOD_NUM and KMOD_CAPS modifiers coming from SDL
-    Mask &= ~(0x1000);  // 0x1000 is the KMOD_NUM value defined in SDL_keysym.h
-    Mask &= ~(0x2000);  // 0x2000 is the KMOD_CAPS value defined in SDL_keysym.h
-
-    // complete partial modifiers comming from SDL
-    if( _Modifiers & TW_KMOD_SHIFT )
-        _Modifiers |= TW_KMOD_SHIFT;
-    if( _Modifiers & TW_KMOD_CTRL )
-        _Modifiers |= TW_KMOD_CTRL;
-    if( _Modifiers & TW_KMOD_ALT )
-        _Modifiers |= TW_KMOD_ALT;
-    if( _Modifiers & TW_KMOD_META )
-        _Modifiers |= TW_KMOD_META;
-
-    for(size_t i=0; i<m_Vars.size(); ++i)
-        if( m_Vars[i]!=NULL )
-        {
-            if( m_Vars[i]->IsGroup() )
-            {
-                Atom = static_cast<CTwVarGroup *>(m_Vars[i])->FindShortcut(_Key, _Modifiers, _DoIncr);
-                if( Atom!=NULL )
-                    return Atom;
-            }
-            else
-            {
-                Atom = static_cast<CTwVarAtom *>(m_Vars[i]);
-                if( Atom->m_KeyIncr[0]==_Key && (Atom->m_KeyIncr[1]&Mask)==(_Modifiers&Mask) )
-                {
-                    if( _DoIncr!=NULL )
-                        *_DoIncr = true;
-                    return Atom;
-                }
-                else if( Atom->m_KeyDecr[0]==_Key && (Atom->m_KeyDecr[1]&Mask)==(_Modifiers&Mask) )
-                {
-                    if( _DoIncr!=NULL )
-                        *_DoIncr = false;
-                    return Atom;
-                }
-            }
-        }
-    return NULL;
-}
-
 bool CTwBar::KeyPressed(int _Key, int _Modifiers)
 {
     assert(g_TwMgr->m_Graph && g_TwMgr->m_WndHeight>0 && g_TwMgr->m_WndWidth>0);
@@ -6720,11 +7497,15 @@ bool CTwBar::KeyPressed(int _Key, int _Modifiers)
         {
             Handled = EditInPlaceKeyPressed(_Key, _Modifiers);
         }
+        else if( m_IsPopupList && PopupTypeAhead(_Key, _Modifiers) )
+        {
+            Handled = true;
+        }
         else
         {
             bool BarActive = (m_DrawHandles || m_IsPopupList) && !m_IsMinimized;
             bool DoIncr = true;
-            CTwVarAtom *Atom = m_VarRoot.FindShortcut(_Key, _Modifiers, &DoIncr);
+            CTwVarAtom *Atom = g_TwMgr->FindShortcut(this, _Key, _Modifiers, &DoIncr);
             if( Atom!=NULL && Atom->m_Visible )
             {
                 if( !Atom->m_ReadOnly )
@@ -6871,7 +7652,7 @@ bool CTwBar::KeyPressed(int _Key, int _Modifiers)
                     TwDeleteBar(this);
                     g_TwMgr->m_PopupBar = NULL;                
                     if( LinkedBar!=NULL )
-                        LinkedBar->m_DrawHandles = true;
+                        LinkedBar->SetFocus(true);
                     return true; // this bar has been destroyed
                 }
             }
@@ -6897,7 +7678,7 @@ bool CTwBar::KeyPressed(int _Key, int _Modifiers)
                     TwDeleteBar(this);
                     g_TwMgr->m_PopupBar = NULL;                
                     if( LinkedBar!=NULL )
-                        LinkedBar->m_DrawHandles = true;
+                        LinkedBar->SetFocus(true);
                     return true; // this bar has been destroyed
                 }
             }
@@ -6923,7 +7704,7 @@ bool CTwBar::KeyTest(int _Key, int _Modifiers)
         {
             bool BarActive = (m_DrawHandles || m_IsPopupList) && !m_IsMinimized;
             bool DoIncr;
-            CTwVarAtom *Atom = m_VarRoot.FindShortcut(_Key, _Modifiers, &DoIncr);
+            CTwVarAtom *Atom = g_TwMgr->FindShortcut(this, _Key, _Modifiers, &DoIncr);
             if( Atom!=NULL && Atom->m_Visible )
                 Handled = true;
             else if( BarActive && ( _Key==TW_KEY_RIGHT || _Key==TW_KEY_LEFT || _Key==TW_KEY_UP || _Key==TW_KEY_DOWN
@@ -7387,7 +8168,7 @@ bool CTwBar::EditInPlaceIsReadOnly()
         return true;
     else if( m_EditInPlace.m_Var->m_Type==TW_TYPE_CDSTRING && ((m_EditInPlace.m_Var->m_Ptr==NULL && m_EditInPlace.m_Var->m_SetCallback==NULL) || (m_EditInPlace.m_Var->m_Ptr!=NULL && g_TwMgr->m_CopyCDStringToClient==NULL)) )
         return true;
-    else if( m_EditInPlace.m_Var->m_Type==TW_TYPE_CDSTDSTRING && m_EditInPlace.m_Var->m_SetCallback==NULL )
+    else if( (m_EditInPlace.m_Var->m_Type==TW_TYPE_CDSTDSTRING || m_EditInPlace.m_Var->m_Type==TW_TYPE_STRINGVIEW) && m_EditInPlace.m_Var->m_SetCallback==NULL )
         return true;
     else if( m_EditInPlace.m_Var->m_Type==TW_TYPE_STDSTRING && ((m_EditInPlace.m_Var->m_Ptr==NULL && m_EditInPlace.m_Var->m_SetCallback==NULL) || (m_EditInPlace.m_Var->m_Ptr!=NULL && g_TwMgr->m_CopyStdStringToClient==NULL)) )
         return true;
@@ -7439,7 +8220,7 @@ void CTwBar::EditInPlaceDraw()
     // draw edit text
     color32 ColText = EditInPlaceIsReadOnly() ? m_ColValTextRO : m_ColEditText;
     color32 ColBg = EditInPlaceIsReadOnly() ? m_ColValBg : m_ColEditBg;
-    g_TwMgr->m_Graph->BuildText(m_EditInPlace.m_EditTextObj, &Substr, NULL, NULL, 1, m_Font, 0, m_EditInPlace.m_Width);
+    BuildText(m_EditInPlace.m_EditTextObj, &Substr, NULL, NULL, 1, m_Font, 0, m_EditInPlace.m_Width);
     g_TwMgr->m_Graph->DrawText(m_EditInPlace.m_EditTextObj, m_PosX+m_EditInPlace.m_X, m_PosY+m_EditInPlace.m_Y, ColText, ColBg);
 
     // draw selected text
@@ -7465,7 +8246,7 @@ void CTwBar::EditInPlaceDraw()
     if( SelWidth>0 && StrSelected.length()>0 )
     {
         color32 ColSelBg = EditInPlaceIsReadOnly() ? m_ColValTextRO : m_ColEditSelBg;
-        g_TwMgr->m_Graph->BuildText(m_EditInPlace.m_EditSelTextObj, &StrSelected, NULL, NULL, 1, m_Font, 0, SelWidth);
+        BuildText(m_EditInPlace.m_EditSelTextObj, &StrSelected, NULL, NULL, 1, m_Font, 0, SelWidth);
         if ( m_EditInPlace.m_CaretPos>m_EditInPlace.m_SelectionStart )
             g_TwMgr->m_Graph->DrawText(m_EditInPlace.m_EditSelTextObj, CaretX-SelWidth, m_PosY+m_EditInPlace.m_Y, m_ColEditSelText, ColSelBg);
         else
@@ -7483,7 +8264,7 @@ bool CTwBar::EditInPlaceAcceptVar(const CTwVarAtom* _Var)
         return false;
     if( _Var->m_Type>=TW_TYPE_CHAR && _Var->m_Type<=TW_TYPE_DOUBLE )
         return true;
-    if( _Var->m_Type==TW_TYPE_CDSTRING || _Var->m_Type==TW_TYPE_CDSTDSTRING || _Var->m_Type==TW_TYPE_STDSTRING )
+    if( _Var->m_Type==TW_TYPE_CDSTRING || _Var->m_Type==TW_TYPE_CDSTDSTRING || _Var->m_Type==TW_TYPE_STDSTRING || _Var->m_Type==TW_TYPE_STRINGVIEW )
         return true;
     if( IsCSStringType(_Var->m_Type) )
         return true;
@@ -7542,6 +8323,8 @@ void CTwBar::EditInPlaceEnd(bool _Commit)
                     g_TwMgr->m_CopyStdStringToClient(*StringPtr, m_EditInPlace.m_String);
             }
         }
+        else if( m_EditInPlace.m_Var->m_Type==TW_TYPE_STRINGVIEW )
+            m_EditInPlace.m_Var->SetStringView(m_EditInPlace.m_String.c_str(), m_EditInPlace.m_String.length());
         else if( IsCSStringType(m_EditInPlace.m_Var->m_Type) )
         {
             int n = TW_CSSTRING_SIZE(m_EditInPlace.m_Var->m_Type);
@@ -16,6 +16,8 @@
 
 #include <AntTweakBar.h>
 #include "TwColors.h"
+#include "TwAlloc.h"
+#include "TwStringPool.h"
   
 #define ANT_TWEAK_BAR_DLL "AntTweakBar"
 
@@ -23,12 +25,37 @@
 //  ---------------------------------------------------------------------------
 
 bool IsCustomType(int _Type);
+bool IsCSStringType(int _Type);
+bool IsEnumType(int _Type);
+
+// Storage of the var nodes of a bar. Nodes are carved from chunks of slots of
+// the same size so that the vars of a bar stay packed in memory; freed slots
+// are reused by the next nodes of the same size.
+struct CTwVarArena
+{
+                            CTwVarArena();
+                            ~CTwVarArena();
+    static void *           Alloc(CTwVarArena *_Arena, size_t _Size);  // _Arena==NULL: node allocated apart
+    static void             Free(void *_Ptr);
+protected:
+    enum                    { SLOT_ALIGN = 16, NB_SIZE_CLASSES = 32, MIN_CHUNK_SLOTS = 8, MAX_CHUNK_SLOTS = 256 };
+    union CSlotHeader
+    {
+        struct              { CTwVarArena *m_Arena; int m_SizeClass; } m_Info;
+        unsigned char       m_Align[SLOT_ALIGN];
+    };
+    void *                  m_FreeSlots[NB_SIZE_CLASSES];   // lists linked through the free slots
+    int                     m_ChunkSlots[NB_SIZE_CLASSES];  // number of slots of the next chunk
+    int                     m_NbUsedSlots;
+    std::vector<void *, TTwAllocator<void *> > m_Chunks;
+private:
+                            CTwVarArena(const CTwVarArena&);
+    CTwVarArena&            operator=(const CTwVarArena&);
+};
 
 struct CTwVar
 {
-    std::string             m_Name;
-    std::string             m_Label;
-    std::string             m_Help;
+    // fields read while browsing the hierarchy come first
     bool                    m_IsRoot;
     bool                    m_DontClip;
     bool                    m_Visible;
@@ -36,10 +63,14 @@ struct CTwVar
     signed short            m_TopMargin;
     const color32 *         m_ColorPtr;
     const color32 *         m_BgColorPtr;
+    CTwIString              m_Name;
+    CTwIString              m_Label;
+    CTwIString              m_Help;
 
     virtual bool            IsGroup() const = 0;
     virtual bool            IsCustom() const { return false; }
-    virtual const CTwVar *  Find(const char *_Name, struct CTwVarGroup **_Parent, int *_Index) const = 0;
+    virtual const CTwVar *  Find(CTwIString::Id _Name, struct CTwVarGroup **_Parent, int *_Index) const = 0;
+    const CTwVar *          Find(const char *_Name, struct CTwVarGroup **_Parent, int *_Index) const;
     virtual int             HasAttrib(const char *_Attrib, bool *_HasValue) const;
     virtual int             SetAttrib(int _AttribID, const char *_Value, TwBar *_Bar, struct CTwVarGroup *_VarParent, int _VarIndex);
     virtual ERetType        GetAttrib(int _AttribID, TwBar *_Bar, struct CTwVarGroup *_VarParent, int _VarIndex, std::vector<double>& outDouble, std::ostringstream& outString) const;
@@ -47,20 +78,37 @@ struct CTwVar
     virtual bool            IsReadOnly() const = 0;
                             CTwVar();
     virtual                 ~CTwVar() {}
+    static void *           operator new(size_t _Size)                      { return CTwVarArena::Alloc(NULL, _Size); }
+    static void *           operator new(size_t _Size, CTwVarArena *_Arena) { return CTwVarArena::Alloc(_Arena, _Size); }
+    static void             operator delete(void *_Ptr)                     { CTwVarArena::Free(_Ptr); }
+    static void             operator delete(void *_Ptr, CTwVarArena *)      { CTwVarArena::Free(_Ptr); }
 
     static size_t           GetDataSize(TwType _Type);
 };
 
 
+// Value line of a TW_TYPE_STRINGVIEW var: formatted again only if the view
+// generation, the available width or the font changes
+struct CStringViewLine
+{
+    bool                    m_Valid;
+    unsigned int            m_Generation;
+    int                     m_WidthMax;
+    const CTexFont *        m_Font;
+    int                     m_FontGeneration;
+    std::string             m_Text;
+};
+
+
 struct CTwVarAtom : CTwVar
 {
     ETwType                 m_Type;
+    bool                    m_ReadOnly;
+    bool                    m_NoSlider;
     void *                  m_Ptr;
     TwSetVarCallback        m_SetCallback;
     TwGetVarCallback        m_GetCallback;
     void *                  m_ClientData;
-    bool                    m_ReadOnly;
-    bool                    m_NoSlider;
     int                     m_KeyIncr[2];   // [0]=key_code [1]=modifiers
     int                     m_KeyDecr[2];   // [0]=key_code [1]=modifiers
 
@@ -108,11 +156,16 @@ struct CTwVarAtom : CTwVar
         {
             TwButtonCallback m_Callback;
             int             m_Separator;
+            CTwMgr::CPlotProxy *m_Plot;     // not NULL if the row is covered by a plot
         }                   m_Button;
         struct CCustomVal
         {
             CTwMgr::CMemberProxy *m_MemberProxy;
         }                   m_Custom;
+        struct CStringViewVal
+        {
+            struct CStringViewLine *m_Line; // allocated by the first ListValues
+        }                   m_StringView;
     };
     UVal                    m_Val;
 
@@ -122,7 +175,8 @@ struct CTwVarAtom : CTwVar
     virtual double          ValueToDouble() const;
     virtual void            ValueFromDouble(double _Val);
     virtual void            MinMaxStepToDouble(double *_Min, double *_Max, double *_Step) const;
-    virtual const CTwVar *  Find(const char *_Name, struct CTwVarGroup **_Parent, int *_Index) const;
+    using                   CTwVar::Find;
+    virtual const CTwVar *  Find(CTwIString::Id _Name, struct CTwVarGroup **_Parent, int *_Index) const;
     virtual int             HasAttrib(const char *_Attrib, bool *_HasValue) const;
     virtual int             SetAttrib(int _AttribID, const char *_Value, TwBar *_Bar, struct CTwVarGroup *_VarParent, int _VarIndex);
     virtual ERetType        GetAttrib(int _AttribID, TwBar *_Bar, struct CTwVarGroup *_VarParent, int _VarIndex, std::vector<double>& outDouble, std::ostringstream& outString) const;
@@ -130,6 +184,8 @@ struct CTwVarAtom : CTwVar
     virtual void            SetDefaults();
     virtual void            SetReadOnly(bool _ReadOnly) { m_ReadOnly=_ReadOnly; if( m_Type!=TW_TYPE_BUTTON && m_SetCallback==NULL && m_Ptr==NULL ) m_ReadOnly=true; }
     virtual bool            IsReadOnly() const { if( m_Type!=TW_TYPE_BUTTON && m_SetCallback==NULL && m_Ptr==NULL ) return true; else return m_ReadOnly; }
+    void                    GetStringView(TwStringView *_View) const;
+    void                    SetStringView(const char *_Str, size_t _Length);
     //virtual int           DefineEnum(const TwEnumVal *_EnumValues, unsigned int _NbValues);
                             CTwVarAtom();
     virtual                 ~CTwVarAtom();
@@ -138,28 +194,34 @@ struct CTwVarAtom : CTwVar
 
 struct CTwVarGroup : CTwVar
 {
-    std::vector<CTwVar *>   m_Vars;
     bool                    m_Open;
+    bool                    m_StructPending;    // struct members not created yet (see TwExpandStructVar)
+    bool                    m_StructReadOnly;   // read-only state of the pending struct members
+    typedef std::vector<CTwVar *, TTwAllocator<CTwVar *> > CVars;
+    CVars                   m_Vars;
     TwSummaryCallback       m_SummaryCallback;
     void *                  m_SummaryClientData;
     void *                  m_StructValuePtr;
     TwType                  m_StructType;
+    CTwMgr::CStructProxy *  m_StructProxy;      // NULL if the struct members point to m_StructValuePtr
+    CTwMgr::CArrayProxy *   m_ArrayProxy;       // not NULL if the group displays an array var
+    CTwMgr::CPlotProxy *    m_PlotProxy;        // not NULL if the group displays a plot
 
     virtual bool            IsGroup() const { return true; }
-    virtual const CTwVar *  Find(const char *_Name, CTwVarGroup **_Parent, int *_Index) const;
+    using                   CTwVar::Find;
+    virtual const CTwVar *  Find(CTwIString::Id _Name, CTwVarGroup **_Parent, int *_Index) const;
     virtual int             HasAttrib(const char *_Attrib, bool *_HasValue) const;
     virtual int             SetAttrib(int _AttribID, const char *_Value, TwBar *_Bar, struct CTwVarGroup *_VarParent, int _VarIndex);
     virtual ERetType        GetAttrib(int _AttribID, TwBar *_Bar, struct CTwVarGroup *_VarParent, int _VarIndex, std::vector<double>& outDouble, std::ostringstream& outString) const;
-    virtual CTwVarAtom *    FindShortcut(int _Key, int _Modifiers, bool *_DoIncr);
-    virtual void            SetReadOnly(bool _ReadOnly) { for(size_t i=0; i<m_Vars.size(); ++i) if(m_Vars[i]) m_Vars[i]->SetReadOnly(_ReadOnly); }
-    virtual bool            IsReadOnly() const { for(size_t i=0; i<m_Vars.size(); ++i) if(m_Vars[i] && !m_Vars[i]->IsReadOnly()) return false; return true; }
-                            CTwVarGroup()   { m_Open=false; m_StructType=TW_TYPE_UNDEF; m_SummaryCallback=NULL; m_SummaryClientData=NULL; m_StructValuePtr=NULL; }
+    virtual void            SetReadOnly(bool _ReadOnly);
+    virtual bool            IsReadOnly() const { if( m_StructPending ) return m_StructReadOnly; for(size_t i=0; i<m_Vars.size(); ++i) if(m_Vars[i] && !m_Vars[i]->IsReadOnly()) return false; return true; }
+                            CTwVarGroup()   { m_Open=false; m_StructPending=false; m_StructReadOnly=false; m_StructType=TW_TYPE_UNDEF; m_SummaryCallback=NULL; m_SummaryClientData=NULL; m_StructValuePtr=NULL; m_StructProxy=NULL; m_ArrayProxy=NULL; m_PlotProxy=NULL; }
     virtual                 ~CTwVarGroup();
 };
 
 //  ---------------------------------------------------------------------------
 
-struct CTwBar
+struct CTwBar : CTwAllocated
 {
     std::string             m_Name;
     std::string             m_Label;
@@ -186,12 +248,18 @@ struct CTwBar
     bool                    m_Movable;
     bool                    m_Iconifiable;
     bool                    m_Contained;
+    int                     m_CommitMode;       // CTwMgr::ECommitMode given to the vars added to the bar
+    double                  m_ThrottlePeriod;
 
+    CTwVarArena             m_VarArena;     // declared before m_VarRoot to be destroyed after it
     CTwVarGroup             m_VarRoot;
 
     enum EDrawPart          { DRAW_BG=(1<<0), DRAW_CONTENT=(1<<1), DRAW_ALL=DRAW_BG|DRAW_CONTENT };
     void                    Draw(int _DrawPart=DRAW_ALL);
     void                    NotUpToDate();
+    enum EFrameTime         { FRAME_UPDATE, FRAME_TEXT, FRAME_SUBMIT, FRAME_NB_TIMES };
+    double                  m_FrameTimes[FRAME_NB_TIMES];       // timings of the current frame in ms
+    double                  m_LastFrameTimes[FRAME_NB_TIMES];   // timings of the last frame in ms
     const CTwVar *          Find(const char *_Name, CTwVarGroup **_Parent=NULL, int *_Index=NULL) const;
     CTwVar *                Find(const char *_Name, CTwVarGroup **_Parent=NULL, int *_Index=NULL);
     int                     HasAttrib(const char *_Attrib, bool *_HasValue) const;
@@ -204,11 +272,12 @@ struct CTwBar
     bool                    KeyTest(int _Key, int _Modifiers);
     bool                    IsMinimized() const { return m_IsMinimized; }
     bool                    IsDragging() const  { return m_MouseDrag; }
+    void                    GetHitRect(int *_X, int *_Y, int *_W, int *_H) const; // area where MouseMotion handles the mouse (bar or minimized icon)
     bool                    Show(CTwVar *_Var); // display the line associated to _Var
     bool                    OpenHier(CTwVarGroup *_Root, CTwVar *_Var); // open a hierarchy if it contains _Var
     int                     LineInHier(CTwVarGroup *_Root, CTwVar *_Var); // returns the number of the line associated to _Var
     void                    UnHighlightLine() { m_HighlightedLine = -1; NotUpToDate(); } // used by PopupCallback
-    void                    SetFocus(bool _Focus) { m_DrawHandles = _Focus; }            // used by PopupCallback
+    void                    SetFocus(bool _Focus) { if( _Focus ) ClaimHighlight(); m_DrawHandles = _Focus; } // used by PopupCallback
     bool                    GetFocus() const { return m_DrawHandles || m_EditInPlace.m_Active; }
     void                    StopEditInPlace() { if( m_EditInPlace.m_Active ) EditInPlaceEnd(false); }
     void                    CheckScrollbar(int NbHierLinesDelta);
@@ -275,8 +344,12 @@ protected:
     bool                    m_UpToDate;
     float                   m_LastUpdateTime;
     void                    Update();
+    void                    BuildText(void *_TextObj, const std::string *_TextLines, color32 *_LineColors, color32 *_LineBgColors, int _NbLines, const CTexFont *_Font, int _Sep, int _BgWidth);
+    CTwGlyphUses            m_GlyphUses;    // cached glyphs used by the texts built by Update
 
-    bool                    m_MouseDrag;
+    bool                    m_MouseDrag;        // set through SetMouseDrag
+    void                    SetMouseDrag(bool _Drag);
+    void                    ClaimHighlight();   // clears the handles and title highlight of the previous highlighted bar
     bool                    m_MouseDragVar;
     bool                    m_MouseDragTitle;
     bool                    m_MouseDragScroll;
@@ -321,6 +394,7 @@ protected:
     bool                    m_DrawListBtn;
     bool                    m_DrawBoolBtn;
     EButtonAlign            m_ButtonAlign;
+    void                    SetCommitMode(CTwVarGroup *_Grp);
 
     struct CHierTag
     {
@@ -328,16 +402,39 @@ protected:
         int                 m_Level;
         bool                m_Closing;
     };
-    std::vector<CHierTag>   m_HierTags;
+    std::vector<CHierTag, TTwAllocator<CHierTag> > m_HierTags;
     void                    BrowseHierarchy(int *_LineNum, int _CurrLevel, const CTwVar *_Var, int _First, int _Last);
+    void                    ExpandOpenStructs(CTwVarGroup *_Grp);
+
+    // Popup list of enum values: only the rows that fit in the popup are
+    // created, and they are rebound to the visible entries at each update.
+    unsigned int            m_PopupValue;   // current value of the linked var
+    unsigned int            m_PopupVersion; // version of the enum entries m_PopupRows refers to
+    std::string             m_PopupFilter;  // type-ahead filter, displayed on the first row
+    std::vector<int>        m_PopupRows;    // indices of the entries matching m_PopupFilter
+    std::vector<std::vector<int> > m_PopupRowsStack; // m_PopupRows of the shorter filters, popped by backspace
+    void                    BindPopupRows(int _NbLines);
+    void                    FilterPopupRows(const std::vector<int> *_Prev);
+    bool                    PopupTypeAhead(int _Key, int _Modifiers);
     void *                  m_TitleTextObj;
     void *                  m_LabelsTextObj;
     void *                  m_ValuesTextObj;
     void *                  m_ShortcutTextObj;
     int                     m_ShortcutLine;
     void *                  m_HeadersTextObj;
-    void                    ListLabels(std::vector<std::string>& _Labels, std::vector<color32>& _Colors, std::vector<color32>& _BgColors, bool *_HasBgColors, const CTexFont *_Font, int _AtomWidthMax, int _GroupWidthMax);
-    void                    ListValues(std::vector<std::string>& _Values, std::vector<color32>& _Colors, std::vector<color32>& _BgColors, const CTexFont *_Font, int _WidthMax);
+
+    // Text lines built by ListLabels and ListValues. They are kept between
+    // updates, and the strings of previous lines are recycled through m_LinePool.
+    typedef std::vector<std::string, TTwAllocator<std::string> > CLines;
+    typedef std::vector<color32, TTwAllocator<color32> > CLineColors;
+    CLines                  m_Lines;
+    CLineColors             m_LineColors;
+    CLineColors             m_LineBgColors;
+    CLines                  m_LinePool;
+    void                    RecycleLines(CLines& _Lines);
+    std::string&            PushLine(CLines& _Lines);
+    void                    ListLabels(CLines& _Labels, CLineColors& _Colors, CLineColors& _BgColors, bool *_HasBgColors, const CTexFont *_Font, int _AtomWidthMax, int _GroupWidthMax);
+    void                    ListValues(CLines& _Values, CLineColors& _Colors, CLineColors& _BgColors, const CTexFont *_Font, int _WidthMax);
     int                     ComputeLabelsWidth(const CTexFont *_Font);
     int                     ComputeValuesWidth(const CTexFont *_Font);
     void                    DrawHierHandle();
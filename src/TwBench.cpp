@@ -0,0 +1,856 @@
+//  ---------------------------------------------------------------------------
+//
+//  @file       TwBench.cpp
+//  @brief      Micro-benchmarks of the core UI paths (no GPU required)
+//  @author     Philippe Decaudin
+//  @license    This file is part of the AntTweakBar library.
+//              For conditions of distribution and use, see License.txt
+//
+//  note:       Built by "make bench". The library objects are linked
+//              statically and drawn through a null graph, so only the
+//              CPU side of bars management, update and layout is measured.
+//              Each line reports the time and the number of heap
+//              allocations per operation (through operator new and through
+//              the library allocator).
+//
+//  ---------------------------------------------------------------------------
+
+
+#include "TwPrecomp.h"
+#include "TwMgr.h"
+#include "TwBar.h"
+
+using namespace std;
+
+
+//  ---------------------------------------------------------------------------
+//  Allocation counters
+//  ---------------------------------------------------------------------------
+
+static long long g_NbAllocs = 0;
+
+void *operator new(size_t _Size)
+{
+    ++g_NbAllocs;
+    void *p = malloc(_Size>0 ? _Size : 1);
+    if( p==NULL )
+        throw bad_alloc();
+    return p;
+}
+
+void *operator new[](size_t _Size)
+{
+    return operator new(_Size);
+}
+
+void operator delete(void *_Ptr) throw()
+{
+    free(_Ptr);
+}
+
+void operator delete[](void *_Ptr) throw()
+{
+    free(_Ptr);
+}
+
+void operator delete(void *_Ptr, size_t) throw()
+{
+    free(_Ptr);
+}
+
+void operator delete[](void *_Ptr, size_t) throw()
+{
+    free(_Ptr);
+}
+
+static void * TW_CALL BenchAlloc(size_t _Size, void * /*_ClientData*/)
+{
+    ++g_NbAllocs;
+    return malloc(_Size);
+}
+
+static void TW_CALL BenchFree(void *_Ptr, void * /*_ClientData*/)
+{
+    free(_Ptr);
+}
+
+
+//  ---------------------------------------------------------------------------
+//  Null graph: draws nothing but lays out text like the real back-ends do
+//  ---------------------------------------------------------------------------
+
+class CTwGraphNull : public ITwGraph
+{
+public:
+    virtual int         Init() { return 1; }
+    virtual int         Shut() { return 1; }
+    virtual void        BeginDraw(int, int) {}
+    virtual void        EndDraw() {}
+    virtual bool        IsDrawing() { return false; }
+    virtual void        Restore() {}
+    virtual void        DrawLine(int, int, int, int, color32, color32, bool) {}
+    virtual void        DrawLine(int, int, int, int, color32, bool) {}
+    virtual void        DrawRect(int, int, int, int, color32, color32, color32, color32) {}
+    virtual void        DrawRect(int, int, int, int, color32) {}
+    virtual void        DrawTriangles(int, int *, color32 *, Cull) {}
+    virtual void *      NewTextObj() { return new CTextObj; }
+    virtual void        DeleteTextObj(void *_TextObj) { delete static_cast<CTextObj *>(_TextObj); }
+    virtual void        BuildText(void *_TextObj, const std::string *_TextLines, color32 *, color32 *, int _NbLines, const CTexFont *_Font, int _Sep, int);
+    virtual void        DrawText(void *, int, int, color32, color32) {}
+    virtual void        ChangeViewport(int, int, int, int, int, int) {}
+    virtual void        RestoreViewport() {}
+    virtual void        SetScissor(int, int, int, int) {}
+
+protected:
+    struct CTextObj
+    {
+        std::vector<int> m_Pos;     // x and y of each glyph
+    };
+};
+
+void CTwGraphNull::BuildText(void *_TextObj, const std::string *_TextLines, color32 *, color32 *, int _NbLines, const CTexFont *_Font, int _Sep, int)
+{
+    CTextObj *TextObj = static_cast<CTextObj *>(_TextObj);
+    TextObj->m_Pos.clear();
+    int y = 0;
+    for( int Line=0; Line<_NbLines; ++Line )
+    {
+        int x = 0;
+        const std::string& Text = _TextLines[Line];
+        for( size_t i=0; i<Text.length(); ++i )
+        {
+            TextObj->m_Pos.push_back(x);
+            TextObj->m_Pos.push_back(y);
+            x += _Font->m_CharWidth[(unsigned char)Text[i]];
+        }
+        y += _Font->m_CharHeight + _Sep;
+    }
+}
+
+
+//  ---------------------------------------------------------------------------
+//  Benchmark helpers
+//  ---------------------------------------------------------------------------
+
+static const int WND_WIDTH  = 1280;
+static const int WND_HEIGHT = 720;
+
+struct CBenchTimer
+{
+    PerfTimer   m_Timer;
+    long long   m_Allocs;
+                CBenchTimer() { m_Allocs = g_NbAllocs; m_Timer.Reset(); }
+    void        Report(const char *_Name, int _NbOps);
+};
+
+void CBenchTimer::Report(const char *_Name, int _NbOps)
+{
+    double t = m_Timer.GetTime();
+    long long a = g_NbAllocs - m_Allocs;
+    if( _NbOps<1 )
+        _NbOps = 1;
+    printf("%-40s %8d ops %14.1f ns/op %12.2f allocs/op\n", _Name, _NbOps, 1.0e9*t/_NbOps, (double)a/_NbOps);
+}
+
+static void RefreshAndDraw()
+{
+    for( int i=0; i<TwGetBarCount(); ++i )
+        TwRefreshBar(TwGetBarByIndex(i));
+    TwDraw();
+}
+
+static TwBar *NewBar(const char *_Name, int _Index)
+{
+    TwBar *Bar = TwNewBar(_Name);
+    int Pos[2] = { 16 + (_Index%16)*76, 16 + ((_Index/16)%8)*84 };
+    int Size[2] = { 200, 160 };
+    TwSetParam(Bar, NULL, "position", TW_PARAM_INT32, 2, Pos);
+    TwSetParam(Bar, NULL, "size", TW_PARAM_INT32, 2, Size);
+    return Bar;
+}
+
+
+//  ---------------------------------------------------------------------------
+//  Scenarios
+//  ---------------------------------------------------------------------------
+
+static float g_Floats[10000];
+static int g_Ints[10000];
+
+static void BenchBars(int _NbBars)
+{
+    char Name[64], Title[64];
+    {
+        CBenchTimer b;
+        for( int i=0; i<_NbBars; ++i )
+        {
+            sprintf(Name, "Bar%d", i);
+            TwBar *Bar = NewBar(Name, i);
+            for( int j=0; j<10; ++j )
+            {
+                sprintf(Name, "v%d", j);
+                TwAddVarRW(Bar, Name, (j&1) ? TW_TYPE_INT32 : TW_TYPE_FLOAT, (j&1) ? (void *)&g_Ints[j] : (void *)&g_Floats[j], NULL);
+            }
+        }
+        sprintf(Title, "bars %d: create (10 vars)", _NbBars);
+        b.Report(Title, _NbBars);
+    }
+    TwDraw();
+    {
+        const int NbFrames = (_NbBars>=1000) ? 10 : 100;
+        CBenchTimer b;
+        for( int f=0; f<NbFrames; ++f )
+            RefreshAndDraw();
+        sprintf(Title, "bars %d: refresh+draw", _NbBars);
+        b.Report(Title, NbFrames);
+    }
+    {
+        const int NbFrames = 1000;
+        CBenchTimer b;
+        for( int f=0; f<NbFrames; ++f )
+            TwDraw();
+        sprintf(Title, "bars %d: draw", _NbBars);
+        b.Report(Title, NbFrames);
+    }
+    {
+        CBenchTimer b;
+        TwDeleteAllBars();
+        sprintf(Title, "bars %d: delete", _NbBars);
+        b.Report(Title, _NbBars);
+    }
+}
+
+static void BenchManyVars()
+{
+    const int NbVars = 10000;
+    char Name[64], Def[256];
+    TwBar *Bar = NewBar("Vars", 0);
+    {
+        CBenchTimer b;
+        for( int i=0; i<NbVars; ++i )
+        {
+            sprintf(Name, "v%d", i);
+            TwAddVarRW(Bar, Name, TW_TYPE_FLOAT, &g_Floats[i], NULL);
+        }
+        b.Report("vars 10k: add", NbVars);
+    }
+    {
+        const int NbFrames = 20;
+        CBenchTimer b;
+        for( int f=0; f<NbFrames; ++f )
+            RefreshAndDraw();
+        b.Report("vars 10k: refresh+draw", NbFrames);
+    }
+    {
+        const int NbOps = 1000;
+        CBenchTimer b;
+        for( int i=0; i<NbOps; ++i )
+        {
+            sprintf(Def, " Vars/v%d label='Var %d' min=0 max=100 step=0.5 help='A float' ", (i*7919)%NbVars, i);
+            TwDefine(Def);
+        }
+        b.Report("vars 10k: TwDefine var attributes", NbOps);
+    }
+    {
+        const int NbOps = 1000;
+        CBenchTimer b;
+        for( int i=0; i<NbOps; ++i )
+        {
+            sprintf(Name, "v%d", (i*7919)%NbVars);
+            TwRemoveVar(Bar, Name);
+        }
+        b.Report("vars 10k: remove", NbOps);
+    }
+    TwDeleteAllBars();
+}
+
+static void BenchArrays()
+{
+    const int NbElems = 4096;
+    char Name[64];
+    for( int v=0; v<2; ++v )
+    {
+        TwBar *Bar = NewBar("Samples", 0);
+        {
+            CBenchTimer b;
+            if( v==0 )
+                for( int i=0; i<NbElems; ++i )
+                {
+                    sprintf(Name, "s%d", i);
+                    TwAddVarRW(Bar, Name, TW_TYPE_FLOAT, &g_Floats[i], NULL);
+                }
+            else
+                TwAddVarArrayRW(Bar, "s", TW_TYPE_FLOAT, g_Floats, NbElems, 0, "opened=true");
+            b.Report(v==0 ? "array 4k floats: add as vars" : "array 4k floats: add as paged array", 1);
+        }
+        RefreshAndDraw();
+        const int NbFrames = 100;
+        CBenchTimer b;
+        for( int f=0; f<NbFrames; ++f )
+        {
+            if( v==1 )
+            {
+                int Page = 1 + f%(NbElems/16);
+                TwSetParam(Bar, "s.page", "value", TW_PARAM_INT32, 1, &Page);
+            }
+            RefreshAndDraw();
+        }
+        b.Report(v==0 ? "array 4k floats: refresh+draw as vars" : "array 4k floats: refresh+draw paging", NbFrames);
+        TwDeleteAllBars();
+    }
+}
+
+static void BenchPlots()
+{
+    static float s_Value = 0;
+    const unsigned int HistorySizes[3] = { 1000, 100000, 1000000 };
+    for( int v=0; v<3; ++v )
+    {
+        TwBar *Bar = NewBar("Graphs", 0);
+        TwAddVarPlot(Bar, "Frame", TW_TYPE_FLOAT, &s_Value, HistorySizes[v], "rows=4");
+        CTwMgr::CPlotProxy& Plot = g_TwMgr->m_PlotProxies.back();
+        for( unsigned int i=0; i<HistorySizes[v]; ++i )
+            Plot.Push((float)(i%97));
+        RefreshAndDraw();
+        const int NbFrames = 200;
+        CBenchTimer b;
+        for( int f=0; f<NbFrames; ++f )
+        {
+            s_Value = (float)(f%13);
+            TwDraw();
+        }
+        b.Report(v==0 ? "plot 1k samples: sample+draw" : (v==1 ? "plot 100k samples: sample+draw" : "plot 1M samples: sample+draw"), NbFrames);
+        TwDeleteAllBars();
+    }
+}
+
+static void BenchDeepGroups()
+{
+    const int Depth = 32;
+    const int NbVarsPerGroup = 8;
+    char Name[64], Def[128];
+    TwBar *Bar = NewBar("Deep", 0);
+    {
+        CBenchTimer b;
+        for( int g=0; g<Depth; ++g )
+        {
+            sprintf(Def, " group=g%d ", g);
+            for( int i=0; i<NbVarsPerGroup; ++i )
+            {
+                sprintf(Name, "v%d_%d", g, i);
+                TwAddVarRW(Bar, Name, TW_TYPE_INT32, &g_Ints[g*NbVarsPerGroup+i], Def);
+            }
+            if( g>0 )
+            {
+                sprintf(Def, " Deep/g%d group=g%d ", g, g-1);
+                TwDefine(Def);
+            }
+        }
+        b.Report("groups depth 32: build", Depth*NbVarsPerGroup);
+    }
+    {
+        const int NbFrames = 200;
+        CBenchTimer b;
+        for( int f=0; f<NbFrames; ++f )
+            RefreshAndDraw();
+        b.Report("groups depth 32: refresh+draw", NbFrames);
+    }
+    {
+        const int NbOps = 200;
+        CBenchTimer b;
+        for( int i=0; i<NbOps; ++i )
+        {
+            sprintf(Def, " Deep/g%d opened=%s ", i%Depth, ((i/Depth)&1) ? "true" : "false");
+            TwDefine(Def);
+        }
+        b.Report("groups depth 32: open/close", NbOps);
+    }
+    TwDeleteAllBars();
+}
+
+struct CBenchStruct
+{
+    float   m_Pos[3];
+    float   m_Dir[3];
+    int     m_Count;
+    float   m_Weight;
+};
+
+static void BenchStructs()
+{
+    const int NbVars = 1000;
+    static CBenchStruct s_Structs[NbVars];
+    TwStructMember Members[] = 
+    {
+        { "px", TW_TYPE_FLOAT, offsetof(CBenchStruct, m_Pos[0]), "" },
+        { "py", TW_TYPE_FLOAT, offsetof(CBenchStruct, m_Pos[1]), "" },
+        { "pz", TW_TYPE_FLOAT, offsetof(CBenchStruct, m_Pos[2]), "" },
+        { "dx", TW_TYPE_FLOAT, offsetof(CBenchStruct, m_Dir[0]), "" },
+        { "dy", TW_TYPE_FLOAT, offsetof(CBenchStruct, m_Dir[1]), "" },
+        { "dz", TW_TYPE_FLOAT, offsetof(CBenchStruct, m_Dir[2]), "" },
+        { "count", TW_TYPE_INT32, offsetof(CBenchStruct, m_Count), "min=0" },
+        { "weight", TW_TYPE_FLOAT, offsetof(CBenchStruct, m_Weight), "step=0.01" }
+    };
+    static TwType s_StructType = TW_TYPE_UNDEF;
+    if( s_StructType==TW_TYPE_UNDEF )
+        s_StructType = TwDefineStruct("BenchStruct", Members, sizeof(Members)/sizeof(Members[0]), sizeof(CBenchStruct), NULL, NULL);
+    char Name[64];
+    TwBar *Bar = NewBar("Structs", 0);
+    {
+        CBenchTimer b;
+        for( int i=0; i<NbVars; ++i )
+        {
+            sprintf(Name, "s%d", i);
+            TwAddVarRW(Bar, Name, s_StructType, &s_Structs[i], NULL);
+        }
+        b.Report("structs 1000x8: add", NbVars);
+    }
+    const int NbFrames = 20;
+    {
+        CBenchTimer b;
+        for( int f=0; f<NbFrames; ++f )
+            RefreshAndDraw();
+        b.Report("structs 1000x8: refresh+draw closed", NbFrames);
+    }
+    {
+        CBenchTimer b;
+        for( int i=0; i<NbVars; ++i )
+        {
+            sprintf(Name, "Structs/s%d opened=true", i);
+            TwDefine(Name);
+        }
+        RefreshAndDraw();
+        b.Report("structs 1000x8: open", NbVars);
+    }
+    {
+        CBenchTimer b;
+        for( int f=0; f<NbFrames; ++f )
+            RefreshAndDraw();
+        b.Report("structs 1000x8: refresh+draw opened", NbFrames);
+    }
+    TwDeleteAllBars();
+}
+
+static void BenchSetParam()
+{
+    TwBar *Bar = NewBar("Params", 0);
+    TwAddVarRW(Bar, "v", TW_TYPE_FLOAT, &g_Floats[0], NULL);
+    const int NbOps = 100000;
+    {
+        CBenchTimer b;
+        for( int i=0; i<NbOps; ++i )
+        {
+            int Pos[2] = { i%200, i%100 };
+            TwSetParam(Bar, NULL, "position", TW_PARAM_INT32, 2, Pos);
+        }
+        b.Report("TwSetParam bar position", NbOps);
+    }
+    {
+        CBenchTimer b;
+        for( int i=0; i<NbOps; ++i )
+            TwSetParam(Bar, "v", "label", TW_PARAM_CSTRING, 1, (i&1) ? "Value" : "Other value");
+        b.Report("TwSetParam var label", NbOps);
+    }
+    {
+        double Step = 0;
+        CBenchTimer b;
+        for( int i=0; i<NbOps; ++i )
+            TwGetParam(Bar, "v", "step", TW_PARAM_DOUBLE, 1, &Step);
+        b.Report("TwGetParam var step", NbOps);
+    }
+    {
+        CBenchTimer b;
+        for( int i=0; i<NbOps; ++i )
+            TwDefine((i&1) ? " Params color='255 0 0' alpha=200 " : " Params color='0 0 255' alpha=100 ");
+        b.Report("TwDefine bar color", NbOps);
+    }
+    TwDeleteAllBars();
+}
+
+static void BenchLongText()
+{
+    const int NbVars = 200;
+    const int Len = 1024;
+    static char s_Strings[NbVars][Len];
+    char Name[64];
+    TwBar *Bar = NewBar("Text", 0);
+    int Size[2] = { 600, 700 };
+    TwSetParam(Bar, NULL, "size", TW_PARAM_INT32, 2, Size);
+    TwSetParam(Bar, NULL, "valueswidth", TW_PARAM_CSTRING, 1, "fit");
+    for( int i=0; i<NbVars; ++i )
+    {
+        for( int j=0; j<Len-1; ++j )
+            s_Strings[i][j] = (char)('a' + (i+j)%26);
+        s_Strings[i][Len-1] = '\0';
+        sprintf(Name, "s%d", i);
+        TwAddVarRW(Bar, Name, TW_TYPE_CSSTRING(Len), s_Strings[i], NULL);
+    }
+    {
+        const int NbFrames = 100;
+        CBenchTimer b;
+        for( int f=0; f<NbFrames; ++f )
+            RefreshAndDraw();
+        b.Report("text 200x1k chars: refresh+draw", NbFrames);
+    }
+    TwDeleteAllBars();
+}
+
+// Status strings of 120 chars, unchanged between frames: std::string vars
+// are converted at each refresh, string views are read only if their generation changes
+static void BenchStringViews()
+{
+    const int NbVars = 200;
+    static std::string s_Strings[NbVars];
+    static TwStringView s_Views[NbVars];
+    char Name[64];
+    for( int i=0; i<NbVars; ++i )
+    {
+        s_Strings[i].assign(120, (char)('a' + i%26));
+        s_Views[i].Str = s_Strings[i].c_str();
+        s_Views[i].Length = s_Strings[i].length();
+        s_Views[i].Generation = 1;
+    }
+    for( int v=0; v<2; ++v )
+    {
+        TwBar *Bar = NewBar("Status", 0);
+        int Size[2] = { 600, 700 };
+        TwSetParam(Bar, NULL, "size", TW_PARAM_INT32, 2, Size);
+        for( int i=0; i<NbVars; ++i )
+        {
+            sprintf(Name, "s%d", i);
+            if( v==0 )
+                TwAddVarRO(Bar, Name, TW_TYPE_STDSTRING, &s_Strings[i], NULL);
+            else
+                TwAddVarRO(Bar, Name, TW_TYPE_STRINGVIEW, &s_Views[i], NULL);
+        }
+        RefreshAndDraw();
+        const int NbFrames = 100;
+        CBenchTimer b;
+        for( int f=0; f<NbFrames; ++f )
+            RefreshAndDraw();
+        b.Report(v==0 ? "status 200 strings: std::string" : "status 200 strings: string view", NbFrames);
+        TwDeleteAllBars();
+    }
+}
+
+static void BenchHover()
+{
+    char Name[64];
+    for( int i=0; i<100; ++i )
+    {
+        sprintf(Name, "Hover%d", i);
+        TwBar *Bar = NewBar(Name, i);
+        for( int j=0; j<10; ++j )
+        {
+            sprintf(Name, "v%d", j);
+            TwAddVarRW(Bar, Name, TW_TYPE_FLOAT, &g_Floats[j], NULL);
+        }
+    }
+    TwDraw();
+    int n = 0;
+    CBenchTimer b;
+    for( int Pass=0; Pass<4; ++Pass )
+        for( int y=0; y<WND_HEIGHT; y+=8 )
+            for( int x=0; x<WND_WIDTH; x+=8, ++n )
+                TwMouseMotion(((y/8)&1) ? WND_WIDTH-1-x : x, y);
+    b.Report("hover sweep 100 bars: mouse motion", n);
+    TwDeleteAllBars();
+}
+
+
+static void BenchEnumPopup()
+{
+    const int NbEntries = 20000;
+    vector<TwEnumVal> Vals(NbEntries);
+    vector<string> Labels(NbEntries);
+    char Name[64];
+    for( int i=0; i<NbEntries; ++i )
+    {
+        sprintf(Name, "Entry %05d", (i*7919)%NbEntries);
+        Labels[i] = Name;
+        Vals[i].Value = (i*7919)%NbEntries;
+        Vals[i].Label = Labels[i].c_str();
+    }
+    TwType EnumType = TW_TYPE_UNDEF;
+    {
+        CBenchTimer b;
+        for( int i=0; i<10; ++i )
+            EnumType = TwDefineEnum("BigEnum", &Vals[0], NbEntries);
+        b.Report("enum 20k entries: define", 10);
+    }
+    TwBar *Bar = NewBar("Popup", 0);
+    static int s_Value = NbEntries/2;
+    TwAddVarRW(Bar, "e", EnumType, &s_Value, NULL);
+    TwDraw();
+
+    // find the value field of the var by clicking down the values column
+    int x = 16+200-40, y = 16;
+    while( g_TwMgr->m_PopupBar==NULL && y<16+160 )
+    {
+        y += 2;
+        TwMouseMotion(x, y);
+        TwMouseButton(TW_MOUSE_PRESSED, TW_MOUSE_LEFT);
+        TwMouseButton(TW_MOUSE_RELEASED, TW_MOUSE_LEFT);
+    }
+    if( g_TwMgr->m_PopupBar==NULL )
+    {
+        printf("enum 20k entries: popup not found\n");
+        TwDeleteAllBars();
+        return;
+    }
+    TwDraw();
+    int NbOps = 100;
+    {
+        CBenchTimer b;
+        for( int i=0; i<NbOps; ++i )
+        {
+            TwMouseMotion(x, y);
+            TwMouseButton(TW_MOUSE_PRESSED, TW_MOUSE_LEFT); // closes the popup
+            TwMouseButton(TW_MOUSE_RELEASED, TW_MOUSE_LEFT);
+            TwMouseButton(TW_MOUSE_PRESSED, TW_MOUSE_LEFT); // reopens it
+            TwMouseButton(TW_MOUSE_RELEASED, TW_MOUSE_LEFT);
+            TwDraw();
+        }
+        b.Report("enum 20k entries: open popup+draw", NbOps);
+    }
+    TwMouseMotion(x, y+40); // over the popup
+    {
+        CBenchTimer b;
+        for( int i=0; i<NbOps; ++i )
+        {
+            TwMouseWheel(-10*(i+1));
+            TwDraw();
+        }
+        b.Report("enum 20k entries: scroll popup+draw", NbOps);
+    }
+    {
+        CBenchTimer b;
+        const char *Keys = "0123456789";
+        for( int i=0; i<NbOps; ++i )
+        {
+            TwKeyPressed(Keys[i%10], TW_KMOD_NONE);
+            if( i%3==2 )
+                for( int k=0; k<3; ++k )
+                    TwKeyPressed(TW_KEY_BACKSPACE, TW_KMOD_NONE);
+            TwDraw();
+        }
+        b.Report("enum 20k entries: type-ahead+draw", NbOps);
+    }
+    TwDeleteAllBars();
+}
+
+
+static vector<string> g_EnumLabels;
+static unsigned int g_EnumGeneration = 0;
+
+static unsigned int TW_CALL GetEnumCount(void * /*_ClientData*/)
+{
+    return (unsigned int)g_EnumLabels.size();
+}
+
+static void TW_CALL GetEnumVal(unsigned int _Index, TwEnumVal *_Val, void * /*_ClientData*/)
+{
+    _Val->Value = (int)_Index;
+    _Val->Label = g_EnumLabels[_Index].c_str();
+}
+
+static void BenchDynamicEnum()
+{
+    const int NbEntries = 1000;
+    const int NbOps = 100;
+    char Name[64];
+    vector<TwEnumVal> Vals(NbEntries);
+    g_EnumLabels.resize(NbEntries);
+    for( int i=0; i<NbEntries; ++i )
+    {
+        sprintf(Name, "Mesh %d", i);
+        g_EnumLabels[i] = Name;
+        Vals[i].Value = i;
+        Vals[i].Label = g_EnumLabels[i].c_str();
+    }
+    static int s_Values[2] = { 0, 0 };
+    TwBar *Bar = NewBar("Enums", 0);
+    TwAddVarRW(Bar, "static", TwDefineEnum("StaticList", &Vals[0], NbEntries), &s_Values[0], NULL);
+    TwAddVarRW(Bar, "dynamic", TwDefineEnumCB("DynamicList", GetEnumCount, GetEnumVal, &g_EnumGeneration, NULL), &s_Values[1], NULL);
+    TwDraw();
+    {
+        CBenchTimer b;
+        for( int i=0; i<NbOps; ++i )
+        {
+            s_Values[0] = i;
+            TwDefineEnum("StaticList", &Vals[0], NbEntries);
+            RefreshAndDraw();
+        }
+        b.Report("enum 1k entries: redefine+refresh", NbOps);
+    }
+    {
+        CBenchTimer b;
+        for( int i=0; i<NbOps; ++i )
+        {
+            s_Values[1] = i;
+            RefreshAndDraw();
+        }
+        b.Report("enum 1k entries: callback+refresh", NbOps);
+    }
+    {
+        CBenchTimer b;
+        for( int i=0; i<NbOps; ++i )
+        {
+            s_Values[1] = i;
+            ++g_EnumGeneration;
+            RefreshAndDraw();
+        }
+        b.Report("enum 1k entries: new generation+refresh", NbOps);
+    }
+    TwDeleteAllBars();
+}
+
+static void BenchState()
+{
+    const int NbVars = 10000;
+    const int NbOps = 100;
+    char Name[64];
+    TwBar *Bar = NewBar("State", 0);
+    for( int i=0; i<NbVars; ++i )
+    {
+        sprintf(Name, "v%d", i);
+        TwAddVarRW(Bar, Name, TW_TYPE_FLOAT, &g_Floats[i], NULL);
+    }
+    RefreshAndDraw();
+    size_t Size = 0;
+    {
+        CBenchTimer b;
+        for( int i=0; i<NbOps; ++i )
+            TwSaveState(&Size);
+        b.Report("state 10k vars: save", NbOps);
+    }
+    const char *State = static_cast<const char *>(TwSaveState(&Size));
+    vector<char> Preset(State, State+Size);
+    {
+        CBenchTimer b;
+        for( int i=0; i<NbOps; ++i )
+            TwLoadState(&Preset[0], Preset.size());
+        b.Report("state 10k vars: load", NbOps);
+    }
+    {
+        // two presets applied in turn so that all the values differ at each apply
+        const char *Presets[2] = { "TwBench1.preset", "TwBench2.preset" };
+        TwSavePreset(Presets[0]);
+        for( int i=0; i<NbVars; ++i )
+            g_Floats[i] += 1.0f;
+        TwSavePreset(Presets[1]);
+        CBenchTimer b;
+        for( int i=0; i<NbOps; ++i )
+            TwApplyPreset(Presets[i&1]);
+        b.Report("state 10k vars: apply preset file", NbOps);
+        remove(Presets[0]);
+        remove(Presets[1]);
+    }
+    TwDeleteAllBars();
+}
+
+static float g_RebuiltValue = 0;
+static float g_RebuildSum = 0;
+
+// Set callback of an expensive client var (eg, a shader recompile)
+static void TW_CALL SetRebuiltValue(const void *_Value, void * /*_ClientData*/)
+{
+    g_RebuiltValue = *static_cast<const float *>(_Value);
+    for( int i=0; i<10000; ++i )
+        g_RebuildSum += g_Floats[i]*g_RebuiltValue;
+}
+
+static void TW_CALL GetRebuiltValue(void *_Value, void * /*_ClientData*/)
+{
+    *static_cast<float *>(_Value) = g_RebuiltValue;
+}
+
+static void BenchChanges()
+{
+    const int NbFrames = 100;
+    const int NbSetsPerFrame = 50;  // as many edits per frame as a fast roto-slider drag
+    TwBar *Bar = NewBar("Changes", 0);
+    TwAddVarCB(Bar, "direct", TW_TYPE_FLOAT, SetRebuiltValue, GetRebuiltValue, NULL, NULL);
+    TwAddVarCB(Bar, "coalesced", TW_TYPE_FLOAT, SetRebuiltValue, GetRebuiltValue, NULL, " coalesce=true ");
+    const char *VarNames[2] = { "direct", "coalesced" };
+    const char *Reports[2] = { "changes 50/frame: direct", "changes 50/frame: coalesced" };
+    for( int v=0; v<2; ++v )
+    {
+        CBenchTimer b;
+        for( int f=0; f<NbFrames; ++f )
+        {
+            for( int i=0; i<NbSetsPerFrame; ++i )
+            {
+                float Val = (float)(f*NbSetsPerFrame + i);
+                TwSetParam(Bar, VarNames[v], "value", TW_PARAM_FLOAT, 1, &Val);
+            }
+            TwDraw();
+        }
+        b.Report(Reports[v], NbFrames);
+    }
+    TwDeleteAllBars();
+}
+
+// A drag of 100 frames with one edit per frame, committed with each commit mode
+static void BenchCommit()
+{
+    const int NbFrames = 100;
+    TwBar *Bar = NewBar("Commit", 0);
+    const char *Modes[4] = { "immediate", "ondraw", "onrelease", "throttle:50ms" };
+    const char *Reports[4] = { "drag 100 frames: commit=immediate", "drag 100 frames: commit=ondraw", "drag 100 frames: commit=onrelease", "drag 100 frames: commit=throttle" };
+    for( int m=0; m<4; ++m )
+    {
+        char Def[64];
+        sprintf(Def, " commit=%s ", Modes[m]);
+        TwAddVarCB(Bar, Modes[m], TW_TYPE_FLOAT, SetRebuiltValue, GetRebuiltValue, NULL, Def);
+        CBenchTimer b;
+        TwMouseButton(TW_MOUSE_PRESSED, TW_MOUSE_LEFT);
+        for( int f=0; f<NbFrames; ++f )
+        {
+            float Val = (float)f;
+            TwSetParam(Bar, Modes[m], "value", TW_PARAM_FLOAT, 1, &Val);
+            TwDraw();
+        }
+        TwMouseButton(TW_MOUSE_RELEASED, TW_MOUSE_LEFT);
+        b.Report(Reports[m], NbFrames);
+    }
+    TwDeleteAllBars();
+}
+
+
+//  ---------------------------------------------------------------------------
+
+int main()
+{
+    TwSetAllocator(BenchAlloc, BenchFree, NULL);
+    g_TwCustomGraph = new CTwGraphNull;
+    if( !TwInit(TW_OPENGL, NULL) )
+    {
+        fprintf(stderr, "TwInit failed: %s\n", TwGetLastError());
+        return 1;
+    }
+    TwWindowSize(WND_WIDTH, WND_HEIGHT);
+
+    BenchBars(10);
+    BenchBars(100);
+    BenchBars(1000);
+    BenchManyVars();
+    BenchArrays();
+    BenchPlots();
+    BenchDeepGroups();
+    BenchStructs();
+    BenchSetParam();
+    BenchLongText();
+    BenchStringViews();
+    BenchHover();
+    BenchEnumPopup();
+    BenchDynamicEnum();
+    BenchState();
+    BenchChanges();
+    BenchCommit();
+
+    TwTerminate();
+    if( g_TwAllocLiveBytes!=0 )
+        printf("%d bytes still allocated after TwTerminate\n", (int)g_TwAllocLiveBytes);
+    return 0;
+}
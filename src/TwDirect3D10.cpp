@@ -251,6 +251,7 @@ int CTwGraphDirect3D10::Init()
     m_OffsetX = m_OffsetY = 0;
     m_ViewportInit = new D3D10_VIEWPORT;
     m_FontTex = NULL;
+    m_FontTexVersion = 0;
     m_FontD3DTexRV = NULL;
     m_WndWidth = 0;
     m_WndHeight = 0;
@@ -661,6 +662,7 @@ void CTwGraphDirect3D10::Restore()
     m_FontD3DTexRV = NULL;
     
     m_FontTex = NULL;
+    m_FontTexVersion = 0;
 }
 
 
@@ -737,6 +739,7 @@ void CTwGraphDirect3D10::DrawLine(int _X0, int _Y0, int _X1, int _Y1, color32 _C
         {
             m_LineRectTech->GetPassByIndex(p)->Apply(0);
             m_D3DDev->Draw(2, 0);
+            m_NbDrawCalls++;
         }
 
         if( _AntiAliased )
@@ -815,6 +818,7 @@ void CTwGraphDirect3D10::DrawRect(int _X0, int _Y0, int _X1, int _Y1, color32 _C
         {
             m_LineRectTech->GetPassByIndex(p)->Apply(0);
             m_D3DDev->Draw(4, 0);
+            m_NbDrawCalls++;
         }
     }
 }
@@ -850,13 +854,6 @@ void CTwGraphDirect3D10::BuildText(void *_TextObj, const std::string *_TextLines
     assert(_TextObj!=NULL);
     assert(_Font!=NULL);
 
-    if( _Font != m_FontTex )
-    {
-        UnbindFont(m_D3DDev, m_FontD3DResVar, m_FontD3DTexRV);
-        m_FontD3DTexRV = BindFont(m_D3DDev, m_FontD3DResVar, _Font);
-        m_FontTex = _Font;
-    }
-
     int nbTextVerts = 0;
     int line;
     for( line=0; line<_NbLines; ++line )
@@ -923,7 +920,7 @@ void CTwGraphDirect3D10::BuildText(void *_TextObj, const std::string *_TextLines
 
     int x, x1, y, y1, i, len;
     float px, px1, py, py1;
-    unsigned char ch;
+    int ch;
     const unsigned char *text;
     color32 lineColor = COLOR32_RED;
     CTextVtx vtx;
@@ -943,9 +940,9 @@ void CTwGraphDirect3D10::BuildText(void *_TextObj, const std::string *_TextLines
             lineColor = ToR8G8B8A8(_LineColors[line]);
 
         if( textVerts!=NULL )
-            for( i=0; i<len; ++i )
+            for( i=0; i<len; )
             {
-                ch = text[i];
+                ch = _Font->NextGlyph(text, len, &i);
                 x1 = x + _Font->m_CharWidth[ch];
 
                 px  = ToNormScreenX(x,  m_WndWidth);
@@ -1031,15 +1028,25 @@ void CTwGraphDirect3D10::BuildText(void *_TextObj, const std::string *_TextLines
             bgVerts[bgVtxIndex++] = bgVtx;
         }
     }
-    assert( textVtxIndex==nbTextVerts );
+    assert( textVtxIndex<=nbTextVerts ); // UTF-8 sequences may use several bytes per glyph
     assert( bgVtxIndex==nbBgVerts );
-    textObj->m_NbTextVerts = nbTextVerts;
+    textObj->m_NbTextVerts = textVtxIndex;
     textObj->m_NbBgVerts = nbBgVerts;
 
     if( textVerts!=NULL )
         textObj->m_TextVertexBuffer->Unmap();
     if( bgVerts!=NULL )
         textObj->m_BgVertexBuffer->Unmap();
+
+    // Upload the font texture after the glyph loop: NextGlyph may have cached
+    // new glyphs and bumped m_TexVersion while the text was built
+    if( _Font != m_FontTex || _Font->m_TexVersion != m_FontTexVersion )
+    {
+        UnbindFont(m_D3DDev, m_FontD3DResVar, m_FontD3DTexRV);
+        m_FontD3DTexRV = BindFont(m_D3DDev, m_FontD3DResVar, _Font);
+        m_FontTex = _Font;
+        m_FontTexVersion = _Font->m_TexVersion;
+    }
 }
 
 //  ---------------------------------------------------------------------------
@@ -1089,6 +1096,7 @@ void CTwGraphDirect3D10::DrawText(void *_TextObj, int _X, int _Y, color32 _Color
         {
             tech->GetPassByIndex(p)->Apply(0);
             m_D3DDev->Draw(textObj->m_NbBgVerts, 0);
+            m_NbDrawCalls++;
         }
     }
 
@@ -1123,6 +1131,7 @@ void CTwGraphDirect3D10::DrawText(void *_TextObj, int _X, int _Y, color32 _Color
         {
             tech->GetPassByIndex(p)->Apply(0);
             m_D3DDev->Draw(textObj->m_NbTextVerts, 0);
+            m_NbDrawCalls++;
         }
     }
 }
@@ -1277,6 +1286,7 @@ void CTwGraphDirect3D10::DrawTriangles(int _NumTriangles, int *_Vertices, color3
         {
             m_LineRectTech->GetPassByIndex(p)->Apply(0);
             m_D3DDev->Draw(3*_NumTriangles, 0);
+            m_NbDrawCalls++;
         }
 
         if( _CullMode==CULL_CW || _CullMode==CULL_CCW )
@@ -47,6 +47,7 @@ protected:
     unsigned int                m_D3DDevInitialRefCount;
     bool                        m_Drawing;
     const CTexFont *            m_FontTex;
+    int                         m_FontTexVersion;
     struct ID3D10ShaderResourceView *m_FontD3DTexRV;
     int                         m_WndWidth;
     int                         m_WndHeight;
@@ -67,7 +68,7 @@ protected:
         float                   m_UV[2];
     };
 
-    struct CTextObj
+    struct CTextObj : CTwAllocated
     {
         struct ID3D10Buffer *   m_TextVertexBuffer;
         struct ID3D10Buffer *   m_BgVertexBuffer;
@@ -517,6 +517,7 @@ int CTwGraphDirect3D11::Init()
     m_OffsetX = m_OffsetY = 0;
     m_ViewportInit = new D3D11_VIEWPORT;
     m_FontTex = NULL;
+    m_FontTexVersion = 0;
     m_FontD3DTex = NULL;
     m_FontD3DTexRV = NULL;
     m_WndWidth = 0;
@@ -991,6 +992,7 @@ void CTwGraphDirect3D11::Restore()
     m_FontD3DTex = NULL;
     
     m_FontTex = NULL;
+    m_FontTexVersion = 0;
 }
 
 //  ---------------------------------------------------------------------------
@@ -1074,6 +1076,7 @@ void CTwGraphDirect3D11::DrawLine(int _X0, int _Y0, int _X1, int _Y1, color32 _C
         m_D3DDevImmContext->VSSetShader(m_LineRectVS, NULL, 0);
         m_D3DDevImmContext->PSSetShader(m_LineRectPS, NULL, 0);
         m_D3DDevImmContext->Draw(2, 0);
+        m_NbDrawCalls++;
 
         if( _AntiAliased )
             m_D3DDevImmContext->RSSetState(m_RasterState); // restore default raster state
@@ -1159,6 +1162,7 @@ void CTwGraphDirect3D11::DrawRect(int _X0, int _Y0, int _X1, int _Y1, color32 _C
         m_D3DDevImmContext->VSSetShader(m_LineRectVS, NULL, 0);
         m_D3DDevImmContext->PSSetShader(m_LineRectPS, NULL, 0);
         m_D3DDevImmContext->Draw(4, 0);
+        m_NbDrawCalls++;
     }
 }
 
@@ -1193,13 +1197,6 @@ void CTwGraphDirect3D11::BuildText(void *_TextObj, const std::string *_TextLines
     assert(_TextObj!=NULL);
     assert(_Font!=NULL);
 
-    if( _Font != m_FontTex )
-    {
-        UnbindFont(m_D3DDev, m_FontD3DTex, m_FontD3DTexRV);
-        BindFont(m_D3DDev, _Font, &m_FontD3DTex, &m_FontD3DTexRV);
-        m_FontTex = _Font;
-    }
-
     int nbTextVerts = 0;
     int line;
     for( line=0; line<_NbLines; ++line )
@@ -1276,7 +1273,7 @@ void CTwGraphDirect3D11::BuildText(void *_TextObj, const std::string *_TextLines
 
     int x, x1, y, y1, i, len;
     float px, px1, py, py1;
-    unsigned char ch;
+    int ch;
     const unsigned char *text;
     color32 lineColor = COLOR32_RED;
     CTextVtx vtx;
@@ -1296,9 +1293,9 @@ void CTwGraphDirect3D11::BuildText(void *_TextObj, const std::string *_TextLines
             lineColor = ToR8G8B8A8(_LineColors[line]);
 
         if( textVerts!=NULL )
-            for( i=0; i<len; ++i )
+            for( i=0; i<len; )
             {
-                ch = text[i];
+                ch = _Font->NextGlyph(text, len, &i);
                 x1 = x + _Font->m_CharWidth[ch];
 
                 px  = ToNormScreenX(x,  m_WndWidth);
@@ -1384,15 +1381,25 @@ void CTwGraphDirect3D11::BuildText(void *_TextObj, const std::string *_TextLines
             bgVerts[bgVtxIndex++] = bgVtx;
         }
     }
-    assert( textVtxIndex==nbTextVerts );
+    assert( textVtxIndex<=nbTextVerts ); // UTF-8 sequences may use several bytes per glyph
     assert( bgVtxIndex==nbBgVerts );
-    textObj->m_NbTextVerts = nbTextVerts;
+    textObj->m_NbTextVerts = textVtxIndex;
     textObj->m_NbBgVerts = nbBgVerts;
 
     if( textVerts!=NULL )
         m_D3DDevImmContext->Unmap(textObj->m_TextVertexBuffer, 0);
     if( bgVerts!=NULL )
         m_D3DDevImmContext->Unmap(textObj->m_BgVertexBuffer, 0);
+
+    // Upload the font texture after the glyph loop: NextGlyph may have cached
+    // new glyphs and bumped m_TexVersion while the text was built
+    if( _Font != m_FontTex || _Font->m_TexVersion != m_FontTexVersion )
+    {
+        UnbindFont(m_D3DDev, m_FontD3DTex, m_FontD3DTexRV);
+        BindFont(m_D3DDev, _Font, &m_FontD3DTex, &m_FontD3DTexRV);
+        m_FontTex = _Font;
+        m_FontTexVersion = _Font->m_TexVersion;
+    }
 }
 
 //  ---------------------------------------------------------------------------
@@ -1442,6 +1449,7 @@ void CTwGraphDirect3D11::DrawText(void *_TextObj, int _X, int _Y, color32 _Color
         m_D3DDevImmContext->PSSetSamplers(0, 1, &m_SamplerState);
         m_D3DDevImmContext->PSSetShader(m_LineRectPS, NULL, 0);
         m_D3DDevImmContext->Draw(textObj->m_NbBgVerts, 0);
+        m_NbDrawCalls++;
     }
 
     // Draw text
@@ -1482,6 +1490,7 @@ void CTwGraphDirect3D11::DrawText(void *_TextObj, int _X, int _Y, color32 _Color
         m_D3DDevImmContext->PSSetSamplers(0, 1, &m_SamplerState);
         m_D3DDevImmContext->PSSetShader(m_TextPS, NULL, 0);
         m_D3DDevImmContext->Draw(textObj->m_NbTextVerts, 0);
+        m_NbDrawCalls++;
     }
 }
 
@@ -1645,6 +1654,7 @@ void CTwGraphDirect3D11::DrawTriangles(int _NumTriangles, int *_Vertices, color3
         m_D3DDevImmContext->VSSetShader(m_LineRectVS, NULL, 0);
         m_D3DDevImmContext->PSSetShader(m_LineRectPS, NULL, 0);
         m_D3DDevImmContext->Draw(3*_NumTriangles, 0);
+        m_NbDrawCalls++;
 
         m_D3DDevImmContext->RSSetState(m_RasterState); // restore default raster state
     }
@@ -48,6 +48,7 @@ protected:
     unsigned int                m_D3DDevInitialRefCount;
     bool                        m_Drawing;
     const CTexFont *            m_FontTex;
+    int                         m_FontTexVersion;
     struct ID3D11Texture2D *    m_FontD3DTex;
     struct ID3D11ShaderResourceView *m_FontD3DTexRV;
     int                         m_WndWidth;
@@ -74,7 +75,7 @@ protected:
         float                   m_CstColor[4];
     };
 
-    struct CTextObj
+    struct CTextObj : CTwAllocated
     {
         struct ID3D11Buffer *   m_TextVertexBuffer;
         struct ID3D11Buffer *   m_BgVertexBuffer;
@@ -107,6 +107,7 @@ int CTwGraphDirect3D12::Init()
 	g_TwMgr->m_GraphContext = NULL;
 
 	m_Font = NULL;
+	m_FontTexVersion = 0;
 	m_FontResource = NULL;
 
 	D3D12_DESCRIPTOR_HEAP_DESC heapDesc;
@@ -414,6 +415,7 @@ void CTwGraphDirect3D12::Restore()
 {
 	if(m_FontResource) m_FontResource->Release();
 	m_Font = NULL;
+	m_FontTexVersion = 0;
 }
 
 
@@ -703,6 +705,7 @@ void CTwGraphDirect3D12::DrawLine(int _X0, int _Y0, int _X1, int _Y1, color32 _C
 	m_D3DGraphCmdList->IASetVertexBuffers(0, 1, &vbView);
 	m_D3DGraphCmdList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_LINELIST);
 	m_D3DGraphCmdList->DrawInstanced(2, 1, 0, 0);
+	m_NbDrawCalls++;
 }
 
 void CTwGraphDirect3D12::DrawRect(int _X0, int _Y0, int _X1, int _Y1, color32 _Color00, color32 _Color10, color32 _Color01, color32 _Color11)
@@ -767,6 +770,7 @@ void CTwGraphDirect3D12::DrawRect(int _X0, int _Y0, int _X1, int _Y1, color32 _C
 	m_D3DGraphCmdList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
 
 	m_D3DGraphCmdList->DrawInstanced(4, 1, 0, 0);
+	m_NbDrawCalls++;
 }
 
 void CTwGraphDirect3D12::DrawTriangles(int _NumTriangles, int *_Vertices, color32 *_Colors, Cull _CullMode)
@@ -820,6 +824,7 @@ void CTwGraphDirect3D12::DrawTriangles(int _NumTriangles, int *_Vertices, color3
 	m_D3DGraphCmdList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 
 	m_D3DGraphCmdList->DrawInstanced(_NumTriangles*3, 1, 0, 0);
+	m_NbDrawCalls++;
 }
 
 void * CTwGraphDirect3D12::NewTextObj()
@@ -845,55 +850,6 @@ void CTwGraphDirect3D12::BuildText(void *_TextObj, const std::string *_TextLines
 
 	CTextObj *textObj = (CTextObj *)_TextObj;
 
-	if (_Font != m_Font)
-	{
-		if (m_FontResource) 
-		{ 
-			m_ResourcesToFree.push_back(m_FontResource);
-			m_FontResource = NULL;
-		}
-
-		D3D12_RESOURCE_DESC desc;
-		memset(&desc, 0, sizeof(desc));
-		desc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
-		desc.Width = _Font->m_TexWidth;
-		desc.Height = _Font->m_TexHeight;
-		desc.DepthOrArraySize = 1;
-		desc.MipLevels = 1;
-		desc.SampleDesc.Count = 1;
-		desc.Format = DXGI_FORMAT_R8_UNORM;
-		desc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
-
-		uint64_t rowBytes=0,totalBytes=0;
-		m_D3DDev->GetCopyableFootprints(&desc, 0, 1, 0, NULL, NULL, &rowBytes, &totalBytes);
-		UploadBuffer texUpload = AllocUploadBuffer(uint32_t(totalBytes),512);
-
-		uint8_t *dest = (uint8_t *)texUpload.Map();
-		for (int y = 0; y < desc.Height; y++)
-		{
-			memcpy(dest + y * rowBytes, _Font->m_TexBytes + desc.Width*y, desc.Width);
-		}
-		texUpload.Unmap();
-
-		m_Font = _Font;
-		m_FontResource = CreateGPUCopy(texUpload, &desc);
-		D3D12_SHADER_RESOURCE_VIEW_DESC textureDesc;
-		textureDesc.Format = desc.Format;
-		textureDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
-		textureDesc.Shader4ComponentMapping = D3D12_ENCODE_SHADER_4_COMPONENT_MAPPING(
-			D3D12_SHADER_COMPONENT_MAPPING_FORCE_VALUE_1, 
-			D3D12_SHADER_COMPONENT_MAPPING_FORCE_VALUE_1, 
-			D3D12_SHADER_COMPONENT_MAPPING_FORCE_VALUE_1, 
-			D3D12_SHADER_COMPONENT_MAPPING_FROM_MEMORY_COMPONENT_0);
-		textureDesc.Texture2D.MostDetailedMip = 0;
-		textureDesc.Texture2D.MipLevels = 1;
-		textureDesc.Texture2D.PlaneSlice = 0;
-		textureDesc.Texture2D.ResourceMinLODClamp = 0;
-
-		m_D3DDev->CreateShaderResourceView(m_FontResource, &textureDesc, m_srvDescriptorHeap->GetCPUDescriptorHandleForHeapStart());
-		SET_DX_NAME(m_FontResource);
-	}
-
 	if (textObj->m_BgVertexBuffer) { m_ResourcesToFree.push_back(textObj->m_BgVertexBuffer); textObj->m_BgVertexBuffer = NULL; }
 	if (textObj->m_TextVertexBuffer) { m_ResourcesToFree.push_back(textObj->m_TextVertexBuffer); textObj->m_TextVertexBuffer = NULL; }
 	int nbTextVerts = 0;
@@ -926,7 +882,7 @@ void CTwGraphDirect3D12::BuildText(void *_TextObj, const std::string *_TextLines
 
 	int x, x1, y, y1, i, len;
 	float px, px1, py, py1;
-	unsigned char ch;
+	int ch;
 	const unsigned char *text;
 	color32 lineColor = COLOR32_RED;
 	CTextVtx vtx;
@@ -946,9 +902,9 @@ void CTwGraphDirect3D12::BuildText(void *_TextObj, const std::string *_TextLines
 			lineColor = ToR8G8B8A8(_LineColors[line]);
 
 		if (textVerts != NULL)
-			for (i = 0; i < len; ++i)
+			for (i = 0; i < len; )
 			{
-				ch = text[i];
+				ch = _Font->NextGlyph(text, len, &i);
 				x1 = x + _Font->m_CharWidth[ch];
 
 				px = ToNormScreenX(x, m_WndWidth);
@@ -1034,7 +990,7 @@ void CTwGraphDirect3D12::BuildText(void *_TextObj, const std::string *_TextLines
 			bgVerts[bgVtxIndex++] = bgVtx;
 		}
 	}
-	assert(textVtxIndex == nbTextVerts);
+	assert(textVtxIndex <= nbTextVerts); // UTF-8 sequences may use several bytes per glyph
 	assert(bgVtxIndex == nbBgVerts);
 
 	textObj->m_NbTextVerts = textVtxIndex;
@@ -1052,6 +1008,58 @@ void CTwGraphDirect3D12::BuildText(void *_TextObj, const std::string *_TextLines
 		textObj->m_BgVertexBuffer = CreateGPUCopy(bgVertsUpload);
 		SET_DX_NAME(textObj->m_BgVertexBuffer);
 	}
+
+	// Upload the font texture after the glyph loop: NextGlyph may have cached
+	// new glyphs and bumped m_TexVersion while the text was built
+	if (_Font != m_Font || _Font->m_TexVersion != m_FontTexVersion)
+	{
+		if (m_FontResource) 
+		{ 
+			m_ResourcesToFree.push_back(m_FontResource);
+			m_FontResource = NULL;
+		}
+
+		D3D12_RESOURCE_DESC desc;
+		memset(&desc, 0, sizeof(desc));
+		desc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+		desc.Width = _Font->m_TexWidth;
+		desc.Height = _Font->m_TexHeight;
+		desc.DepthOrArraySize = 1;
+		desc.MipLevels = 1;
+		desc.SampleDesc.Count = 1;
+		desc.Format = DXGI_FORMAT_R8_UNORM;
+		desc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+
+		uint64_t rowBytes=0,totalBytes=0;
+		m_D3DDev->GetCopyableFootprints(&desc, 0, 1, 0, NULL, NULL, &rowBytes, &totalBytes);
+		UploadBuffer texUpload = AllocUploadBuffer(uint32_t(totalBytes),512);
+
+		uint8_t *dest = (uint8_t *)texUpload.Map();
+		for (int y = 0; y < desc.Height; y++)
+		{
+			memcpy(dest + y * rowBytes, _Font->m_TexBytes + desc.Width*y, desc.Width);
+		}
+		texUpload.Unmap();
+
+		m_Font = _Font;
+		m_FontTexVersion = _Font->m_TexVersion;
+		m_FontResource = CreateGPUCopy(texUpload, &desc);
+		D3D12_SHADER_RESOURCE_VIEW_DESC textureDesc;
+		textureDesc.Format = desc.Format;
+		textureDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+		textureDesc.Shader4ComponentMapping = D3D12_ENCODE_SHADER_4_COMPONENT_MAPPING(
+			D3D12_SHADER_COMPONENT_MAPPING_FORCE_VALUE_1, 
+			D3D12_SHADER_COMPONENT_MAPPING_FORCE_VALUE_1, 
+			D3D12_SHADER_COMPONENT_MAPPING_FORCE_VALUE_1, 
+			D3D12_SHADER_COMPONENT_MAPPING_FROM_MEMORY_COMPONENT_0);
+		textureDesc.Texture2D.MostDetailedMip = 0;
+		textureDesc.Texture2D.MipLevels = 1;
+		textureDesc.Texture2D.PlaneSlice = 0;
+		textureDesc.Texture2D.ResourceMinLODClamp = 0;
+
+		m_D3DDev->CreateShaderResourceView(m_FontResource, &textureDesc, m_srvDescriptorHeap->GetCPUDescriptorHandleForHeapStart());
+		SET_DX_NAME(m_FontResource);
+	}
 }
 
 void CTwGraphDirect3D12::DrawText(void *_TextObj, int _X, int _Y, color32 _Color, color32 _BgColor)
@@ -1088,6 +1096,7 @@ void CTwGraphDirect3D12::DrawText(void *_TextObj, int _X, int _Y, color32 _Color
 		m_D3DGraphCmdList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 
 		m_D3DGraphCmdList->DrawInstanced(textObj->m_NbBgVerts, 1, 0, 0);
+		m_NbDrawCalls++;
 
 	}
 
@@ -1118,5 +1127,6 @@ void CTwGraphDirect3D12::DrawText(void *_TextObj, int _X, int _Y, color32 _Color
 		m_D3DGraphCmdList->SetGraphicsRootDescriptorTable(1, m_srvDescriptorHeap->GetGPUDescriptorHandleForHeapStart());
 
 		m_D3DGraphCmdList->DrawInstanced(textObj->m_NbTextVerts, 1, 0, 0);
+		m_NbDrawCalls++;
 	}
 }
\ No newline at end of file
@@ -78,6 +78,7 @@ protected:
 	uint32_t                    m_UploadResourceUsed;
 
 	const CTexFont *            m_Font;
+	int                         m_FontTexVersion;
 	struct ID3D12Resource *     m_FontResource;
 
 	struct CLineRectVtx
@@ -97,7 +98,7 @@ protected:
 		float                   m_CstColor[4];
 	};
 
-	struct CTextObj
+	struct CTextObj : CTwAllocated
 	{
 		struct ID3D12Resource * m_TextVertexBuffer;
 		struct ID3D12Resource * m_BgVertexBuffer;
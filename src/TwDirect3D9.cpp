@@ -126,6 +126,7 @@ int CTwGraphDirect3D9::Init()
     m_D3DDev = static_cast<IDirect3DDevice9 *>(g_TwMgr->m_Device);
     m_Drawing = false;
     m_FontTex = NULL;
+    m_FontTexVersion = 0;
     m_FontD3DTex = NULL;
     D3DDEVICE_CREATION_PARAMETERS cp;
     m_D3DDev->GetCreationParameters(&cp);
@@ -265,6 +266,7 @@ void CTwGraphDirect3D9::Restore()
     m_FontD3DTex = NULL;
     
     m_FontTex = NULL;
+    m_FontTexVersion = 0;
 }
 
 
@@ -299,6 +301,8 @@ void CTwGraphDirect3D9::DrawLine(int _X0, int _Y0, int _X1, int _Y1, color32 _Co
     m_D3DDev->SetTextureStageState(0, D3DTSS_ALPHAOP, D3DTOP_DISABLE);
     m_D3DDev->SetFVF(D3DFVF_XYZRHW|D3DFVF_DIFFUSE);
     m_D3DDev->DrawPrimitiveUP(D3DPT_LINELIST, 1, p, sizeof(CVtx));
+    m_NbDrawCalls++;
+    m_NbUploadedBytes += (int)(2*sizeof(CVtx));
     //if( m_State->m_Caps.LineCaps & D3DLINECAPS_ANTIALIAS )
         m_D3DDev->SetRenderState(D3DRS_ANTIALIASEDLINEENABLE, FALSE);
 }
@@ -354,6 +358,8 @@ void CTwGraphDirect3D9::DrawRect(int _X0, int _Y0, int _X1, int _Y1, color32 _Co
     m_D3DDev->SetTextureStageState(0, D3DTSS_ALPHAOP, D3DTOP_DISABLE);
     m_D3DDev->SetFVF(D3DFVF_XYZRHW|D3DFVF_DIFFUSE);
     m_D3DDev->DrawPrimitiveUP(D3DPT_TRIANGLESTRIP, 2, p, sizeof(CVtx));
+    m_NbDrawCalls++;
+    m_NbUploadedBytes += (int)(4*sizeof(CVtx));
 }
 
 //  ---------------------------------------------------------------------------
@@ -379,13 +385,6 @@ void CTwGraphDirect3D9::BuildText(void *_TextObj, const std::string *_TextLines,
     assert(_TextObj!=NULL);
     assert(_Font!=NULL);
 
-    if( _Font != m_FontTex )
-    {
-        UnbindFont(m_D3DDev, m_FontD3DTex);
-        m_FontD3DTex = BindFont(m_D3DDev, _Font);
-        m_FontTex = _Font;
-    }
-
     CTextObj *TextObj = static_cast<CTextObj *>(_TextObj);
     TextObj->m_TextVerts.resize(0);
     TextObj->m_BgVerts.resize(0);
@@ -393,7 +392,7 @@ void CTwGraphDirect3D9::BuildText(void *_TextObj, const std::string *_TextLines,
     TextObj->m_LineBgColors = (_LineBgColors!=NULL);
 
     int x, x1, y, y1, i, Len;
-    unsigned char ch;
+    int ch;
     const unsigned char *Text;
     color32 LineColor = COLOR32_RED;
     CTextVtx Vtx;
@@ -412,9 +411,9 @@ void CTwGraphDirect3D9::BuildText(void *_TextObj, const std::string *_TextLines,
         if( _LineColors!=NULL )
             LineColor = _LineColors[Line];
 
-        for( i=0; i<Len; ++i )
+        for( i=0; i<Len; )
         {
-            ch = Text[i];
+            ch = _Font->NextGlyph(Text, Len, &i);
             x1 = x + _Font->m_CharWidth[ch];
 
             Vtx.m_Color  = LineColor;
@@ -490,6 +489,15 @@ void CTwGraphDirect3D9::BuildText(void *_TextObj, const std::string *_TextLines,
         }
     }
 
+    // Upload the font texture after the glyph loop: NextGlyph may have cached
+    // new glyphs and bumped m_TexVersion while the text was built
+    if( _Font != m_FontTex || _Font->m_TexVersion != m_FontTexVersion )
+    {
+        UnbindFont(m_D3DDev, m_FontD3DTex);
+        m_FontD3DTex = BindFont(m_D3DDev, _Font);
+        m_FontTex = _Font;
+        m_FontTexVersion = _Font->m_TexVersion;
+    }
 }
 
 //  ---------------------------------------------------------------------------
@@ -520,6 +528,8 @@ void CTwGraphDirect3D9::DrawText(void *_TextObj, int _X, int _Y, color32 _Color,
         m_D3DDev->SetTextureStageState(0, D3DTSS_ALPHAOP, D3DTOP_DISABLE);
         m_D3DDev->SetFVF(D3DFVF_XYZRHW|D3DFVF_DIFFUSE);
         m_D3DDev->DrawPrimitiveUP(D3DPT_TRIANGLELIST, nb/3, &(TextObj->m_BgVerts[0]), sizeof(CBgVtx));
+        m_NbDrawCalls++;
+        m_NbUploadedBytes += (int)(nb*sizeof(CBgVtx));
 
         for( i=0; i<nb; ++i )
         {
@@ -544,6 +554,8 @@ void CTwGraphDirect3D9::DrawText(void *_TextObj, int _X, int _Y, color32 _Color,
         m_D3DDev->SetTextureStageState(0, D3DTSS_ALPHAOP, D3DTOP_SELECTARG1);
         m_D3DDev->SetFVF(D3DFVF_XYZRHW|D3DFVF_DIFFUSE|D3DFVF_TEX1|D3DFVF_TEXCOORDSIZE2(0));
         m_D3DDev->DrawPrimitiveUP(D3DPT_TRIANGLELIST, nv/3, &(TextObj->m_TextVerts[0]), sizeof(CTextVtx));
+        m_NbDrawCalls++;
+        m_NbUploadedBytes += (int)(nv*sizeof(CTextVtx));
 
         for( i=0; i<nv; ++i )
         {
@@ -633,6 +645,8 @@ void CTwGraphDirect3D9::DrawTriangles(int _NumTriangles, int *_Vertices, color32
     m_D3DDev->SetTextureStageState(0, D3DTSS_ALPHAOP, D3DTOP_DISABLE);
     m_D3DDev->SetFVF(D3DFVF_XYZRHW|D3DFVF_DIFFUSE);
     m_D3DDev->DrawPrimitiveUP(D3DPT_TRIANGLELIST, _NumTriangles, &(m_TriVertices[0]), sizeof(CTriVtx));
+    m_NbDrawCalls++;
+    m_NbUploadedBytes += (int)(3*_NumTriangles*sizeof(CTriVtx));
 
     m_D3DDev->SetRenderState(D3DRS_CULLMODE, prevCullMode);
 }
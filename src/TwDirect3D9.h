@@ -46,6 +46,7 @@ protected:
     struct IDirect3DDevice9 *   m_D3DDev;
     bool                        m_Drawing;
     const CTexFont *            m_FontTex;
+    int                         m_FontTexVersion;
     struct IDirect3DTexture9 *  m_FontD3DTex;
     bool                        m_PureDevice;
     int                         m_WndWidth;
@@ -66,10 +67,10 @@ protected:
         color32                 m_Color;
     };
 
-    struct CTextObj
+    struct CTextObj : CTwAllocated
     {
-        std::vector<CTextVtx>   m_TextVerts;
-        std::vector<CBgVtx>     m_BgVerts;
+        std::vector<CTextVtx, TTwAllocator<CTextVtx> > m_TextVerts;
+        std::vector<CBgVtx, TTwAllocator<CBgVtx> > m_BgVerts;
         bool                    m_LineColors;
         bool                    m_LineBgColors;
     };
@@ -18,6 +18,8 @@
 
 int TW_CALL TwEventSDL12(const void *sdlEvent); // implemented in TwEventSDL12.c
 int TW_CALL TwEventSDL13(const void *sdlEvent); // implmeneted in TwEventSDL13.c
+int TW_CALL TwEventSDL12Batch(const void *sdlEvents, int count, int eventSize); // implemented in TwEventSDL12.c
+int TW_CALL TwEventSDL13Batch(const void *sdlEvents, int count, int eventSize); // implemented in TwEventSDL13.c
 #ifdef  __cplusplus
     extern "C" { int TW_CALL TwSetLastError(const char *staticErrorMessage); }
 #else
@@ -41,3 +43,20 @@ int TW_CALL TwEventSDL(const void *sdlEvent, unsigned char majorVersion, unsigne
     else // if( majorVersion==1 && minorVersion==3 ) 
         return TwEventSDL13(sdlEvent); // will probably not work for version > 1.3, but give it a chance
 }
+
+//  TwEventSDLBatch processes an array of count SDL events of eventSize bytes
+//  each (ie. sizeof(SDL_Event)) and returns the number of events handled 
+//  by the AntTweakBar library.
+int TW_CALL TwEventSDLBatch(const void *sdlEvents, int count, int eventSize, unsigned char majorVersion, unsigned char minorVersion)
+{
+    if (majorVersion < 1 || (majorVersion == 1 && minorVersion < 2))
+    {
+        static const char *g_ErrBadSDLVersion = "Unsupported SDL version";
+        TwSetLastError(g_ErrBadSDLVersion);
+        return 0;
+    }
+    else if (majorVersion == 1 && minorVersion == 2)
+        return TwEventSDL12Batch(sdlEvents, count, eventSize);
+    else // if( majorVersion==1 && minorVersion==3 ) 
+        return TwEventSDL13Batch(sdlEvents, count, eventSize); // will probably not work for version > 1.3, but give it a chance
+}
@@ -18,34 +18,35 @@
 // it just needs some definitions for its helper functions.
 
 #include <AntTweakBar.h>
+#include <stdlib.h>
+#include <string.h>
 
 
-//  TwEventSDL12 returns zero if msg has not been handled, 
-//  and a non-zero value if it has been handled by the AntTweakBar library.
-int TW_CALL TwEventSDL12(const void *sdlEvent)
+//  Translates an SDL input event to a TwEvent. Returns zero if the event is
+//  not an input event for AntTweakBar (window resizes are handled by callers).
+static int TranslateEventSDL12(const SDL_Event *event, TwEvent *twEvent)
 {
-    int handled = 0;
-    const SDL_Event *event = (const SDL_Event *)sdlEvent;
-
-    if( event==NULL )
-        return 0;
-
+    memset(twEvent, 0, sizeof(TwEvent));
     switch( event->type )
     {
     case SDL_KEYDOWN:
+        twEvent->Type = TW_EVENT_KEY_PRESSED;
+        twEvent->Modifiers = event->key.keysym.mod;
         if( event->key.keysym.unicode!=0 && (event->key.keysym.unicode & 0xFF00)==0 )
         {
             if( (event->key.keysym.unicode & 0xFF)<32 && (event->key.keysym.unicode & 0xFF)!=event->key.keysym.sym )
-                handled = TwKeyPressed((event->key.keysym.unicode & 0xFF)+'a'-1, event->key.keysym.mod);
+                twEvent->Key = (event->key.keysym.unicode & 0xFF)+'a'-1;
             else
-                handled = TwKeyPressed(event->key.keysym.unicode & 0xFF, event->key.keysym.mod);
+                twEvent->Key = event->key.keysym.unicode & 0xFF;
         }
         else
-            handled = TwKeyPressed(event->key.keysym.sym, event->key.keysym.mod);
-        break;
+            twEvent->Key = event->key.keysym.sym;
+        return 1;
     case SDL_MOUSEMOTION:
-        handled = TwMouseMotion(event->motion.x, event->motion.y);
-        break;
+        twEvent->Type = TW_EVENT_MOUSE_MOTION;
+        twEvent->MouseX = event->motion.x;
+        twEvent->MouseY = event->motion.y;
+        return 1;
     case SDL_MOUSEBUTTONUP:
     case SDL_MOUSEBUTTONDOWN:
         if( event->type==SDL_MOUSEBUTTONDOWN && (event->button.button==4 || event->button.button==5) )  // mouse wheel
@@ -55,17 +56,82 @@ int TW_CALL TwEventSDL12(const void *sdlEvent)
                 ++s_WheelPos;
             else
                 --s_WheelPos;
-            handled = TwMouseWheel(s_WheelPos);
+            twEvent->Type = TW_EVENT_MOUSE_WHEEL;
+            twEvent->WheelPos = s_WheelPos;
         }
         else
-            handled = TwMouseButton((event->type==SDL_MOUSEBUTTONUP)?TW_MOUSE_RELEASED:TW_MOUSE_PRESSED, (TwMouseButtonID)event->button.button);
-        break;
-    case SDL_VIDEORESIZE:
+        {
+            twEvent->Type = TW_EVENT_MOUSE_BUTTON;
+            twEvent->Action = (event->type==SDL_MOUSEBUTTONUP)?TW_MOUSE_RELEASED:TW_MOUSE_PRESSED;
+            twEvent->Button = (TwMouseButtonID)event->button.button;
+        }
+        return 1;
+    }
+    return 0;
+}
+
+
+//  TwEventSDL12 returns zero if msg has not been handled, 
+//  and a non-zero value if it has been handled by the AntTweakBar library.
+int TW_CALL TwEventSDL12(const void *sdlEvent)
+{
+    TwEvent twEvent;
+    const SDL_Event *event = (const SDL_Event *)sdlEvent;
+
+    if( event==NULL )
+        return 0;
+
+    if( event->type==SDL_VIDEORESIZE )
+    {
         // tell the new size to TweakBar
         TwWindowSize(event->resize.w, event->resize.h);
-        // do not set 'handled', SDL_VIDEORESIZE may be also processed by the calling application
-        break;
+        // not handled, SDL_VIDEORESIZE may be also processed by the calling application
+        return 0;
+    }
+    if( TranslateEventSDL12(event, &twEvent) )
+        return TwProcessEvents(&twEvent, 1);
+    return 0;
+}
+
+
+//  TwEventSDL12Batch sends an array of eventSize-byte SDL events to AntTweakBar.
+//  The events are translated and sent with a single call to TwProcessEvents 
+//  (split only around window resizes), which coalesces consecutive mouse 
+//  motion events. It returns the number of events handled by AntTweakBar.
+int TW_CALL TwEventSDL12Batch(const void *sdlEvents, int count, int eventSize)
+{
+    TwEvent localEvents[64];
+    TwEvent *twEvents = localEvents;
+    int i, n = 0, handled = 0;
+    const char *events = (const char *)sdlEvents;
+
+    if( events==NULL || count<=0 || eventSize<(int)sizeof(Uint8) )
+        return 0;
+    if( count>(int)(sizeof(localEvents)/sizeof(TwEvent)) )
+    {
+        twEvents = (TwEvent *)malloc(count*sizeof(TwEvent));
+        if( twEvents==NULL )
+            return 0;
+    }
+
+    for( i=0; i<count; ++i )
+    {
+        const SDL_Event *event = (const SDL_Event *)(events+i*eventSize);
+        if( event->type==SDL_VIDEORESIZE )
+        {
+            // the events before the resize are processed with the previous size
+            if( n>0 )
+                handled += TwProcessEvents(twEvents, n);
+            n = 0;
+            TwWindowSize(event->resize.w, event->resize.h);
+        }
+        else if( TranslateEventSDL12(event, &twEvents[n]) )
+            ++n;
     }
+    if( n>0 )
+        handled += TwProcessEvents(twEvents, n);
 
+    if( twEvents!=localEvents )
+        free(twEvents);
     return handled;
 }
@@ -17,6 +17,8 @@
 // it just needs some definitions for its helper functions.
 
 #include <AntTweakBar.h>
+#include <stdlib.h>
+#include <string.h>
 
 
 //  The way SDL handles keyboard events has changed between version 1.2
@@ -26,33 +28,33 @@
 //  If someone knows a better and more robust way to do the keyboard events
 //  translation, please let me know.
 
-//  TwEventSDL returns zero if msg has not been handled, 
-//  and a non-zero value if it has been handled by the AntTweakBar library.
-int TW_CALL TwEventSDL13(const void *sdlEvent)
+//  Translates an SDL input event to a TwEvent. Returns zero if the event is
+//  not an input event for AntTweakBar (window resizes are handled by callers).
+static int TranslateEventSDL13(const SDL_Event *event, TwEvent *twEvent)
 {
-    int handled = 0;
     static int s_KeyMod = 0;
-    const SDL_Event *event = (const SDL_Event *)sdlEvent;
-
-    if( event==NULL )
-        return 0;
 
+    memset(twEvent, 0, sizeof(TwEvent));
+    twEvent->Type = TW_EVENT_KEY_PRESSED;
     switch( event->type )
     {
     case SDL_TEXTINPUT:
         if( event->text.text[0]!=0 && event->text.text[1]==0 ) 
         {
             if( s_KeyMod & TW_KMOD_CTRL && event->text.text[0]<32 )
-                handled = TwKeyPressed(event->text.text[0]+'a'-1, s_KeyMod);
+                twEvent->Key = event->text.text[0]+'a'-1;
             else
             {
                 if (s_KeyMod & KMOD_RALT)
                     s_KeyMod &= ~KMOD_CTRL;
-                handled = TwKeyPressed(event->text.text[0], s_KeyMod);
+                twEvent->Key = event->text.text[0];
             }
+            twEvent->Modifiers = s_KeyMod;
+            s_KeyMod = 0;
+            return 1;
         }
         s_KeyMod = 0;
-        break;
+        return 0;
     case SDL_KEYDOWN:
         if( event->key.keysym.sym & SDLK_SCANCODE_MASK )
         {
@@ -90,20 +92,26 @@ int TW_CALL TwEventSDL13(const void *sdlEvent)
                 if( event->key.keysym.sym>=SDLK_F1 && event->key.keysym.sym<=SDLK_F12 )
                     key = event->key.keysym.sym + TW_KEY_F1 - SDLK_F1;
             }
-            if( key!=0 )
-                handled = TwKeyPressed(key, event->key.keysym.mod);
+            twEvent->Key = key;
+            twEvent->Modifiers = event->key.keysym.mod;
+            return (key!=0);
         }
         else if( event->key.keysym.mod & TW_KMOD_ALT )
-            handled = TwKeyPressed(event->key.keysym.sym & 0xFF, event->key.keysym.mod);
-        else
-            s_KeyMod = event->key.keysym.mod;
-        break;
+        {
+            twEvent->Key = event->key.keysym.sym & 0xFF;
+            twEvent->Modifiers = event->key.keysym.mod;
+            return 1;
+        }
+        s_KeyMod = event->key.keysym.mod;
+        return 0;
     case SDL_KEYUP:
         s_KeyMod = 0;
-        break;
+        return 0;
     case SDL_MOUSEMOTION:
-        handled = TwMouseMotion(event->motion.x, event->motion.y);
-        break;
+        twEvent->Type = TW_EVENT_MOUSE_MOTION;
+        twEvent->MouseX = event->motion.x;
+        twEvent->MouseY = event->motion.y;
+        return 1;
     case SDL_MOUSEBUTTONUP:
     case SDL_MOUSEBUTTONDOWN:
         if( event->type==SDL_MOUSEBUTTONDOWN && (event->button.button==4 || event->button.button==5) )  // mouse wheel
@@ -113,17 +121,82 @@ int TW_CALL TwEventSDL13(const void *sdlEvent)
                 ++s_WheelPos;
             else
                 --s_WheelPos;
-            handled = TwMouseWheel(s_WheelPos);
+            twEvent->Type = TW_EVENT_MOUSE_WHEEL;
+            twEvent->WheelPos = s_WheelPos;
         }
         else
-            handled = TwMouseButton((event->type==SDL_MOUSEBUTTONUP)?TW_MOUSE_RELEASED:TW_MOUSE_PRESSED, (TwMouseButtonID)event->button.button);
-        break;
-    case SDL_VIDEORESIZE:
+        {
+            twEvent->Type = TW_EVENT_MOUSE_BUTTON;
+            twEvent->Action = (event->type==SDL_MOUSEBUTTONUP)?TW_MOUSE_RELEASED:TW_MOUSE_PRESSED;
+            twEvent->Button = (TwMouseButtonID)event->button.button;
+        }
+        return 1;
+    }
+    return 0;
+}
+
+
+//  TwEventSDL returns zero if msg has not been handled, 
+//  and a non-zero value if it has been handled by the AntTweakBar library.
+int TW_CALL TwEventSDL13(const void *sdlEvent)
+{
+    TwEvent twEvent;
+    const SDL_Event *event = (const SDL_Event *)sdlEvent;
+
+    if( event==NULL )
+        return 0;
+
+    if( event->type==SDL_VIDEORESIZE )
+    {
         // tell the new size to TweakBar
         TwWindowSize(event->resize.w, event->resize.h);
-        // do not set 'handled', SDL_VIDEORESIZE may be also processed by the calling application
-        break;
+        // not handled, SDL_VIDEORESIZE may be also processed by the calling application
+        return 0;
+    }
+    if( TranslateEventSDL13(event, &twEvent) )
+        return TwProcessEvents(&twEvent, 1);
+    return 0;
+}
+
+
+//  TwEventSDL13Batch sends an array of eventSize-byte SDL events to AntTweakBar.
+//  The events are translated and sent with a single call to TwProcessEvents 
+//  (split only around window resizes), which coalesces consecutive mouse 
+//  motion events. It returns the number of events handled by AntTweakBar.
+int TW_CALL TwEventSDL13Batch(const void *sdlEvents, int count, int eventSize)
+{
+    TwEvent localEvents[64];
+    TwEvent *twEvents = localEvents;
+    int i, n = 0, handled = 0;
+    const char *events = (const char *)sdlEvents;
+
+    if( events==NULL || count<=0 || eventSize<(int)sizeof(Uint8) )
+        return 0;
+    if( count>(int)(sizeof(localEvents)/sizeof(TwEvent)) )
+    {
+        twEvents = (TwEvent *)malloc(count*sizeof(TwEvent));
+        if( twEvents==NULL )
+            return 0;
+    }
+
+    for( i=0; i<count; ++i )
+    {
+        const SDL_Event *event = (const SDL_Event *)(events+i*eventSize);
+        if( event->type==SDL_VIDEORESIZE )
+        {
+            // the events before the resize are processed with the previous size
+            if( n>0 )
+                handled += TwProcessEvents(twEvents, n);
+            n = 0;
+            TwWindowSize(event->resize.w, event->resize.h);
+        }
+        else if( TranslateEventSDL13(event, &twEvents[n]) )
+            ++n;
     }
+    if( n>0 )
+        handled += TwProcessEvents(twEvents, n);
 
+    if( twEvents!=localEvents )
+        free(twEvents);
     return handled;
 }
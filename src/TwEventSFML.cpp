@@ -17,34 +17,19 @@
 // it just needs some definitions for its helper functions.
 
 #include <AntTweakBar.h>
+#include <string.h>
 
 
-//  TwEventSFML returns zero if msg has not been handled, 
-//  and a non-zero value if it has been handled by the AntTweakBar library.
-int TW_CALL TwEventSFML(const void *sfmlEvent, unsigned char majorVersion, unsigned char minorVersion)
+//  Translates an SFML input event to a TwEvent. Returns false if the event is
+//  not an input event for AntTweakBar (window resizes are handled by callers).
+static bool TranslateEventSFML(const sf::Event *event, TwEvent *twEvent)
 {
-    // Assume version 1.6 (will possibly not work for version != 1.6, but give it a chance)
-    /*
-    if (majorVersion > 1 || (majorVersion == 1 && minorVersion > 6)
-    {
-        static const char *g_ErrBadSFMLVersion = "Unsupported SFML version";
-        TwSetLastError(g_ErrBadSFMLVersion);
-        return 0;
-    }
-    */
-    (void)majorVersion, (void)minorVersion;
-
-    int handled = 0;
-    const sf::Event *event = (const sf::Event *)sfmlEvent;
-    TwMouseAction mouseAction;
     int key = 0;
     static int s_KMod = 0;
     static bool s_PreventTextHandling = false;
     static int s_WheelPos = 0;
 
-    if (event == NULL)
-        return 0;
-
+    memset(twEvent, 0, sizeof(TwEvent));
     switch (event->Type)
     {
     case sf::Event::KeyPressed:
@@ -117,8 +102,11 @@ int TW_CALL TwEventSFML(const void *sfmlEvent, unsigned char majorVersion, unsig
         }
         if (key != 0) 
         {
-            handled = TwKeyPressed(key, s_KMod);
+            twEvent->Type = TW_EVENT_KEY_PRESSED;
+            twEvent->Key = key;
+            twEvent->Modifiers = s_KMod;
             s_PreventTextHandling = true;
+            return true;
         }
         break;
     case sf::Event::KeyReleased:
@@ -128,46 +116,127 @@ int TW_CALL TwEventSFML(const void *sfmlEvent, unsigned char majorVersion, unsig
     case sf::Event::TextEntered:
         if (!s_PreventTextHandling && event->Text.Unicode != 0 && (event->Text.Unicode & 0xFF00) == 0)
         {
+            twEvent->Type = TW_EVENT_KEY_PRESSED;
             if ((event->Text.Unicode & 0xFF) < 32) // CTRL+letter
-                handled = TwKeyPressed((event->Text.Unicode & 0xFF)+'a'-1, TW_KMOD_CTRL|s_KMod);
+            {
+                twEvent->Key = (event->Text.Unicode & 0xFF)+'a'-1;
+                twEvent->Modifiers = TW_KMOD_CTRL|s_KMod;
+            }
             else 
-                handled = TwKeyPressed(event->Text.Unicode & 0xFF, 0);
+                twEvent->Key = event->Text.Unicode & 0xFF;
+            s_PreventTextHandling = false;
+            return true;
         }
         s_PreventTextHandling = false;
         break;
     case sf::Event::MouseMoved:
-        handled = TwMouseMotion(event->MouseMove.X, event->MouseMove.Y);
-        break;
+        twEvent->Type = TW_EVENT_MOUSE_MOTION;
+        twEvent->MouseX = event->MouseMove.X;
+        twEvent->MouseY = event->MouseMove.Y;
+        return true;
     case sf::Event::MouseButtonPressed:
     case sf::Event::MouseButtonReleased:
-        mouseAction = (event->Type==sf::Event::MouseButtonPressed) ? TW_MOUSE_PRESSED : TW_MOUSE_RELEASED;
+        twEvent->Type = TW_EVENT_MOUSE_BUTTON;
+        twEvent->Action = (event->Type==sf::Event::MouseButtonPressed) ? TW_MOUSE_PRESSED : TW_MOUSE_RELEASED;
         switch (event->MouseButton.Button) 
         {
         case sf::Mouse::Left:
-            handled = TwMouseButton(mouseAction, TW_MOUSE_LEFT);
-            break;
+            twEvent->Button = TW_MOUSE_LEFT;
+            return true;
         case sf::Mouse::Middle:
-            handled = TwMouseButton(mouseAction, TW_MOUSE_MIDDLE);
-            break;
+            twEvent->Button = TW_MOUSE_MIDDLE;
+            return true;
         case sf::Mouse::Right:
-            handled = TwMouseButton(mouseAction, TW_MOUSE_RIGHT);
-            break;
+            twEvent->Button = TW_MOUSE_RIGHT;
+            return true;
         default:
             break;
         }
         break;
     case sf::Event::MouseWheelMoved:
         s_WheelPos += event->MouseWheel.Delta;
-        handled = TwMouseWheel(s_WheelPos);
+        twEvent->Type = TW_EVENT_MOUSE_WHEEL;
+        twEvent->WheelPos = s_WheelPos;
+        return true;
+    default:
         break;
-    case sf::Event::Resized:
+    }
+
+    return false;
+}
+
+
+//  TwEventSFML returns zero if msg has not been handled, 
+//  and a non-zero value if it has been handled by the AntTweakBar library.
+int TW_CALL TwEventSFML(const void *sfmlEvent, unsigned char majorVersion, unsigned char minorVersion)
+{
+    // Assume version 1.6 (will possibly not work for version != 1.6, but give it a chance)
+    /*
+    if (majorVersion > 1 || (majorVersion == 1 && minorVersion > 6)
+    {
+        static const char *g_ErrBadSFMLVersion = "Unsupported SFML version";
+        TwSetLastError(g_ErrBadSFMLVersion);
+        return 0;
+    }
+    */
+    (void)majorVersion, (void)minorVersion;
+
+    TwEvent twEvent;
+    const sf::Event *event = (const sf::Event *)sfmlEvent;
+
+    if (event == NULL)
+        return 0;
+
+    if (event->Type == sf::Event::Resized)
+    {
         // tell the new size to TweakBar
         TwWindowSize(event->Size.Width, event->Size.Height);
-        // do not set 'handled', sf::Event::Resized may be also processed by the client application
-        break;
-    default:
-        break;
+        // not handled, sf::Event::Resized may be also processed by the client application
+        return 0;
+    }
+    if (TranslateEventSFML(event, &twEvent))
+        return TwProcessEvents(&twEvent, 1);
+    return 0;
+}
+
+
+//  TwEventSFMLBatch processes an array of count SFML events of eventSize bytes
+//  each (ie. sizeof(sf::Event)). The events are translated and sent with a
+//  single call to TwProcessEvents (split only around window resizes), which
+//  coalesces consecutive mouse motion events. It returns the number of events
+//  handled by the AntTweakBar library.
+int TW_CALL TwEventSFMLBatch(const void *sfmlEvents, int count, int eventSize, unsigned char majorVersion, unsigned char minorVersion)
+{
+    (void)majorVersion, (void)minorVersion;
+
+    const char *events = (const char *)sfmlEvents;
+    TwEvent localEvents[64];
+    TwEvent *twEvents = localEvents;
+    int n = 0, handled = 0;
+
+    if (events == NULL || count <= 0 || eventSize < (int)sizeof(sf::Event::EventType))
+        return 0;
+    if (count > (int)(sizeof(localEvents)/sizeof(TwEvent)))
+        twEvents = new TwEvent[count];
+
+    for (int i = 0; i < count; ++i)
+    {
+        const sf::Event *event = (const sf::Event *)(events + i*eventSize);
+        if (event->Type == sf::Event::Resized)
+        {
+            // the events before the resize are processed with the previous size
+            if (n > 0)
+                handled += TwProcessEvents(twEvents, n);
+            n = 0;
+            TwWindowSize(event->Size.Width, event->Size.Height);
+        }
+        else if (TranslateEventSFML(event, &twEvents[n]))
+            ++n;
     }
+    if (n > 0)
+        handled += TwProcessEvents(twEvents, n);
 
+    if (twEvents != localEvents)
+        delete[] twEvents;
     return handled;
 }
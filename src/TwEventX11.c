@@ -15,6 +15,7 @@
 #include <X11/keysym.h>
 #include <X11/Xutil.h>
 #include <AntTweakBar.h>
+#include <string.h>
 
 static int s_KMod = 0;
 const int buff_sz = 80;
@@ -46,7 +47,9 @@ static int _XKeyRelease(XEvent *event)
 
 // ----------------------------------------------------------------------
 // ----------------------------------------------------------------------
-static int _XKeyPress(XEvent *event)
+// Translates a key press to at most buff_sz TwEvents (one per character of
+// the looked up string), returns the number of events written
+static int _XKeyPress(XEvent *event, TwEvent *twEvents)
 {
     int modifiers = 0;  // modifiers sent to AntTweakBar
     int k = 0;          // key sent to AntTweakBar
@@ -137,25 +140,40 @@ static int _XKeyPress(XEvent *event)
         
     if (k == 0 && num_char)
     {
-        int i, handled = 0;
+        int i;
         for (i=0; i<num_char; ++i)
-            if (TwKeyPressed(buffer[i], modifiers))
-                handled = 1;
-        return handled;
+        {
+            memset(&twEvents[i], 0, sizeof(TwEvent));
+            twEvents[i].Type = TW_EVENT_KEY_PRESSED;
+            twEvents[i].Key = buffer[i];
+            twEvents[i].Modifiers = modifiers;
+        }
+        return num_char;
     }
 
     // if we have a valid key, send to AntTweakBar
     // -------------------------------------------
-    return (k > 0) ? TwKeyPressed(k, modifiers) : 0;
+    if (k > 0)
+    {
+        memset(twEvents, 0, sizeof(TwEvent));
+        twEvents->Type = TW_EVENT_KEY_PRESSED;
+        twEvents->Key = k;
+        twEvents->Modifiers = modifiers;
+        return 1;
+    }
+    return 0;
 }
 
 // ----------------------------------------------------------------------
 // ----------------------------------------------------------------------
-static int _XButtonEvent(XEvent *event)
+static int _XButtonEvent(XEvent *event, TwEvent *twEvent)
 {
-    TwMouseAction action = (event->type == ButtonPress) ? TW_MOUSE_PRESSED : TW_MOUSE_RELEASED;
     XButtonEvent *xbe = (XButtonEvent *)event;
-    return TwMouseButton(action, xbe->button);
+    memset(twEvent, 0, sizeof(TwEvent));
+    twEvent->Type = TW_EVENT_MOUSE_BUTTON;
+    twEvent->Action = (event->type == ButtonPress) ? TW_MOUSE_PRESSED : TW_MOUSE_RELEASED;
+    twEvent->Button = (TwMouseButtonID)xbe->button;
+    return 1;
 }
     
 // ----------------------------------------------------------------------
@@ -169,39 +187,87 @@ static int _XConfigureEvent(XEvent *event)
 
 // ----------------------------------------------------------------------
 // ----------------------------------------------------------------------
-static int _XMotionEvent(XEvent *event)
+static int _XMotionEvent(XEvent *event, TwEvent *twEvent)
 {
     XMotionEvent *xme = (XMotionEvent *)event;
-    return TwMouseMotion(xme->x, xme->y);
+    memset(twEvent, 0, sizeof(TwEvent));
+    twEvent->Type = TW_EVENT_MOUSE_MOTION;
+    twEvent->MouseX = xme->x;
+    twEvent->MouseY = xme->y;
+    return 1;
 }
 
 // ----------------------------------------------------------------------
+// Translates an input event to at most buff_sz TwEvents, returns the number
+// of events written (ConfigureNotify is handled by the callers)
 // ----------------------------------------------------------------------
-TW_API int TW_CDECL_CALL TwEventX11(void *xevent)
+static int _XTranslateEvent(XEvent *event, TwEvent *twEvents)
 {
-    XEvent *event = (XEvent *)xevent;
-    
     switch (event->type)
     {
     case KeyPress:    
-        return _XKeyPress(xevent);
+        return _XKeyPress(event, twEvents);
 
     case KeyRelease:  
-        return 0; // _XKeyRelease(xevent);
+        return 0; // _XKeyRelease(event);
 
     case ButtonPress: 
     case ButtonRelease: 
-        return _XButtonEvent(xevent);
+        return _XButtonEvent(event, twEvents);
 
     case MotionNotify:
-        return _XMotionEvent(xevent);
-
-    case ConfigureNotify:
-        return _XConfigureEvent(xevent);
+        return _XMotionEvent(event, twEvents);
 
     default:  
         break;
     }
     return 0;
 }
+
+// ----------------------------------------------------------------------
+// ----------------------------------------------------------------------
+TW_API int TW_CDECL_CALL TwEventX11(void *xevent)
+{
+    XEvent *event = (XEvent *)xevent;
+    TwEvent twEvents[buff_sz];
+    int n;
+
+    if (event->type == ConfigureNotify)
+        return _XConfigureEvent(event);
+
+    n = _XTranslateEvent(event, twEvents);
+    return (n > 0 && TwProcessEvents(twEvents, n) > 0) ? 1 : 0;
+}
         
+
+// ----------------------------------------------------------------------
+// ----------------------------------------------------------------------
+TW_API int TW_CDECL_CALL TwEventX11Batch(void *xevents, int count)
+{
+    XEvent *events = (XEvent *)xevents;
+    TwEvent twEvents[4*buff_sz];
+    int i, n = 0, handled = 0;
+
+    if (events == NULL)
+        return 0;
+
+    // the translated events are sent with a single TwProcessEvents call (which
+    // coalesces consecutive motion events), split only around window resizes
+    // or when a key press could overflow the buffer
+    for (i = 0; i < count; ++i)
+    {
+        if (events[i].type == ConfigureNotify || n+buff_sz > 4*buff_sz)
+        {
+            if (n > 0)
+                handled += TwProcessEvents(twEvents, n);
+            n = 0;
+        }
+        if (events[i].type == ConfigureNotify)
+            _XConfigureEvent(&events[i]);
+        else
+            n += _XTranslateEvent(&events[i], &twEvents[n]);
+    }
+    if (n > 0)
+        handled += TwProcessEvents(twEvents, n);
+    return handled;
+}
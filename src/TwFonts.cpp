@@ -14,24 +14,45 @@
 
 // Fedora patch: memset()
 using std::memset;
+using std::memcpy;
 
 //  ---------------------------------------------------------------------------
 
 CTexFont::CTexFont()
 {
-    for( int i=0; i<256; ++i )
+    for( int i=0; i<TW_FONT_NB_SLOTS; ++i )
     {
         m_CharU0[i] = 0;
         m_CharU1[i] = 0;
         m_CharV0[i] = 0;
         m_CharV1[i] = 0;
         m_CharWidth[i] = 0;
+        m_CharTexWidth[i] = 0;
     }
     m_TexWidth = 0;
     m_TexHeight = 0;
     m_TexBytes = NULL;
     m_NbCharRead = 0;
     m_CharHeight = 0;
+    m_TexVersion = 0;
+    m_SDF = false;
+    m_TexScale = 1;
+    m_Atlas = NULL;
+    m_AtlasScale = 1;
+    m_GlyphHeight = 0;
+    m_Scaling = 1;
+    m_TexelOffset = 0;
+    m_CacheY0 = 0;
+    m_CacheCellWidth = 0;
+    m_NbCachedSlots = 0;
+    m_CacheClock = 0;
+    m_NbEvictions = 0;
+    for( int i=0; i<TW_FONT_NB_CACHED_SLOTS; ++i )
+    {
+        m_SlotCodePoint[i] = 0;
+        m_SlotLastUse[i] = 0;
+        m_SlotEviction[i] = 0;
+    }
 }
 
 //  ---------------------------------------------------------------------------
@@ -58,9 +79,141 @@ static int NextPow2(int _n)
 
 //  ---------------------------------------------------------------------------
 
+// Signed distance field parameters: the SDF texture has SDF_UPSCALE times the
+// resolution of the source bitmap, and distances are clamped to SDF_SPREAD texels.
+const int SDF_UPSCALE = 4;
+const int SDF_SPREAD = 2*SDF_UPSCALE;
+const float SDF_INF = 1.0e20f;
+
+// 1D squared distance transform of sampled function _f (Felzenszwalb & Huttenlocher)
+static void DistanceTransform1D(const float *_f, int _n, float *_d, int *_v, float *_z)
+{
+    int k = 0;
+    _v[0] = 0;
+    _z[0] = -SDF_INF;
+    _z[1] = SDF_INF;
+    for( int q=1; q<_n; ++q )
+    {
+        float s = ((_f[q]+float(q*q))-(_f[_v[k]]+float(_v[k]*_v[k])))/float(2*q-2*_v[k]);
+        while( s<=_z[k] )
+        {
+            --k;
+            s = ((_f[q]+float(q*q))-(_f[_v[k]]+float(_v[k]*_v[k])))/float(2*q-2*_v[k]);
+        }
+        ++k;
+        _v[k] = q;
+        _z[k] = s;
+        _z[k+1] = SDF_INF;
+    }
+    k = 0;
+    for( int q=0; q<_n; ++q )
+    {
+        while( _z[k+1]<float(q) )
+            ++k;
+        _d[q] = float((q-_v[k])*(q-_v[k])) + _f[_v[k]];
+    }
+}
+
+// 2D squared distance transform in place (0 on features, SDF_INF elsewhere)
+static void DistanceTransform2D(std::vector<float>& _Grid, int _w, int _h)
+{
+    int n = (_w>_h) ? _w : _h;
+    std::vector<float> f(n), d(n), z(n+1);
+    std::vector<int> v(n);
+    int x, y;
+    for( x=0; x<_w; ++x )
+    {
+        for( y=0; y<_h; ++y )
+            f[y] = _Grid[y*_w+x];
+        DistanceTransform1D(&f[0], _h, &d[0], &v[0], &z[0]);
+        for( y=0; y<_h; ++y )
+            _Grid[y*_w+x] = d[y];
+    }
+    for( y=0; y<_h; ++y )
+    {
+        DistanceTransform1D(&_Grid[y*_w], _w, &d[0], &v[0], &z[0]);
+        for( x=0; x<_w; ++x )
+            _Grid[y*_w+x] = d[x];
+    }
+}
+
+// Converts a _w x _h alpha bitmap to a (SDF_UPSCALE*_w) x (SDF_UPSCALE*_h) distance field
+static void ComputeSDF(const unsigned char *_Alpha, int _w, int _h, int _Pitch, unsigned char *_Dest, int _DestPitch)
+{
+    int W = SDF_UPSCALE*_w;
+    int H = SDF_UPSCALE*_h;
+    std::vector<float> Outside(W*H), Inside(W*H);
+    int x, y;
+    for( y=0; y<H; ++y )
+        for( x=0; x<W; ++x )
+        {
+            // bilinear sample of the source bitmap
+            float sx = (float(x)+0.5f)/float(SDF_UPSCALE) - 0.5f;
+            float sy = (float(y)+0.5f)/float(SDF_UPSCALE) - 0.5f;
+            int ix = (int)floorf(sx), iy = (int)floorf(sy);
+            float fx = sx-float(ix), fy = sy-float(iy);
+            int ix0 = (ix<0) ? 0 : ix, iy0 = (iy<0) ? 0 : iy;
+            int ix1 = (ix+1>=_w) ? _w-1 : ix+1, iy1 = (iy+1>=_h) ? _h-1 : iy+1;
+            float a = (1-fy)*((1-fx)*_Alpha[iy0*_Pitch+ix0] + fx*_Alpha[iy0*_Pitch+ix1]) 
+                    +    fy *((1-fx)*_Alpha[iy1*_Pitch+ix0] + fx*_Alpha[iy1*_Pitch+ix1]);
+            bool In = (a>=128.0f);
+            Outside[y*W+x] = In ? 0 : SDF_INF;
+            Inside[y*W+x] = In ? SDF_INF : 0;
+        }
+    DistanceTransform2D(Outside, W, H);
+    DistanceTransform2D(Inside, W, H);
+    for( y=0; y<H; ++y )
+        for( x=0; x<W; ++x )
+        {
+            float Dist = sqrtf(Outside[y*W+x]) - sqrtf(Inside[y*W+x]); // >0 outside the glyph
+            float d = 0.5f - Dist/float(2*SDF_SPREAD);
+            if( d<0 )
+                d = 0;
+            else if( d>1 )
+                d = 1;
+            _Dest[y*_DestPitch+x] = (unsigned char)(d*255.0f+0.5f);
+        }
+}
+
+bool TwSupportSDFFonts()
+{
+    // SDF fonts require linear filtering and a distance-aware text shader,
+    // which are only implemented by the OpenGL graphs for now.
+    return g_TwMgr!=NULL && (g_TwMgr->m_GraphAPI==TW_OPENGL || g_TwMgr->m_GraphAPI==TW_OPENGL_CORE);
+}
+
+//  ---------------------------------------------------------------------------
+
+// Unicode code points of the characters 128 to 255 of the source bitmaps (0 = undefined)
+static const unsigned short s_CodePageCP1252[128] = 
+{
+    0x20AC,0,0x201A,0x0192,0x201E,0x2026,0x2020,0x2021,0x02C6,0x2030,0x0160,0x2039,0x0152,0,0x017D,0,
+    0,0x2018,0x2019,0x201C,0x201D,0x2022,0x2013,0x2014,0x02DC,0x2122,0x0161,0x203A,0x0153,0,0x017E,0x0178,
+    0x00A0,0x00A1,0x00A2,0x00A3,0x00A4,0x00A5,0x00A6,0x00A7,0x00A8,0x00A9,0x00AA,0x00AB,0x00AC,0x00AD,0x00AE,0x00AF,
+    0x00B0,0x00B1,0x00B2,0x00B3,0x00B4,0x00B5,0x00B6,0x00B7,0x00B8,0x00B9,0x00BA,0x00BB,0x00BC,0x00BD,0x00BE,0x00BF,
+    0x00C0,0x00C1,0x00C2,0x00C3,0x00C4,0x00C5,0x00C6,0x00C7,0x00C8,0x00C9,0x00CA,0x00CB,0x00CC,0x00CD,0x00CE,0x00CF,
+    0x00D0,0x00D1,0x00D2,0x00D3,0x00D4,0x00D5,0x00D6,0x00D7,0x00D8,0x00D9,0x00DA,0x00DB,0x00DC,0x00DD,0x00DE,0x00DF,
+    0x00E0,0x00E1,0x00E2,0x00E3,0x00E4,0x00E5,0x00E6,0x00E7,0x00E8,0x00E9,0x00EA,0x00EB,0x00EC,0x00ED,0x00EE,0x00EF,
+    0x00F0,0x00F1,0x00F2,0x00F3,0x00F4,0x00F5,0x00F6,0x00F7,0x00F8,0x00F9,0x00FA,0x00FB,0x00FC,0x00FD,0x00FE,0x00FF
+};
+
+static const unsigned short s_CodePageCP1251[128] = 
+{
+    0x0402,0x0403,0x201A,0x0453,0x201E,0x2026,0x2020,0x2021,0x20AC,0x2030,0x0409,0x2039,0x040A,0x040C,0x040B,0x040F,
+    0x0452,0x2018,0x2019,0x201C,0x201D,0x2022,0x2013,0x2014,0,0x2122,0x0459,0x203A,0x045A,0x045C,0x045B,0x045F,
+    0x00A0,0x040E,0x045E,0x0408,0x00A4,0x0490,0x00A6,0x00A7,0x0401,0x00A9,0x0404,0x00AB,0x00AC,0x00AD,0x00AE,0x0407,
+    0x00B0,0x00B1,0x0406,0x0456,0x0491,0x00B5,0x00B6,0x00B7,0x0451,0x2116,0x0454,0x00BB,0x0458,0x0405,0x0455,0x0457,
+    0x0410,0x0411,0x0412,0x0413,0x0414,0x0415,0x0416,0x0417,0x0418,0x0419,0x041A,0x041B,0x041C,0x041D,0x041E,0x041F,
+    0x0420,0x0421,0x0422,0x0423,0x0424,0x0425,0x0426,0x0427,0x0428,0x0429,0x042A,0x042B,0x042C,0x042D,0x042E,0x042F,
+    0x0430,0x0431,0x0432,0x0433,0x0434,0x0435,0x0436,0x0437,0x0438,0x0439,0x043A,0x043B,0x043C,0x043D,0x043E,0x043F,
+    0x0440,0x0441,0x0442,0x0443,0x0444,0x0445,0x0446,0x0447,0x0448,0x0449,0x044A,0x044B,0x044C,0x044D,0x044E,0x044F
+};
+
+//  ---------------------------------------------------------------------------
+
 const char *g_ErrBadFontHeight = "Cannot determine font height while reading font bitmap (check first pixel column)";
 
-CTexFont *TwGenerateFont(const unsigned char *_Bitmap, int _BmWidth, int _BmHeight, float _Scaling)
+CTexFont *TwGenerateFont(const unsigned char *_Bitmap, int _BmWidth, int _BmHeight, float _Scaling, bool _SDF)
 {
     // find height of the font
     int x, y;
@@ -135,11 +288,13 @@ CTexFont *TwGenerateFont(const unsigned char *_Bitmap, int _BmWidth, int _BmHeig
     // - Second, build the texture
     CTexFont *TexFont = new CTexFont;
     TexFont->m_NbCharRead = ch-32;
-    TexFont->m_CharHeight = (int)(_Scaling*h+0.5f);
     TexFont->m_TexWidth = NextPow2(lmax);
     TexFont->m_TexHeight = NextPow2(14*(h+MARGIN_Y));
     TexFont->m_TexBytes = new unsigned char[TexFont->m_TexWidth*TexFont->m_TexHeight];
     memset(TexFont->m_TexBytes, 0, TexFont->m_TexWidth*TexFont->m_TexHeight);
+    TexFont->m_GlyphHeight = h;
+    TexFont->m_CacheY0 = 14*(h+MARGIN_Y);
+    TexFont->m_CacheCellWidth = (h<TexFont->m_TexWidth-MARGIN_X) ? h : TexFont->m_TexWidth-MARGIN_X;
     int xx;
     float du = 0.4f;
     float dv = 0.4f;
@@ -157,6 +312,7 @@ CTexFont *TwGenerateFont(const unsigned char *_Bitmap, int _BmWidth, int _BmHeig
             dv = 0.5f;
         }
     }
+    TexFont->m_TexelOffset = du;
     float alpha;
     for( r=0; r<14; ++r )
         for( xx=0, ch=r*16; ch<(r+1)*16; ++ch )
@@ -174,7 +330,7 @@ CTexFont *TwGenerateFont(const unsigned char *_Bitmap, int _BmWidth, int _BmHeig
                 TexFont->m_CharU1[ch+32] = (float(xx)+du)/float(TexFont->m_TexWidth);
                 TexFont->m_CharV0[ch+32] = (float(r*(h+MARGIN_Y))+dv)/float(TexFont->m_TexHeight);
                 TexFont->m_CharV1[ch+32] = (float(r*(h+MARGIN_Y)+h)+dv)/float(TexFont->m_TexHeight);
-                TexFont->m_CharWidth[ch+32] = (int)(_Scaling*(x1[ch]-x0[ch]+1)+0.5f);
+                TexFont->m_CharTexWidth[ch+32] = x1[ch]-x0[ch]+1;
                 xx += MARGIN_X;
             }
 
@@ -185,7 +341,23 @@ CTexFont *TwGenerateFont(const unsigned char *_Bitmap, int _BmWidth, int _BmHeig
         TexFont->m_CharU1[ch] = TexFont->m_CharU1[Undef];
         TexFont->m_CharV0[ch] = TexFont->m_CharV0[Undef];
         TexFont->m_CharV1[ch] = TexFont->m_CharV1[Undef];
-        TexFont->m_CharWidth[ch] = TexFont->m_CharWidth[Undef]/2;
+    }
+    TexFont->SetScaling(_Scaling);
+    TexFont->SetCodePage(s_CodePageCP1252);
+
+    // Replace the alpha texture by its distance field (UVs are unchanged)
+    if( _SDF && TwSupportSDFFonts() )
+    {
+        int w = TexFont->m_TexWidth;
+        int h = TexFont->m_TexHeight;
+        unsigned char *SDFBytes = new unsigned char[SDF_UPSCALE*w*SDF_UPSCALE*h];
+        ComputeSDF(TexFont->m_TexBytes, w, h, w, SDFBytes, SDF_UPSCALE*w);
+        delete[] TexFont->m_TexBytes;
+        TexFont->m_TexBytes = SDFBytes;
+        TexFont->m_TexWidth = SDF_UPSCALE*w;
+        TexFont->m_TexHeight = SDF_UPSCALE*h;
+        TexFont->m_TexScale = SDF_UPSCALE;
+        TexFont->m_SDF = true;
     }
 
     return TexFont;
@@ -193,6 +365,329 @@ CTexFont *TwGenerateFont(const unsigned char *_Bitmap, int _BmWidth, int _BmHeig
 
 //  ---------------------------------------------------------------------------
 
+// Scaled bitmap font: a distance field (SDF font) can be shared by views of
+// any size, which only differ by their metrics and never upload a texture
+CTexFont *TwGenerateFontView(const CTexFont *_Atlas, int _GlyphHeight, float _Scaling)
+{
+    assert( _Atlas!=NULL && _Atlas->m_Atlas==NULL && _Atlas->m_GlyphHeight>0 );
+    CTexFont *View = new CTexFont;
+    View->m_Atlas = _Atlas;
+    View->m_AtlasScale = float(_GlyphHeight)/float(_Atlas->m_GlyphHeight);
+    View->m_NbCharRead = _Atlas->m_NbCharRead;
+    View->m_SDF = _Atlas->m_SDF;
+    View->m_TexScale = _Atlas->m_TexScale;
+    View->m_GlyphHeight = _Atlas->m_GlyphHeight;
+    View->m_TexelOffset = _Atlas->m_TexelOffset;
+    View->SetScaling(_Scaling);
+    return View;
+}
+
+//  ---------------------------------------------------------------------------
+
+void CTexFont::SetScaling(float _Scaling)
+{
+    const int Undef = 127;
+    const CTexFont *Glyphs = Atlas();
+    float Scale = _Scaling*m_AtlasScale;
+    m_Scaling = _Scaling;
+    m_CharHeight = (int)(Scale*m_GlyphHeight+0.5f);
+    for( int i=32; i<TW_FONT_NB_SLOTS; ++i )
+        m_CharWidth[i] = (int)(Scale*Glyphs->m_CharTexWidth[i]+0.5f);
+    for( int i=0; i<32; ++i )
+        m_CharWidth[i] = m_CharWidth[Undef]/2;
+}
+
+//  ---------------------------------------------------------------------------
+
+float CTexFont::SDFEdgeWidth() const
+{
+    // half a screen pixel, expressed in normalized distance
+    float PixelsPerTexel = (m_GlyphHeight>0) ? float(m_CharHeight)/float(m_GlyphHeight*m_TexScale) : 1.0f;
+    if( PixelsPerTexel<0.01f )
+        PixelsPerTexel = 0.01f;
+    return 0.5f/(PixelsPerTexel*float(2*SDF_SPREAD));
+}
+
+//  ---------------------------------------------------------------------------
+
+void CTexFont::SetCodePage(const unsigned short *_CodePage)
+{
+    // Map the unicode code points of the static glyphs 128-255 to their slots
+    for( CGlyphMap::iterator it=m_GlyphMap.begin(); it!=m_GlyphMap.end(); )
+        if( it->second<TW_FONT_NB_STATIC_SLOTS )
+            m_GlyphMap.erase(it++);
+        else
+            ++it;
+    for( int ch=128; ch<256; ++ch )
+        if( _CodePage[ch-128]!=0 )
+            m_GlyphMap[_CodePage[ch-128]] = ch;
+}
+
+//  ---------------------------------------------------------------------------
+
+int CTexFont::DecodeGlyph(const unsigned char *_Text, int _Len, int *_Pos) const
+{
+    if( m_Atlas!=NULL )
+        return ViewGlyph(m_Atlas->DecodeGlyph(_Text, _Len, _Pos));
+
+    int i = *_Pos;
+    unsigned char c = _Text[i];
+    int n = 0;
+    if( c>=0xC2 && c<0xE0 )
+        n = 1;
+    else if( c>=0xE0 && c<0xF0 )
+        n = 2;
+    else if( c>=0xF0 && c<0xF5 )
+        n = 3;
+
+    if( n>0 && i+n<_Len )
+    {
+        unsigned int cp = c & (0x3F>>n);
+        int k;
+        for( k=1; k<=n && (_Text[i+k]&0xC0)==0x80; ++k )
+            cp = (cp<<6) | (_Text[i+k]&0x3F);
+        if( k>n && !(n==2 && cp<0x800) && !(n==3 && cp<0x10000) && !(cp>=0xD800 && cp<0xE000) && cp<0x110000 )
+        {
+            *_Pos = i+n+1;
+            return GlyphFromCodePoint(cp);
+        }
+    }
+
+    // not a valid UTF-8 sequence: legacy single byte character
+    *_Pos = i+1;
+    return c;
+}
+
+//  ---------------------------------------------------------------------------
+
+int CTexFont::GlyphFromCodePoint(unsigned int _CodePoint) const
+{
+    if( _CodePoint<0x80 )
+        return (int)_CodePoint;
+    if( m_Atlas!=NULL )
+        return ViewGlyph(m_Atlas->GlyphFromCodePoint(_CodePoint));
+
+    int Slot;
+    CGlyphMap::const_iterator it = m_GlyphMap.find(_CodePoint);
+    if( it!=m_GlyphMap.end() )
+    {
+        Slot = it->second;
+        if( Slot>=TW_FONT_NB_STATIC_SLOTS )
+            m_SlotLastUse[Slot-TW_FONT_NB_STATIC_SLOTS] = ++m_CacheClock;
+    }
+    else
+        Slot = CacheGlyph(_CodePoint);
+    if( g_TwGlyphUses!=NULL && Slot>=TW_FONT_NB_STATIC_SLOTS )
+        g_TwGlyphUses->Add(this, Slot);
+    return Slot;
+}
+
+//  ---------------------------------------------------------------------------
+
+// Glyph slots of a view are those of its atlas, which may have cached (or
+// recycled) the slot since the view computed its width
+int CTexFont::ViewGlyph(int _Slot) const
+{
+    if( _Slot>=TW_FONT_NB_STATIC_SLOTS )
+        m_CharWidth[_Slot] = (int)(m_Scaling*m_AtlasScale*m_Atlas->m_CharTexWidth[_Slot]+0.5f);
+    return _Slot;
+}
+
+//  ---------------------------------------------------------------------------
+
+int CTexFont::TextWidth(const char *_Text, int _Len) const
+{
+    const unsigned char *Text = (const unsigned char *)_Text;
+    int w = 0;
+    for( int i=0; i<_Len; )
+        w += m_CharWidth[NextGlyph(Text, _Len, &i)];
+    return w;
+}
+
+//  ---------------------------------------------------------------------------
+
+const int CACHE_MARGIN = 2;
+
+bool CTexFont::ReserveCacheCell(int _CacheSlot) const
+{
+    int NbCellsPerRow = (m_TexWidth/m_TexScale-CACHE_MARGIN) / (m_CacheCellWidth+CACHE_MARGIN);
+    if( NbCellsPerRow<=0 || m_GlyphHeight<=0 )
+        return false;
+    int y = m_CacheY0 + (_CacheSlot/NbCellsPerRow)*(m_GlyphHeight+CACHE_MARGIN);
+    int yEnd = (y+m_GlyphHeight)*m_TexScale;   // in texels
+    if( yEnd<=m_TexHeight )
+        return true;
+
+    // Grow the texture: existing texels are kept, V coords are rescaled
+    CTexFont *Font = const_cast<CTexFont *>(this);
+    int NewHeight = 2*m_TexHeight;
+    while( yEnd>NewHeight )
+        NewHeight *= 2;
+    unsigned char *NewBytes = new unsigned char[m_TexWidth*NewHeight];
+    memcpy(NewBytes, m_TexBytes, m_TexWidth*m_TexHeight);
+    memset(NewBytes+m_TexWidth*m_TexHeight, 0, m_TexWidth*(NewHeight-m_TexHeight));
+    delete[] Font->m_TexBytes;
+    Font->m_TexBytes = NewBytes;
+    float Ratio = float(m_TexHeight)/float(NewHeight);
+    for( int i=0; i<TW_FONT_NB_SLOTS; ++i )
+    {
+        Font->m_CharV0[i] *= Ratio;
+        Font->m_CharV1[i] *= Ratio;
+    }
+    Font->m_TexHeight = NewHeight;
+    ++m_TexVersion;
+    ++g_TwFontGeneration;
+    return true;
+}
+
+//  ---------------------------------------------------------------------------
+
+TwRasterizeGlyph g_RasterizeGlyph = NULL;
+void *g_RasterizeGlyphClientData = NULL;
+int g_TwFontGeneration = 0;
+
+int CTexFont::CacheGlyph(unsigned int _CodePoint) const
+{
+    if( g_RasterizeGlyph==NULL || m_TexBytes==NULL )
+    {
+        m_GlyphMap[_CodePoint] = TW_FONT_UNDEF_SLOT;
+        return TW_FONT_UNDEF_SLOT;
+    }
+
+    // Find a free cache slot, or evict the least recently used one
+    int s;
+    if( m_NbCachedSlots<TW_FONT_NB_CACHED_SLOTS )
+    {
+        s = m_NbCachedSlots;
+        if( !ReserveCacheCell(s) )
+        {
+            m_GlyphMap[_CodePoint] = TW_FONT_UNDEF_SLOT;
+            return TW_FONT_UNDEF_SLOT;
+        }
+    }
+    else
+    {
+        s = 0;
+        for( int i=1; i<TW_FONT_NB_CACHED_SLOTS; ++i )
+            if( m_SlotLastUse[i]<m_SlotLastUse[s] )
+                s = i;
+        CGlyphMap::iterator it = m_GlyphMap.find(m_SlotCodePoint[s]);
+        if( it!=m_GlyphMap.end() && it->second==TW_FONT_NB_STATIC_SLOTS+s )
+            m_GlyphMap.erase(it);
+        m_SlotLastUse[s] = 0;
+        // only the texts which used the slot are rebuilt (see CTwGlyphUses),
+        // the texture upload is triggered by m_TexVersion
+        m_SlotEviction[s] = ++m_NbEvictions;
+    }
+
+    // Rasterize the glyph
+    int w = m_CacheCellWidth;
+    int h = m_GlyphHeight;
+    std::vector<unsigned char> Bitmap(w*h, 0);
+    int GlyphWidth = g_RasterizeGlyph(_CodePoint, &(Bitmap[0]), w, h, g_RasterizeGlyphClientData);
+    if( GlyphWidth<=0 )
+    {
+        m_GlyphMap[_CodePoint] = TW_FONT_UNDEF_SLOT;
+        return TW_FONT_UNDEF_SLOT;
+    }
+    if( GlyphWidth>w )
+        GlyphWidth = w;
+    if( s==m_NbCachedSlots )
+        ++m_NbCachedSlots;
+
+    // Copy it to its texture cell (coordinates in texels)
+    CTexFont *Font = const_cast<CTexFont *>(this);
+    int NbCellsPerRow = (m_TexWidth/m_TexScale-CACHE_MARGIN) / (w+CACHE_MARGIN);
+    int x0 = m_TexScale*(CACHE_MARGIN + (s%NbCellsPerRow)*(w+CACHE_MARGIN));
+    int y0 = m_TexScale*(m_CacheY0 + (s/NbCellsPerRow)*(h+CACHE_MARGIN));
+    if( m_SDF )
+    {
+        // compute the distance field on a padded copy so that glyph borders are not truncated
+        const int P = CACHE_MARGIN;
+        int pw = w+2*P, ph = h+2*P;
+        std::vector<unsigned char> Padded(pw*ph, 0);
+        for( int y=0; y<h; ++y )
+            memcpy(&(Padded[(y+P)*pw+P]), &(Bitmap[y*w]), w);
+        std::vector<unsigned char> Dist(SDF_UPSCALE*pw*SDF_UPSCALE*ph);
+        ComputeSDF(&(Padded[0]), pw, ph, pw, &(Dist[0]), SDF_UPSCALE*pw);
+        for( int y=0; y<SDF_UPSCALE*h; ++y )
+            memcpy(m_TexBytes+(y0+y)*m_TexWidth+x0, &(Dist[(y+SDF_UPSCALE*P)*SDF_UPSCALE*pw+SDF_UPSCALE*P]), SDF_UPSCALE*w);
+    }
+    else
+        for( int y=0; y<h; ++y )
+            memcpy(m_TexBytes+(y0+y)*m_TexWidth+x0, &(Bitmap[y*w]), w);
+    int Slot = TW_FONT_NB_STATIC_SLOTS + s;
+    Font->m_CharU0[Slot] = (float(x0)+m_TexelOffset)/float(m_TexWidth);
+    Font->m_CharU1[Slot] = (float(x0+m_TexScale*GlyphWidth)+m_TexelOffset)/float(m_TexWidth);
+    Font->m_CharV0[Slot] = (float(y0)+m_TexelOffset)/float(m_TexHeight);
+    Font->m_CharV1[Slot] = (float(y0+m_TexScale*h)+m_TexelOffset)/float(m_TexHeight);
+    Font->m_CharTexWidth[Slot] = GlyphWidth;
+    Font->m_CharWidth[Slot] = (int)(m_Scaling*GlyphWidth+0.5f);
+    m_SlotCodePoint[s] = _CodePoint;
+    m_SlotLastUse[s] = ++m_CacheClock;
+    m_GlyphMap[_CodePoint] = Slot;
+    ++m_TexVersion;
+
+    return Slot;
+}
+
+//  ---------------------------------------------------------------------------
+
+CTwGlyphUses *g_TwGlyphUses = NULL;
+
+void CTwGlyphUses::Add(const CTexFont *_Atlas, int _Slot)
+{
+    CAtlasUses *Uses = NULL;
+    for( size_t i=0; i<m_Atlases.size(); ++i )
+        if( m_Atlases[i].m_Atlas==_Atlas )
+            Uses = &m_Atlases[i];
+    if( Uses==NULL )
+    {
+        m_Atlases.push_back(CAtlasUses());
+        Uses = &m_Atlases.back();
+        Uses->m_Atlas = _Atlas;
+        Uses->m_NbEvictions = _Atlas->m_NbEvictions;
+        memset(Uses->m_Slots, 0, sizeof(Uses->m_Slots));
+    }
+    int s = _Slot-TW_FONT_NB_STATIC_SLOTS;
+    Uses->m_Slots[s/32] |= 1U<<(s%32);
+}
+
+bool CTwGlyphUses::Evicted()
+{
+    for( size_t i=0; i<m_Atlases.size(); ++i )
+    {
+        CAtlasUses& Uses = m_Atlases[i];
+        if( Uses.m_Atlas->m_NbEvictions==Uses.m_NbEvictions )
+            continue;   // fast path: nothing evicted from this atlas
+        for( int s=0; s<TW_FONT_NB_CACHED_SLOTS; ++s )
+            if( (Uses.m_Slots[s/32]&(1U<<(s%32)))!=0 && Uses.m_Atlas->m_SlotEviction[s]>Uses.m_NbEvictions )
+                return true;
+        Uses.m_NbEvictions = Uses.m_Atlas->m_NbEvictions;  // evicted slots were not used here
+    }
+    return false;
+}
+
+//  ---------------------------------------------------------------------------
+
+void TwResetGlyphCaches()
+{
+    CTexFont *Fonts[] = { g_DefaultSmallFont, g_DefaultNormalFont, g_DefaultLargeFont, g_DefaultFixed1Font, g_DefaultFixedRuFont };
+    for( int i=0; i<(int)(sizeof(Fonts)/sizeof(Fonts[0])); ++i )
+        if( Fonts[i]!=NULL )
+        {
+            for( CTexFont::CGlyphMap::iterator it=Fonts[i]->m_GlyphMap.begin(); it!=Fonts[i]->m_GlyphMap.end(); )
+                if( it->second>=TW_FONT_NB_STATIC_SLOTS || it->second==TW_FONT_UNDEF_SLOT )
+                    Fonts[i]->m_GlyphMap.erase(it++);
+                else
+                    ++it;
+            Fonts[i]->m_NbCachedSlots = 0;
+        }
+    ++g_TwFontGeneration;
+}
+
+//  ---------------------------------------------------------------------------
+
 CTexFont *g_DefaultSmallFont = NULL;
 CTexFont *g_DefaultNormalFont = NULL;
 CTexFont *g_DefaultLargeFont = NULL;
@@ -4871,18 +5366,68 @@ static const unsigned char s_FontFixed1[] = {
 
 #include "res/RuFont.txt"
 
-void TwGenerateDefaultFonts(float _Scaling)
+// Sets _Font to _NewFont, in place if it already exists (bars keep pointers to it)
+static void ReplaceDefaultFont(CTexFont *& _Font, CTexFont *_NewFont)
+{
+    assert(_NewFont && _NewFont->m_NbCharRead==224);
+    if( _Font==NULL || _NewFont==NULL )
+    {
+        _Font = _NewFont;
+        return;
+    }
+    unsigned char *OldBytes = _Font->m_TexBytes;
+    int Version = _Font->m_TexVersion;
+    *_Font = *_NewFont;
+    _Font->m_TexVersion = Version+1;
+    _NewFont->m_TexBytes = OldBytes; // released with _NewFont
+    delete _NewFont;
+}
+
+static void GenerateDefaultFont(CTexFont *& _Font, const unsigned char *_Bitmap, int _BmWidth, int _BmHeight, float _Scaling, bool _SDF)
+{
+    ReplaceDefaultFont(_Font, TwGenerateFont(_Bitmap, _BmWidth, _BmHeight, _Scaling, _SDF));
+}
+
+// Height of the glyphs of a source bitmap (see TwGenerateFont)
+static int BitmapGlyphHeight(const unsigned char *_Bitmap, int _BmWidth, int _BmHeight)
+{
+    for( int y=0; y<_BmHeight; ++y )
+        if( _Bitmap[y*_BmWidth]==0 )
+            return y;
+    return _BmHeight;
+}
+
+void TwGenerateDefaultFonts(float _Scaling, bool _SDF)
+{
+    // the large font is generated first: with SDF fonts, the small and normal
+    // sizes are views of its atlas, so changing fontsize uploads no texture
+    GenerateDefaultFont(g_DefaultLargeFont, s_Font2AA, FONT2AA_BM_W, FONT2AA_BM_H, _Scaling, _SDF);
+    if( g_DefaultLargeFont!=NULL && g_DefaultLargeFont->m_SDF )
+    {
+        ReplaceDefaultFont(g_DefaultSmallFont, TwGenerateFontView(g_DefaultLargeFont, BitmapGlyphHeight(s_Font0, FONT0_BM_W, FONT0_BM_H), _Scaling));
+        ReplaceDefaultFont(g_DefaultNormalFont, TwGenerateFontView(g_DefaultLargeFont, BitmapGlyphHeight(s_Font1AA, FONT1AA_BM_W, FONT1AA_BM_H), _Scaling));
+    }
+    else
+    {
+        GenerateDefaultFont(g_DefaultSmallFont, s_Font0, FONT0_BM_W, FONT0_BM_H, _Scaling, _SDF);
+        GenerateDefaultFont(g_DefaultNormalFont, s_Font1AA, FONT1AA_BM_W, FONT1AA_BM_H, _Scaling, _SDF);
+    }
+    GenerateDefaultFont(g_DefaultFixed1Font, s_FontFixed1, FONTFIXED1_BM_W, FONTFIXED1_BM_H, _Scaling, _SDF);
+    GenerateDefaultFont(g_DefaultFixedRuFont, s_FontFixedRU, FONTFIXEDRU_BM_W, FONTFIXEDRU_BM_H, _Scaling, _SDF);
+    if( g_DefaultFixedRuFont )
+        g_DefaultFixedRuFont->SetCodePage(s_CodePageCP1251);
+    ++g_TwFontGeneration;
+}
+
+//  ---------------------------------------------------------------------------
+
+void TwScaleDefaultFonts(float _Scaling)
 {
-    g_DefaultSmallFont = TwGenerateFont(s_Font0, FONT0_BM_W, FONT0_BM_H, _Scaling);
-    assert(g_DefaultSmallFont && g_DefaultSmallFont->m_NbCharRead==224);
-    g_DefaultNormalFont = TwGenerateFont(s_Font1AA, FONT1AA_BM_W, FONT1AA_BM_H, _Scaling);
-    assert(g_DefaultNormalFont && g_DefaultNormalFont->m_NbCharRead==224);
-    g_DefaultLargeFont = TwGenerateFont(s_Font2AA, FONT2AA_BM_W, FONT2AA_BM_H, _Scaling);
-    assert(g_DefaultLargeFont && g_DefaultLargeFont->m_NbCharRead==224);
-    g_DefaultFixed1Font = TwGenerateFont(s_FontFixed1, FONTFIXED1_BM_W, FONTFIXED1_BM_H, _Scaling);
-    assert(g_DefaultFixed1Font && g_DefaultFixed1Font->m_NbCharRead==224);
-    g_DefaultFixedRuFont = TwGenerateFont(s_FontFixedRU, FONTFIXEDRU_BM_W, FONTFIXEDRU_BM_H, _Scaling);
-    assert(g_DefaultFixedRuFont && g_DefaultFixedRuFont->m_NbCharRead==224);
+    CTexFont *Fonts[] = { g_DefaultSmallFont, g_DefaultNormalFont, g_DefaultLargeFont, g_DefaultFixed1Font, g_DefaultFixedRuFont };
+    for( int i=0; i<(int)(sizeof(Fonts)/sizeof(Fonts[0])); ++i )
+        if( Fonts[i]!=NULL )
+            Fonts[i]->SetScaling(_Scaling);
+    ++g_TwFontGeneration;
 }
 
 //  ---------------------------------------------------------------------------
@@ -15,6 +15,7 @@
 #define ANT_TW_FONTS_INCLUDED
 
 //#include <AntTweakBar.h>
+#include "TwAlloc.h"
 
 /*
 A source bitmap includes 224 characters starting from ascii char 32 (i.e. space) 
@@ -34,25 +35,92 @@ Last pixel row of a line of characters is a delimiter with color=zero at the las
 */
 
 
+/*
+Text strings are UTF-8 encoded. Glyphs are addressed through slots:
+- slots 0 to 255 are the static glyphs read from the source bitmap; codes 
+  below 128 are ASCII and are looked up directly (fast path),
+- slots 256 and above form a cache of glyphs rasterized on demand by the 
+  client (see TwRasterizeGlyphFunc). They are stored in extra texture rows 
+  and recycled in least-recently-used order.
+Bytes that are not part of a valid UTF-8 sequence are interpreted as a slot 
+of the font code page (Latin1/CP1252 or CP1251) for compatibility.
+*/
+
+enum ETexFontSlots
+{
+    TW_FONT_NB_STATIC_SLOTS = 256,
+    TW_FONT_NB_CACHED_SLOTS = 256,
+    TW_FONT_NB_SLOTS        = TW_FONT_NB_STATIC_SLOTS + TW_FONT_NB_CACHED_SLOTS,
+    TW_FONT_UNDEF_SLOT      = 127
+};
+
+
 struct CTexFont
 {
     unsigned char * m_TexBytes;
     int             m_TexWidth;     // power of 2
     int             m_TexHeight;    // power of 2
-    float           m_CharU0[256];
-    float           m_CharV0[256];
-    float           m_CharU1[256];
-    float           m_CharV1[256];
-    int             m_CharWidth[256];
+    float           m_CharU0[TW_FONT_NB_SLOTS];
+    float           m_CharV0[TW_FONT_NB_SLOTS];
+    float           m_CharU1[TW_FONT_NB_SLOTS];
+    float           m_CharV1[TW_FONT_NB_SLOTS];
+    mutable int     m_CharWidth[TW_FONT_NB_SLOTS];  // mutable: updated when a view resolves a glyph cached by its atlas
     int             m_CharHeight;
     int             m_NbCharRead;
+    mutable int     m_TexVersion;   // incremented each time m_TexBytes is modified
+    bool            m_SDF;          // texels store a signed distance to the glyph edges (0.5 on the edge)
+    int             m_TexScale;     // texture resolution relative to the source bitmap (>1 for SDF fonts)
+    const CTexFont *m_Atlas;        // font owning the texture and the glyph slots, NULL if this font owns them
+    float           m_AtlasScale;   // glyph height relative to the atlas glyph height (1 if this font owns its atlas)
 
     CTexFont();
     ~CTexFont();
+
+    // Returns the slot of the glyph starting at _Text[*_Pos] and moves *_Pos to the next glyph
+    inline int      NextGlyph(const unsigned char *_Text, int _Len, int *_Pos) const
+                    {
+                        unsigned char c = _Text[*_Pos];
+                        if( c<0x80 )
+                        {
+                            ++(*_Pos);
+                            return c;
+                        }
+                        return DecodeGlyph(_Text, _Len, _Pos);
+                    }
+    inline const CTexFont *Atlas() const { return (m_Atlas!=NULL) ? m_Atlas : this; } // texture and UVs to use for drawing
+    int             DecodeGlyph(const unsigned char *_Text, int _Len, int *_Pos) const;
+    int             GlyphFromCodePoint(unsigned int _CodePoint) const;
+    int             TextWidth(const char *_Text, int _Len) const;
+    void            SetCodePage(const unsigned short *_CodePage);
+    void            SetScaling(float _Scaling);     // only updates the metrics, the texture is unchanged
+    float           SDFEdgeWidth() const;           // smoothing half-width of SDF edges for the current scaling
+
+    int             m_CharTexWidth[TW_FONT_NB_SLOTS];   // unscaled width, in source bitmap pixels
+
+    // Glyph cache
+    int             m_GlyphHeight;  // unscaled height of a glyph, in source bitmap pixels
+    float           m_Scaling;
+    float           m_TexelOffset;  // texel alignment offset (for D3D)
+    int             m_CacheY0;      // first texture row used by the cache
+    int             m_CacheCellWidth;
+    mutable int     m_NbCachedSlots;
+    mutable unsigned int m_CacheClock;
+    mutable unsigned int m_SlotCodePoint[TW_FONT_NB_CACHED_SLOTS];
+    mutable unsigned int m_SlotLastUse[TW_FONT_NB_CACHED_SLOTS];
+    typedef std::map<unsigned int, int, std::less<unsigned int>, TTwAllocator<std::pair<const unsigned int, int> > > CGlyphMap;
+    mutable CGlyphMap m_GlyphMap;   // code point -> slot (for non-ASCII glyphs)
+    mutable unsigned int m_NbEvictions;
+    mutable unsigned int m_SlotEviction[TW_FONT_NB_CACHED_SLOTS];  // value of m_NbEvictions when the glyph of a slot has been evicted
+protected:
+    int             CacheGlyph(unsigned int _CodePoint) const;
+    bool            ReserveCacheCell(int _CacheSlot) const;
+    int             ViewGlyph(int _Slot) const;
 };
 
 
-CTexFont *TwGenerateFont(const unsigned char *_Bitmap, int _BmWidth, int _BmHeight, float _Scaling=1.0f);
+CTexFont *TwGenerateFont(const unsigned char *_Bitmap, int _BmWidth, int _BmHeight, float _Scaling=1.0f, bool _SDF=false);
+CTexFont *TwGenerateFontView(const CTexFont *_Atlas, int _GlyphHeight, float _Scaling=1.0f); // same glyphs drawn _GlyphHeight high from _Atlas texture
+bool TwSupportSDFFonts();
 
 
 extern CTexFont *g_DefaultSmallFont;
@@ -61,8 +129,33 @@ extern CTexFont *g_DefaultLargeFont;
 extern CTexFont *g_DefaultFixed1Font;
 extern CTexFont *g_DefaultFixedRuFont;
 
-void TwGenerateDefaultFonts(float _Scaling=1.0f);
+void TwGenerateDefaultFonts(float _Scaling=1.0f, bool _SDF=false);    // fonts already generated are regenerated in place
+void TwScaleDefaultFonts(float _Scaling);
 void TwDeleteDefaultFonts();
 
+// Incremented each time cached glyphs are moved: texts built before are invalid.
+extern int g_TwFontGeneration;
+
+// Cached slots used by a set of texts (those of a bar), recorded while
+// g_TwGlyphUses points to it. An evicted glyph only invalidates the texts
+// that used its slot.
+struct CTwGlyphUses
+{
+    struct CAtlasUses
+    {
+        const CTexFont *m_Atlas;
+        unsigned int    m_NbEvictions;  // m_Atlas->m_NbEvictions when the first slot has been recorded
+        unsigned int    m_Slots[TW_FONT_NB_CACHED_SLOTS/32];
+    };
+    std::vector<CAtlasUses> m_Atlases;
+
+    void            Clear() { m_Atlases.resize(0); }
+    void            Add(const CTexFont *_Atlas, int _Slot);
+    bool            Evicted();      // returns true if a recorded slot has been evicted since it has been used
+};
+extern CTwGlyphUses *g_TwGlyphUses;
+
+void TwResetGlyphCaches();
+
 
 #endif  // !defined ANT_TW_FONTS_INCLUDED
@@ -1,7 +1,7 @@
 //  ---------------------------------------------------------------------------
 //
 //  @file       TwGraph.h
-//  @brief      ITwGraph pure interface
+//  @brief      ITwGraph interface
 //  @author     Philippe Decaudin
 //  @license    This file is part of the AntTweakBar library.
 //              For conditions of distribution and use, see License.txt
@@ -16,6 +16,7 @@
 
 #include "TwColors.h"
 #include "TwFonts.h"
+#include "TwAlloc.h"
 
 
 //  ---------------------------------------------------------------------------
@@ -24,9 +25,10 @@
 #   undef DrawText
 #endif  // DrawText
 
-class ITwGraph
+class ITwGraph : public CTwAllocated
 {
 public:
+                        ITwGraph() : m_NbDrawCalls(0), m_NbUploadedBytes(0) {}
     virtual int         Init() = 0;
     virtual int         Shut() = 0;
     virtual void        BeginDraw(int _WndWidth, int _WndHeight) = 0;
@@ -51,6 +53,11 @@ public:
     virtual void        SetScissor(int _X0, int _Y0, int _Width, int _Height) = 0;
 
     virtual             ~ITwGraph() {}  // required by gcc
+
+    // Counters of the graphic API calls, collected into the frame stats by the
+    // thread which draws with this graph (TwDraw or TwSubmit)
+    int                 m_NbDrawCalls;
+    int                 m_NbUploadedBytes;
 };
 
 //  ---------------------------------------------------------------------------
@@ -0,0 +1,609 @@
+//  ---------------------------------------------------------------------------
+//
+//  @file       TwGraphRecorder.cpp
+//  @author     Philippe Decaudin
+//  @license    This file is part of the AntTweakBar library.
+//              For conditions of distribution and use, see License.txt
+//
+//  ---------------------------------------------------------------------------
+
+
+#include "TwPrecomp.h"
+#include "TwGraphRecorder.h"
+#include "TwMgr.h"
+
+using namespace std;
+
+//  ---------------------------------------------------------------------------
+
+void CTwCommandList::PushData(const void *_Data, size_t _Size)
+{
+    size_t Pos = m_Data.size();
+    m_Data.resize(Pos + _Size);
+    if( _Size>0 )
+        memcpy(&(m_Data[Pos]), _Data, _Size);
+}
+
+//  ---------------------------------------------------------------------------
+
+void CTwCommandList::PushArray(const void *_Data, size_t _Size)
+{
+    while( m_Data.size()%4!=0 )
+        m_Data.push_back(0);
+    PushData(_Data, _Size);
+}
+
+//  ---------------------------------------------------------------------------
+
+namespace
+{
+    struct CCmdReader
+    {
+        const unsigned char *m_Ptr;
+        const unsigned char *m_Start;
+
+        template<typename T> T Read()
+        {
+            T Value;
+            memcpy(&Value, m_Ptr, sizeof(T));
+            m_Ptr += sizeof(T);
+            return Value;
+        }
+        const void *ReadArray(size_t _Size)
+        {
+            while( (m_Ptr-m_Start)%4!=0 )
+                ++m_Ptr;
+            const void *Data = m_Ptr;
+            m_Ptr += _Size;
+            return Data;
+        }
+    };
+} // namespace
+
+void CTwCommandList::Replay(ITwGraph *_Graph) const
+{
+    if( m_Data.empty() )
+        return;
+
+    CCmdReader Rd;
+    Rd.m_Start = Rd.m_Ptr = &(m_Data[0]);
+    const unsigned char *End = Rd.m_Start + m_Data.size();
+    vector<string> Lines;
+    int X0, Y0, X1, Y1;
+    while( Rd.m_Ptr<End )
+    {
+        ECmd Cmd = (ECmd)Rd.Read<unsigned char>();
+        switch( Cmd )
+        {
+        case CMD_BEGIN_DRAW:
+            X1 = Rd.Read<int>();
+            Y1 = Rd.Read<int>();
+            _Graph->BeginDraw(X1, Y1);
+            break;
+        case CMD_END_DRAW:
+            _Graph->EndDraw();
+            break;
+        case CMD_LINE:
+            {
+                X0 = Rd.Read<int>(); Y0 = Rd.Read<int>(); X1 = Rd.Read<int>(); Y1 = Rd.Read<int>();
+                color32 Color0 = Rd.Read<color32>();
+                color32 Color1 = Rd.Read<color32>();
+                bool AntiAliased = Rd.Read<bool>();
+                _Graph->DrawLine(X0, Y0, X1, Y1, Color0, Color1, AntiAliased);
+            }
+            break;
+        case CMD_RECT:
+            {
+                X0 = Rd.Read<int>(); Y0 = Rd.Read<int>(); X1 = Rd.Read<int>(); Y1 = Rd.Read<int>();
+                color32 Colors[4];
+                for( int i=0; i<4; ++i )
+                    Colors[i] = Rd.Read<color32>();
+                _Graph->DrawRect(X0, Y0, X1, Y1, Colors[0], Colors[1], Colors[2], Colors[3]);
+            }
+            break;
+        case CMD_TRIANGLES:
+            {
+                int NbTriangles = Rd.Read<int>();
+                ITwGraph::Cull CullMode = (ITwGraph::Cull)Rd.Read<int>();
+                // backends only read the arrays
+                int *Vertices = (int *)Rd.ReadArray(6*NbTriangles*sizeof(int));
+                color32 *Colors = (color32 *)Rd.ReadArray(3*NbTriangles*sizeof(color32));
+                _Graph->DrawTriangles(NbTriangles, Vertices, Colors, CullMode);
+            }
+            break;
+        case CMD_BUILD_TEXT:
+            {
+                void *TextObj = Rd.Read<void *>();
+                const CTexFont *Font = Rd.Read<const CTexFont *>();
+                int Sep = Rd.Read<int>();
+                int BgWidth = Rd.Read<int>();
+                int NbLines = Rd.Read<int>();
+                Lines.resize(NbLines);
+                for( int i=0; i<NbLines; ++i )
+                {
+                    int Len = Rd.Read<int>();
+                    Lines[i].assign((const char *)Rd.m_Ptr, Len);
+                    Rd.m_Ptr += Len;
+                }
+                color32 *LineColors = NULL;
+                if( Rd.Read<bool>() )
+                    LineColors = (color32 *)Rd.ReadArray(NbLines*sizeof(color32));
+                color32 *LineBgColors = NULL;
+                if( Rd.Read<bool>() )
+                    LineBgColors = (color32 *)Rd.ReadArray(NbLines*sizeof(color32));
+                _Graph->BuildText(TextObj, NbLines>0 ? &(Lines[0]) : NULL, LineColors, LineBgColors, NbLines, Font, Sep, BgWidth);
+            }
+            break;
+        case CMD_TEXT:
+            {
+                void *TextObj = Rd.Read<void *>();
+                X0 = Rd.Read<int>(); Y0 = Rd.Read<int>();
+                color32 Color = Rd.Read<color32>();
+                color32 BgColor = Rd.Read<color32>();
+                _Graph->DrawText(TextObj, X0, Y0, Color, BgColor);
+            }
+            break;
+        case CMD_VIEWPORT:
+            {
+                X0 = Rd.Read<int>(); Y0 = Rd.Read<int>(); X1 = Rd.Read<int>(); Y1 = Rd.Read<int>();
+                int OffsetX = Rd.Read<int>();
+                int OffsetY = Rd.Read<int>();
+                _Graph->ChangeViewport(X0, Y0, X1, Y1, OffsetX, OffsetY);
+            }
+            break;
+        case CMD_RESTORE_VIEWPORT:
+            _Graph->RestoreViewport();
+            break;
+        case CMD_SCISSOR:
+            X0 = Rd.Read<int>(); Y0 = Rd.Read<int>(); X1 = Rd.Read<int>(); Y1 = Rd.Read<int>();
+            _Graph->SetScissor(X0, Y0, X1, Y1);
+            break;
+        case CMD_FONT:
+            {
+                CTexFont *Font = Rd.Read<CTexFont *>();
+                Font->m_Atlas = Rd.Read<const CTexFont *>();
+                Font->m_CharHeight = Rd.Read<int>();
+                Font->m_GlyphHeight = Rd.Read<int>();
+                Font->m_TexScale = Rd.Read<int>();
+                Font->m_SDF = Rd.Read<bool>();
+                Font->m_Scaling = Rd.Read<float>();
+                Font->m_AtlasScale = Rd.Read<float>();
+                memcpy(Font->m_CharWidth, Rd.ReadArray(sizeof(Font->m_CharWidth)), sizeof(Font->m_CharWidth));
+                if( Font->m_Atlas==NULL && Rd.Read<bool>() )    // atlas changed
+                {
+                    memcpy(Font->m_CharTexWidth, Rd.ReadArray(sizeof(Font->m_CharTexWidth)), sizeof(Font->m_CharTexWidth));
+                    memcpy(Font->m_CharU0, Rd.ReadArray(sizeof(Font->m_CharU0)), sizeof(Font->m_CharU0));
+                    memcpy(Font->m_CharV0, Rd.ReadArray(sizeof(Font->m_CharV0)), sizeof(Font->m_CharV0));
+                    memcpy(Font->m_CharU1, Rd.ReadArray(sizeof(Font->m_CharU1)), sizeof(Font->m_CharU1));
+                    memcpy(Font->m_CharV1, Rd.ReadArray(sizeof(Font->m_CharV1)), sizeof(Font->m_CharV1));
+                    ++Font->m_TexVersion;
+                }
+                if( Font->m_Atlas==NULL && Rd.Read<bool>() )    // texels changed
+                {
+                    int W = Rd.Read<int>();
+                    int H = Rd.Read<int>();
+                    if( W*H!=Font->m_TexWidth*Font->m_TexHeight )
+                    {
+                        delete[] Font->m_TexBytes;
+                        Font->m_TexBytes = new unsigned char[W*H];
+                    }
+                    memcpy(Font->m_TexBytes, Rd.ReadArray(W*H), W*H);
+                    Font->m_TexWidth = W;
+                    Font->m_TexHeight = H;
+                }
+            }
+            break;
+        default:
+            assert(false); // corrupted command list
+            return;
+        }
+    }
+}
+
+//  ---------------------------------------------------------------------------
+
+CTwGraphRecorder::CTwGraphRecorder(ITwGraph *_Target)
+{
+    assert(_Target!=NULL);
+    m_Target = _Target;
+    m_TextsLost = false;
+    m_RecordList = 0;
+    m_ReadyList = -1;
+    m_ReadySubmitted = false;
+    m_Drawing = false;
+    m_SubmittingList = -1;
+    m_SubmitTime = 0;
+    m_SubmitDrawCalls = 0;
+    m_SubmitUploadedBytes = 0;
+}
+
+//  ---------------------------------------------------------------------------
+
+CTwGraphRecorder::~CTwGraphRecorder()
+{
+    for( size_t i=0; i<m_ReplayFonts.size(); ++i )
+        delete m_ReplayFonts[i].m_Copy;
+}
+
+//  ---------------------------------------------------------------------------
+
+// Returns true with m_Mutex locked, or false (unlocked) if Submit did not
+// release the list within the same delay as TwFreeAsyncDrawing
+bool CTwGraphRecorder::LockIdle(int _List)
+{
+    const double SLEEP_MAX = 0.25; // wait at most 1/4 second
+    PerfTimer timer;
+    m_Mutex.Lock();
+    while( m_SubmittingList>=0 && (_List<0 || m_SubmittingList==_List) )
+    {
+        m_Mutex.Unlock();
+        if( timer.GetTime()>=SLEEP_MAX )
+            return false;
+        #if defined(ANT_WINDOWS)
+            Sleep(1); // milliseconds
+        #elif defined(ANT_UNIX) || defined(ANT_OSX)
+            usleep(1000); // microseconds
+        #endif
+        m_Mutex.Lock();
+    }
+    return true;
+}
+
+//  ---------------------------------------------------------------------------
+
+bool CTwGraphRecorder::BeginRecord()
+{
+    assert(!m_Drawing);
+    // only this thread changes m_ReadyList, so the list to record cannot become
+    // the one taken by Submit while waiting
+    m_Mutex.Lock();
+    m_RecordList = (m_ReadyList==0) ? 1 : 0;
+    m_Mutex.Unlock();
+    if( !LockIdle(m_RecordList) )
+        return false;
+
+    // the ready list will be replaced before being submitted: its texts must be rebuilt
+    bool Lost = (m_ReadyList>=0 && !m_ReadySubmitted && m_SubmittingList!=m_ReadyList);
+    m_Mutex.Unlock();
+    if( Lost )
+    {
+        m_TextsLost = true;
+        ResendFonts();
+    }
+
+    m_Lists[m_RecordList].Clear();
+    return true;
+}
+
+//  ---------------------------------------------------------------------------
+
+void CTwGraphRecorder::EndRecord()
+{
+    assert(!m_Drawing);
+    m_Mutex.Lock();
+    m_ReadyList = m_RecordList;
+    m_ReadySubmitted = false;
+    m_Mutex.Unlock();
+}
+
+//  ---------------------------------------------------------------------------
+
+int CTwGraphRecorder::Submit()
+{
+    m_Mutex.Lock();
+    int List = m_ReadyList;
+    if( List<0 )
+    {
+        m_Mutex.Unlock();
+        return 1; // nothing recorded
+    }
+    m_SubmittingList = List;
+    m_Mutex.Unlock();
+
+    PerfTimer timer;
+    m_Target->m_NbDrawCalls = 0;
+    m_Target->m_NbUploadedBytes = 0;
+    m_Lists[List].Replay(m_Target);
+
+    m_Mutex.Lock();
+    if( m_ReadyList==List )
+        m_ReadySubmitted = true;
+    m_SubmittingList = -1;
+    m_SubmitTime += 1000.0*timer.GetTime();
+    m_SubmitDrawCalls += m_Target->m_NbDrawCalls;
+    m_SubmitUploadedBytes += m_Target->m_NbUploadedBytes;
+    m_Mutex.Unlock();
+    return 1;
+}
+
+//  ---------------------------------------------------------------------------
+
+void CTwGraphRecorder::TakeSubmitStats(TwFrameStats& _Stats)
+{
+    m_Mutex.Lock();
+    _Stats.SubmitTime += m_SubmitTime;
+    _Stats.NbDrawCalls += m_SubmitDrawCalls;
+    _Stats.NbUploadedBytes += m_SubmitUploadedBytes;
+    m_SubmitTime = 0;
+    m_SubmitDrawCalls = 0;
+    m_SubmitUploadedBytes = 0;
+    m_Mutex.Unlock();
+}
+
+//  ---------------------------------------------------------------------------
+
+void CTwGraphRecorder::Discard()
+{
+    if( !LockIdle(-1) )
+    {
+        // Submit is stuck in a list: unpublish it, it is cleared by the next BeginRecord
+        m_Mutex.Lock();
+        bool Lost = (m_ReadyList>=0);
+        m_ReadyList = -1;
+        m_Mutex.Unlock();
+        if( Lost )
+        {
+            m_TextsLost = true;
+            ResendFonts();
+        }
+        return;
+    }
+    if( m_ReadyList<0 )
+    {
+        m_Mutex.Unlock();
+        return;
+    }
+    bool Lost = !m_ReadySubmitted;
+    m_ReadyList = -1;
+    m_Mutex.Unlock();
+    if( Lost )
+        m_TextsLost = true;
+    ResendFonts();
+    m_Lists[0].Clear();
+    m_Lists[1].Clear();
+}
+
+//  ---------------------------------------------------------------------------
+
+void CTwGraphRecorder::ResendFonts()
+{
+    for( size_t i=0; i<m_ReplayFonts.size(); ++i )
+    {
+        m_ReplayFonts[i].m_TexVersion = -1;
+        m_ReplayFonts[i].m_CharHeight = -1;
+        m_ReplayFonts[i].m_Scaling = 0;
+    }
+}
+
+//  ---------------------------------------------------------------------------
+
+// Glyph slots resolved at record time are passed to the replay copy as code
+// points of a private use plane, which its glyph map sends back to the slots
+const unsigned int REPLAY_GLYPH_BASE = 0xF0000;
+
+static void AppendGlyph(string& _Text, int _Slot)
+{
+    if( _Slot<0x80 )
+    {
+        _Text += (char)_Slot;
+        return;
+    }
+    unsigned int cp = REPLAY_GLYPH_BASE + (unsigned int)_Slot;
+    _Text += (char)(0xF0 | (cp>>18));
+    _Text += (char)(0x80 | ((cp>>12)&0x3F));
+    _Text += (char)(0x80 | ((cp>>6)&0x3F));
+    _Text += (char)(0x80 | (cp&0x3F));
+}
+
+// Replay copies mirror the atlas/view structure of the fonts, so that the views
+// of an atlas still share its texture when replayed
+const CTexFont *CTwGraphRecorder::ReplayFont(const CTexFont *_Font)
+{
+    const CTexFont *AtlasCopy = (_Font->m_Atlas!=NULL) ? ReplayFont(_Font->m_Atlas) : NULL;
+    size_t i;
+    for( i=0; i<m_ReplayFonts.size() && m_ReplayFonts[i].m_Source!=_Font; ++i ) {}
+    if( i==m_ReplayFonts.size() )
+    {
+        m_ReplayFonts.push_back(CReplayFont());
+        CReplayFont& New = m_ReplayFonts.back();
+        New.m_Source = _Font;
+        New.m_Copy = new CTexFont;
+        if( _Font->m_Atlas==NULL )
+            for( int s=0x80; s<TW_FONT_NB_SLOTS; ++s )
+                New.m_Copy->m_GlyphMap[REPLAY_GLYPH_BASE+s] = s;
+        New.m_TexVersion = -1;
+        New.m_CharHeight = -1;
+        New.m_Scaling = 0;
+    }
+    CReplayFont& Font = m_ReplayFonts[i];
+
+    bool AtlasChanged = (_Font->m_Atlas==NULL && Font.m_TexVersion!=_Font->m_TexVersion);
+    if( AtlasChanged || Font.m_CharHeight!=_Font->m_CharHeight || Font.m_Scaling!=_Font->m_Scaling
+        || memcmp(Font.m_CharWidth, _Font->m_CharWidth, sizeof(Font.m_CharWidth))!=0 )
+    {
+        CTwCommandList& List = m_Lists[m_RecordList];
+        List.PushCmd(CTwCommandList::CMD_FONT);
+        List.Push(Font.m_Copy);
+        List.Push(AtlasCopy);
+        List.Push(_Font->m_CharHeight);
+        List.Push(_Font->m_GlyphHeight);
+        List.Push(_Font->m_TexScale);
+        List.Push(_Font->m_SDF);
+        List.Push(_Font->m_Scaling);
+        List.Push(_Font->m_AtlasScale);
+        List.PushArray(_Font->m_CharWidth, sizeof(_Font->m_CharWidth));
+        if( _Font->m_Atlas==NULL )
+        {
+            List.Push(AtlasChanged);
+            if( AtlasChanged )
+            {
+                List.PushArray(_Font->m_CharTexWidth, sizeof(_Font->m_CharTexWidth));
+                List.PushArray(_Font->m_CharU0, sizeof(_Font->m_CharU0));
+                List.PushArray(_Font->m_CharV0, sizeof(_Font->m_CharV0));
+                List.PushArray(_Font->m_CharU1, sizeof(_Font->m_CharU1));
+                List.PushArray(_Font->m_CharV1, sizeof(_Font->m_CharV1));
+            }
+            bool Texels = (AtlasChanged && _Font->m_TexBytes!=NULL);
+            List.Push(Texels);
+            if( Texels )
+            {
+                List.Push(_Font->m_TexWidth);
+                List.Push(_Font->m_TexHeight);
+                List.PushArray(_Font->m_TexBytes, _Font->m_TexWidth*_Font->m_TexHeight);
+            }
+            Font.m_TexVersion = _Font->m_TexVersion;
+        }
+        Font.m_CharHeight = _Font->m_CharHeight;
+        Font.m_Scaling = _Font->m_Scaling;
+        memcpy(Font.m_CharWidth, _Font->m_CharWidth, sizeof(Font.m_CharWidth));
+    }
+    return Font.m_Copy;
+}
+
+//  ---------------------------------------------------------------------------
+
+void CTwGraphRecorder::BeginDraw(int _WndWidth, int _WndHeight)
+{
+    assert(m_Drawing==false && _WndWidth>0 && _WndHeight>0);
+    m_Drawing = true;
+    CTwCommandList& List = m_Lists[m_RecordList];
+    List.PushCmd(CTwCommandList::CMD_BEGIN_DRAW);
+    List.Push(_WndWidth);
+    List.Push(_WndHeight);
+}
+
+//  ---------------------------------------------------------------------------
+
+void CTwGraphRecorder::EndDraw()
+{
+    assert(m_Drawing==true);
+    m_Drawing = false;
+    m_Lists[m_RecordList].PushCmd(CTwCommandList::CMD_END_DRAW);
+}
+
+//  ---------------------------------------------------------------------------
+
+void CTwGraphRecorder::DrawLine(int _X0, int _Y0, int _X1, int _Y1, color32 _Color0, color32 _Color1, bool _AntiAliased)
+{
+    assert(m_Drawing==true);
+    CTwCommandList& List = m_Lists[m_RecordList];
+    List.PushCmd(CTwCommandList::CMD_LINE);
+    List.Push(_X0); List.Push(_Y0); List.Push(_X1); List.Push(_Y1);
+    List.Push(_Color0);
+    List.Push(_Color1);
+    List.Push(_AntiAliased);
+}
+
+//  ---------------------------------------------------------------------------
+
+void CTwGraphRecorder::DrawRect(int _X0, int _Y0, int _X1, int _Y1, color32 _Color00, color32 _Color10, color32 _Color01, color32 _Color11)
+{
+    assert(m_Drawing==true);
+    CTwCommandList& List = m_Lists[m_RecordList];
+    List.PushCmd(CTwCommandList::CMD_RECT);
+    List.Push(_X0); List.Push(_Y0); List.Push(_X1); List.Push(_Y1);
+    List.Push(_Color00); List.Push(_Color10); List.Push(_Color01); List.Push(_Color11);
+}
+
+//  ---------------------------------------------------------------------------
+
+void CTwGraphRecorder::DrawTriangles(int _NumTriangles, int *_Vertices, color32 *_Colors, Cull _CullMode)
+{
+    assert(m_Drawing==true);
+    if( _NumTriangles<=0 )
+        return;
+    CTwCommandList& List = m_Lists[m_RecordList];
+    List.PushCmd(CTwCommandList::CMD_TRIANGLES);
+    List.Push(_NumTriangles);
+    List.Push((int)_CullMode);
+    List.PushArray(_Vertices, 6*_NumTriangles*sizeof(int));
+    List.PushArray(_Colors, 3*_NumTriangles*sizeof(color32));
+}
+
+//  ---------------------------------------------------------------------------
+
+void CTwGraphRecorder::BuildText(void *_TextObj, const std::string *_TextLines, color32 *_LineColors, color32 *_LineBgColors, int _NbLines, const CTexFont *_Font, int _Sep, int _BgWidth)
+{
+    // Texts may be built outside BeginDraw/EndDraw (eg. when a bar is updated),
+    // they are recorded in the list being recorded and rebuilt at submit time.
+    if( _TextLines==NULL )
+        _NbLines = 0;
+
+    // resolve the glyphs now: this may cache glyphs in _Font, which the
+    // submitting thread must not see
+    if( (int)m_GlyphLines.size()<_NbLines )
+        m_GlyphLines.resize(_NbLines);
+    for( int i=0; i<_NbLines; ++i )
+    {
+        string& Glyphs = m_GlyphLines[i];
+        Glyphs.clear();
+        const unsigned char *Text = (const unsigned char *)_TextLines[i].c_str();
+        int Len = (int)_TextLines[i].length();
+        for( int j=0; j<Len; )
+            AppendGlyph(Glyphs, _Font->NextGlyph(Text, Len, &j));
+    }
+    const CTexFont *Font = ReplayFont(_Font);
+
+    CTwCommandList& List = m_Lists[m_RecordList];
+    List.PushCmd(CTwCommandList::CMD_BUILD_TEXT);
+    List.Push(_TextObj);
+    List.Push(Font);
+    List.Push(_Sep);
+    List.Push(_BgWidth);
+    List.Push(_NbLines);
+    for( int i=0; i<_NbLines; ++i )
+    {
+        int Len = (int)m_GlyphLines[i].length();
+        List.Push(Len);
+        List.PushData(m_GlyphLines[i].c_str(), Len);
+    }
+    List.Push(bool(_LineColors!=NULL && _NbLines>0));
+    if( _LineColors!=NULL && _NbLines>0 )
+        List.PushArray(_LineColors, _NbLines*sizeof(color32));
+    List.Push(bool(_LineBgColors!=NULL && _NbLines>0));
+    if( _LineBgColors!=NULL && _NbLines>0 )
+        List.PushArray(_LineBgColors, _NbLines*sizeof(color32));
+}
+
+//  ---------------------------------------------------------------------------
+
+void CTwGraphRecorder::DrawText(void *_TextObj, int _X, int _Y, color32 _Color, color32 _BgColor)
+{
+    assert(m_Drawing==true);
+    CTwCommandList& List = m_Lists[m_RecordList];
+    List.PushCmd(CTwCommandList::CMD_TEXT);
+    List.Push(_TextObj);
+    List.Push(_X);
+    List.Push(_Y);
+    List.Push(_Color);
+    List.Push(_BgColor);
+}
+
+//  ---------------------------------------------------------------------------
+
+void CTwGraphRecorder::ChangeViewport(int _X0, int _Y0, int _Width, int _Height, int _OffsetX, int _OffsetY)
+{
+    CTwCommandList& List = m_Lists[m_RecordList];
+    List.PushCmd(CTwCommandList::CMD_VIEWPORT);
+    List.Push(_X0); List.Push(_Y0); List.Push(_Width); List.Push(_Height);
+    List.Push(_OffsetX);
+    List.Push(_OffsetY);
+}
+
+//  ---------------------------------------------------------------------------
+
+void CTwGraphRecorder::RestoreViewport()
+{
+    m_Lists[m_RecordList].PushCmd(CTwCommandList::CMD_RESTORE_VIEWPORT);
+}
+
+//  ---------------------------------------------------------------------------
+
+void CTwGraphRecorder::SetScissor(int _X0, int _Y0, int _Width, int _Height)
+{
+    CTwCommandList& List = m_Lists[m_RecordList];
+    List.PushCmd(CTwCommandList::CMD_SCISSOR);
+    List.Push(_X0); List.Push(_Y0); List.Push(_Width); List.Push(_Height);
+}
+
+//  ---------------------------------------------------------------------------
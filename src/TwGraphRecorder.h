@@ -0,0 +1,165 @@
+//  ---------------------------------------------------------------------------
+//
+//  @file       TwGraphRecorder.h
+//  @brief      Draw command recording and replay (TwRecord/TwSubmit)
+//  @author     Philippe Decaudin
+//  @license    This file is part of the AntTweakBar library.
+//              For conditions of distribution and use, see License.txt
+//
+//  note:       Private header
+//
+//  ---------------------------------------------------------------------------
+
+
+#if !defined ANT_TW_GRAPH_RECORDER_INCLUDED
+#define ANT_TW_GRAPH_RECORDER_INCLUDED
+
+#include "TwGraph.h"
+
+//  ---------------------------------------------------------------------------
+
+// Backend-neutral list of ITwGraph calls stored in a single byte buffer.
+// Text objects referenced by the list belong to the replaying graph, fonts
+// referenced by the list are replay copies updated by CMD_FONT.
+class CTwCommandList
+{
+public:
+    enum ECmd
+    {
+        CMD_BEGIN_DRAW = 1,
+        CMD_END_DRAW,
+        CMD_LINE,
+        CMD_RECT,
+        CMD_TRIANGLES,
+        CMD_BUILD_TEXT,
+        CMD_TEXT,
+        CMD_VIEWPORT,
+        CMD_RESTORE_VIEWPORT,
+        CMD_SCISSOR,
+        CMD_FONT
+    };
+
+                        CTwCommandList() : m_NbCommands(0) {}
+    void                Clear()         { m_Data.clear(); m_NbCommands = 0; }
+    bool                Empty() const   { return m_NbCommands==0; }
+    int                 NbCommands() const { return m_NbCommands; }
+    size_t              Size() const    { return m_Data.size(); }
+
+    void                PushCmd(ECmd _Cmd) { Push((unsigned char)_Cmd); ++m_NbCommands; }
+    template<typename T> void Push(const T& _Value) { PushData(&_Value, sizeof(T)); }
+    void                PushData(const void *_Data, size_t _Size);
+    void                PushArray(const void *_Data, size_t _Size);  // 4-byte aligned
+    void                Replay(ITwGraph *_Graph) const;
+
+protected:
+    std::vector<unsigned char, TTwAllocator<unsigned char> > m_Data;
+    int                 m_NbCommands;
+};
+
+//  ---------------------------------------------------------------------------
+
+// Minimal mutex for the handoff between the recording and submitting threads
+class CTwMutex
+{
+public:
+#if defined(ANT_WINDOWS)
+                        CTwMutex()      { InitializeCriticalSection(&m_CS); }
+                        ~CTwMutex()     { DeleteCriticalSection(&m_CS); }
+    void                Lock()          { EnterCriticalSection(&m_CS); }
+    void                Unlock()        { LeaveCriticalSection(&m_CS); }
+private:
+    CRITICAL_SECTION    m_CS;
+#else
+                        CTwMutex()      { pthread_mutex_init(&m_Mutex, NULL); }
+                        ~CTwMutex()     { pthread_mutex_destroy(&m_Mutex); }
+    void                Lock()          { pthread_mutex_lock(&m_Mutex); }
+    void                Unlock()        { pthread_mutex_unlock(&m_Mutex); }
+private:
+    pthread_mutex_t     m_Mutex;
+#endif
+                        CTwMutex(const CTwMutex&);
+    CTwMutex&           operator=(const CTwMutex&);
+};
+
+//  ---------------------------------------------------------------------------
+
+// ITwGraph which records draw calls in a command list instead of issuing
+// graphic API calls. Recorded lists are replayed on the target graph by Submit.
+//
+// Threading: BeginRecord/EndRecord/Discard and the draw calls are made by the
+// thread which calls TwRecord and the other AntTweakBar functions. Submit may
+// run on another thread at the same time. The two threads only share the
+// list indices below, which are guarded by m_Mutex: a list is published by
+// EndRecord under the lock, so its content is visible to the thread which
+// takes it in Submit, and it is not written again until Submit is done with it.
+//
+// Texts are laid out when they are recorded: glyphs are resolved (and cached)
+// in the fonts of the recording thread, and the replay builds them with a
+// copy of each font which only the submitting thread reads and writes. The
+// copies are updated by CMD_FONT commands recorded when a font changes.
+class CTwGraphRecorder : public ITwGraph
+{
+public:
+                        CTwGraphRecorder(ITwGraph *_Target);
+    virtual             ~CTwGraphRecorder();
+    virtual int         Init()          { return 1; }
+    virtual int         Shut()          { return 1; }
+    virtual void        BeginDraw(int _WndWidth, int _WndHeight);
+    virtual void        EndDraw();
+    virtual bool        IsDrawing()     { return m_Drawing; }
+    virtual void        Restore()       { m_Target->Restore(); }
+    virtual void        DrawLine(int _X0, int _Y0, int _X1, int _Y1, color32 _Color0, color32 _Color1, bool _AntiAliased=false);
+    virtual void        DrawLine(int _X0, int _Y0, int _X1, int _Y1, color32 _Color, bool _AntiAliased=false) { DrawLine(_X0, _Y0, _X1, _Y1, _Color, _Color, _AntiAliased); }
+    virtual void        DrawRect(int _X0, int _Y0, int _X1, int _Y1, color32 _Color00, color32 _Color10, color32 _Color01, color32 _Color11);
+    virtual void        DrawRect(int _X0, int _Y0, int _X1, int _Y1, color32 _Color) { DrawRect(_X0, _Y0, _X1, _Y1, _Color, _Color, _Color, _Color); }
+    virtual void        DrawTriangles(int _NumTriangles, int *_Vertices, color32 *_Colors, Cull _CullMode);
+
+    virtual void *      NewTextObj()    { return m_Target->NewTextObj(); }
+    virtual void        DeleteTextObj(void *_TextObj) { m_Target->DeleteTextObj(_TextObj); }
+    virtual void        BuildText(void *_TextObj, const std::string *_TextLines, color32 *_LineColors, color32 *_LineBgColors, int _NbLines, const CTexFont *_Font, int _Sep, int _BgWidth);
+    virtual void        DrawText(void *_TextObj, int _X, int _Y, color32 _Color, color32 _BgColor);
+
+    virtual void        ChangeViewport(int _X0, int _Y0, int _Width, int _Height, int _OffsetX, int _OffsetY);
+    virtual void        RestoreViewport();
+    virtual void        SetScissor(int _X0, int _Y0, int _Width, int _Height);
+
+    bool                BeginRecord();  // returns false if the list to overwrite is still being submitted
+    void                EndRecord();    // publishes the recorded list for Submit
+    int                 Submit();       // replays the last published list on the target graph (any thread)
+    void                Discard();      // drops the published list (eg. when text objects are deleted)
+    void                TakeSubmitStats(TwFrameStats& _Stats); // adds the Submit time and counters since the last call
+
+    ITwGraph *          m_Target;
+    bool                m_TextsLost;    // recorded BuildText calls have been dropped: texts must be rebuilt
+
+protected:
+    bool                LockIdle(int _List);    // locks m_Mutex once _List (-1: any list) is not being submitted
+    const CTexFont *    ReplayFont(const CTexFont *_Font);  // records the changes of _Font and returns its replay copy
+    void                ResendFonts();          // the replay copies miss the commands of a dropped list
+    struct CReplayFont
+    {
+        const CTexFont *m_Source;
+        CTexFont *      m_Copy;                 // written by the replay only
+        int             m_TexVersion;           // state of m_Source last recorded, -1 to resend it
+        int             m_CharHeight;
+        float           m_Scaling;
+        int             m_CharWidth[TW_FONT_NB_SLOTS];
+    };
+    std::vector<CReplayFont> m_ReplayFonts;     // recording thread only
+    std::vector<std::string> m_GlyphLines;      // recording thread only, kept to avoid reallocations
+    CTwCommandList      m_Lists[2];
+    int                 m_RecordList;   // recording thread only
+    bool                m_Drawing;      // recording thread only
+    CTwMutex            m_Mutex;
+    int                 m_ReadyList;    // guarded by m_Mutex; -1 if no list is ready
+    bool                m_ReadySubmitted; // guarded by m_Mutex
+    int                 m_SubmittingList; // guarded by m_Mutex; -1 if Submit is not running
+    double              m_SubmitTime;   // guarded by m_Mutex
+    int                 m_SubmitDrawCalls;      // guarded by m_Mutex
+    int                 m_SubmitUploadedBytes;  // guarded by m_Mutex
+};
+
+//  ---------------------------------------------------------------------------
+
+
+#endif // !defined ANT_TW_GRAPH_RECORDER_INCLUDED
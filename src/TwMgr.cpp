@@ -15,6 +15,7 @@
 #include "TwFonts.h"
 #include "TwOpenGL.h"
 #include "TwOpenGLCore.h"
+#include "TwGraphRecorder.h"
 #ifdef ANT_WINDOWS
 #   include "TwDirect3D9.h"
 #   include "TwDirect3D10.h"
@@ -34,6 +35,7 @@
 using namespace std;
 
 CTwMgr *g_TwMgr = NULL; // current TwMgr
+ITwGraph *g_TwCustomGraph = NULL;
 bool g_BreakOnError = false;
 TwErrorHandler g_ErrorHandler = NULL;
 int g_TabLength = 4;
@@ -43,6 +45,7 @@ int g_InitWndHeight = -1;
 TwCopyCDStringToClient  g_InitCopyCDStringToClient = NULL;
 TwCopyStdStringToClient g_InitCopyStdStringToClient = NULL;
 float g_FontScaling = 1.0f;
+bool g_FontSDF = false;
 
 // multi-windows
 const int TW_MASTER_WINDOW_ID = 0;
@@ -65,6 +68,7 @@ const char *g_ErrNotFound   = "Not found";
 const char *g_ErrNthToDo    = "Nothing to do";
 const char *g_ErrBadSize    = "Bad size";
 const char *g_ErrIsDrawing  = "Asynchronous drawing detected";
+const char *g_ErrIsRecording= "Recording already in progress";
 const char *g_ErrIsProcessing="Asynchronous processing detected";
 const char *g_ErrOffset     = "Offset larger than StructSize";
 const char *g_ErrDelStruct  = "Cannot delete a struct member";
@@ -75,6 +79,11 @@ const char *g_ErrOutOfRange = "Index out of range";
 const char *g_ErrHasNoValue = "Has no value";
 const char *g_ErrBadType    = "Incompatible type";
 const char *g_ErrDelHelp    = "Cannot delete help bar";
+const char *g_ErrNoSDFFonts = "SDF fonts are not supported by this graphic API";
+const char *g_ErrAllocator  = "Allocator cannot be changed while memory is allocated by the library";
+const char *g_ErrBadState   = "Invalid state data";
+const char *g_ErrStateVersion = "State data saved by another version or on a platform of another byte order";
+const char *g_ErrPresetFile = "Cannot access preset file";
 char g_ErrParse[512];
 
 void ANT_CALL TwGlobalError(const char *_ErrorMessage);
@@ -1776,6 +1785,14 @@ static int TwCreateGraph(ETwGraphAPI _GraphAPI)
 {
     assert( g_TwMgr!=NULL && g_TwMgr->m_Graph==NULL );
 
+    if( g_TwCustomGraph!=NULL )
+    {
+        // the custom graph is then owned by the manager and deleted by TwTerminate
+        g_TwMgr->m_Graph = g_TwCustomGraph;
+        g_TwCustomGraph = NULL;
+        return g_TwMgr->m_Graph->Init();
+    }
+
     switch( _GraphAPI )
     {
     case TW_OPENGL:
@@ -1960,7 +1977,13 @@ int ANT_CALL TwInit(ETwGraphAPI _GraphAPI, void *_Device)
     g_Wnds[TW_MASTER_WINDOW_ID] = g_TwMasterMgr;
     g_TwMgr = g_TwMasterMgr;
 
-    TwGenerateDefaultFonts(g_FontScaling);
+    // GLOBAL fontsdf may have been requested before the graphic API was known
+    if( g_FontSDF && !TwSupportSDFFonts() )
+    {
+        g_FontSDF = false;
+        g_TwMgr->SetLastError(g_ErrNoSDFFonts);
+    }
+    TwGenerateDefaultFonts(g_FontScaling, g_FontSDF);
     g_TwMgr->m_CurrentFont = g_DefaultNormalFont;
 
     int Res = TwCreateGraph(_GraphAPI);
@@ -2115,9 +2138,337 @@ int ANT_CALL TwDrawContext(void *context)
 }
 //  ---------------------------------------------------------------------------
 
+int ANT_CALL TwRecord()
+{
+    if( g_TwMgr==NULL || g_TwMgr->m_Graph==NULL )
+    {
+        TwGlobalError(g_ErrNotInit);
+        return 0; // not initialized
+    }
+    if( g_TwMgr->m_Recorder!=NULL && g_TwMgr->m_Graph==g_TwMgr->m_Recorder )
+    {
+        g_TwMgr->SetLastError(g_ErrIsRecording);
+        return 0;
+    }
+
+    if( g_TwMgr->m_Recorder==NULL )
+        g_TwMgr->m_Recorder = new CTwGraphRecorder(g_TwMgr->m_Graph);
+    CTwGraphRecorder *Recorder = g_TwMgr->m_Recorder;
+    if( !Recorder->BeginRecord() )
+    {
+        g_TwMgr->SetLastError(g_ErrIsDrawing);
+        return 0;
+    }
+
+    // TwDraw issues its draw calls to the recorder instead of the graph API
+    ITwGraph *Graph = g_TwMgr->m_Graph;
+    g_TwMgr->m_Graph = Recorder;
+    int Res = TwDraw();
+    g_TwMgr->m_Graph = Graph;
+
+    if( Recorder->IsDrawing() )  // TwDraw failed while recording
+        Recorder->EndDraw();
+    Recorder->EndRecord();
+    return Res;
+}
+
+//  ---------------------------------------------------------------------------
+
+// May be called on another thread than TwRecord, concurrently with it. It only
+// uses the recorder and its target graph: g_TwMgr->m_Graph, which TwRecord
+// swaps, is not read here. Texts are laid out when recorded and replayed with
+// copies of the fonts, and the graph counters are collected by the next TwDraw. TwSubmit must not overlap any other AntTweakBar call
+// (TwDraw, TwInit, TwTerminate, TwWindowSize...), and the first TwRecord must
+// have returned before TwSubmit is called from another thread.
+int ANT_CALL TwSubmit(void *context)
+{
+    if( g_TwMgr==NULL )
+    {
+        TwGlobalError(g_ErrNotInit);
+        return 0; // not initialized
+    }
+    CTwGraphRecorder *Recorder = g_TwMgr->m_Recorder;
+    if( Recorder==NULL )
+        return 1; // nothing recorded
+
+    g_TwMgr->m_GraphContext = context;  // read by the target graph during the replay
+    int Res = Recorder->Submit();       // its time is accounted in the next recorded frame
+    g_TwMgr->m_GraphContext = NULL;
+    return Res;
+}
+
+//  ---------------------------------------------------------------------------
+
+// Graph proxy used to draw the content of an overlapped bar in a single pass:
+// each primitive is issued once per visible rect of the bar's scissor list.
+class CTwScissorListGraph : public ITwGraph
+{
+public:
+    ITwGraph *          m_Target;
+    const std::vector<CRect> *m_Rects;
+
+    void                Begin(ITwGraph *_Target, const std::vector<CRect> *_Rects) { m_Target = _Target; m_Rects = _Rects; m_Applied = -1; m_ViewportChanged = false; }
+    virtual int         Init()          { return 1; }
+    virtual int         Shut()          { return 1; }
+    virtual void        BeginDraw(int _WndWidth, int _WndHeight) { m_Target->BeginDraw(_WndWidth, _WndHeight); }
+    virtual void        EndDraw()       { m_Target->EndDraw(); }
+    virtual bool        IsDrawing()     { return m_Target->IsDrawing(); }
+    virtual void        Restore()       { m_Target->Restore(); }
+    virtual void        DrawLine(int _X0, int _Y0, int _X1, int _Y1, color32 _Color0, color32 _Color1, bool _AntiAliased=false)
+    {
+        for( int i=0; i<(int)m_Rects->size(); ++i )
+            if( Apply(i, min(_X0, _X1), min(_Y0, _Y1), max(_X0, _X1), max(_Y0, _Y1)) )
+                m_Target->DrawLine(_X0, _Y0, _X1, _Y1, _Color0, _Color1, _AntiAliased);
+    }
+    virtual void        DrawLine(int _X0, int _Y0, int _X1, int _Y1, color32 _Color, bool _AntiAliased=false) { DrawLine(_X0, _Y0, _X1, _Y1, _Color, _Color, _AntiAliased); }
+    virtual void        DrawRect(int _X0, int _Y0, int _X1, int _Y1, color32 _Color00, color32 _Color10, color32 _Color01, color32 _Color11)
+    {
+        for( int i=0; i<(int)m_Rects->size(); ++i )
+            if( Apply(i, min(_X0, _X1), min(_Y0, _Y1), max(_X0, _X1), max(_Y0, _Y1)) )
+                m_Target->DrawRect(_X0, _Y0, _X1, _Y1, _Color00, _Color10, _Color01, _Color11);
+    }
+    virtual void        DrawRect(int _X0, int _Y0, int _X1, int _Y1, color32 _Color) { DrawRect(_X0, _Y0, _X1, _Y1, _Color, _Color, _Color, _Color); }
+    virtual void        DrawTriangles(int _NumTriangles, int *_Vertices, color32 *_Colors, Cull _CullMode)
+    {
+        if( _NumTriangles<=0 )
+            return;
+        int XMin = _Vertices[0], YMin = _Vertices[1], XMax = XMin, YMax = YMin;
+        for( int v=1; v<3*_NumTriangles; ++v )
+        {
+            XMin = min(XMin, _Vertices[2*v]);
+            XMax = max(XMax, _Vertices[2*v]);
+            YMin = min(YMin, _Vertices[2*v+1]);
+            YMax = max(YMax, _Vertices[2*v+1]);
+        }
+        for( int i=0; i<(int)m_Rects->size(); ++i )
+            if( Apply(i, XMin, YMin, XMax, YMax) )
+                m_Target->DrawTriangles(_NumTriangles, _Vertices, _Colors, _CullMode);
+    }
+
+    virtual void *      NewTextObj()    { return m_Target->NewTextObj(); }
+    virtual void        DeleteTextObj(void *_TextObj) { m_Target->DeleteTextObj(_TextObj); }
+    virtual void        BuildText(void *_TextObj, const std::string *_TextLines, color32 *_LineColors, color32 *_LineBgColors, int _NbLines, const CTexFont *_Font, int _Sep, int _BgWidth) { m_Target->BuildText(_TextObj, _TextLines, _LineColors, _LineBgColors, _NbLines, _Font, _Sep, _BgWidth); }
+    virtual void        DrawText(void *_TextObj, int _X, int _Y, color32 _Color, color32 _BgColor)
+    {
+        for( int i=0; i<(int)m_Rects->size(); ++i )
+            if( Apply(i, INT_MIN, INT_MIN, INT_MAX, INT_MAX) ) // text extent is unknown
+                m_Target->DrawText(_TextObj, _X, _Y, _Color, _BgColor);
+    }
+
+    virtual void        ChangeViewport(int _X0, int _Y0, int _Width, int _Height, int _OffsetX, int _OffsetY)
+    {
+        m_Target->ChangeViewport(_X0, _Y0, _Width, _Height, _OffsetX, _OffsetY);
+        m_Viewport = CRect(_X0, _Y0, _Width, _Height);
+        m_ViewportChanged = (_Width>0 && _Height>0);
+        m_Applied = -1; // some graphs use the scissor to change the viewport
+    }
+    virtual void        RestoreViewport()
+    {
+        m_Target->RestoreViewport();
+        m_ViewportChanged = false;
+        m_Applied = -1;
+    }
+    virtual void        SetScissor(int _X0, int _Y0, int _Width, int _Height) { m_Target->SetScissor(_X0, _Y0, _Width, _Height); m_Applied = -1; }
+
+protected:
+    int                 m_Applied;
+    bool                m_ViewportChanged;
+    CRect               m_Viewport;
+
+    // Sets the scissor to the visible rect _Index. Returns false if the rect is
+    // empty or does not intersect the primitive bounds (given in window coordinates).
+    bool                Apply(int _Index, int _XMin, int _YMin, int _XMax, int _YMax)
+    {
+        const CRect& R = (*m_Rects)[_Index];
+        CRect Scissor(R.X+1, R.Y, R.W, R.H-1); // same adjustment as SetScissor calls of previous versions
+        if( m_ViewportChanged )
+        {
+            // primitives are in viewport coordinates: clip the scissor to the viewport instead
+            int X0 = max(Scissor.X, m_Viewport.X), Y0 = max(Scissor.Y, m_Viewport.Y);
+            int X1 = min(Scissor.X+Scissor.W, m_Viewport.X+m_Viewport.W), Y1 = min(Scissor.Y+Scissor.H, m_Viewport.Y+m_Viewport.H);
+            Scissor = CRect(X0, Y0, X1-X0, Y1-Y0);
+        }
+        else if( _XMax<R.X || _XMin>=R.X+R.W || _YMax<R.Y || _YMin>=R.Y+R.H )
+            return false;
+        if( Scissor.Empty() )
+            return false;
+        if( m_Applied!=_Index )
+        {
+            m_Target->SetScissor(Scissor.X, Scissor.Y, Scissor.W, Scissor.H);
+            m_Applied = _Index;
+        }
+        return true;
+    }
+};
+
+//  ---------------------------------------------------------------------------
+
+static inline void UpdateLayoutKey(vector<int>& _Key, size_t _Index, int _Value, bool *_Changed)
+{
+    if( _Key[_Index]!=_Value )
+    {
+        _Key[_Index] = _Value;
+        *_Changed = true;
+    }
+}
+
+// Compares the current order, position, size and state of bars with the
+// ones stored in _Key and updates it. Returns true if something has changed.
+bool CTwMgr::BarsLayoutChanged(vector<int>& _Key) const
+{
+    size_t i, NbBars = m_Bars.size();
+    const size_t HEADER_SIZE = 3, KEY_SIZE = 6;
+    bool Changed = false;
+    if( _Key.size()!=HEADER_SIZE+KEY_SIZE*NbBars )
+    {
+        _Key.assign(HEADER_SIZE+KEY_SIZE*NbBars, -1);
+        Changed = true;
+    }
+    UpdateLayoutKey(_Key, 0, m_OverlapContent ? 1 : 0, &Changed);
+    UpdateLayoutKey(_Key, 1, m_WndWidth, &Changed);
+    UpdateLayoutKey(_Key, 2, m_WndHeight, &Changed);
+    int X, Y, W, H;
+    for( i=0; i<NbBars; ++i )
+    {
+        const CTwBar *Bar = m_Bars[m_Order[i]];
+        size_t k = HEADER_SIZE + KEY_SIZE*i;
+        UpdateLayoutKey(_Key, k+0, m_Order[i], &Changed);
+        if( Bar==NULL )
+            continue;
+        UpdateLayoutKey(_Key, k+1, (Bar->m_Visible ? 1 : 0) | (Bar->IsMinimized() ? 2 : 0), &Changed);
+        Bar->GetHitRect(&X, &Y, &W, &H);
+        UpdateLayoutKey(_Key, k+2, X, &Changed);
+        UpdateLayoutKey(_Key, k+3, Y, &Changed);
+        UpdateLayoutKey(_Key, k+4, W, &Changed);
+        UpdateLayoutKey(_Key, k+5, H, &Changed);
+    }
+    return Changed;
+}
+
+//  ---------------------------------------------------------------------------
+
+void CTwMgr::UpdateBarClips()
+{
+    size_t i, j, NbBars = m_Bars.size();
+    if( !BarsLayoutChanged(m_BarClipsKey) && m_BarClips.size()==NbBars )
+        return;
+
+    // Clip overlapped transparent bars to make them more readable
+    m_BarClips.resize(NbBars);
+    vector<CRect> TopBarsRects;
+    for( i=0; i<NbBars; ++i )
+    {
+        CBarClip& Clip = m_BarClips[i];
+        Clip.m_Clipped = false;
+        Clip.m_Rects.clear();
+        const CTwBar *Bar = m_Bars[m_Order[i]];
+        if( !Bar->m_Visible || m_OverlapContent || Bar->IsMinimized() )
+            continue;
+
+        const int Margin = 4;
+        CRect BarRect(Bar->m_PosX - Margin, Bar->m_PosY - Margin, Bar->m_Width + 2*Margin, Bar->m_Height + 2*Margin);
+        TopBarsRects.clear();
+        for( j=i+1; j<NbBars; ++j )
+        {
+            const CTwBar *TopBar = m_Bars[m_Order[j]];
+            if( TopBar->m_Visible && !TopBar->IsMinimized() )
+            {
+                CRect TopBarRect(TopBar->m_PosX, TopBar->m_PosY, TopBar->m_Width, TopBar->m_Height);
+                if( TopBarRect.Intersects(BarRect) )
+                    TopBarsRects.push_back(TopBarRect);
+            }
+        }
+        if( TopBarsRects.empty() )
+            continue;
+
+        BarRect.Subtract(TopBarsRects, Clip.m_Rects);
+        if( Clip.m_Rects.size()==1 && Clip.m_Rects[0]==BarRect )
+        {
+            Clip.m_Rects.clear();
+            continue; // unclipped
+        }
+        Clip.m_Clipped = true;
+        for( j=0; j<Clip.m_Rects.size(); )
+            if( Clip.m_Rects[j].W>1 && Clip.m_Rects[j].H>1 )
+                ++j;
+            else
+                Clip.m_Rects.erase(Clip.m_Rects.begin()+j);
+    }
+}
+
+//  ---------------------------------------------------------------------------
+
+TwBar *CTwMgr::HitTestBar(int _X, int _Y)
+{
+    const int CELL_SIZE = 64;
+    int i, c;
+    if( m_HitIndexDirty || m_HitCellStart.empty() )
+    {
+        // Rebuild the grid
+        m_HitIndexDirty = false;
+        m_HitRects.clear();
+        for( i=(int)m_Bars.size()-1; i>=0; --i )
+        {
+            CHitRect HitRect;
+            HitRect.m_Bar = m_Bars[m_Order[i]];
+            if( HitRect.m_Bar==NULL || !HitRect.m_Bar->m_Visible )
+                continue;
+            HitRect.m_Bar->GetHitRect(&HitRect.m_Rect.X, &HitRect.m_Rect.Y, &HitRect.m_Rect.W, &HitRect.m_Rect.H);
+            if( !HitRect.m_Rect.Empty() )
+                m_HitRects.push_back(HitRect);
+        }
+        m_HitNbCellsX = max(1, (m_WndWidth+CELL_SIZE-1)/CELL_SIZE);
+        m_HitNbCellsY = max(1, (m_WndHeight+CELL_SIZE-1)/CELL_SIZE);
+        int NbCells = m_HitNbCellsX*m_HitNbCellsY;
+        m_HitCellStart.assign(NbCells+1, 0);
+        vector<int> Fill;
+        for( int Pass=0; Pass<2; ++Pass ) // first pass counts the items of each cell, second pass stores them
+        {
+            if( Pass==1 )
+            {
+                for( c=0; c<NbCells; ++c )
+                    m_HitCellStart[c+1] += m_HitCellStart[c];
+                m_HitCellItems.resize(m_HitCellStart[NbCells]);
+                Fill.assign(m_HitCellStart.begin(), m_HitCellStart.end()-1);
+            }
+            for( i=0; i<(int)m_HitRects.size(); ++i )
+            {
+                const CRect& R = m_HitRects[i].m_Rect;
+                if( R.X+R.W<=0 || R.Y+R.H<=0 || R.X>=m_WndWidth || R.Y>=m_WndHeight )
+                    continue; // outside the window
+                int cx0 = max(0, R.X/CELL_SIZE), cx1 = min(m_HitNbCellsX-1, (R.X+R.W-1)/CELL_SIZE);
+                int cy0 = max(0, R.Y/CELL_SIZE), cy1 = min(m_HitNbCellsY-1, (R.Y+R.H-1)/CELL_SIZE);
+                for( int cy=cy0; cy<=cy1; ++cy )
+                    for( int cx=cx0; cx<=cx1; ++cx )
+                    {
+                        c = cy*m_HitNbCellsX + cx;
+                        if( Pass==0 )
+                            ++m_HitCellStart[c+1];
+                        else
+                            m_HitCellItems[Fill[c]++] = i;
+                    }
+            }
+        }
+    }
+
+    if( _X<0 || _Y<0 || _X>=m_WndWidth || _Y>=m_WndHeight )
+        return NULL;
+    c = (_Y/CELL_SIZE)*m_HitNbCellsX + _X/CELL_SIZE;
+    if( c+1>=(int)m_HitCellStart.size() )
+        return NULL;
+    for( i=m_HitCellStart[c]; i<m_HitCellStart[c+1]; ++i )
+    {
+        const CHitRect& HitRect = m_HitRects[m_HitCellItems[i]];
+        if( _X>=HitRect.m_Rect.X && _X<HitRect.m_Rect.X+HitRect.m_Rect.W && _Y>=HitRect.m_Rect.Y && _Y<HitRect.m_Rect.Y+HitRect.m_Rect.H )
+            return HitRect.m_Bar;
+    }
+    return NULL;
+}
+
+//  ---------------------------------------------------------------------------
+
 int ANT_CALL TwDraw()
 {
-    PERF( PerfTimer Timer; double DT; )
     //CTwFPU fpu;   // fpu precision only forced in update (do not modif dx draw calls)
 
     if( g_TwMgr==NULL || g_TwMgr->m_Graph==NULL )
@@ -2132,6 +2483,18 @@ int ANT_CALL TwDraw()
     if( !TwFreeAsyncDrawing() )
         return 0;
 
+    // Apply the changes deferred since the last draw that are due
+    g_TwMgr->FlushChanges(false);
+    if( g_TwMgr==NULL ) // Mgr might have been destroyed by the client inside a callback call
+        return 0;
+
+    // Record the plot samples that are due
+    g_TwMgr->SamplePlots();
+    if( g_TwMgr==NULL ) // Mgr might have been destroyed by the client inside a callback call
+        return 0;
+
+    PerfTimer DrawTimer;
+
     // Create cursors
     #if defined(ANT_WINDOWS) || defined(ANT_OSX)
         if( !g_TwMgr->m_CursorsCreated )
@@ -2176,72 +2539,270 @@ int ANT_CALL TwDraw()
         return 0;
     }
     else if( g_TwMgr->m_WndWidth==0 || g_TwMgr->m_WndHeight==0 )    // probably iconified
+    {
+        g_TwMgr->m_CurFrameStats.DrawTime += 1000.0*DrawTimer.GetTime();
+        g_TwMgr->EndFrameStats();
         return 1;   // nothing to do
+    }
 
     // count number of bars to draw
-    size_t i, j;
+    size_t i;
     int Nb = 0;
     for( i=0; i<g_TwMgr->m_Bars.size(); ++i )
         if( g_TwMgr->m_Bars[i]!=NULL && g_TwMgr->m_Bars[i]->m_Visible )
             ++Nb;
 
+    // Immediate drawing: drop the recorded list, it would overwrite texts built now
+    if( g_TwMgr->m_Recorder!=NULL && g_TwMgr->m_Graph!=g_TwMgr->m_Recorder )
+        g_TwMgr->m_Recorder->Discard();
+    if( g_TwMgr->m_Recorder!=NULL )
+        g_TwMgr->m_Recorder->TakeSubmitStats(g_TwMgr->m_CurFrameStats);
+
+    // Cached glyphs have been moved or evicted, or recorded texts have been
+    // dropped before being submitted: rebuild texts
+    if( g_TwMgr->m_FontGeneration!=g_TwFontGeneration || (g_TwMgr->m_Recorder!=NULL && g_TwMgr->m_Recorder->m_TextsLost) )
+    {
+        for( i=0; i<g_TwMgr->m_Bars.size(); ++i )
+            if( g_TwMgr->m_Bars[i]!=NULL )
+                g_TwMgr->m_Bars[i]->NotUpToDate();
+        g_TwMgr->m_KeyPressedBuildText = true;
+        g_TwMgr->m_InfoBuildText = true;
+        g_TwMgr->m_FontGeneration = g_TwFontGeneration;
+        if( g_TwMgr->m_Recorder!=NULL )
+            g_TwMgr->m_Recorder->m_TextsLost = false;
+    }
+
+    TwFrameStats& Stats = g_TwMgr->m_CurFrameStats;
     if( Nb>0 )
     {
-        PERF( Timer.Reset(); )
+        PerfTimer SubmitTimer;
         g_TwMgr->m_Graph->BeginDraw(g_TwMgr->m_WndWidth, g_TwMgr->m_WndHeight);
-        PERF( DT = Timer.GetTime(); printf("\nBegin=%.4fms ", 1000.0*DT); )
+        Stats.SubmitTime += 1000.0*SubmitTimer.GetTime();
 
-        PERF( Timer.Reset(); )
-        vector<CRect> TopBarsRects, ClippedBarRects;
+        g_TwMgr->UpdateBarClips();
+        CTwScissorListGraph ScissorGraph;
         for( i=0; i<g_TwMgr->m_Bars.size(); ++i )
         {
             CTwBar *Bar = g_TwMgr->m_Bars[ g_TwMgr->m_Order[i] ];
             if( Bar->m_Visible )
             {
-                if( g_TwMgr->m_OverlapContent || Bar->IsMinimized() )
-                    Bar->Draw();
+                // submit time is the bar drawing time minus updates and texts built while drawing
+                double PrevTime = Stats.UpdateTime + Stats.TextTime;
+                SubmitTimer.Reset();
+                const CTwMgr::CBarClip& Clip = g_TwMgr->m_BarClips[i];
+                if( !Clip.m_Clipped )
+                    Bar->Draw(); // unclipped
                 else
                 {
-                    // Clip overlapped transparent bars to make them more readable
-                    const int Margin = 4;
-                    CRect BarRect(Bar->m_PosX - Margin, Bar->m_PosY - Margin, Bar->m_Width + 2*Margin, Bar->m_Height + 2*Margin);
-                    TopBarsRects.clear();
-                    for( j=i+1; j<g_TwMgr->m_Bars.size(); ++j )
-                    {
-                        CTwBar *TopBar = g_TwMgr->m_Bars[g_TwMgr->m_Order[j]];
-                        if( TopBar->m_Visible && !TopBar->IsMinimized() )
-                            TopBarsRects.push_back(CRect(TopBar->m_PosX, TopBar->m_PosY, TopBar->m_Width, TopBar->m_Height));
-                    }
-                    ClippedBarRects.clear();
-                    BarRect.Subtract(TopBarsRects, ClippedBarRects);
+                    Bar->Draw(CTwBar::DRAW_BG); // draw background only
 
-                    if( ClippedBarRects.size()==1 && ClippedBarRects[0]==BarRect )
-                        //g_TwMgr->m_Graph->DrawRect(Bar->m_PosX, Bar->m_PosY, Bar->m_PosX+Bar->m_Width-1, Bar->m_PosY+Bar->m_Height-1, 0x70ffffff); // Clipping test
-                        Bar->Draw(); // unclipped
-                    else
+                    // draw content once, each primitive being clipped by the bar scissor list
+                    if( !Clip.m_Rects.empty() )
                     {
-                        Bar->Draw(CTwBar::DRAW_BG); // draw background only
-
-                        // draw content for each clipped rectangle
-                        for( j=0; j<ClippedBarRects.size(); j++ )
-                            if (ClippedBarRects[j].W>1 && ClippedBarRects[j].H>1)
-                            {
-                                g_TwMgr->m_Graph->SetScissor(ClippedBarRects[j].X+1, ClippedBarRects[j].Y, ClippedBarRects[j].W, ClippedBarRects[j].H-1);
-                                //g_TwMgr->m_Graph->DrawRect(0, 0, 1000, 1000, 0x70ffffff); // Clipping test
-                                Bar->Draw(CTwBar::DRAW_CONTENT);
-                            }
+                        ScissorGraph.Begin(g_TwMgr->m_Graph, &Clip.m_Rects);
+                        g_TwMgr->m_Graph = &ScissorGraph;
+                        Bar->Draw(CTwBar::DRAW_CONTENT);
+                        g_TwMgr->m_Graph = ScissorGraph.m_Target;
                         g_TwMgr->m_Graph->SetScissor(0, 0, 0, 0);
                     }
                 }
+                double DT = 1000.0*SubmitTimer.GetTime() - (Stats.UpdateTime+Stats.TextTime-PrevTime);
+                Bar->m_FrameTimes[CTwBar::FRAME_SUBMIT] += DT;
+                Stats.SubmitTime += DT;
             }
         }
-        PERF( DT = Timer.GetTime(); printf("Draw=%.4fms ", 1000.0*DT); )
 
-        PERF( Timer.Reset(); )
+        SubmitTimer.Reset();
         g_TwMgr->m_Graph->EndDraw();
-        PERF( DT = Timer.GetTime(); printf("End=%.4fms\n", 1000.0*DT); )
+        Stats.SubmitTime += 1000.0*SubmitTimer.GetTime();
+    }
+    Stats.NbDrawCalls += g_TwMgr->m_Graph->m_NbDrawCalls;   // none when recording: the replay counts them
+    Stats.NbUploadedBytes += g_TwMgr->m_Graph->m_NbUploadedBytes;
+    g_TwMgr->m_Graph->m_NbDrawCalls = 0;
+    g_TwMgr->m_Graph->m_NbUploadedBytes = 0;
+
+    Stats.DrawTime += 1000.0*DrawTimer.GetTime();
+    g_TwMgr->EndFrameStats();
+
+    return 1;
+}
+
+//  ---------------------------------------------------------------------------
+
+void CTwMgr::EndFrameStats()
+{
+    m_CurFrameStats.NbAllocs = (int)(g_TwAllocCount - m_FrameAllocCount);
+    m_CurFrameStats.LiveBytes = g_TwAllocLiveBytes;
+    m_FrameAllocCount = g_TwAllocCount;
+    m_FrameStats[m_CurFrameStats.Frame%NB_FRAME_STATS] = m_CurFrameStats;
+    for( size_t i=0; i<m_Bars.size(); ++i )
+        if( m_Bars[i]!=NULL )
+            for( int t=0; t<CTwBar::FRAME_NB_TIMES; ++t )
+            {
+                m_Bars[i]->m_LastFrameTimes[t] = m_Bars[i]->m_FrameTimes[t];
+                m_Bars[i]->m_FrameTimes[t] = 0;
+            }
+
+    TwFrameStats Stats = m_CurFrameStats;
+    memset(&m_CurFrameStats, 0, sizeof(m_CurFrameStats));
+    m_CurFrameStats.Frame = Stats.Frame+1;
+    if( m_StatsBar!=NULL )
+        UpdateStatsBar();
+    if( m_FrameStatsCallback!=NULL )
+        m_FrameStatsCallback(&Stats, m_FrameStatsClientData);
+}
+
+//  ---------------------------------------------------------------------------
+
+bool CTwMgr::CreateStatsBar()
+{
+    if( m_StatsBar!=NULL )
+        return true;
+    m_StatsBar = TwNewBar("TW_STATS");
+    if( m_StatsBar==NULL )
+        return false;
+    m_StatsBar->m_Label = "~ Statistics ~";
+    m_StatsBar->m_Width = 240;
+    m_StatsBar->m_ValuesWidth = 17*(m_StatsBar->m_Font->m_CharHeight/2);
+    m_StatsBar->m_Color = 0xa05f5f5f;
+    m_StatsBar->m_DarkText = false;
+    m_StatsBar->m_UpdatePeriod = 0.25f;
+
+    CStatsValues& V = m_StatsValues;
+    memset(&V, 0, sizeof(V));
+    UpdateStatsBar();
+    bool Ok = true;
+    Ok = Ok && TwAddVarRO(m_StatsBar, "DrawTime", TW_TYPE_DOUBLE, &V.m_DrawTime, " label='Draw (ms)' precision=3 help='Time spent in TwDraw during the last frame.' ")!=0;
+    Ok = Ok && TwAddVarRO(m_StatsBar, "DrawTimeAvg", TW_TYPE_DOUBLE, &V.m_DrawTimeAvg, " label='Draw avg (ms)' precision=3 help='Average draw time of the recorded frames.' ")!=0;
+    Ok = Ok && TwAddVarRO(m_StatsBar, "DrawTimeMax", TW_TYPE_DOUBLE, &V.m_DrawTimeMax, " label='Draw max (ms)' precision=3 help='Maximum draw time of the recorded frames.' ")!=0;
+    Ok = Ok && TwAddVarRO(m_StatsBar, "DrawHistory", TW_TYPE_CSSTRING(sizeof(V.m_DrawHistory)), V.m_DrawHistory, " label='Draw history' help='Draw time of the recorded frames, oldest first.' ")!=0;
+    Ok = Ok && TwAddVarPlot(m_StatsBar, "DrawGraph", TW_TYPE_DOUBLE, &V.m_DrawTime, NB_FRAME_STATS, " label='Draw graph' help='Draw time of the recorded frames.' ")!=0;
+    Ok = Ok && TwAddVarRO(m_StatsBar, "UpdateTime", TW_TYPE_DOUBLE, &V.m_UpdateTime, " label='Update (ms)' precision=3 group=Details ")!=0;
+    Ok = Ok && TwAddVarRO(m_StatsBar, "TextTime", TW_TYPE_DOUBLE, &V.m_TextTime, " label='Text (ms)' precision=3 group=Details ")!=0;
+    Ok = Ok && TwAddVarRO(m_StatsBar, "SubmitTime", TW_TYPE_DOUBLE, &V.m_SubmitTime, " label='Submit (ms)' precision=3 group=Details ")!=0;
+    Ok = Ok && TwAddVarRO(m_StatsBar, "NbUpdates", TW_TYPE_INT32, &V.m_NbUpdates, " label='Bar updates' group=Details ")!=0;
+    Ok = Ok && TwAddVarRO(m_StatsBar, "NbGlyphs", TW_TYPE_INT32, &V.m_NbGlyphs, " label='Glyphs' group=Details ")!=0;
+    Ok = Ok && TwAddVarRO(m_StatsBar, "NbDrawCalls", TW_TYPE_INT32, &V.m_NbDrawCalls, " label='Draw calls' group=Details ")!=0;
+    Ok = Ok && TwAddVarRO(m_StatsBar, "NbUploadedBytes", TW_TYPE_INT32, &V.m_NbUploadedBytes, " label='Uploaded bytes' group=Details ")!=0;
+    Ok = Ok && TwAddVarRO(m_StatsBar, "NbAllocs", TW_TYPE_INT32, &V.m_NbAllocs, " label='Allocations' group=Memory ")!=0;
+    Ok = Ok && TwAddVarRO(m_StatsBar, "LiveBytes", TW_TYPE_UINT32, &V.m_LiveBytes, " label='Live bytes' group=Memory ")!=0;
+    Ok = Ok && TwAddVarPlot(m_StatsBar, "LiveBytesGraph", TW_TYPE_UINT32, &V.m_LiveBytes, NB_FRAME_STATS, " label='Live bytes graph' group=Memory ")!=0;
+    if( !Ok )
+    {
+        TwDeleteBar(m_StatsBar);
+        m_StatsBar = NULL;
+        return false;
+    }
+    return true;
+}
+
+//  ---------------------------------------------------------------------------
+
+void CTwMgr::UpdateStatsBar()
+{
+    CStatsValues& V = m_StatsValues;
+    int NbFrames = (int)m_CurFrameStats.Frame;
+    if( NbFrames>NB_FRAME_STATS )
+        NbFrames = NB_FRAME_STATS;
+    if( NbFrames<=0 )
+    {
+        strcpy(V.m_DrawHistory, "");
+        return;
+    }
+
+    const TwFrameStats& Last = m_FrameStats[(m_CurFrameStats.Frame+NB_FRAME_STATS-1)%NB_FRAME_STATS];
+    V.m_DrawTime = Last.DrawTime;
+    V.m_UpdateTime = Last.UpdateTime;
+    V.m_TextTime = Last.TextTime;
+    V.m_SubmitTime = Last.SubmitTime;
+    V.m_NbUpdates = Last.NbUpdates;
+    V.m_NbGlyphs = Last.NbGlyphs;
+    V.m_NbDrawCalls = Last.NbDrawCalls;
+    V.m_NbUploadedBytes = Last.NbUploadedBytes;
+    V.m_NbAllocs = Last.NbAllocs;
+    V.m_LiveBytes = (unsigned int)Last.LiveBytes;
+
+    // average and max over the ring, then one sparkline column per group of frames
+    const int NbCols = (int)sizeof(V.m_DrawHistory)-1;
+    double ColTime[NbCols];
+    int ColCount[NbCols];
+    memset(ColTime, 0, sizeof(ColTime));
+    memset(ColCount, 0, sizeof(ColCount));
+    unsigned int First = m_CurFrameStats.Frame-(unsigned int)NbFrames;
+    double Sum = 0, Max = 0;
+    for( int i=0; i<NbFrames; ++i )
+    {
+        double t = m_FrameStats[(First+i)%NB_FRAME_STATS].DrawTime;
+        Sum += t;
+        if( t>Max )
+            Max = t;
+        int c = (i*NbCols)/NbFrames;
+        if( ColTime[c]<t )
+            ColTime[c] = t;
+        ++ColCount[c];
+    }
+    V.m_DrawTimeAvg = Sum/NbFrames;
+    V.m_DrawTimeMax = Max;
+
+    static const char s_Levels[] = " .:-=+*#";
+    const int NbLevels = (int)sizeof(s_Levels)-1;
+    int n = 0;
+    for( int c=0; c<NbCols; ++c )
+        if( ColCount[c]>0 )
+        {
+            int l = (Max>0) ? (int)(ColTime[c]/Max*(NbLevels-1)+0.5) : 0;
+            V.m_DrawHistory[n++] = s_Levels[(l<0) ? 0 : ((l>=NbLevels) ? NbLevels-1 : l)];
+        }
+    V.m_DrawHistory[n] = '\0';
+}
+
+int ANT_CALL TwSetAllocator(TwAllocCallback _AllocFunc, TwFreeCallback _FreeFunc, void *_ClientData)
+{
+    if( (_AllocFunc==NULL)!=(_FreeFunc==NULL) )
+    {
+        TwGlobalError(g_ErrBadParam);
+        return 0;
+    }
+    if( g_TwMasterMgr!=NULL || !TwSetAllocMem(_AllocFunc, _FreeFunc, _ClientData) )
+    {
+        TwGlobalError(g_ErrAllocator);
+        return 0;
+    }
+    return 1;
+}
+
+//  ---------------------------------------------------------------------------
+
+int ANT_CALL TwGetFrameStats(TwFrameStats *_FrameStats, int _MaxCount)
+{
+    if( g_TwMgr==NULL )
+    {
+        TwGlobalError(g_ErrNotInit);
+        return 0; // not initialized
     }
+    if( _FrameStats==NULL || _MaxCount<=0 )
+        return 0;
+
+    unsigned int NbFrames = g_TwMgr->m_CurFrameStats.Frame; // number of completed frames
+    if( NbFrames>CTwMgr::NB_FRAME_STATS )
+        NbFrames = CTwMgr::NB_FRAME_STATS;
+    if( NbFrames>(unsigned int)_MaxCount )
+        NbFrames = (unsigned int)_MaxCount;
+    unsigned int First = g_TwMgr->m_CurFrameStats.Frame - NbFrames;
+    for( unsigned int i=0; i<NbFrames; ++i )
+        _FrameStats[i] = g_TwMgr->m_FrameStats[(First+i)%CTwMgr::NB_FRAME_STATS];
+    return (int)NbFrames;
+}
 
+int ANT_CALL TwSetFrameStatsCallback(TwFrameStatsCallback _Callback, void *_ClientData)
+{
+    if( g_TwMgr==NULL )
+    {
+        TwGlobalError(g_ErrNotInit);
+        return 0; // not initialized
+    }
+    g_TwMgr->m_FrameStatsCallback = _Callback;
+    g_TwMgr->m_FrameStatsClientData = _ClientData;
     return 1;
 }
 
@@ -2282,6 +2843,7 @@ int ANT_CALL TwWindowSize(int _Width, int _Height)
 
     g_TwMgr->m_WndWidth = _Width;
     g_TwMgr->m_WndHeight = _Height;
+    g_TwMgr->m_HitIndexDirty = true;
     g_TwMgr->m_Graph->Restore();
 
     // Recreate extra text objects
@@ -2317,6 +2879,21 @@ CTwMgr::CTwMgr(ETwGraphAPI _GraphAPI, void *_Device, int _WndID)
     m_CurrentDbgLine = 0;
     //m_Processing = false;
     m_Graph = NULL;
+    m_GraphContext = NULL;
+    m_Recorder = NULL;
+    m_HitNbCellsX = m_HitNbCellsY = 0;
+    m_HitIndexDirty = true;
+    m_HoverBar = NULL;
+    m_DraggingBar = NULL;
+    m_HighlightBar = NULL;
+    m_CustomCaptureProxy = NULL;
+    memset(m_FrameStats, 0, sizeof(m_FrameStats));
+    memset(&m_CurFrameStats, 0, sizeof(m_CurFrameStats));
+    m_FrameStatsCallback = NULL;
+    m_FrameStatsClientData = NULL;
+    m_FrameAllocCount = g_TwAllocCount;
+    m_StatsBar = NULL;
+    memset(&m_StatsValues, 0, sizeof(m_StatsValues));
     m_WndWidth = g_InitWndWidth;
     m_WndHeight = g_InitWndHeight;
     m_CurrentFont = NULL;   // set after by TwIntialize
@@ -2350,7 +2927,9 @@ CTwMgr::CTwMgr(ETwGraphAPI _GraphAPI, void *_Device, int _WndID)
     m_RepeatMousePressedPeriod = 0.1;
     m_CanRepeatMousePressed = false;
     m_IsRepeatingMousePressed = false;
+    m_DragStartedInBar = false;
     m_LastDrawTime = 0;
+    m_FontGeneration = g_TwFontGeneration;
     m_UseOldColorScheme = false;
     m_Contained = false;
     m_ButtonAlign = BUTTON_ALIGN_RIGHT;
@@ -2358,6 +2937,7 @@ CTwMgr::CTwMgr(ETwGraphAPI _GraphAPI, void *_Device, int _WndID)
     m_Terminating = false;
     
     m_CursorsCreated = false;   
+    m_CursorsShared = false;
     #if defined(ANT_UNIX)
         m_CurrentXDisplay = NULL;
         m_CurrentXWindow = 0;
@@ -2373,39 +2953,327 @@ CTwMgr::CTwMgr(ETwGraphAPI _GraphAPI, void *_Device, int _WndID)
 
 CTwMgr::~CTwMgr()
 {
+    if( m_Recorder!=NULL )
+    {
+        delete m_Recorder;
+        m_Recorder = NULL;
+    }
 }
 
 //  ---------------------------------------------------------------------------
 
-int CTwMgr::FindBar(const char *_Name) const
+// Modifiers as compared by shortcuts
+static int ShortcutModifiers(int _Key, int _Modifiers)
 {
-    if( _Name==NULL || strlen(_Name)<=0 )
-        return -1;
-    int i;
-    for( i=0; i<(int)m_Bars.size(); ++i )
-        if( m_Bars[i]!=NULL && strcmp(_Name, m_Bars[i]->m_Name.c_str())==0 )
-            return i;
-    return -1;
+    int Mask = 0xffffffff;
+    if( _Key>' ' && _Key<256 ) // don't test SHIFT if _Key is a common key
+        Mask &= ~TW_KMOD_SHIFT;
+
+    // don't test KMOD_NUM and KMOD_CAPS modifiers coming from SDL
+    Mask &= ~(0x1000);  // 0x1000 is the KMOD_NUM value defined in SDL_keysym.h
+    Mask &= ~(0x2000);  // 0x2000 is the KMOD_CAPS value defined in SDL_keysym.h
+
+    // complete partial modifiers comming from SDL
+    if( _Modifiers & TW_KMOD_SHIFT )
+        _Modifiers |= TW_KMOD_SHIFT;
+    if( _Modifiers & TW_KMOD_CTRL )
+        _Modifiers |= TW_KMOD_CTRL;
+    if( _Modifiers & TW_KMOD_ALT )
+        _Modifiers |= TW_KMOD_ALT;
+    if( _Modifiers & TW_KMOD_META )
+        _Modifiers |= TW_KMOD_META;
+
+    return _Modifiers & Mask;
 }
 
+static inline int ShortcutBucket(int _Key, int _Modifiers)
+{
+    return (int)(((unsigned int)_Key*2654435761U ^ (unsigned int)_Modifiers) % CTwMgr::NB_SHORTCUT_BUCKETS);
+}
 
-//  ---------------------------------------------------------------------------
+void CTwMgr::AddShortcuts(CTwVarAtom *_Atom, TwBar *_Bar)
+{
+    assert( _Atom!=NULL && _Bar!=NULL );
+    CShortcut Shortcut;
+    Shortcut.m_Atom = _Atom;
+    Shortcut.m_Bar = _Bar;
+    if( _Atom->m_KeyIncr[0]>0 )
+    {
+        Shortcut.m_Key = _Atom->m_KeyIncr[0];
+        Shortcut.m_Modifiers = ShortcutModifiers(_Atom->m_KeyIncr[0], _Atom->m_KeyIncr[1]);
+        Shortcut.m_Incr = true;
+        m_Shortcuts[ShortcutBucket(Shortcut.m_Key, Shortcut.m_Modifiers)].push_back(Shortcut);
+    }
+    if( _Atom->m_KeyDecr[0]>0 )
+    {
+        Shortcut.m_Key = _Atom->m_KeyDecr[0];
+        Shortcut.m_Modifiers = ShortcutModifiers(_Atom->m_KeyDecr[0], _Atom->m_KeyDecr[1]);
+        Shortcut.m_Incr = false;
+        m_Shortcuts[ShortcutBucket(Shortcut.m_Key, Shortcut.m_Modifiers)].push_back(Shortcut);
+    }
+}
 
-int CTwMgr::HasAttrib(const char *_Attrib, bool *_HasValue) const
+void CTwMgr::RemoveShortcuts(const CTwVarAtom *_Atom)
 {
-    *_HasValue = true;
-    if( _stricmp(_Attrib, "help")==0 )
-        return MGR_HELP;
-    else if( _stricmp(_Attrib, "fontsize")==0 )
-        return MGR_FONT_SIZE;
-    else if( _stricmp(_Attrib, "fontstyle")==0 )
-        return MGR_FONT_STYLE;
-    else if( _stricmp(_Attrib, "iconpos")==0 )
-        return MGR_ICON_POS;
-    else if( _stricmp(_Attrib, "iconalign")==0 )
-        return MGR_ICON_ALIGN;
-    else if( _stricmp(_Attrib, "iconmargin")==0 )
-        return MGR_ICON_MARGIN;
+    if( _Atom->m_KeyIncr[0]>0 )
+    {
+        vector<CShortcut>& Bucket = m_Shortcuts[ShortcutBucket(_Atom->m_KeyIncr[0], ShortcutModifiers(_Atom->m_KeyIncr[0], _Atom->m_KeyIncr[1]))];
+        for( size_t i=0; i<Bucket.size(); ++i )
+            if( Bucket[i].m_Atom==_Atom && Bucket[i].m_Incr )
+            {
+                Bucket.erase(Bucket.begin()+i);
+                break;
+            }
+    }
+    if( _Atom->m_KeyDecr[0]>0 )
+    {
+        vector<CShortcut>& Bucket = m_Shortcuts[ShortcutBucket(_Atom->m_KeyDecr[0], ShortcutModifiers(_Atom->m_KeyDecr[0], _Atom->m_KeyDecr[1]))];
+        for( size_t i=0; i<Bucket.size(); ++i )
+            if( Bucket[i].m_Atom==_Atom && !Bucket[i].m_Incr )
+            {
+                Bucket.erase(Bucket.begin()+i);
+                break;
+            }
+    }
+}
+
+CTwVarAtom *CTwMgr::FindShortcut(const TwBar *_Bar, int _Key, int _Modifiers, bool *_DoIncr) const
+{
+    _Modifiers = ShortcutModifiers(_Key, _Modifiers);
+    const vector<CShortcut>& Bucket = m_Shortcuts[ShortcutBucket(_Key, _Modifiers)];
+    for( size_t i=0; i<Bucket.size(); ++i )
+        if( Bucket[i].m_Key==_Key && Bucket[i].m_Modifiers==_Modifiers 
+            && (Bucket[i].m_Bar==_Bar || (_Bar==NULL && Bucket[i].m_Bar->m_Visible && Bucket[i].m_Atom->m_Visible)) )
+        {
+            if( _DoIncr!=NULL )
+                *_DoIncr = Bucket[i].m_Incr;
+            return Bucket[i].m_Atom;
+        }
+    return NULL;
+}
+
+//  ---------------------------------------------------------------------------
+
+TwChangeStreamCallback g_ChangeStream = NULL;
+void *g_ChangeStreamClientData = NULL;
+
+void ANT_CALL CTwMgr::CChangeProxy::SetCB(const void *_Value, void *_ClientData)
+{
+    CChangeProxy *Proxy = static_cast<CChangeProxy *>(_ClientData);
+    if( Proxy==NULL || _Value==NULL || g_TwMgr==NULL )
+        return;
+    memcpy(Proxy->m_Value, _Value, CTwVar::GetDataSize(Proxy->m_Var->m_Type));
+    if( !Proxy->m_Pending )
+    {
+        Proxy->m_Pending = true;
+        g_TwMgr->m_PendingChanges.push_back(Proxy);
+    }
+}
+
+void ANT_CALL CTwMgr::CChangeProxy::GetCB(void *_Value, void *_ClientData)
+{
+    const CChangeProxy *Proxy = static_cast<const CChangeProxy *>(_ClientData);
+    if( Proxy==NULL || _Value==NULL )
+        return;
+    size_t Size = CTwVar::GetDataSize(Proxy->m_Var->m_Type);
+    if( Proxy->m_Pending )
+        memcpy(_Value, Proxy->m_Value, Size);
+    else if( Proxy->m_ClientVar!=NULL )
+        memcpy(_Value, Proxy->m_ClientVar, Size);
+    else if( Proxy->m_ClientGetCallback!=NULL )
+        Proxy->m_ClientGetCallback(_Value, Proxy->m_ClientData);
+}
+
+bool CTwMgr::CanDeferChanges(const CTwVarAtom *_Atom)
+{
+    // only values of fixed size are deferred
+    return !(    _Atom->m_Type==TW_TYPE_CDSTRING || _Atom->m_Type==TW_TYPE_CDSTDSTRING || _Atom->m_Type==TW_TYPE_STRINGVIEW || IsCSStringType(_Atom->m_Type)
+              || _Atom->IsCustom() || CTwVar::GetDataSize(_Atom->m_Type)==0
+              || _Atom->m_GetCallback==CArrayProxy::RowGetCB || _Atom->m_GetCallback==CArrayProxy::PageGetCB ); // array rows follow the page
+}
+
+int CTwMgr::SetCommitMode(CTwVarAtom *_Atom, TwBar *_Bar, int _Mode, double _ThrottlePeriod)
+{
+    assert( _Atom!=NULL && _Bar!=NULL );
+    bool HasProxy = (_Atom->m_SetCallback==CChangeProxy::SetCB);
+    if( !HasProxy && _Mode==COMMIT_IMMEDIATE )
+        return 1;
+    if( HasProxy && _Mode!=COMMIT_IMMEDIATE )
+    {
+        CChangeProxy *Proxy = static_cast<CChangeProxy *>(_Atom->m_ClientData);
+        Proxy->m_CommitMode = _Mode;
+        Proxy->m_ThrottlePeriod = _ThrottlePeriod;
+        return 1;
+    }
+
+    if( _Mode!=COMMIT_IMMEDIATE )
+    {
+        if( !CanDeferChanges(_Atom) )
+        {
+            SetLastError(g_ErrBadType);
+            return 0;
+        }
+        m_ChangeProxies.push_back(CChangeProxy());
+        CChangeProxy& Proxy = m_ChangeProxies.back();
+        Proxy.m_Var = _Atom;
+        Proxy.m_Bar = _Bar;
+        Proxy.m_ClientVar = _Atom->m_Ptr;
+        Proxy.m_ClientSetCallback = _Atom->m_SetCallback;
+        Proxy.m_ClientGetCallback = _Atom->m_GetCallback;
+        Proxy.m_ClientData = _Atom->m_ClientData;
+        Proxy.m_Pending = false;
+        Proxy.m_CommitMode = _Mode;
+        Proxy.m_ThrottlePeriod = _ThrottlePeriod;
+        Proxy.m_LastCommitTime = m_Timer.GetTime() - _ThrottlePeriod;
+        _Atom->m_Ptr = NULL;
+        _Atom->m_SetCallback = CChangeProxy::SetCB;
+        _Atom->m_GetCallback = CChangeProxy::GetCB;
+        _Atom->m_ClientData = &Proxy;
+    }
+    else
+    {
+        CChangeProxy Proxy = *static_cast<CChangeProxy *>(_Atom->m_ClientData);
+        RemoveChangeProxy(static_cast<CChangeProxy *>(_Atom->m_ClientData));
+        _Atom->m_Ptr = Proxy.m_ClientVar;
+        _Atom->m_SetCallback = Proxy.m_ClientSetCallback;
+        _Atom->m_GetCallback = Proxy.m_ClientGetCallback;
+        _Atom->m_ClientData = Proxy.m_ClientData;
+        if( Proxy.m_Pending )   // the last edit is applied but not reported
+        {
+            if( _Atom->m_Ptr!=NULL )
+                memcpy(_Atom->m_Ptr, Proxy.m_Value, CTwVar::GetDataSize(_Atom->m_Type));
+            else if( _Atom->m_SetCallback!=NULL )
+                _Atom->m_SetCallback(Proxy.m_Value, _Atom->m_ClientData);
+        }
+    }
+    return 1;
+}
+
+void CTwMgr::RemoveChangeProxy(CChangeProxy *_Proxy)
+{
+    vector<CChangeProxy *>::iterator itc = find(m_PendingChanges.begin(), m_PendingChanges.end(), _Proxy);
+    if( itc!=m_PendingChanges.end() )
+        m_PendingChanges.erase(itc);
+    for( list<CChangeProxy>::iterator it=m_ChangeProxies.begin(); it!=m_ChangeProxies.end(); ++it )
+        if( &(*it)==_Proxy )
+        {
+            m_ChangeProxies.erase(it);
+            break;
+        }
+}
+
+// Copy of a pending change: client callbacks may remove vars and their proxy
+struct CFlushedChange
+{
+    TwBar *             m_Bar;
+    CTwIString          m_Name;
+    TwType              m_Type;
+    void *              m_ClientVar;
+    TwSetVarCallback    m_ClientSetCallback;
+    void *              m_ClientData;
+    double              m_Value[2];
+};
+
+void CTwMgr::FlushChanges(bool _Force)
+{
+    if( m_PendingChanges.empty() )
+        return;
+
+    double Now = m_Timer.GetTime();
+    vector<CFlushedChange> Changes; // no allocation while the pending changes are not due
+    size_t NbKept = 0;
+    for( size_t i=0; i<m_PendingChanges.size(); ++i )
+    {
+        CChangeProxy *Proxy = m_PendingChanges[i];
+        bool Due = _Force || !m_DragStartedInBar || Proxy->m_CommitMode==COMMIT_ONDRAW
+                   || (Proxy->m_CommitMode==COMMIT_THROTTLE && Now-Proxy->m_LastCommitTime>=Proxy->m_ThrottlePeriod);
+        if( !Due )
+        {
+            m_PendingChanges[NbKept++] = Proxy; // keeps its order
+            continue;
+        }
+        Changes.push_back(CFlushedChange());
+        CFlushedChange& Change = Changes.back();
+        Change.m_Bar = Proxy->m_Bar;
+        Change.m_Name = Proxy->m_Var->m_Name;
+        Change.m_Type = Proxy->m_Var->m_Type;
+        Change.m_ClientVar = Proxy->m_ClientVar;
+        Change.m_ClientSetCallback = Proxy->m_ClientSetCallback;
+        Change.m_ClientData = Proxy->m_ClientData;
+        memcpy(Change.m_Value, Proxy->m_Value, sizeof(Change.m_Value));
+        Proxy->m_Pending = false;
+        Proxy->m_LastCommitTime = Now;
+    }
+    m_PendingChanges.resize(NbKept);
+    if( Changes.empty() )
+        return;
+
+    for( size_t i=0; i<Changes.size(); ++i )
+    {
+        const CFlushedChange& Change = Changes[i];
+        if( Change.m_ClientVar!=NULL )
+            memcpy(Change.m_ClientVar, Change.m_Value, CTwVar::GetDataSize(Change.m_Type));
+        else if( Change.m_ClientSetCallback!=NULL )
+        {
+            Change.m_ClientSetCallback(Change.m_Value, Change.m_ClientData);
+            if( g_TwMgr==NULL ) // Mgr might have been destroyed by the client inside a callback call
+                return;
+        }
+    }
+
+    if( g_ChangeStream!=NULL )
+    {
+        vector<TwChange> Stream;
+        Stream.reserve(Changes.size());
+        for( size_t i=0; i<Changes.size(); ++i )
+        {
+            // a set callback may have deleted the bar: its changes are dropped
+            // rather than streamed with a dangling bar pointer
+            if( std::find(m_Bars.begin(), m_Bars.end(), Changes[i].m_Bar)==m_Bars.end() )
+                continue;
+            Stream.push_back(TwChange());
+            TwChange& Change = Stream.back();
+            Change.Bar = Changes[i].m_Bar;
+            Change.VarName = Changes[i].m_Name.c_str();
+            Change.Type = Changes[i].m_Type;
+            Change.Value = Changes[i].m_Value;
+        }
+        if( !Stream.empty() )
+            g_ChangeStream(&Stream[0], (unsigned int)Stream.size(), g_ChangeStreamClientData);
+    }
+}
+
+//  ---------------------------------------------------------------------------
+
+int CTwMgr::FindBar(const char *_Name) const
+{
+    if( _Name==NULL || strlen(_Name)<=0 )
+        return -1;
+    int i;
+    for( i=0; i<(int)m_Bars.size(); ++i )
+        if( m_Bars[i]!=NULL && strcmp(_Name, m_Bars[i]->m_Name.c_str())==0 )
+            return i;
+    return -1;
+}
+
+
+//  ---------------------------------------------------------------------------
+
+int CTwMgr::HasAttrib(const char *_Attrib, bool *_HasValue) const
+{
+    *_HasValue = true;
+    if( _stricmp(_Attrib, "help")==0 )
+        return MGR_HELP;
+    else if( _stricmp(_Attrib, "fontsize")==0 )
+        return MGR_FONT_SIZE;
+    else if( _stricmp(_Attrib, "fontstyle")==0 )
+        return MGR_FONT_STYLE;
+    else if( _stricmp(_Attrib, "iconpos")==0 )
+        return MGR_ICON_POS;
+    else if( _stricmp(_Attrib, "iconalign")==0 )
+        return MGR_ICON_ALIGN;
+    else if( _stricmp(_Attrib, "iconmargin")==0 )
+        return MGR_ICON_MARGIN;
     else if( _stricmp(_Attrib, "fontresizable")==0 )
         return MGR_FONT_RESIZABLE;
     else if( _stricmp(_Attrib, "colorscheme")==0 )
@@ -2416,6 +3284,14 @@ int CTwMgr::HasAttrib(const char *_Attrib, bool *_HasValue) const
         return MGR_BUTTON_ALIGN;
     else if( _stricmp(_Attrib, "overlap")==0 )
         return MGR_OVERLAP;
+    else if( _stricmp(_Attrib, "fontscaling")==0 )
+        return MGR_FONT_SCALING;
+    else if( _stricmp(_Attrib, "fontsdf")==0 )
+        return MGR_FONT_SDF;
+    else if( _stricmp(_Attrib, "frametimes")==0 )
+        return MGR_FRAME_TIMES;
+    else if( _stricmp(_Attrib, "statsbar")==0 )
+        return MGR_STATS_BAR;
 
     *_HasValue = false;
     return 0; // not found
@@ -2705,6 +3581,84 @@ int CTwMgr::SetAttrib(int _AttribID, const char *_Value)
             g_TwMgr->SetLastError(g_ErrNoValue);
             return 0;
         }
+    case MGR_FONT_SCALING:
+        if( _Value && strlen(_Value)>0 )
+        {
+            float s;
+            int n = sscanf(_Value, "%f", &s);
+            if( n==1 && s>0 )
+            {
+                if( s!=g_FontScaling )
+                {
+                    // only the font metrics change, the font textures are kept
+                    g_FontScaling = s;
+                    RescaleFonts(false);
+                }
+                return 1;
+            }
+            else
+            {
+                SetLastError(g_ErrBadValue);
+                return 0;
+            }
+        }
+        else
+        {
+            SetLastError(g_ErrNoValue);
+            return 0;
+        }
+    case MGR_FONT_SDF:
+        if( _Value && strlen(_Value)>0 )
+        {
+            bool sdf;
+            if( _stricmp(_Value, "1")==0 || _stricmp(_Value, "true")==0 )
+                sdf = true;
+            else if( _stricmp(_Value, "0")==0 || _stricmp(_Value, "false")==0 )
+                sdf = false;
+            else
+            {
+                SetLastError(g_ErrBadValue);
+                return 0;
+            }
+            if( sdf && !TwSupportSDFFonts() )
+            {
+                SetLastError(g_ErrNoSDFFonts);
+                return 0;
+            }
+            if( sdf!=g_FontSDF )
+            {
+                g_FontSDF = sdf;
+                RescaleFonts(true);
+            }
+            return 1;
+        }
+        else
+        {
+            SetLastError(g_ErrNoValue);
+            return 0;
+        }
+    case MGR_STATS_BAR:
+        if( _Value && strlen(_Value)>0 )
+        {
+            if( _stricmp(_Value, "1")==0 || _stricmp(_Value, "true")==0 )
+                return CreateStatsBar() ? 1 : 0;
+            else if( _stricmp(_Value, "0")==0 || _stricmp(_Value, "false")==0 )
+            {
+                if( m_StatsBar!=NULL )
+                    return TwDeleteBar(m_StatsBar);
+                return 1;
+            }
+            else
+            {
+                SetLastError(g_ErrBadValue);
+                return 0;
+            }
+        }
+        else
+        {
+            SetLastError(g_ErrNoValue);
+            return 0;
+        }
     default:
         g_TwMgr->SetLastError(g_ErrUnknownAttrib);
         return 0;
@@ -2796,6 +3750,24 @@ ERetType CTwMgr::GetAttrib(int _AttribID, std::vector<double>& outDoubles, std::
     case MGR_OVERLAP:
         outDoubles.push_back(m_OverlapContent);
         return RET_DOUBLE;
+    case MGR_FONT_SCALING:
+        outDoubles.push_back(g_FontScaling);
+        return RET_DOUBLE;
+    case MGR_FONT_SDF:
+        outDoubles.push_back(g_FontSDF);
+        return RET_DOUBLE;
+    case MGR_FRAME_TIMES: // read-only: draw, update, text and submit times of the last frame in ms
+        {
+            const TwFrameStats& Stats = m_FrameStats[(m_CurFrameStats.Frame+NB_FRAME_STATS-1)%NB_FRAME_STATS];
+            outDoubles.push_back(Stats.DrawTime);
+            outDoubles.push_back(Stats.UpdateTime);
+            outDoubles.push_back(Stats.TextTime);
+            outDoubles.push_back(Stats.SubmitTime);
+            return RET_DOUBLE;
+        }
+    case MGR_STATS_BAR:
+        outDoubles.push_back(m_StatsBar!=NULL);
+        return RET_DOUBLE;
     default:
         g_TwMgr->SetLastError(g_ErrUnknownAttrib);
         return RET_ERROR;
@@ -2825,6 +3797,7 @@ void CTwMgr::Minimize(TwBar *_Bar)
         _Bar->m_MinNumber = -1;
     _Bar->m_IsMinimized = true;
     _Bar->NotUpToDate();
+    m_HitIndexDirty = true;
 }
 
 //  ---------------------------------------------------------------------------
@@ -2845,6 +3818,7 @@ void CTwMgr::Maximize(TwBar *_Bar)
     }
     _Bar->m_IsMinimized = false;
     _Bar->NotUpToDate();
+    m_HitIndexDirty = true;
     if( _Bar->m_IsHelpBar )
         m_HelpBarNotUpToDate = true;
 }
@@ -2864,6 +3838,7 @@ void CTwMgr::Hide(TwBar *_Bar)
     }
     else
         _Bar->m_Visible = false;
+    m_HitIndexDirty = true;
     if( !_Bar->m_IsHelpBar )
         m_HelpBarNotUpToDate = true;
 }
@@ -2884,12 +3859,32 @@ void CTwMgr::Unhide(TwBar *_Bar)
     else
         _Bar->m_Visible = true;
     _Bar->NotUpToDate();
+    m_HitIndexDirty = true;
     if( !_Bar->m_IsHelpBar )
         m_HelpBarNotUpToDate = true;
 }
 
 //  ---------------------------------------------------------------------------
 
+static void ResizeBarForFont(CTwBar *_Bar, int _PrevCharHeight, int _CharHeight)
+{
+    int fh = _PrevCharHeight;
+    if( fh<=0 )
+        return;
+    if( _Bar->m_Movable )
+    {
+        _Bar->m_PosX += (3*(fh-_CharHeight))/2;
+        _Bar->m_PosY += (fh-_CharHeight)/2;
+    }
+    if( _Bar->m_Resizable ) 
+    {
+        _Bar->m_Width = (_Bar->m_Width*_CharHeight)/fh;
+        _Bar->m_Height = (_Bar->m_Height*_CharHeight)/fh;
+        _Bar->m_ValuesWidth = (_Bar->m_ValuesWidth*_CharHeight)/fh;
+    }
+    g_TwMgr->m_HitIndexDirty = true;
+}
+
 void CTwMgr::SetFont(const CTexFont *_Font, bool _ResizeBars)
 {
     assert(m_Graph!=NULL);
@@ -2903,19 +3898,7 @@ void CTwMgr::SetFont(const CTexFont *_Font, bool _ResizeBars)
             int fh = m_Bars[i]->m_Font->m_CharHeight;
             m_Bars[i]->m_Font = _Font;
             if( _ResizeBars )
-            {
-                if( m_Bars[i]->m_Movable )
-                {
-                    m_Bars[i]->m_PosX += (3*(fh-_Font->m_CharHeight))/2;
-                    m_Bars[i]->m_PosY += (fh-_Font->m_CharHeight)/2;
-                }
-                if( m_Bars[i]->m_Resizable ) 
-                {
-                    m_Bars[i]->m_Width = (m_Bars[i]->m_Width*_Font->m_CharHeight)/fh;
-                    m_Bars[i]->m_Height = (m_Bars[i]->m_Height*_Font->m_CharHeight)/fh;
-                    m_Bars[i]->m_ValuesWidth = (m_Bars[i]->m_ValuesWidth*_Font->m_CharHeight)/fh;
-                }
-            }
+                ResizeBarForFont(m_Bars[i], fh, _Font->m_CharHeight);
             m_Bars[i]->NotUpToDate();
         }
 
@@ -2928,6 +3911,40 @@ void CTwMgr::SetFont(const CTexFont *_Font, bool _ResizeBars)
 
 //  ---------------------------------------------------------------------------
 
+// Applies g_FontScaling (and g_FontSDF if _Regenerate) to the default fonts.
+// Fonts are shared by all windows, so bars of every window are resized.
+void CTwMgr::RescaleFonts(bool _Regenerate)
+{
+    vector<int> PrevHeights;
+    CTwWndMap::iterator it;
+    int i;
+    for( it=g_Wnds.begin(); it!=g_Wnds.end(); ++it )
+        for( i=0; i<(int)it->second->m_Bars.size(); ++i )
+            PrevHeights.push_back((it->second->m_Bars[i]!=NULL) ? it->second->m_Bars[i]->m_Font->m_CharHeight : 0);
+
+    if( _Regenerate )
+        TwGenerateDefaultFonts(g_FontScaling, g_FontSDF);
+    else
+        TwScaleDefaultFonts(g_FontScaling);
+
+    size_t k = 0;
+    for( it=g_Wnds.begin(); it!=g_Wnds.end(); ++it )
+    {
+        CTwMgr *Mgr = it->second;
+        for( i=0; i<(int)Mgr->m_Bars.size(); ++i, ++k )
+            if( Mgr->m_Bars[i]!=NULL )
+            {
+                ResizeBarForFont(Mgr->m_Bars[i], PrevHeights[k], Mgr->m_Bars[i]->m_Font->m_CharHeight);
+                Mgr->m_Bars[i]->NotUpToDate();
+            }
+        Mgr->m_InfoBuildText = true;
+        Mgr->m_KeyPressedBuildText = true;
+        Mgr->m_HelpBarNotUpToDate = true;
+    }
+}
+
+//  ---------------------------------------------------------------------------
+
 void ANT_CALL TwGlobalError(const char *_ErrorMessage)  // to be called when g_TwMasterMgr is not created
 {
     if( g_ErrorHandler==NULL )
@@ -3089,6 +4106,7 @@ TwBar *ANT_CALL TwNewBar(const char *_Name)
     g_TwMgr->m_Order.push_back((int)g_TwMgr->m_Bars.size()-1);
     g_TwMgr->m_MinOccupied.push_back(false);
     g_TwMgr->m_HelpBarNotUpToDate = true;
+    g_TwMgr->m_HitIndexDirty = true;
 
     return Bar;
 }
@@ -3158,6 +4176,8 @@ int ANT_CALL TwDeleteBar(TwBar *_Bar)
 
     // erase & delete _Bar
     g_TwMgr->m_Bars.erase(BarIt);
+    if( _Bar==g_TwMgr->m_StatsBar )
+        g_TwMgr->m_StatsBar = NULL;
     delete _Bar;
 
     g_TwMgr->m_HelpBarNotUpToDate = true;
@@ -3189,13 +4209,19 @@ int ANT_CALL TwDeleteAllBars()
         g_TwMgr->m_Bars.clear();
         g_TwMgr->m_Order.clear();
         g_TwMgr->m_MinOccupied.clear();
+        g_TwMgr->m_StatsBar = NULL;
         g_TwMgr->m_HelpBarNotUpToDate = true;
     }
     else
     {
+        if( g_TwMgr->m_PopupBar!=NULL ) // deleted with the bar it is linked to
+        {
+            TwDeleteBar(g_TwMgr->m_PopupBar);
+            g_TwMgr->m_PopupBar = NULL;
+        }
         vector<CTwBar *> bars = g_TwMgr->m_Bars;
         for( size_t i = 0; i < bars.size(); ++i )
-            if( bars[i]!=0 && bars[i]!=g_TwMgr->m_HelpBar)
+            if( bars[i]!=0 && bars[i]!=g_TwMgr->m_HelpBar && bars[i]!=g_TwMgr->m_StatsBar )
             {
                 ++n;
                 TwDeleteBar(bars[i]);
@@ -3252,6 +4278,7 @@ int ANT_CALL TwSetTopBar(const TwBar *_Bar)
     for( int j=iOrder; j<(int)g_TwMgr->m_Bars.size()-1; ++j )
         g_TwMgr->m_Order[j] = g_TwMgr->m_Order[j+1];
     g_TwMgr->m_Order[(int)g_TwMgr->m_Bars.size()-1] = i;
+    g_TwMgr->m_HitIndexDirty = true;
 
     if( _Bar!=g_TwMgr->m_PopupBar && g_TwMgr->m_BarAlwaysOnTop.length()>0 )
     {
@@ -3326,6 +4353,7 @@ int ANT_CALL TwSetBottomBar(const TwBar *_Bar)
         for( int j=iOrder-1; j>=0; --j )
             g_TwMgr->m_Order[j+1] = g_TwMgr->m_Order[j];
     g_TwMgr->m_Order[0] = i;
+    g_TwMgr->m_HitIndexDirty = true;
 
     if( _Bar!=g_TwMgr->m_PopupBar && g_TwMgr->m_BarAlwaysOnBottom.length()>0 )
     {
@@ -3829,51 +4857,728 @@ int ANT_CALL TwSetParam(TwBar *bar, const char *varName, const char *paramName,
 }
 
 //  ---------------------------------------------------------------------------
+//  State snapshot, stored as is in preset files so that they can be mapped
+//  in memory and applied without parsing: a header, a table of bars, an index
+//  of var entries (name, type tag, value location) in hierarchy order, the
+//  names, and the values aligned on STATE_ALIGN bytes.
+//  Struct vars whose data holds no string pointer are stored as a whole so
+//  that they are read and written with a single call to their callbacks.
+//  Values are stored in the byte order of the platform which saved them.
+
+static const char g_StateMagic[4] = { 'T', 'w', 'S', 't' };
+static const unsigned int STATE_VERSION = 3;            // incremented each time the layout of the state changes
+static const unsigned int STATE_BYTE_ORDER = 0x01020304;
+static const unsigned int STATE_ALIGN = 8;
+
+struct CStateHeader
+{
+    char            m_Magic[4];
+    unsigned int    m_Version;      // STATE_VERSION
+    unsigned int    m_ByteOrder;    // STATE_BYTE_ORDER written in the byte order of the values
+    unsigned int    m_Size;         // total size of the state in bytes
+    unsigned int    m_NbBars;       // followed by m_NbBars CStateBar
+    unsigned int    m_NbEntries;    // followed by m_NbEntries CStateEntry
+};
 
-static int s_PassProxy = 0;
-void *CTwMgr::CStruct::s_PassProxyAsClientData = &s_PassProxy;  // special tag
+struct CStateBar                    // offsets are from the beginning of the state
+{
+    unsigned int    m_NameOffset;
+    unsigned int    m_NameLength;
+    unsigned int    m_FirstEntry;
+    unsigned int    m_NbEntries;
+};
 
-CTwMgr::CStructProxy::CStructProxy()
-{ 
-    memset(this, 0, sizeof(*this)); 
+struct CStateEntry
+{
+    unsigned int    m_NameOffset;
+    unsigned int    m_NameLength;
+    unsigned int    m_Type;         // see CStateTypeTags
+    unsigned int    m_TypeHash;
+    unsigned int    m_ValueOffset;
+    unsigned int    m_ValueSize;
+};
+
+enum EStateSlotKind { STATE_VALUE, STATE_STRING, STATE_STRUCT };
+
+struct CStateSlot
+{
+    CTwVar *    m_Var;
+    int         m_Kind;
+};
+
+static bool IsStructType(int _Type)
+{
+    return (_Type>=TW_TYPE_STRUCT_BASE && _Type<TW_TYPE_STRUCT_BASE+(int)g_TwMgr->m_Structs.size());
 }
 
-CTwMgr::CStructProxy::~CStructProxy() 
-{ 
-    if( m_StructData!=NULL && m_DeleteStructData )
-    {
-        //if( m_StructExtData==NULL && g_TwMgr!=NULL && m_Type>=TW_TYPE_STRUCT_BASE && m_Type<TW_TYPE_STRUCT_BASE+(int)g_TwMgr->m_Structs.size() )
-        //  g_TwMgr->UninitVarData(m_Type, m_StructData, g_TwMgr->m_Structs[m_Type-TW_TYPE_STRUCT_BASE].m_Size);
-        delete[] (char*)m_StructData;
-    }
-    if( m_StructExtData!=NULL )
-    {
-        //if( g_TwMgr!=NULL && m_Type>=TW_TYPE_STRUCT_BASE && m_Type<TW_TYPE_STRUCT_BASE+(int)g_TwMgr->m_Structs.size() )
-        //  g_TwMgr->UninitVarData(m_Type, m_StructExtData, g_TwMgr->m_Structs[m_Type-TW_TYPE_STRUCT_BASE].m_Size);
-        delete[] (char*)m_StructExtData;
-    }
-    memset(this, 0, sizeof(*this));
+static unsigned int StateHash(unsigned int _Hash, const void *_Data, size_t _Size)
+{
+    const unsigned char *Data = static_cast<const unsigned char *>(_Data);
+    for( size_t i=0; i<_Size; ++i )
+        _Hash = (_Hash ^ Data[i]) * 16777619u;  // FNV-1a
+    return _Hash;
 }
 
-/*
-void CTwMgr::InitVarData(TwType _Type, void *_Data, size_t _Size)
+// The ids of enum and struct types depend on the order they are defined in a
+// session. Entries of these types store TW_TYPE_ENUM_BASE or TW_TYPE_STRUCT_BASE
+// and a hash of the type name and layout, the other types store their id.
+struct CStateTypeTags
 {
-    if( _Data!=NULL )
+    std::vector<unsigned int>   m_StructHashes; // computed once per save or load, 0 if not computed yet
+    std::vector<unsigned int>   m_EnumHashes;
+    unsigned int                Tag(int _Type, unsigned int *_TypeHash);
+};
+
+unsigned int CStateTypeTags::Tag(int _Type, unsigned int *_TypeHash)
+{
+    if( IsStructType(_Type) )
     {
-        if( _Type>=TW_TYPE_STRUCT_BASE && _Type<TW_TYPE_STRUCT_BASE+(int)m_Structs.size() )
+        size_t Idx = _Type - TW_TYPE_STRUCT_BASE;
+        if( m_StructHashes.size()<=Idx )
+            m_StructHashes.resize(g_TwMgr->m_Structs.size(), 0);
+        if( m_StructHashes[Idx]==0 )
         {
-            CTwMgr::CStruct& s = m_Structs[_Type-TW_TYPE_STRUCT_BASE];
+            const CTwMgr::CStruct& s = g_TwMgr->m_Structs[Idx];
+            unsigned int Size = (unsigned int)(s.m_IsExt ? s.m_ClientStructSize : s.m_Size);
+            unsigned int h = StateHash(2166136261u, s.m_Name.c_str(), s.m_Name.length()+1);
+            h = StateHash(h, &Size, sizeof(Size));
             for( size_t i=0; i<s.m_Members.size(); ++i )
             {
-                CTwMgr::CStructMember& sm = s.m_Members[i];
-                assert( sm.m_Offset+sm.m_Size<=_Size );
-                InitVarData(sm.m_Type, (char *)_Data + sm.m_Offset, sm.m_Size);
+                const CTwMgr::CStructMember& m = s.m_Members[i];
+                unsigned int Layout[3];
+                Layout[0] = Tag(m.m_Type, &Layout[1]);
+                Layout[2] = (unsigned int)m.m_Offset;
+                h = StateHash(h, m.m_Name.c_str(), m.m_Name.length()+1);
+                h = StateHash(h, Layout, sizeof(Layout));
             }
+            m_StructHashes[Idx] = (h!=0) ? h : 1;
         }
-        else if( _Type==TW_TYPE_STDSTRING )
-            ::new(_Data) std::string;
-        else
-            memset(_Data, 0, _Size);
+        *_TypeHash = m_StructHashes[Idx];
+        return TW_TYPE_STRUCT_BASE;
+    }
+    if( _Type>=TW_TYPE_ENUM_BASE && _Type<TW_TYPE_ENUM_BASE+(int)g_TwMgr->m_Enums.size() )
+    {
+        // enum values are stored as 32-bit integers: the name is the layout
+        size_t Idx = _Type - TW_TYPE_ENUM_BASE;
+        if( m_EnumHashes.size()<=Idx )
+            m_EnumHashes.resize(g_TwMgr->m_Enums.size(), 0);
+        if( m_EnumHashes[Idx]==0 )
+        {
+            const string& Name = g_TwMgr->m_Enums[Idx].m_Name;
+            unsigned int h = StateHash(2166136261u, Name.c_str(), Name.length()+1);
+            m_EnumHashes[Idx] = (h!=0) ? h : 1;
+        }
+        *_TypeHash = m_EnumHashes[Idx];
+        return TW_TYPE_ENUM_BASE;
+    }
+    *_TypeHash = 0;
+    return (unsigned int)_Type;
+}
+
+// Returns true if the struct data can be copied byte by byte
+static bool IsPlainStruct(int _Type)
+{
+    const CTwMgr::CStruct& s = g_TwMgr->m_Structs[_Type-TW_TYPE_STRUCT_BASE];
+    if( s.m_IsExt )
+        return true;    // client data of the built-in ext structs are numbers
+    for( size_t i=0; i<s.m_Members.size(); ++i )
+    {
+        int t = s.m_Members[i].m_Type;
+        if( t==TW_TYPE_CDSTRING || t==TW_TYPE_STDSTRING || t==TW_TYPE_CDSTDSTRING || t==TW_TYPE_STRINGVIEW || (IsStructType(t) && !IsPlainStruct(t)) )
+            return false;
+    }
+    return true;
+}
+
+// Lists the vars of _Grp whose value is saved, in the same order for TwSaveState and TwLoadState
+static void CollectStateSlots(CTwBar *_Bar, CTwVarGroup *_Grp, vector<CStateSlot>& _Slots)
+{
+    for( size_t i=0; i<_Grp->m_Vars.size(); ++i )
+    {
+        CTwVar *Var = _Grp->m_Vars[i];
+        if( Var==NULL )
+            continue;
+        CStateSlot Slot;
+        Slot.m_Var = Var;
+        if( Var->IsGroup() )
+        {
+            CTwVarGroup *Grp = static_cast<CTwVarGroup *>(Var);
+            if( Grp->m_ArrayProxy!=NULL )
+                continue;   // the rows of an array only map its current page
+            bool IsStruct = IsStructType(Grp->m_StructType) && (Grp->m_StructProxy!=NULL || Grp->m_StructValuePtr!=NULL);
+            if( IsStruct && Grp->IsReadOnly() )
+                continue;
+            if( IsStruct && IsPlainStruct(Grp->m_StructType) )
+            {
+                Slot.m_Kind = STATE_STRUCT;
+                _Slots.push_back(Slot);
+            }
+            else
+            {
+                if( Grp->m_StructPending )
+                    TwExpandStructVar(_Bar, Grp);   // members are saved one by one
+                CollectStateSlots(_Bar, Grp, _Slots);
+            }
+        }
+        else
+        {
+            CTwVarAtom *Atom = static_cast<CTwVarAtom *>(Var);
+            if( Atom->IsReadOnly() || Atom->IsCustom() )
+                continue;
+            if( Atom->m_Type==TW_TYPE_CDSTRING || Atom->m_Type==TW_TYPE_CDSTDSTRING || Atom->m_Type==TW_TYPE_STRINGVIEW || IsCSStringType(Atom->m_Type) )
+                Slot.m_Kind = STATE_STRING;
+            else if( Atom->m_Type!=TW_TYPE_STDSTRING && !IsStructType(Atom->m_Type) && CTwVar::GetDataSize(Atom->m_Type)>0 )
+                Slot.m_Kind = STATE_VALUE;
+            else
+                continue;
+            _Slots.push_back(Slot);
+        }
+    }
+}
+
+// Client data of a struct var saved as a whole
+static char *StateStructData(const CTwVarGroup *_Grp, size_t *_Size)
+{
+    const CTwMgr::CStruct& s = g_TwMgr->m_Structs[_Grp->m_StructType-TW_TYPE_STRUCT_BASE];
+    const CTwMgr::CStructProxy *sProxy = _Grp->m_StructProxy;
+    if( sProxy==NULL )
+    {
+        *_Size = s.m_Size;
+        return static_cast<char *>(_Grp->m_StructValuePtr);
+    }
+    *_Size = s.m_IsExt ? s.m_ClientStructSize : s.m_Size;
+    return static_cast<char *>(sProxy->m_StructData);
+}
+
+static void SetStateString(CTwVarAtom *_Atom, const string& _Str)
+{
+    if( IsCSStringType(_Atom->m_Type) )
+    {
+        size_t n = TW_CSSTRING_SIZE(_Atom->m_Type);
+        string Str = _Str.substr(0, n-1);
+        if( _Atom->m_SetCallback!=NULL )
+            _Atom->m_SetCallback(Str.c_str(), _Atom->m_ClientData);
+        else if( _Atom->m_Ptr!=NULL )
+            memcpy(_Atom->m_Ptr, Str.c_str(), Str.length()+1);
+    }
+    else if( _Atom->m_Type==TW_TYPE_STRINGVIEW )
+        _Atom->SetStringView(_Str.c_str(), _Str.length());
+    else
+    {
+        const char *Str = _Str.c_str();
+        if( _Atom->m_SetCallback!=NULL )
+            _Atom->m_SetCallback(&Str, _Atom->m_ClientData);
+        else if( _Atom->m_Type==TW_TYPE_CDSTRING && _Atom->m_Ptr!=NULL && g_TwMgr->m_CopyCDStringToClient!=NULL )
+            g_TwMgr->m_CopyCDStringToClient((char **)_Atom->m_Ptr, Str);
+    }
+}
+
+// Appends a value aligned on STATE_ALIGN bytes and returns its offset
+static unsigned int StateAddValue(vector<char>& _Buf, const void *_Data, size_t _Size)
+{
+    size_t Pos = (_Buf.size() + STATE_ALIGN-1) & ~(size_t)(STATE_ALIGN-1);
+    _Buf.resize(Pos + _Size);
+    if( _Size>0 )
+        memcpy(&_Buf[Pos], _Data, _Size);
+    return (unsigned int)Pos;
+}
+
+const void * ANT_CALL TwSaveState(size_t *_StateSize)
+{
+    CTwFPU fpu; // force fpu precision
+
+    if( g_TwMgr==NULL )
+    {
+        TwGlobalError(g_ErrNotInit);
+        return NULL; // not initialized
+    }
+    if( _StateSize==NULL )
+    {
+        g_TwMgr->SetLastError(g_ErrBadParam);
+        return NULL;
+    }
+
+    // list the saved vars first so that the tables and names can be placed before the values
+    vector<CStateBar> Bars;
+    vector<const CTwBar *> SavedBars;
+    vector<CStateSlot> Slots;
+    size_t NamesSize = 0;
+    for( size_t ib=0; ib<g_TwMgr->m_Bars.size(); ++ib )
+    {
+        CTwBar *Bar = g_TwMgr->m_Bars[ib];
+        if( Bar==NULL || Bar==g_TwMgr->m_HelpBar || Bar==g_TwMgr->m_PopupBar )
+            continue;
+        CStateBar StateBar;
+        StateBar.m_NameOffset = 0;  // set once the names are placed
+        StateBar.m_NameLength = (unsigned int)Bar->m_Name.length();
+        StateBar.m_FirstEntry = (unsigned int)Slots.size();
+        Slots.reserve(Slots.size() + Bar->m_VarRoot.m_Vars.size());
+        CollectStateSlots(Bar, &Bar->m_VarRoot, Slots);
+        StateBar.m_NbEntries = (unsigned int)(Slots.size() - StateBar.m_FirstEntry);
+        Bars.push_back(StateBar);
+        SavedBars.push_back(Bar);
+        NamesSize += Bar->m_Name.length();
+    }
+    for( size_t i=0; i<Slots.size(); ++i )
+        NamesSize += Slots[i].m_Var->m_Name.length();
+
+    size_t BarsPos = sizeof(CStateHeader);
+    size_t EntriesPos = BarsPos + Bars.size()*sizeof(CStateBar);
+    size_t NamesPos = EntriesPos + Slots.size()*sizeof(CStateEntry);
+    size_t ValuesPos = (NamesPos + NamesSize + STATE_ALIGN-1) & ~(size_t)(STATE_ALIGN-1);
+    vector<char>& Buf = g_TwMgr->m_StateBuffer; // its capacity is kept from one call to the next
+    Buf.assign(ValuesPos, 0);
+    size_t NamePos = NamesPos;
+    for( size_t ib=0; ib<Bars.size(); ++ib )
+    {
+        const CTwBar *Bar = SavedBars[ib];
+        Bars[ib].m_NameOffset = (unsigned int)NamePos;
+        memcpy(&Buf[NamePos], Bar->m_Name.c_str(), Bar->m_Name.length());
+        NamePos += Bar->m_Name.length();
+    }
+    if( Bars.size()>0 )
+        memcpy(&Buf[BarsPos], &Bars[0], Bars.size()*sizeof(CStateBar));
+
+    string Str;
+    CStateTypeTags Tags;
+    for( size_t i=0; i<Slots.size(); ++i )
+    {
+        const CTwVar *Var = Slots[i].m_Var;
+        CStateEntry Entry;
+        Entry.m_NameOffset = (unsigned int)NamePos;
+        Entry.m_NameLength = (unsigned int)Var->m_Name.length();
+        memcpy(&Buf[NamePos], Var->m_Name.c_str(), Var->m_Name.length());
+        NamePos += Var->m_Name.length();
+        if( Slots[i].m_Kind==STATE_STRUCT )
+        {
+            const CTwVarGroup *Grp = static_cast<const CTwVarGroup *>(Var);
+            const CTwMgr::CStructProxy *sProxy = Grp->m_StructProxy;
+            if( sProxy!=NULL && sProxy->m_StructGetCallback!=NULL )
+                sProxy->m_StructGetCallback(sProxy->m_StructData, sProxy->m_StructClientData);
+            size_t Size;
+            const char *Data = StateStructData(Grp, &Size);
+            Entry.m_Type = Tags.Tag(Grp->m_StructType, &Entry.m_TypeHash);
+            Entry.m_ValueSize = (unsigned int)Size;
+            Entry.m_ValueOffset = StateAddValue(Buf, Data, Size);
+        }
+        else if( Slots[i].m_Kind==STATE_STRING )
+        {
+            static_cast<const CTwVarAtom *>(Var)->ValueToString(&Str);
+            Entry.m_Type = TW_TYPE_CDSTRING;
+            Entry.m_TypeHash = 0;
+            Entry.m_ValueSize = (unsigned int)Str.length();
+            Entry.m_ValueOffset = StateAddValue(Buf, Str.c_str(), Str.length());
+        }
+        else
+        {
+            const CTwVarAtom *Atom = static_cast<const CTwVarAtom *>(Var);
+            size_t Size = CTwVar::GetDataSize(Atom->m_Type);
+            double Val[2] = { 0, 0 }; // large enough for all the STATE_VALUE types
+            if( Atom->m_Ptr!=NULL )
+                memcpy(Val, Atom->m_Ptr, Size);
+            else
+                Atom->m_GetCallback(Val, Atom->m_ClientData);
+            Entry.m_Type = Tags.Tag(Atom->m_Type, &Entry.m_TypeHash);
+            Entry.m_ValueSize = (unsigned int)Size;
+            Entry.m_ValueOffset = StateAddValue(Buf, Val, Size);
+        }
+        memcpy(&Buf[EntriesPos + i*sizeof(CStateEntry)], &Entry, sizeof(Entry));
+    }
+
+    CStateHeader Header;
+    memcpy(Header.m_Magic, g_StateMagic, sizeof(g_StateMagic));
+    Header.m_Version = STATE_VERSION;
+    Header.m_ByteOrder = STATE_BYTE_ORDER;
+    Header.m_Size = (unsigned int)Buf.size();
+    Header.m_NbBars = (unsigned int)Bars.size();
+    Header.m_NbEntries = (unsigned int)Slots.size();
+    memcpy(&Buf[0], &Header, sizeof(Header));
+
+    *_StateSize = Buf.size();
+    return &Buf[0];
+}
+
+//  ---------------------------------------------------------------------------
+
+static bool StateRange(const CStateHeader& _Header, unsigned int _Offset, unsigned int _Size)
+{
+    return _Offset<=_Header.m_Size && _Size<=_Header.m_Size-_Offset;
+}
+
+// Checks the bounds of all the tables and entries before anything is applied
+static bool CheckState(const char *_State, size_t _StateSize)
+{
+    CStateHeader Header;
+    if( _State==NULL || _StateSize<sizeof(Header) )
+        return false;
+    memcpy(&Header, _State, sizeof(Header));    // the state may not be aligned
+    if( memcmp(Header.m_Magic, g_StateMagic, sizeof(g_StateMagic))!=0 || Header.m_Size>_StateSize
+        || Header.m_NbBars>Header.m_Size/sizeof(CStateBar) || Header.m_NbEntries>Header.m_Size/sizeof(CStateEntry)
+        || sizeof(Header) + Header.m_NbBars*sizeof(CStateBar) + Header.m_NbEntries*sizeof(CStateEntry)>Header.m_Size )
+        return false;
+    const char *Bars = _State + sizeof(Header);
+    for( unsigned int ib=0; ib<Header.m_NbBars; ++ib )
+    {
+        CStateBar Bar;
+        memcpy(&Bar, Bars + ib*sizeof(CStateBar), sizeof(Bar));
+        if( !StateRange(Header, Bar.m_NameOffset, Bar.m_NameLength) || Bar.m_FirstEntry>Header.m_NbEntries || Bar.m_NbEntries>Header.m_NbEntries-Bar.m_FirstEntry )
+            return false;
+    }
+    const char *Entries = Bars + Header.m_NbBars*sizeof(CStateBar);
+    for( unsigned int i=0; i<Header.m_NbEntries; ++i )
+    {
+        CStateEntry Entry;
+        memcpy(&Entry, Entries + i*sizeof(CStateEntry), sizeof(Entry));
+        if( !StateRange(Header, Entry.m_NameOffset, Entry.m_NameLength) || !StateRange(Header, Entry.m_ValueOffset, Entry.m_ValueSize) )
+            return false;
+    }
+    return true;
+}
+
+// Sets the vars whose value differs from the state; each modified bar is invalidated once
+static int ApplyState(const char *_State, size_t _StateSize)
+{
+    CStateHeader Header;
+    if( _State!=NULL && _StateSize>=sizeof(Header) )
+    {
+        memcpy(&Header, _State, sizeof(Header));
+        if( memcmp(Header.m_Magic, g_StateMagic, sizeof(g_StateMagic))==0 && (Header.m_Version!=STATE_VERSION || Header.m_ByteOrder!=STATE_BYTE_ORDER) )
+        {
+            g_TwMgr->SetLastError(g_ErrStateVersion);
+            return 0;
+        }
+    }
+    if( !CheckState(_State, _StateSize) )
+    {
+        g_TwMgr->SetLastError(g_ErrBadState);
+        return 0;
+    }
+
+    memcpy(&Header, _State, sizeof(Header));
+    const char *Bars = _State + sizeof(Header);
+    const char *Entries = Bars + Header.m_NbBars*sizeof(CStateBar);
+    vector<CStateSlot> Slots;
+    map<string, size_t> SlotIndex;  // only built if the entries are not in the order of the slots
+    string Str;
+    CStateTypeTags Tags;
+    unsigned int TypeHash;
+    for( unsigned int ib=0; ib<Header.m_NbBars; ++ib )
+    {
+        CStateBar StateBar;
+        memcpy(&StateBar, Bars + ib*sizeof(CStateBar), sizeof(StateBar));
+        int BarIdx = g_TwMgr->FindBar(string(_State + StateBar.m_NameOffset, StateBar.m_NameLength).c_str());
+        CTwBar *Bar = (BarIdx>=0) ? g_TwMgr->m_Bars[BarIdx] : NULL;
+        if( Bar==NULL || Bar==g_TwMgr->m_HelpBar || Bar==g_TwMgr->m_PopupBar )
+            continue;
+        Slots.resize(0);
+        Slots.reserve(Bar->m_VarRoot.m_Vars.size());
+        CollectStateSlots(Bar, &Bar->m_VarRoot, Slots);
+        SlotIndex.clear();
+
+        size_t Next = 0;
+        bool Changed = false;
+        for( unsigned int i=StateBar.m_FirstEntry; i<StateBar.m_FirstEntry+StateBar.m_NbEntries; ++i )
+        {
+            CStateEntry Entry;
+            memcpy(&Entry, Entries + i*sizeof(CStateEntry), sizeof(Entry));
+            const char *Name = _State + Entry.m_NameOffset;
+            const char *Value = _State + Entry.m_ValueOffset;
+            size_t Size = Entry.m_ValueSize;
+
+            // entries are usually found in the order of the slots
+            const CStateSlot *Slot = NULL;
+            if( Next<Slots.size() && Slots[Next].m_Var->m_Name.length()==Entry.m_NameLength && memcmp(Slots[Next].m_Var->m_Name.c_str(), Name, Entry.m_NameLength)==0 )
+                Slot = &Slots[Next++];
+            else if( Slots.size()>0 )
+            {
+                if( SlotIndex.empty() )
+                    for( size_t j=0; j<Slots.size(); ++j )
+                        SlotIndex[Slots[j].m_Var->m_Name.Str()] = j;
+                map<string, size_t>::const_iterator it = SlotIndex.find(string(Name, Entry.m_NameLength));
+                if( it!=SlotIndex.end() )
+                {
+                    Slot = &Slots[it->second];
+                    Next = it->second + 1;
+                }
+            }
+            if( Slot==NULL )
+                continue;   // var removed since the state was saved
+
+            if( Slot->m_Kind==STATE_STRUCT )
+            {
+                CTwVarGroup *Grp = static_cast<CTwVarGroup *>(Slot->m_Var);
+                size_t StructSize;
+                char *StructData = StateStructData(Grp, &StructSize);
+                const CTwMgr::CStructProxy *sProxy = Grp->m_StructProxy;
+                if( Entry.m_Type==Tags.Tag(Grp->m_StructType, &TypeHash) && Entry.m_TypeHash==TypeHash && Size==StructSize && StructData!=NULL )
+                {
+                    if( sProxy!=NULL && sProxy->m_StructGetCallback!=NULL )
+                        sProxy->m_StructGetCallback(sProxy->m_StructData, sProxy->m_StructClientData);
+                    if( memcmp(StructData, Value, Size)!=0 )
+                    {
+                        memcpy(StructData, Value, Size);
+                        if( sProxy!=NULL && sProxy->m_StructSetCallback!=NULL )
+                            sProxy->m_StructSetCallback(sProxy->m_StructData, sProxy->m_StructClientData);
+                        Changed = true;
+                    }
+                }
+            }
+            else if( Slot->m_Kind==STATE_STRING )
+            {
+                CTwVarAtom *Atom = static_cast<CTwVarAtom *>(Slot->m_Var);
+                if( Entry.m_Type==TW_TYPE_CDSTRING )
+                {
+                    Atom->ValueToString(&Str);
+                    if( Str.length()!=Size || memcmp(Str.c_str(), Value, Size)!=0 )
+                    {
+                        SetStateString(Atom, string(Value, Size));
+                        Changed = true;
+                    }
+                }
+            }
+            else
+            {
+                CTwVarAtom *Atom = static_cast<CTwVarAtom *>(Slot->m_Var);
+                if( Entry.m_Type==Tags.Tag(Atom->m_Type, &TypeHash) && Entry.m_TypeHash==TypeHash && Size==CTwVar::GetDataSize(Atom->m_Type) )
+                {
+                    double Val[2];
+                    if( Atom->m_Ptr!=NULL )
+                    {
+                        if( memcmp(Atom->m_Ptr, Value, Size)!=0 )
+                        {
+                            memcpy(Atom->m_Ptr, Value, Size);
+                            Changed = true;
+                        }
+                    }
+                    else
+                    {
+                        Atom->m_GetCallback(Val, Atom->m_ClientData);
+                        if( memcmp(Val, Value, Size)!=0 )
+                        {
+                            memcpy(Val, Value, Size);
+                            Atom->m_SetCallback(Val, Atom->m_ClientData);
+                            Changed = true;
+                        }
+                    }
+                }
+            }
+        }
+
+        if( g_TwMgr==NULL ) // Mgr might have been destroyed by the client inside a callback call
+            return 1;
+        if( Changed )
+            Bar->NotUpToDate();
+    }
+
+    return 1;
+}
+
+int ANT_CALL TwLoadState(const void *_State, size_t _StateSize)
+{
+    CTwFPU fpu; // force fpu precision
+
+    if( g_TwMgr==NULL )
+    {
+        TwGlobalError(g_ErrNotInit);
+        return 0; // not initialized
+    }
+
+    return ApplyState(static_cast<const char *>(_State), _StateSize);
+}
+
+//  ---------------------------------------------------------------------------
+
+// Read-only memory mapping of a preset file
+struct CMappedFile
+{
+    const char *    m_Data;
+    size_t          m_Size;
+#if defined(ANT_WINDOWS)
+    HANDLE          m_File;
+    HANDLE          m_Mapping;
+#endif
+                    CMappedFile() : m_Data(NULL), m_Size(0) {}
+                    ~CMappedFile() { Unmap(); }
+    bool            Map(const char *_FileName);
+    void            Unmap();
+};
+
+#if defined(ANT_WINDOWS)
+
+bool CMappedFile::Map(const char *_FileName)
+{
+    m_File = CreateFileA(_FileName, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if( m_File==INVALID_HANDLE_VALUE )
+        return false;
+    LARGE_INTEGER Size;
+    m_Mapping = NULL;
+    if( GetFileSizeEx(m_File, &Size) && Size.QuadPart>0 && Size.HighPart==0 )
+        m_Mapping = CreateFileMappingA(m_File, NULL, PAGE_READONLY, 0, 0, NULL);
+    if( m_Mapping!=NULL )
+        m_Data = static_cast<const char *>(MapViewOfFile(m_Mapping, FILE_MAP_READ, 0, 0, 0));
+    if( m_Data==NULL )
+    {
+        if( m_Mapping!=NULL )
+            CloseHandle(m_Mapping);
+        CloseHandle(m_File);
+        return false;
+    }
+    m_Size = (size_t)Size.QuadPart;
+    return true;
+}
+
+void CMappedFile::Unmap()
+{
+    if( m_Data!=NULL )
+    {
+        UnmapViewOfFile(m_Data);
+        CloseHandle(m_Mapping);
+        CloseHandle(m_File);
+        m_Data = NULL;
+    }
+}
+
+#else // ANT_UNIX or ANT_OSX
+
+bool CMappedFile::Map(const char *_FileName)
+{
+    int File = open(_FileName, O_RDONLY);
+    if( File<0 )
+        return false;
+    struct stat Stat;
+    void *Data = MAP_FAILED;
+    if( fstat(File, &Stat)==0 && Stat.st_size>0 )
+        Data = mmap(NULL, (size_t)Stat.st_size, PROT_READ, MAP_PRIVATE, File, 0);
+    close(File);    // the mapping stays valid
+    if( Data==MAP_FAILED )
+        return false;
+    m_Data = static_cast<const char *>(Data);
+    m_Size = (size_t)Stat.st_size;
+    return true;
+}
+
+void CMappedFile::Unmap()
+{
+    if( m_Data!=NULL )
+    {
+        munmap(const_cast<char *>(m_Data), m_Size);
+        m_Data = NULL;
+    }
+}
+
+#endif // defined(ANT_WINDOWS)
+
+int ANT_CALL TwSavePreset(const char *_FileName)
+{
+    if( g_TwMgr==NULL )
+    {
+        TwGlobalError(g_ErrNotInit);
+        return 0; // not initialized
+    }
+    if( _FileName==NULL )
+    {
+        g_TwMgr->SetLastError(g_ErrBadParam);
+        return 0;
+    }
+
+    size_t Size = 0;
+    const void *State = TwSaveState(&Size);
+    if( State==NULL )
+        return 0;
+    FILE *File = fopen(_FileName, "wb");
+    if( File==NULL )
+    {
+        g_TwMgr->SetLastError(g_ErrPresetFile);
+        return 0;
+    }
+    bool Written = (fwrite(State, 1, Size, File)==Size);
+    if( fclose(File)!=0 || !Written )
+    {
+        g_TwMgr->SetLastError(g_ErrPresetFile);
+        return 0;
+    }
+    return 1;
+}
+
+int ANT_CALL TwApplyPreset(const char *_FileName)
+{
+    CTwFPU fpu; // force fpu precision
+
+    if( g_TwMgr==NULL )
+    {
+        TwGlobalError(g_ErrNotInit);
+        return 0; // not initialized
+    }
+    if( _FileName==NULL )
+    {
+        g_TwMgr->SetLastError(g_ErrBadParam);
+        return 0;
+    }
+
+    CMappedFile File;   // pages are only read when their entries are compared
+    if( !File.Map(_FileName) )
+    {
+        g_TwMgr->SetLastError(g_ErrPresetFile);
+        return 0;
+    }
+    return ApplyState(File.m_Data, File.m_Size);
+}
+
+//  ---------------------------------------------------------------------------
+
+static int s_PassProxy = 0;
+void *CTwMgr::CStruct::s_PassProxyAsClientData = &s_PassProxy;  // special tag
+
+CTwMgr::CStructProxy::CStructProxy()
+{ 
+    memset(this, 0, sizeof(*this)); 
+}
+
+void CTwMgr::CStructProxy::SetCustomCaptureFocus(bool _Focus)
+{
+    m_CustomCaptureFocus = _Focus;
+    if( _Focus )
+        g_TwMgr->m_CustomCaptureProxy = this;
+    else if( g_TwMgr->m_CustomCaptureProxy==this )
+        g_TwMgr->m_CustomCaptureProxy = NULL;
+}
+
+CTwMgr::CStructProxy::~CStructProxy() 
+{ 
+    if( m_StructData!=NULL && m_DeleteStructData )
+    {
+        //if( m_StructExtData==NULL && g_TwMgr!=NULL && m_Type>=TW_TYPE_STRUCT_BASE && m_Type<TW_TYPE_STRUCT_BASE+(int)g_TwMgr->m_Structs.size() )
+        //  g_TwMgr->UninitVarData(m_Type, m_StructData, g_TwMgr->m_Structs[m_Type-TW_TYPE_STRUCT_BASE].m_Size);
+        delete[] (char*)m_StructData;
+    }
+    if( m_StructExtData!=NULL )
+    {
+        //if( g_TwMgr!=NULL && m_Type>=TW_TYPE_STRUCT_BASE && m_Type<TW_TYPE_STRUCT_BASE+(int)g_TwMgr->m_Structs.size() )
+        //  g_TwMgr->UninitVarData(m_Type, m_StructExtData, g_TwMgr->m_Structs[m_Type-TW_TYPE_STRUCT_BASE].m_Size);
+        delete[] (char*)m_StructExtData;
+    }
+    memset(this, 0, sizeof(*this));
+}
+
+/*
+void CTwMgr::InitVarData(TwType _Type, void *_Data, size_t _Size)
+{
+    if( _Data!=NULL )
+    {
+        if( _Type>=TW_TYPE_STRUCT_BASE && _Type<TW_TYPE_STRUCT_BASE+(int)m_Structs.size() )
+        {
+            CTwMgr::CStruct& s = m_Structs[_Type-TW_TYPE_STRUCT_BASE];
+            for( size_t i=0; i<s.m_Members.size(); ++i )
+            {
+                CTwMgr::CStructMember& sm = s.m_Members[i];
+                assert( sm.m_Offset+sm.m_Size<=_Size );
+                InitVarData(sm.m_Type, (char *)_Data + sm.m_Offset, sm.m_Size);
+            }
+        }
+        else if( _Type==TW_TYPE_STDSTRING )
+            ::new(_Data) std::string;
+        else
+            memset(_Data, 0, _Size);
     }
 }
 
@@ -4098,6 +5803,87 @@ static int s_SeparatorTag = 0;
 
 //  ---------------------------------------------------------------------------
 
+// Adds the member vars of the struct var _Name. Members point directly into
+// _StructPtr if _Proxy is NULL, or are accessed through member proxies otherwise.
+static int AddStructMembers(TwBar *_Bar, const char *_Name, TwType _Type, void *_StructPtr, CTwMgr::CStructProxy *_Proxy, bool _ReadOnly)
+{
+    CTwMgr::CStruct& s = g_TwMgr->m_Structs[_Type-TW_TYPE_STRUCT_BASE];
+    for( int i=0; i<(int)s.m_Members.size(); ++i )
+    {
+        CTwMgr::CStructMember& m = s.m_Members[i];
+        string name = string(_Name) + '.' + m.m_Name;
+        const char *access = "";
+        if( _ReadOnly )
+            access = "readonly ";
+        string def  = "label=`" + m.m_Name + "` group=`" + _Name + "` " + access; // + m.m_DefString;  // member def must be done after group def
+        if( _Proxy==NULL )
+        {
+            if( TwAddVarRW(_Bar, name.c_str(), m.m_Type, (char*)_StructPtr+m.m_Offset, def.c_str())==0 )
+                return 0;
+        }
+        else
+        {
+            // create a new MemberProxy
+            g_TwMgr->m_MemberProxies.push_back(CTwMgr::CMemberProxy());
+            CTwMgr::CMemberProxy& mProxy = g_TwMgr->m_MemberProxies.back();
+            mProxy.m_StructProxy = _Proxy;
+            mProxy.m_MemberIndex = i;
+            assert( !(s.m_IsExt && (m.m_Type==TW_TYPE_STDSTRING || m.m_Type==TW_TYPE_CDSTDSTRING)) );   // forbidden because this case is not handled by UnrollCDStdString
+            if( TwAddVarCB(_Bar, name.c_str(), m.m_Type, CTwMgr::CMemberProxy::SetCB, CTwMgr::CMemberProxy::GetCB, &mProxy, def.c_str())==0 )
+                return 0;
+            mProxy.m_Var = _Bar->Find(name.c_str(), &mProxy.m_VarParent, NULL);
+            mProxy.m_Bar = _Bar;
+
+            if( IsCustomType(m.m_Type) ) // m.m_Type>=TW_TYPE_CUSTOM_BASE && m.m_Type<TW_TYPE_CUSTOM_BASE+(int)g_TwMgr->m_Customs.size() )
+            {
+                if( _Proxy->m_CustomIndexFirst<0 )
+                    _Proxy->m_CustomIndexFirst = _Proxy->m_CustomIndexLast = i;
+                else
+                    _Proxy->m_CustomIndexLast = i;
+            }
+        }
+    }
+    return 1;
+}
+
+// Applies the def strings of the struct members, must be done after the struct group def
+static int DefineStructMembers(TwBar *_Bar, const char *_Name, TwType _Type)
+{
+    const CTwMgr::CStruct& s = g_TwMgr->m_Structs[_Type-TW_TYPE_STRUCT_BASE];
+    int ret = 1;
+    for( int i=0; i<(int)s.m_Members.size(); ++i )
+    {
+        const CTwMgr::CStructMember& m = s.m_Members[i];
+        if( m.m_DefString.length()>0 )
+        {
+            string memberDef = '`' + _Bar->m_Name + "`/`" + _Name + '.' + m.m_Name + "` " + m.m_DefString;
+            if( !TwDefine(memberDef.c_str()) ) // all members must be defined even if memberDef has error
+                ret = 0;
+        }
+    }
+    return ret;
+}
+
+// Creates the members of a struct var added with deferred members.
+// Called when the struct group is opened or when one of its members is looked up.
+int TwExpandStructVar(CTwBar *_Bar, CTwVarGroup *_StructGrp)
+{
+    assert( g_TwMgr!=NULL && _Bar!=NULL && _StructGrp!=NULL );
+    if( !_StructGrp->m_StructPending )
+        return 1;
+    _StructGrp->m_StructPending = false; // cleared first: adding the members looks them up by name
+    TwType Type = _StructGrp->m_StructType;
+    if( Type<TW_TYPE_STRUCT_BASE || Type>=TW_TYPE_STRUCT_BASE+(int)g_TwMgr->m_Structs.size() )
+        return 0;
+    string Name = _StructGrp->m_Name;
+    int ret = AddStructMembers(_Bar, Name.c_str(), Type, _StructGrp->m_StructValuePtr, _StructGrp->m_StructProxy, _StructGrp->m_StructReadOnly);
+    if( !DefineStructMembers(_Bar, Name.c_str(), Type) )
+        ret = 0;
+    return ret;
+}
+
+//  ---------------------------------------------------------------------------
+
 static int AddVar(TwBar *_Bar, const char *_Name, ETwType _Type, void *_VarPtr, bool _ReadOnly, TwSetVarCallback _SetCallback, TwGetVarCallback _GetCallback, TwButtonCallback _ButtonCallback, void *_ClientData, const char *_Def)
 {
     CTwFPU fpu; // force fpu precision
@@ -4203,7 +5989,7 @@ static int AddVar(TwBar *_Bar, const char *_Name, ETwType _Type, void *_VarPtr,
              || _Type==TW_TYPE_CDSTDSTRING 
              || IsCustomType(_Type) ) // (_Type>=TW_TYPE_CUSTOM_BASE && _Type<TW_TYPE_CUSTOM_BASE+(int)g_TwMgr->m_Customs.size()) )
     {
-        CTwVarAtom *Var = new CTwVarAtom;
+        CTwVarAtom *Var = new(&_Bar->m_VarArena) CTwVarAtom;
         Var->m_Name = _Name;
         Var->m_Ptr = _VarPtr;
         Var->m_Type = _Type;
@@ -4212,7 +5998,7 @@ static int AddVar(TwBar *_Bar, const char *_Name, ETwType _Type, void *_VarPtr,
         {
             assert( _GetCallback==NULL && _SetCallback==NULL && _ButtonCallback==NULL );
 
-            Var->m_ReadOnly = _ReadOnly;
+            Var->m_ReadOnly = _ReadOnly || _Type==TW_TYPE_STRINGVIEW;  // the chars of a view belong to the client
             Var->m_GetCallback = NULL;
             Var->m_SetCallback = NULL;
             Var->m_ClientData = NULL;
@@ -4241,6 +6027,8 @@ static int AddVar(TwBar *_Bar, const char *_Name, ETwType _Type, void *_VarPtr,
                 Var->m_ReadOnly = (_ButtonCallback==NULL);
         }
         Var->SetDefaults();
+        if( _Bar->m_CommitMode!=CTwMgr::COMMIT_IMMEDIATE && !Var->m_ReadOnly && _Type!=TW_TYPE_BUTTON && CTwMgr::CanDeferChanges(Var) )
+            g_TwMgr->SetCommitMode(Var, _Bar, _Bar->m_CommitMode, _Bar->m_ThrottlePeriod);  // default of the bar, _Def may override it
 
         if( IsCustomType(_Type) ) // _Type>=TW_TYPE_CUSTOM_BASE && _Type<TW_TYPE_CUSTOM_BASE+(int)g_TwMgr->m_Customs.size() )
         {
@@ -4345,107 +6133,645 @@ static int AddVar(TwBar *_Bar, const char *_Name, ETwType _Type, void *_VarPtr,
                 s.m_StructExtInitCallback(sProxy->m_StructExtData, s.m_ExtClientData);
         }
 
-        for( int i=0; i<(int)s.m_Members.size(); ++i )
+        if( s.m_DeferMembers )
         {
-            CTwMgr::CStructMember& m = s.m_Members[i];
-            string name = string(_Name) + '.' + m.m_Name;
-            const char *access = "";
-            if( _ReadOnly )
-                access = "readonly ";
-            string def  = "label=`" + m.m_Name + "` group=`" + _Name + "` " + access; // + m.m_DefString;  // member def must be done after group def
-            if( _VarPtr!=NULL )
-            {
-                if( TwAddVarRW(_Bar, name.c_str(), m.m_Type, (char*)vPtr+m.m_Offset, def.c_str())==0 )
-                    return 0;
-            }
-            else
+            // only the group is created here, its members are created by TwExpandStructVar
+            CTwVarGroup *Grp = new(&_Bar->m_VarArena) CTwVarGroup;
+            Grp->m_Name = _Name;
+            Grp->m_ColorPtr = &(_Bar->m_ColGrpText);
+            Grp->m_StructProxy = sProxy;
+            Grp->m_StructPending = true;
+            Grp->m_StructReadOnly = _ReadOnly;
+            _Bar->m_VarRoot.m_Vars.push_back(Grp);
+            int LineInHier = _Bar->LineInHier(&(_Bar->m_VarRoot), Grp);
+            if( LineInHier>=0 )
             {
-                assert( sProxy!=NULL );
-                // create a new MemberProxy
-                g_TwMgr->m_MemberProxies.push_back(CTwMgr::CMemberProxy());
-                CTwMgr::CMemberProxy& mProxy = g_TwMgr->m_MemberProxies.back();
-                mProxy.m_StructProxy = sProxy;
-                mProxy.m_MemberIndex = i;
-                assert( !(s.m_IsExt && (m.m_Type==TW_TYPE_STDSTRING || m.m_Type==TW_TYPE_CDSTDSTRING)) );   // forbidden because this case is not handled by UnrollCDStdString
-                if( TwAddVarCB(_Bar, name.c_str(), m.m_Type, CTwMgr::CMemberProxy::SetCB, CTwMgr::CMemberProxy::GetCB, &mProxy, def.c_str())==0 )
-                    return 0;
-                mProxy.m_Var = _Bar->Find(name.c_str(), &mProxy.m_VarParent, NULL);
-                mProxy.m_Bar = _Bar;
+                if( LineInHier<_Bar->m_FirstLine )
+                    _Bar->m_FirstLine++;
+                _Bar->CheckScrollbar(+1);
             }
+            _Bar->NotUpToDate();
+            g_TwMgr->m_HelpBarNotUpToDate = true;
+        }
+        else if( !AddStructMembers(_Bar, _Name, _Type, vPtr, sProxy, _ReadOnly) )
+            return 0;
+        char structInfo[1024*4];
+        sprintf(structInfo, "typeid=%d valptr=%p close ", _Type, vPtr);
+        if (_Type == g_TwMgr->m_TypeQuat4F || _Type == g_TwMgr->m_TypeQuat4D || _Type == g_TwMgr->m_TypeDir3F || _Type == g_TwMgr->m_TypeDir3D)
+        {
+            strcat(structInfo, "rows=4 ");
+        }
+        string grpDef = '`' + _Bar->m_Name + "`/`" + _Name + "` " + structInfo;
+        if( _Def!=NULL && strlen(_Def)>0 )
+            grpDef += _Def;
+        int ret = TwDefine(grpDef.c_str());
+        if( !s.m_DeferMembers )
+        {
+            if( !DefineStructMembers(_Bar, _Name, _Type) ) // members must be defined even if grpDef has error
+                ret = 0;
+            CTwVar *Grp = _Bar->Find(_Name);
+            if( Grp!=NULL && Grp->IsGroup() )
+                static_cast<CTwVarGroup *>(Grp)->m_StructProxy = sProxy;
+        }
+        else
+        {
+            // opened by _Def: create the members now rather than at the next draw
+            CTwVar *Grp = _Bar->Find(_Name);
+            if( Grp!=NULL && Grp->IsGroup() && static_cast<CTwVarGroup *>(Grp)->m_Open && !TwExpandStructVar(_Bar, static_cast<CTwVarGroup *>(Grp)) )
+                ret = 0;
+        }
+        return ret;
+    }
+    else
+    {
+        if( _Type==TW_TYPE_CSSTRING_BASE )
+            g_TwMgr->SetLastError(g_ErrBadSize); // static string of size null
+        else
+            g_TwMgr->SetLastError(g_ErrNotFound);
+        return 0;
+    }
+}
+
+//  ---------------------------------------------------------------------------
+
+int ANT_CALL TwAddVarRW(TwBar *_Bar, const char *_Name, ETwType _Type, void *_Var, const char *_Def)
+{
+    return AddVar(_Bar, _Name, _Type, _Var, false, NULL, NULL, NULL, NULL, _Def);
+}
+
+//  ---------------------------------------------------------------------------
+
+int ANT_CALL TwAddVarRO(TwBar *_Bar, const char *_Name, ETwType _Type, const void *_Var, const char *_Def)
+{
+    return AddVar(_Bar, _Name, _Type, const_cast<void *>(_Var), true, NULL, NULL, NULL, NULL, _Def);
+}
+
+//  ---------------------------------------------------------------------------
+
+int ANT_CALL TwAddVarCB(TwBar *_Bar, const char *_Name, ETwType _Type, TwSetVarCallback _SetCallback, TwGetVarCallback _GetCallback, void *_ClientData, const char *_Def)
+{
+    return AddVar(_Bar, _Name, _Type, NULL, false, _SetCallback, _GetCallback, NULL, _ClientData, _Def);
+}
+
+//  ---------------------------------------------------------------------------
+
+int ANT_CALL TwAddButton(TwBar *_Bar, const char *_Name, TwButtonCallback _Callback, void *_ClientData, const char *_Def)
+{
+    return AddVar(_Bar, _Name, TW_TYPE_BUTTON, NULL, false, NULL, NULL, _Callback, _ClientData, _Def);
+}
+
+//  ---------------------------------------------------------------------------
+
+int ANT_CALL TwAddSeparator(TwBar *_Bar, const char *_Name, const char *_Def)
+{
+    return AddVar(_Bar, _Name, TW_TYPE_BUTTON, NULL, true, NULL, NULL, NULL, &s_SeparatorTag, _Def);
+}
+
+//  ---------------------------------------------------------------------------
+
+static double ArrayElementToDouble(const char *_Element, TwType _Type)
+{
+    switch( _Type )
+    {
+    case TW_TYPE_CHAR:
+    case TW_TYPE_UINT8:
+        return *(const unsigned char *)_Element;
+    case TW_TYPE_INT8:
+        return *(const signed char *)_Element;
+    case TW_TYPE_INT16:
+        return *(const short *)_Element;
+    case TW_TYPE_UINT16:
+        return *(const unsigned short *)_Element;
+    case TW_TYPE_INT32:
+        return *(const int *)_Element;
+    case TW_TYPE_UINT32:
+        return *(const unsigned int *)_Element;
+    case TW_TYPE_FLOAT:
+        return *(const float *)_Element;
+    case TW_TYPE_DOUBLE:
+        return *(const double *)_Element;
+    default:
+        return 0;
+    }
+}
+
+void ANT_CALL CTwMgr::CArrayProxy::RowSetCB(const void *_Value, void *_ClientData)
+{
+    const CRow *Row = static_cast<const CRow *>(_ClientData);
+    const CArrayProxy *Array = Row->m_Array;
+    unsigned int Index = Array->m_Page*Array->m_PageSize + Row->m_Slot;
+    if( Index<Array->m_Count )
+        memcpy(Array->m_Array + Index*Array->m_Stride, _Value, CTwVar::GetDataSize(Array->m_ElementType));
+}
+
+void ANT_CALL CTwMgr::CArrayProxy::RowGetCB(void *_Value, void *_ClientData)
+{
+    const CRow *Row = static_cast<const CRow *>(_ClientData);
+    const CArrayProxy *Array = Row->m_Array;
+    unsigned int Index = Array->m_Page*Array->m_PageSize + Row->m_Slot;
+    size_t Size = CTwVar::GetDataSize(Array->m_ElementType);
+    if( Index<Array->m_Count )
+        memcpy(_Value, Array->m_Array + Index*Array->m_Stride, Size);
+    else
+        memset(_Value, 0, Size);
+}
+
+void ANT_CALL CTwMgr::CArrayProxy::PageSetCB(const void *_Value, void *_ClientData)
+{
+    int Page = *static_cast<const int *>(_Value);
+    if( g_TwMgr!=NULL )
+        g_TwMgr->SetArrayPage(static_cast<CArrayProxy *>(_ClientData), (Page>1) ? Page-1 : 0);
+}
 
-            if( sProxy!=NULL && IsCustomType(m.m_Type) ) // m.m_Type>=TW_TYPE_CUSTOM_BASE && m.m_Type<TW_TYPE_CUSTOM_BASE+(int)g_TwMgr->m_Customs.size() )
-            {
-                if( sProxy->m_CustomIndexFirst<0 )
-                    sProxy->m_CustomIndexFirst = sProxy->m_CustomIndexLast = i;
-                else
-                    sProxy->m_CustomIndexLast = i;
-            }
+void ANT_CALL CTwMgr::CArrayProxy::PageGetCB(void *_Value, void *_ClientData)
+{
+    *static_cast<int *>(_Value) = static_cast<const CArrayProxy *>(_ClientData)->m_Page + 1;
+}
+
+// The stats cover the displayed page only: the rest of the array is not read
+void ANT_CALL CTwMgr::CArrayProxy::SummaryCB(char *_SummaryString, size_t _SummaryMaxLength, const void * /*_Value*/, void *_ClientData)
+{
+    const CArrayProxy *Array = static_cast<const CArrayProxy *>(_ClientData);
+    unsigned int First = Array->m_Page*Array->m_PageSize;
+    unsigned int Last = min(First+Array->m_PageSize, Array->m_Count);
+    if( Array->m_ElementType>=TW_TYPE_CHAR && Array->m_ElementType<=TW_TYPE_DOUBLE && First<Last )
+    {
+        double Min = 0, Max = 0, Sum = 0;
+        for( unsigned int i=First; i<Last; ++i )
+        {
+            double Val = ArrayElementToDouble(Array->m_Array + i*Array->m_Stride, Array->m_ElementType);
+            if( i==First || Val<Min )
+                Min = Val;
+            if( i==First || Val>Max )
+                Max = Val;
+            Sum += Val;
         }
-        char structInfo[1024*4];
-        sprintf(structInfo, "typeid=%d valptr=%p close ", _Type, vPtr);
-        if (_Type == g_TwMgr->m_TypeQuat4F || _Type == g_TwMgr->m_TypeQuat4D || _Type == g_TwMgr->m_TypeDir3F || _Type == g_TwMgr->m_TypeDir3D)
+        _snprintf(_SummaryString, _SummaryMaxLength, "%u items, [%u-%u] min=%g max=%g avg=%g", Array->m_Count, First, Last-1, Min, Max, Sum/(Last-First));
+    }
+    else
+        _snprintf(_SummaryString, _SummaryMaxLength, "%u items", Array->m_Count);
+    _SummaryString[_SummaryMaxLength-1] = '\0';
+}
+
+void CTwMgr::SetArrayPage(CArrayProxy *_Array, unsigned int _Page)
+{
+    unsigned int NbPages = _Array->NbPages();
+    if( _Page>=NbPages )
+        _Page = (NbPages>0) ? NbPages-1 : 0;
+    _Array->m_Page = _Page;
+    char Label[32];
+    CTwVarGroup::CVars& Vars = _Array->m_Group->m_Vars;
+    for( size_t i=0; i<Vars.size(); ++i )
+        if( Vars[i]!=NULL && !Vars[i]->IsGroup() && static_cast<CTwVarAtom *>(Vars[i])->m_GetCallback==CArrayProxy::RowGetCB )
         {
-            strcat(structInfo, "rows=4 ");
+            CTwVarAtom *Atom = static_cast<CTwVarAtom *>(Vars[i]);
+            unsigned int Index = _Page*_Array->m_PageSize + static_cast<const CArrayProxy::CRow *>(Atom->m_ClientData)->m_Slot;
+            sprintf(Label, "[%u]", Index);
+            Atom->m_Label = Label;
+            Atom->m_Visible = (Index<_Array->m_Count);
         }
-        string grpDef = '`' + _Bar->m_Name + "`/`" + _Name + "` " + structInfo;
-        if( _Def!=NULL && strlen(_Def)>0 )
-            grpDef += _Def;
-        int ret = TwDefine(grpDef.c_str());
-        for( int i=0; i<(int)s.m_Members.size(); ++i ) // members must be defined even if grpDef has error
+    _Array->m_Bar->NotUpToDate();
+}
+
+// Replaces the row vars of the array: the page is chosen to keep the first displayed element
+int CTwMgr::SetArrayPageSize(CArrayProxy *_Array, unsigned int _PageSize)
+{
+    _PageSize = min(_PageSize, max(_Array->m_Count, 1U));
+    if( _PageSize==_Array->m_PageSize )
+        return 1;
+
+    CTwBar *Bar = _Array->m_Bar;
+    string Name = _Array->m_Group->m_Name.c_str();
+    char Slot[32];
+    for( size_t r=0; r<_Array->m_Rows.size(); ++r )
+    {
+        sprintf(Slot, ".%u", (unsigned int)r);
+        TwRemoveVar(Bar, (Name + Slot).c_str());
+    }
+    unsigned int FirstIndex = _Array->m_Page*_Array->m_PageSize;
+    _Array->m_PageSize = _PageSize;
+    _Array->m_Page = FirstIndex/_PageSize;
+    _Array->m_Rows.resize(_PageSize);
+    string RowDef = "group=`" + Name + "`";
+    int Ret = 1;
+    for( unsigned int r=0; r<_PageSize; ++r )
+    {
+        _Array->m_Rows[r].m_Array = _Array;
+        _Array->m_Rows[r].m_Slot = r;
+        sprintf(Slot, ".%u", r);
+        TwSetVarCallback SetCB = _Array->m_ReadOnly ? NULL : CArrayProxy::RowSetCB;
+        if( !AddVar(Bar, (Name + Slot).c_str(), _Array->m_ElementType, NULL, _Array->m_ReadOnly, SetCB, CArrayProxy::RowGetCB, NULL, &(_Array->m_Rows[r]), RowDef.c_str()) )
+            Ret = 0;
+    }
+
+    unsigned int NbPages = _Array->NbPages();
+    sprintf(Slot, " max=%u visible=%s", max(NbPages, 1U), (NbPages>1) ? "true" : "false");
+    string PageDef = '`' + Bar->m_Name + "`/`" + Name + ".page`" + Slot;
+    if( !TwDefine(PageDef.c_str()) )
+        Ret = 0;
+    SetArrayPage(_Array, _Array->m_Page);
+    return Ret;
+}
+
+void CTwMgr::RemoveArrayProxy(CArrayProxy *_Array)
+{
+    for( list<CArrayProxy>::iterator it=m_ArrayProxies.begin(); it!=m_ArrayProxies.end(); ++it )
+        if( &(*it)==_Array )
         {
-            CTwMgr::CStructMember& m = s.m_Members[i];
-            if( m.m_DefString.length()>0 )
-            {
-                string memberDef = '`' + _Bar->m_Name + "`/`" + _Name + '.' + m.m_Name + "` " + m.m_DefString;
-                if( !TwDefine(memberDef.c_str()) ) // all members must be defined even if memberDef has error
-                    ret = 0;
-            }
+            m_ArrayProxies.erase(it);
+            break;
         }
-        return ret;
+}
+
+static int AddVarArray(TwBar *_Bar, const char *_Name, TwType _ElementType, void *_Array, unsigned int _Count, size_t _Stride, bool _ReadOnly, const char *_Def)
+{
+    CTwFPU fpu; // force fpu precision
+
+    if( g_TwMgr==NULL )
+    {
+        TwGlobalError(g_ErrNotInit);
+        return 0; // not initialized
     }
-    else
+    if( _Bar==NULL || _Name==NULL || strlen(_Name)==0 || (_Array==NULL && _Count>0) )
     {
-        if( _Type==TW_TYPE_CSSTRING_BASE )
-            g_TwMgr->SetLastError(g_ErrBadSize); // static string of size null
-        else
-            g_TwMgr->SetLastError(g_ErrNotFound);
+        g_TwMgr->SetLastError(g_ErrBadParam);
+        return 0;
+    }
+    if( strstr(_Name, "`")!=NULL )
+    {
+        g_TwMgr->SetLastError(g_ErrNoBackQuote);
+        return 0;
+    }
+    string PageName = string(_Name) + ".page";
+    if( _Bar->Find(_Name)!=NULL || _Bar->Find(PageName.c_str())!=NULL )
+    {
+        g_TwMgr->SetLastError(g_ErrExist);
+        return 0;
+    }
+    // elements are numbers, bools or enums, so that a row is a regular var
+    if( !(_ElementType>=TW_TYPE_BOOLCPP && _ElementType<=TW_TYPE_DOUBLE) && !IsEnumType(_ElementType) )
+    {
+        g_TwMgr->SetLastError(g_ErrBadType);
+        return 0;
+    }
+    size_t Size = CTwVar::GetDataSize(_ElementType);
+    if( _Stride==0 )
+        _Stride = Size;
+    else if( _Stride<Size )
+    {
+        g_TwMgr->SetLastError(g_ErrBadSize);
         return 0;
     }
+
+    g_TwMgr->m_ArrayProxies.push_back(CTwMgr::CArrayProxy());
+    CTwMgr::CArrayProxy& Array = g_TwMgr->m_ArrayProxies.back();
+    Array.m_Array = static_cast<char *>(_Array);
+    Array.m_ElementType = _ElementType;
+    Array.m_Count = _Count;
+    Array.m_Stride = _Stride;
+    Array.m_PageSize = 0;
+    Array.m_Page = 0;
+    Array.m_ReadOnly = _ReadOnly;
+    Array.m_Bar = _Bar;
+    Array.m_Group = NULL;
+
+    // the page selector creates the group
+    string PageDef = string("label=page min=1 group=`") + _Name + "`";
+    if( !AddVar(_Bar, PageName.c_str(), TW_TYPE_INT32, NULL, false, CTwMgr::CArrayProxy::PageSetCB, CTwMgr::CArrayProxy::PageGetCB, NULL, &Array, PageDef.c_str()) )
+        return 0;
+    CTwVar *Grp = _Bar->Find(_Name);
+    assert( Grp!=NULL && Grp->IsGroup() );
+    Array.m_Group = static_cast<CTwVarGroup *>(Grp);
+    Array.m_Group->m_ArrayProxy = &Array;
+    Array.m_Group->m_SummaryCallback = CTwMgr::CArrayProxy::SummaryCB;
+    Array.m_Group->m_SummaryClientData = &Array;
+
+    const unsigned int DefaultPageSize = 16;
+    int Ret = g_TwMgr->SetArrayPageSize(&Array, DefaultPageSize);
+    string GrpDef = '`' + _Bar->m_Name + "`/`" + _Name + "` close ";
+    if( _Def!=NULL && strlen(_Def)>0 )
+        GrpDef += _Def;
+    if( !TwDefine(GrpDef.c_str()) )
+        Ret = 0;
+    return Ret;
 }
 
-//  ---------------------------------------------------------------------------
+int ANT_CALL TwAddVarArrayRW(TwBar *_Bar, const char *_Name, TwType _ElementType, void *_Array, unsigned int _Count, size_t _Stride, const char *_Def)
+{
+    return AddVarArray(_Bar, _Name, _ElementType, _Array, _Count, _Stride, false, _Def);
+}
 
-int ANT_CALL TwAddVarRW(TwBar *_Bar, const char *_Name, ETwType _Type, void *_Var, const char *_Def)
+int ANT_CALL TwAddVarArrayRO(TwBar *_Bar, const char *_Name, TwType _ElementType, const void *_Array, unsigned int _Count, size_t _Stride, const char *_Def)
 {
-    return AddVar(_Bar, _Name, _Type, _Var, false, NULL, NULL, NULL, NULL, _Def);
+    return AddVarArray(_Bar, _Name, _ElementType, const_cast<void *>(_Array), _Count, _Stride, true, _Def);
 }
 
 //  ---------------------------------------------------------------------------
 
-int ANT_CALL TwAddVarRO(TwBar *_Bar, const char *_Name, ETwType _Type, const void *_Var, const char *_Def)
+static inline void FoldPlotSample(CTwMgr::CPlotProxy *_Plot, unsigned int _Sample, float _Val, bool _NewColumn)
 {
-    return AddVar(_Bar, _Name, _Type, const_cast<void *>(_Var), true, NULL, NULL, NULL, NULL, _Def);
+    unsigned int c = (_Sample/_Plot->m_ColumnSize)%(unsigned int)_Plot->m_ColumnMin.size();
+    if( _NewColumn || _Sample%_Plot->m_ColumnSize==0 )
+        _Plot->m_ColumnMin[c] = _Plot->m_ColumnMax[c] = _Val;
+    else if( _Val<_Plot->m_ColumnMin[c] )
+        _Plot->m_ColumnMin[c] = _Val;
+    else if( _Val>_Plot->m_ColumnMax[c] )
+        _Plot->m_ColumnMax[c] = _Val;
 }
 
-//  ---------------------------------------------------------------------------
+void CTwMgr::CPlotProxy::Push(float _Val)
+{
+    m_History[m_NbSamples%(unsigned int)m_History.size()] = _Val;
+    FoldPlotSample(this, m_NbSamples, _Val, false);
+    ++m_NbSamples;
+}
 
-int ANT_CALL TwAddVarCB(TwBar *_Bar, const char *_Name, ETwType _Type, TwSetVarCallback _SetCallback, TwGetVarCallback _GetCallback, void *_ClientData, const char *_Def)
+// Columns are aligned on the sample count, so a new sample only updates the
+// last one and a draw reads at most _Width+1 columns whatever the history size
+void CTwMgr::CPlotProxy::SetWidth(int _Width)
 {
-    return AddVar(_Bar, _Name, _Type, NULL, false, _SetCallback, _GetCallback, NULL, _ClientData, _Def);
+    if( _Width<1 )
+        _Width = 1;
+    if( _Width==m_Width )
+        return;
+    m_Width = _Width;
+    unsigned int HistorySize = (unsigned int)m_History.size();
+    m_ColumnSize = (HistorySize+_Width-1)/_Width;
+    unsigned int NbColumns = (HistorySize+m_ColumnSize-1)/m_ColumnSize + 1; // +1 for the column being filled
+    m_ColumnMin.assign(NbColumns, 0.0f);
+    m_ColumnMax.assign(NbColumns, 0.0f);
+    unsigned int First = m_NbSamples - min(m_NbSamples, HistorySize);
+    for( unsigned int s=First; s<m_NbSamples; ++s )
+        FoldPlotSample(this, s, m_History[s%HistorySize], s==First);
 }
 
-//  ---------------------------------------------------------------------------
+// The oldest column may still hold evicted samples: its range is then
+// recomputed from the kept samples of the history
+void CTwMgr::CPlotProxy::ColumnRange(unsigned int _Column, float *_Min, float *_Max) const
+{
+    unsigned int HistorySize = (unsigned int)m_History.size();
+    unsigned int FirstKept = m_NbSamples - min(m_NbSamples, HistorySize);
+    if( _Column*m_ColumnSize<FirstKept )
+    {
+        unsigned int End = min((_Column+1)*m_ColumnSize, m_NbSamples);
+        *_Min = *_Max = m_History[FirstKept%HistorySize];
+        for( unsigned int s=FirstKept+1; s<End; ++s )
+        {
+            *_Min = min(*_Min, m_History[s%HistorySize]);
+            *_Max = max(*_Max, m_History[s%HistorySize]);
+        }
+    }
+    else
+    {
+        unsigned int NbColumns = (unsigned int)m_ColumnMin.size();
+        *_Min = m_ColumnMin[_Column%NbColumns];
+        *_Max = m_ColumnMax[_Column%NbColumns];
+    }
+}
 
-int ANT_CALL TwAddButton(TwBar *_Bar, const char *_Name, TwButtonCallback _Callback, void *_ClientData, const char *_Def)
+// Range of the kept samples; must not be called with an empty history
+void CTwMgr::CPlotProxy::KeptRange(float *_Min, float *_Max) const
 {
-    return AddVar(_Bar, _Name, TW_TYPE_BUTTON, NULL, false, NULL, NULL, _Callback, _ClientData, _Def);
+    unsigned int NbKept = min(m_NbSamples, (unsigned int)m_History.size());
+    assert( NbKept>0 );
+    unsigned int First = (m_NbSamples-NbKept)/m_ColumnSize;
+    unsigned int Last = (m_NbSamples-1)/m_ColumnSize;
+    ColumnRange(First, _Min, _Max);
+    for( unsigned int c=First+1; c<=Last; ++c )
+    {
+        *_Min = min(*_Min, m_ColumnMin[c%m_ColumnMin.size()]);
+        *_Max = max(*_Max, m_ColumnMax[c%m_ColumnMax.size()]);
+    }
 }
 
-//  ---------------------------------------------------------------------------
+void CTwMgr::CPlotProxy::Draw(ITwGraph *_Graph, int _Width, int _Height, color32 _Color, color32 _BgColor)
+{
+    _Graph->DrawRect(0, 0, _Width-1, _Height-1, _BgColor);
+    SetWidth(_Width);
+    unsigned int HistorySize = (unsigned int)m_History.size();
+    unsigned int NbKept = min(m_NbSamples, HistorySize);
+    if( NbKept==0 || _Height<2 )
+        return;
+    unsigned int First = (m_NbSamples-NbKept)/m_ColumnSize;
+    unsigned int Last = (m_NbSamples-1)/m_ColumnSize;
+    double Min = m_RangeMin, Max = m_RangeMax;
+    if( m_AutoRange )
+    {
+        float KeptMin, KeptMax;
+        KeptRange(&KeptMin, &KeptMax);
+        Min = KeptMin;
+        Max = KeptMax;
+        if( Max<=Min )
+        {
+            Min -= 0.5;
+            Max += 0.5;
+        }
+    }
+
+    // one quad per column from its min to its max, stretched to join the previous column
+    double ColumnWidth = (double)_Width*m_ColumnSize/HistorySize;
+    double Scale = (_Height-2)/(Max-Min);
+    m_Vertices.resize(12*(Last-First+1));
+    m_Colors.resize(6*(Last-First+1));
+    int NbTriangles = 0;
+    int PrevTop = 0, PrevBottom = 0;
+    for( unsigned int c=First; c<=Last; ++c )
+    {
+        int x1 = _Width - (int)((Last-c)*ColumnWidth);
+        int x0 = max(_Width - (int)((Last-c+1)*ColumnWidth), 0);
+        float ColMin, ColMax;
+        ColumnRange(c, &ColMin, &ColMax);
+        double Lo = min(max((double)ColMin, Min), Max);
+        double Hi = min(max((double)ColMax, Min), Max);
+        int Top = (int)((Max-Hi)*Scale + 0.5);
+        int Bottom = (int)((Max-Lo)*Scale + 0.5) + 1;
+        int y0 = Top, y1 = Bottom;
+        if( c>First )
+        {
+            y0 = min(y0, PrevBottom-1);
+            y1 = max(y1, PrevTop+1);
+        }
+        PrevTop = Top;
+        PrevBottom = Bottom;
+        if( x1<=x0 )
+            continue;
+        int *v = &m_Vertices[6*NbTriangles];
+        v[0] = x0;  v[1] = y0;  v[2] = x1;  v[3] = y0;  v[4] = x0;  v[5] = y1;
+        v[6] = x1;  v[7] = y0;  v[8] = x1;  v[9] = y1;  v[10] = x0; v[11] = y1;
+        for( int i=0; i<6; ++i )
+            m_Colors[3*NbTriangles+i] = _Color;
+        NbTriangles += 2;
+    }
+    if( NbTriangles>0 )
+        _Graph->DrawTriangles(NbTriangles, &(m_Vertices[0]), &(m_Colors[0]), ITwGraph::CULL_NONE);
+}
+
+void ANT_CALL CTwMgr::CPlotProxy::SummaryCB(char *_SummaryString, size_t _SummaryMaxLength, const void * /*_Value*/, void *_ClientData)
+{
+    const CPlotProxy *Plot = static_cast<const CPlotProxy *>(_ClientData);
+    unsigned int HistorySize = (unsigned int)Plot->m_History.size();
+    unsigned int NbKept = min(Plot->m_NbSamples, HistorySize);
+    if( NbKept>0 )
+    {
+        float Min, Max;
+        Plot->KeptRange(&Min, &Max);
+        _snprintf(_SummaryString, _SummaryMaxLength, "%g [%g, %g]", Plot->m_History[(Plot->m_NbSamples-1)%HistorySize], Min, Max);
+    }
+    else
+        _snprintf(_SummaryString, _SummaryMaxLength, "no samples");
+    _SummaryString[_SummaryMaxLength-1] = '\0';
+}
 
-int ANT_CALL TwAddSeparator(TwBar *_Bar, const char *_Name, const char *_Def)
+void CTwMgr::SamplePlots()
 {
-    return AddVar(_Bar, _Name, TW_TYPE_BUTTON, NULL, true, NULL, NULL, NULL, &s_SeparatorTag, _Def);
+    double Time = m_Timer.GetTime();
+    for( list<CPlotProxy>::iterator it=m_PlotProxies.begin(); it!=m_PlotProxies.end(); ++it )
+    {
+        CPlotProxy& Plot = *it;
+        if( Plot.m_NbSamples>0 && Time-Plot.m_LastSampleTime<Plot.m_Period )
+            continue;
+        // keep the rate steady unless the draws are too far apart
+        if( Plot.m_NbSamples>0 && Plot.m_Period>0 && Time-Plot.m_LastSampleTime<2.0*Plot.m_Period )
+            Plot.m_LastSampleTime += Plot.m_Period;
+        else
+            Plot.m_LastSampleTime = Time;
+        double Value[2] = { 0, 0 };  // large and aligned enough for any sampled type
+        const char *Sample = Plot.m_Var;
+        if( Sample==NULL )
+        {
+            Plot.m_GetCallback(Value, Plot.m_ClientData);
+            if( g_TwMgr==NULL ) // Mgr might have been destroyed by the client inside a callback call
+                return;
+            Sample = reinterpret_cast<const char *>(Value);
+        }
+        Plot.Push((float)ArrayElementToDouble(Sample, Plot.m_Type));
+    }
+}
+
+// The rows only reserve the height of the plot, which is drawn over them
+static int AddPlotRow(CTwMgr::CPlotProxy *_Plot, const string& _GroupName, unsigned int _Row)
+{
+    char Suffix[32];
+    sprintf(Suffix, ".%u", _Row);
+    string Name = _GroupName + Suffix;
+    string Def = "group=`" + _GroupName + "`";
+    if( !AddVar(_Plot->m_Bar, Name.c_str(), TW_TYPE_BUTTON, NULL, true, NULL, NULL, NULL, _Plot, Def.c_str()) )
+        return 0;
+    CTwVar *Var = _Plot->m_Bar->Find(Name.c_str());
+    assert( Var!=NULL && !Var->IsGroup() );
+    static_cast<CTwVarAtom *>(Var)->m_Val.m_Button.m_Plot = _Plot;
+    Var->m_Label = " ";
+    return 1;
+}
+
+int CTwMgr::SetPlotRows(CPlotProxy *_Plot, unsigned int _NbRows)
+{
+    string Name = _Plot->m_Group->m_Name.c_str();
+    unsigned int NbRows = (unsigned int)_Plot->m_Group->m_Vars.size();
+    char Suffix[32];
+    int Ret = 1;
+    for( unsigned int r=NbRows; r<_NbRows; ++r )
+        if( !AddPlotRow(_Plot, Name, r) )
+            Ret = 0;
+    for( unsigned int r=NbRows; r>_NbRows; --r )   // _NbRows>0: the group is deleted with its last row
+    {
+        sprintf(Suffix, ".%u", r-1);
+        TwRemoveVar(_Plot->m_Bar, (Name + Suffix).c_str());
+    }
+    return Ret;
+}
+
+void CTwMgr::RemovePlotProxy(CPlotProxy *_Plot)
+{
+    for( list<CPlotProxy>::iterator it=m_PlotProxies.begin(); it!=m_PlotProxies.end(); ++it )
+        if( &(*it)==_Plot )
+        {
+            m_PlotProxies.erase(it);
+            break;
+        }
+}
+
+static int AddVarPlot(TwBar *_Bar, const char *_Name, TwType _Type, const void *_Var, TwGetVarCallback _GetCallback, void *_ClientData, unsigned int _HistorySize, const char *_Def)
+{
+    CTwFPU fpu; // force fpu precision
+
+    if( g_TwMgr==NULL )
+    {
+        TwGlobalError(g_ErrNotInit);
+        return 0; // not initialized
+    }
+    if( _Bar==NULL || _Name==NULL || strlen(_Name)==0 || (_Var==NULL && _GetCallback==NULL) || _HistorySize==0 )
+    {
+        g_TwMgr->SetLastError(g_ErrBadParam);
+        return 0;
+    }
+    if( strstr(_Name, "`")!=NULL )
+    {
+        g_TwMgr->SetLastError(g_ErrNoBackQuote);
+        return 0;
+    }
+    string FirstRowName = string(_Name) + ".0";
+    if( _Bar->Find(_Name)!=NULL || _Bar->Find(FirstRowName.c_str())!=NULL )
+    {
+        g_TwMgr->SetLastError(g_ErrExist);
+        return 0;
+    }
+    if( !(_Type>=TW_TYPE_CHAR && _Type<=TW_TYPE_DOUBLE) )
+    {
+        g_TwMgr->SetLastError(g_ErrBadType);
+        return 0;
+    }
+
+    g_TwMgr->m_PlotProxies.push_back(CTwMgr::CPlotProxy());
+    CTwMgr::CPlotProxy& Plot = g_TwMgr->m_PlotProxies.back();
+    Plot.m_Var = static_cast<const char *>(_Var);
+    Plot.m_GetCallback = _GetCallback;
+    Plot.m_ClientData = _ClientData;
+    Plot.m_Type = _Type;
+    Plot.m_History.assign(_HistorySize, 0.0f);
+    Plot.m_NbSamples = 0;
+    Plot.m_Period = 0;
+    Plot.m_LastSampleTime = 0;
+    Plot.m_AutoRange = true;
+    Plot.m_RangeMin = 0;
+    Plot.m_RangeMax = 1;
+    Plot.m_Width = 0;
+    Plot.SetWidth(1);
+    Plot.m_Bar = _Bar;
+    Plot.m_Group = NULL;
+
+    // the first row creates the group
+    if( !AddPlotRow(&Plot, _Name, 0) )
+    {
+        g_TwMgr->m_PlotProxies.pop_back();
+        return 0;
+    }
+    CTwVar *Grp = _Bar->Find(_Name);
+    assert( Grp!=NULL && Grp->IsGroup() );
+    Plot.m_Group = static_cast<CTwVarGroup *>(Grp);
+    Plot.m_Group->m_PlotProxy = &Plot;
+    Plot.m_Group->m_SummaryCallback = CTwMgr::CPlotProxy::SummaryCB;
+    Plot.m_Group->m_SummaryClientData = &Plot;
+
+    const unsigned int DefaultRows = 3;
+    int Ret = g_TwMgr->SetPlotRows(&Plot, DefaultRows);
+    if( _Def!=NULL && strlen(_Def)>0 )
+    {
+        string GrpDef = '`' + _Bar->m_Name + "`/`" + _Name + "` " + _Def;
+        if( !TwDefine(GrpDef.c_str()) )
+            Ret = 0;
+    }
+    return Ret;
+}
+
+int ANT_CALL TwAddVarPlot(TwBar *_Bar, const char *_Name, TwType _Type, const void *_Var, unsigned int _HistorySize, const char *_Def)
+{
+    return AddVarPlot(_Bar, _Name, _Type, _Var, NULL, NULL, _HistorySize, _Def);
+}
+
+int ANT_CALL TwAddVarPlotCB(TwBar *_Bar, const char *_Name, TwType _Type, TwGetVarCallback _GetCallback, void *_ClientData, unsigned int _HistorySize, const char *_Def)
+{
+    return AddVarPlot(_Bar, _Name, _Type, NULL, _GetCallback, _ClientData, _HistorySize, _Def);
 }
 
 //  ---------------------------------------------------------------------------
@@ -4526,7 +6852,7 @@ int ANT_CALL TwRemoveAllVars(TwBar *_Bar)
 
     _Bar->StopEditInPlace();    // desactivate EditInPlace
 
-    for( vector<CTwVar*>::iterator it=_Bar->m_VarRoot.m_Vars.begin(); it!=_Bar->m_VarRoot.m_Vars.end(); ++it )
+    for( CTwVarGroup::CVars::iterator it=_Bar->m_VarRoot.m_Vars.begin(); it!=_Bar->m_VarRoot.m_Vars.end(); ++it )
         if( *it != NULL )
         {
             delete *it;
@@ -4757,6 +7083,7 @@ int ANT_CALL TwDefine(const char *_Def)
                 if( strchr(b, '=') != NULL )
                     *strchr(b, '=') = '\0';
                 double scal = 1.0;
+                char sdf[8] = "";
                 if( _stricmp(b, "fontscaling")==0 && sscanf(eq+1, "%lf", &scal)==1 && scal>0 )
                 {
                     g_FontScaling = (float)scal;
@@ -4764,6 +7091,14 @@ int ANT_CALL TwDefine(const char *_Def)
                     delete[] b;
                     return 1;
                 }
+                else if( _stricmp(b, "fontsdf")==0 && sscanf(eq+1, "%7s", sdf)==1 )
+                {
+                    // support is checked by TwInit once the graphic API is known
+                    g_FontSDF = (_stricmp(sdf, "1")==0 || _stricmp(sdf, "true")==0);
+                    delete[] a;
+                    delete[] b;
+                    return 1;
+                }
             }
             delete[] a;
             delete[] b;
@@ -4933,7 +7268,177 @@ int ANT_CALL TwDefine(const char *_Def)
 
 //  ---------------------------------------------------------------------------
 
-TwType ANT_CALL TwDefineEnum(const char *_Name, const TwEnumVal *_EnumValues, unsigned int _NbValues)
+static bool EnumEntryLess(const CTwMgr::CEnum::CEntry& _A, const CTwMgr::CEnum::CEntry& _B)
+{
+    return _A.first<_B.first;
+}
+
+CTwMgr::CEnum::CEntries::iterator CTwMgr::CEnum::CEntries::find(unsigned int _Value)
+{
+    iterator It = std::lower_bound(begin(), end(), CEntry(_Value, CTwIString()), EnumEntryLess);
+    if( It!=end() && It->first==_Value )
+        return It;
+    else
+        return end();
+}
+
+std::pair<CTwMgr::CEnum::CEntries::iterator, bool> CTwMgr::CEnum::CEntries::insert(const CEntry& _Entry)
+{
+    iterator It = std::lower_bound(begin(), end(), _Entry, EnumEntryLess);
+    if( It!=end() && It->first==_Entry.first )
+        return std::pair<iterator, bool>(It, false);
+    else
+        return std::pair<iterator, bool>(std::vector<CEntry>::insert(It, _Entry), true);
+}
+
+void CTwMgr::CEnum::CEntries::SortByValue()
+{
+    std::stable_sort(begin(), end(), EnumEntryLess);
+    size_t n = 0;
+    for( size_t i=0; i<size(); ++i )
+    {
+        if( n>0 && (*this)[n-1].first==(*this)[i].first )
+            (*this)[n-1].second = (*this)[i].second;    // the last definition of a value overrides previous ones
+        else
+        {
+            if( n!=i )
+                (*this)[n] = (*this)[i];
+            ++n;
+        }
+    }
+    resize(n);
+}
+
+CTwMgr::CEnum::CEnum()
+{
+    m_Version = 0;
+    m_LowerLabelsVersion = 0;
+    m_CountCallback = NULL;
+    m_ValCallback = NULL;
+    m_Generation = NULL;
+    m_SyncedGeneration = 0;
+    m_Synced = false;
+    m_ClientData = NULL;
+}
+
+bool CTwMgr::CEnum::Sync()
+{
+    if( m_CountCallback==NULL || m_ValCallback==NULL )
+        return false;
+    if( m_Synced && m_Generation!=NULL && *m_Generation==m_SyncedGeneration )
+        return false;
+
+    // m_Generation is read before the entries in case the client changes it from a callback
+    if( m_Generation!=NULL )
+        m_SyncedGeneration = *m_Generation;
+    m_Synced = true;
+    unsigned int NbValues = m_CountCallback(m_ClientData);
+    m_Entries.clear();
+    m_Entries.reserve(NbValues);
+    for( unsigned int i=0; i<NbValues; ++i )
+    {
+        TwEnumVal Val;
+        Val.Value = (int)i;
+        Val.Label = NULL;
+        m_ValCallback(i, &Val, m_ClientData);
+        m_Entries.push_back(CEntry(Val.Value, (Val.Label!=NULL) ? Val.Label : ""));
+    }
+    m_Entries.SortByValue();
+    ++m_Version;
+    IndexLabels();
+    return true;
+}
+
+void CTwMgr::CEnum::IndexLabels()
+{
+    if( m_LowerLabelsVersion==m_Version && m_LowerLabelStarts.size()==m_Entries.size()+1 )
+        return;
+    m_LowerLabelsVersion = m_Version;
+    m_LowerLabels.resize(0);
+    m_LowerLabelStarts.resize(m_Entries.size()+1);
+    for( size_t i=0; i<m_Entries.size(); ++i )
+    {
+        m_LowerLabelStarts[i] = (unsigned int)m_LowerLabels.length();
+        m_LowerLabels += m_Entries[i].second.Str();
+        m_LowerLabels += '\n';
+    }
+    m_LowerLabelStarts[m_Entries.size()] = (unsigned int)m_LowerLabels.length();
+    for( size_t j=0; j<m_LowerLabels.length(); ++j )
+        m_LowerLabels[j] = (char)tolower((unsigned char)m_LowerLabels[j]);
+}
+
+//  ---------------------------------------------------------------------------
+
+// Returns the index of the enum named _Name, created if needed, and resets its definition
+static size_t DefineEnumIndex(const char *_Name)
+{
+    if( g_TwMgr->m_PopupBar!=NULL ) // delete popup bar first if it exists
+    {
+        TwDeleteBar(g_TwMgr->m_PopupBar);
+        g_TwMgr->m_PopupBar = NULL;
+    }
+
+    size_t enumIndex = g_TwMgr->m_Enums.size();
+    bool Named = ( _Name!=NULL && strlen(_Name)>0 );
+    if( Named )
+    {
+        std::map<std::string, size_t>::iterator itIndex = g_TwMgr->m_EnumIndex.find(_Name);
+        if( itIndex!=g_TwMgr->m_EnumIndex.end() )
+            enumIndex = itIndex->second;
+    }
+    if( enumIndex==g_TwMgr->m_Enums.size() )
+    {
+        g_TwMgr->m_Enums.push_back(CTwMgr::CEnum());
+        if( Named )
+            g_TwMgr->m_EnumIndex[_Name] = enumIndex;
+    }
+    assert( enumIndex>=0 && enumIndex<g_TwMgr->m_Enums.size() );
+    CTwMgr::CEnum& e = g_TwMgr->m_Enums[enumIndex];
+    if( Named )
+        e.m_Name = _Name;
+    else
+        e.m_Name = "";
+    e.m_CountCallback = NULL;
+    e.m_ValCallback = NULL;
+    e.m_Generation = NULL;
+    e.m_Synced = false;
+    e.m_ClientData = NULL;
+    ++e.m_Version;
+    return enumIndex;
+}
+
+//  ---------------------------------------------------------------------------
+
+TwType ANT_CALL TwDefineEnum(const char *_Name, const TwEnumVal *_EnumValues, unsigned int _NbValues)
+{
+    CTwFPU fpu; // force fpu precision
+
+    if( g_TwMgr==NULL )
+    {
+        TwGlobalError(g_ErrNotInit);
+        return TW_TYPE_UNDEF; // not initialized
+    }
+    if( _EnumValues==NULL && _NbValues!=0 )
+    {
+        g_TwMgr->SetLastError(g_ErrBadParam);
+        return TW_TYPE_UNDEF;
+    }
+
+    size_t enumIndex = DefineEnumIndex(_Name);
+    CTwMgr::CEnum& e = g_TwMgr->m_Enums[enumIndex];
+    e.m_Entries.clear();
+    e.m_Entries.reserve(_NbValues);
+    for(unsigned int i=0; i<_NbValues; ++i)
+        e.m_Entries.push_back(CTwMgr::CEnum::CEntry(_EnumValues[i].Value, (_EnumValues[i].Label!=NULL)?_EnumValues[i].Label:""));
+    e.m_Entries.SortByValue();
+    e.IndexLabels();
+
+    return TwType( TW_TYPE_ENUM_BASE + enumIndex );
+}
+
+//  ---------------------------------------------------------------------------
+
+TwType ANT_CALL TwDefineEnumCB(const char *_Name, TwGetEnumCountCallback _CountCallback, TwGetEnumValCallback _ValCallback, const unsigned int *_Generation, void *_ClientData)
 {
     CTwFPU fpu; // force fpu precision
 
@@ -4942,42 +7447,20 @@ TwType ANT_CALL TwDefineEnum(const char *_Name, const TwEnumVal *_EnumValues, un
         TwGlobalError(g_ErrNotInit);
         return TW_TYPE_UNDEF; // not initialized
     }
-    if( _EnumValues==NULL && _NbValues!=0 )
+    if( _CountCallback==NULL || _ValCallback==NULL )
     {
         g_TwMgr->SetLastError(g_ErrBadParam);
         return TW_TYPE_UNDEF;
     }
 
-    if( g_TwMgr->m_PopupBar!=NULL ) // delete popup bar first if it exists
-    {
-        TwDeleteBar(g_TwMgr->m_PopupBar);
-        g_TwMgr->m_PopupBar = NULL;
-    }
-
-    size_t enumIndex = g_TwMgr->m_Enums.size();
-    if( _Name!=NULL && strlen(_Name)>0 )
-        for( size_t j=0; j<g_TwMgr->m_Enums.size(); ++j )
-            if( strcmp(_Name, g_TwMgr->m_Enums[j].m_Name.c_str())==0 )
-            {
-                enumIndex = j;
-                break;
-            }
-    if( enumIndex==g_TwMgr->m_Enums.size() )
-        g_TwMgr->m_Enums.push_back(CTwMgr::CEnum());
-    assert( enumIndex>=0 && enumIndex<g_TwMgr->m_Enums.size() );
+    size_t enumIndex = DefineEnumIndex(_Name);
     CTwMgr::CEnum& e = g_TwMgr->m_Enums[enumIndex];
-    if( _Name!=NULL && strlen(_Name)>0 )
-        e.m_Name = _Name;
-    else
-        e.m_Name = "";
     e.m_Entries.clear();
-    for(unsigned int i=0; i<_NbValues; ++i)
-    {
-        CTwMgr::CEnum::CEntries::value_type Entry(_EnumValues[i].Value, (_EnumValues[i].Label!=NULL)?_EnumValues[i].Label:"");
-        pair<CTwMgr::CEnum::CEntries::iterator, bool> Result = e.m_Entries.insert(Entry);
-        if( !Result.second )
-            (Result.first)->second = Entry.second;
-    }
+    e.m_CountCallback = _CountCallback;
+    e.m_ValCallback = _ValCallback;
+    e.m_Generation = _Generation;
+    e.m_ClientData = _ClientData;
+    // entries are queried when first needed
 
     return TwType( TW_TYPE_ENUM_BASE + enumIndex );
 }
@@ -5017,6 +7500,81 @@ TwType TW_CALL TwDefineEnumFromString(const char *_Name, const char *_EnumString
 
 //  ---------------------------------------------------------------------------
 
+static void CloseSummary(char *_SummaryString, size_t _SummaryMaxLength)
+{
+    size_t l = strlen(_SummaryString);
+    if( l>_SummaryMaxLength-2 )
+    {
+        _SummaryString[_SummaryMaxLength-2] = '.';
+        _SummaryString[_SummaryMaxLength-1] = '.';
+        _SummaryString[_SummaryMaxLength+0] = '\0';
+    }
+    else
+    {
+        _SummaryString[l+0] = '}';
+        _SummaryString[l+1] = '\0';
+    }
+}
+
+// Summary of a struct value read directly through the struct layout.
+// Used for struct vars whose member vars are not created yet.
+static void StructDataSummary(char *_SummaryString, size_t _SummaryMaxLength, size_t _StructIndex, const char *_Data)
+{
+    const CTwMgr::CStruct& s = g_TwMgr->m_Structs[_StructIndex];
+    _SummaryString[0] = '{';
+    _SummaryString[1] = '\0';
+    bool separator = false;
+    string valString;
+    for( size_t i=0; i<s.m_Members.size(); ++i )
+    {
+        const CTwMgr::CStructMember& m = s.m_Members[i];
+        size_t l = strlen(_SummaryString);
+        if( m.m_Type>=TW_TYPE_STRUCT_BASE && m.m_Type<TW_TYPE_STRUCT_BASE+(int)g_TwMgr->m_Structs.size() )
+        {
+            size_t memberIndex = m.m_Type - TW_TYPE_STRUCT_BASE;
+            const CTwMgr::CStruct& ms = g_TwMgr->m_Structs[memberIndex];
+            if( ms.m_SummaryCallback==NULL )
+                continue;
+            if( separator )
+            {
+                _SummaryString[l++] = ',';
+                _SummaryString[l++] = '\0';
+            }
+            if( ms.m_SummaryCallback==CTwMgr::CStruct::DefaultSummary )
+                StructDataSummary(_SummaryString+l, _SummaryMaxLength-l, memberIndex, _Data+m.m_Offset);
+            else
+                ms.m_SummaryCallback(_SummaryString+l, _SummaryMaxLength-l, _Data+m.m_Offset, ms.m_SummaryClientData);
+        }
+        else
+        {
+            if( separator )
+            {
+                _SummaryString[l++] = ',';
+                _SummaryString[l++] = '\0';
+            }
+            CTwVarAtom atom;
+            atom.m_Type = m.m_Type;
+            atom.m_Ptr = const_cast<char *>(_Data+m.m_Offset);
+            atom.SetDefaults();
+            for( size_t j=0; j<m.m_FormatAttribs.size(); ++j )
+                atom.SetAttrib(m.m_FormatAttribs[j].first, (m.m_FormatAttribs[j].second.length()>0) ? m.m_FormatAttribs[j].second.c_str() : NULL, NULL, NULL, -1);
+            atom.ValueToString(&valString);
+            if( atom.m_Type==TW_TYPE_BOOLCPP || atom.m_Type==TW_TYPE_BOOL8 || atom.m_Type==TW_TYPE_BOOL16 || atom.m_Type==TW_TYPE_BOOL32 )
+            {
+                if (valString == "0")
+                    valString = "-";
+                else if (valString == "1")
+                    valString = "\x7f"; // check sign
+            }
+            strncat(_SummaryString, valString.c_str(), _SummaryMaxLength-l);
+        }
+        separator = true;
+        if( strlen(_SummaryString)>_SummaryMaxLength-2 )
+            break;
+    }
+    CloseSummary(_SummaryString, _SummaryMaxLength);
+}
+
 void ANT_CALL CTwMgr::CStruct::DefaultSummary(char *_SummaryString, size_t _SummaryMaxLength, const void *_Value, void *_ClientData)
 {
     const CTwVarGroup *varGroup = static_cast<const CTwVarGroup *>(_Value); // special case
@@ -5027,6 +7585,17 @@ void ANT_CALL CTwMgr::CStruct::DefaultSummary(char *_SummaryString, size_t _Summ
         && varGroup && static_cast<const CTwVar *>(varGroup)->IsGroup()
         && structIndex>=0 && structIndex<=g_TwMgr->m_Structs.size() )
     {
+        if( varGroup->m_StructPending )
+        {
+            const CTwMgr::CStructProxy *sProxy = varGroup->m_StructProxy;
+            if( sProxy!=NULL && sProxy->m_StructGetCallback!=NULL )
+                sProxy->m_StructGetCallback(sProxy->m_StructData, sProxy->m_StructClientData);
+            if( varGroup->m_StructValuePtr!=NULL )
+                StructDataSummary(_SummaryString, _SummaryMaxLength, structIndex, static_cast<const char *>(varGroup->m_StructValuePtr));
+            return;
+        }
+
+
         // return g_TwMgr->m_Structs[structIndex].m_Name.c_str();
         CTwMgr::CStruct& s = g_TwMgr->m_Structs[structIndex];
         _SummaryString[0] = '{';
@@ -5034,7 +7603,7 @@ void ANT_CALL CTwMgr::CStruct::DefaultSummary(char *_SummaryString, size_t _Summ
         bool separator = false;
         for( size_t i=0; i<s.m_Members.size(); ++i )
         {
-            string varName = varGroup->m_Name + '.' + s.m_Members[i].m_Name;
+            string varName = varGroup->m_Name.Str() + '.' + s.m_Members[i].m_Name;
             const CTwVar *var = varGroup->Find(varName.c_str(), NULL, NULL);
             if( var )
             {
@@ -5081,19 +7650,50 @@ void ANT_CALL CTwMgr::CStruct::DefaultSummary(char *_SummaryString, size_t _Summ
                     break;
             }
         }
-        size_t l = strlen(_SummaryString);
-        if( l>_SummaryMaxLength-2 )
-        {
-            _SummaryString[_SummaryMaxLength-2] = '.';
-            _SummaryString[_SummaryMaxLength-1] = '.';
-            _SummaryString[_SummaryMaxLength+0] = '\0';
-        }
-        else
-        {
-            _SummaryString[l+0] = '}';
-            _SummaryString[l+1] = '\0';
+        CloseSummary(_SummaryString, _SummaryMaxLength);
+    }
+}
+
+//  ---------------------------------------------------------------------------
+
+// Keeps the attributes of a member def string that change how the member value
+// is displayed, so that StructDataSummary formats values like the member vars do.
+// Returns true if the def string declares a shortcut: such a member must be
+// created with its instance for the shortcut to be registered.
+static bool ParseMemberFormat(CTwMgr::CStructMember& _Member)
+{
+    static const char *s_FormatAttribs[] = { "min", "max", "step", "precision", "hexa", "decimal", "true", "false" };
+    _Member.m_FormatAttribs.clear();
+    bool hasShortcut = false;
+    CTwVarAtom atom;
+    string token, value;
+    int line = 1, column = 1;
+    const char *cur = _Member.m_DefString.c_str();
+    while( *cur!='\0' )
+    {
+        int p = ParseToken(token, cur, line, column, false, false, '=');
+        if( p<=0 || token.size()<=0 )
+            break;
+        cur += p;
+        while( *cur==' ' || *cur=='\t' )
+            ++cur;
+        value = "";
+        if( *cur=='=' )
+        {
+            p = ParseToken(value, ++cur, line, column, false, false);
+            if( p<0 )
+                break;
+            cur += p;
         }
+        bool hasValue = false;
+        int attribID = atom.HasAttrib(token.c_str(), &hasValue);
+        for( size_t i=0; attribID>0 && i<sizeof(s_FormatAttribs)/sizeof(s_FormatAttribs[0]); ++i )
+            if( _stricmp(token.c_str(), s_FormatAttribs[i])==0 )
+                _Member.m_FormatAttribs.push_back(make_pair(attribID, value));
+        if( _stricmp(token.c_str(), "key")==0 || _stricmp(token.c_str(), "keyincr")==0 || _stricmp(token.c_str(), "keydecr")==0 )
+            hasShortcut = true;
     }
+    return hasShortcut;
 }
 
 //  ---------------------------------------------------------------------------
@@ -5129,6 +7729,7 @@ TwType ANT_CALL TwDefineStruct(const char *_StructName, const TwStructMember *_S
     else
         s.m_Name = "";
     s.m_Members.resize(_NbMembers);
+    bool hasShortcuts = false;
     if( _SummaryCallback!=NULL )
     {
         s.m_SummaryCallback = _SummaryCallback;
@@ -5164,6 +7765,23 @@ TwType ANT_CALL TwDefineStruct(const char *_StructName, const TwStructMember *_S
             m.m_DefString = _StructMembers[i].DefString;
         else
             m.m_DefString = "";
+        if( ParseMemberFormat(m) )
+            hasShortcuts = true;
+    }
+
+    // Member vars of an instance can be created on demand if the summary can be computed
+    // from the struct data alone (no ext data, custom widget or std::string proxy needed)
+    // and if no member has a shortcut, which has to be active before the group is opened.
+    s.m_DeferMembers = !hasShortcuts;
+    for( unsigned int i=0; i<_NbMembers && s.m_DeferMembers; ++i )
+    {
+        TwType t = s.m_Members[i].m_Type;
+        if( t>=TW_TYPE_STRUCT_BASE && t<TW_TYPE_STRUCT_BASE+(int)structIndex )
+            s.m_DeferMembers = g_TwMgr->m_Structs[t-TW_TYPE_STRUCT_BASE].m_DeferMembers;
+        else
+            s.m_DeferMembers =    (t>TW_TYPE_UNDEF && t<=TW_TYPE_DOUBLE) || t==TW_TYPE_CDSTRING
+                               || (t>TW_TYPE_CSSTRING_BASE && t<=TW_TYPE_CSSTRING_MAX)
+                               || (t>=TW_TYPE_ENUM_BASE && t<TW_TYPE_ENUM_BASE+(int)g_TwMgr->m_Enums.size());
     }
 
     g_TwMgr->m_Structs.push_back(s);
@@ -5192,6 +7810,7 @@ TwType ANT_CALL TwDefineStructExt(const char *_StructName, const TwStructMember
     {
         CTwMgr::CStruct& s = g_TwMgr->m_Structs[type-TW_TYPE_STRUCT_BASE];
         s.m_IsExt = true;
+        s.m_DeferMembers = false;
         s.m_ClientStructSize = _StructSize;
         s.m_StructExtInitCallback = _StructExtInitCallback;
         s.m_CopyVarFromExtCallback = _CopyVarFromExtCallback;   
@@ -5509,25 +8128,9 @@ ETwMouseAction   TW_MOUSE_MOTION = (ETwMouseAction)(-2);
 ETwMouseAction   TW_MOUSE_WHEEL = (ETwMouseAction)(-3);
 ETwMouseButtonID TW_MOUSE_NA = (ETwMouseButtonID)(-1);
 
-static int TwMouseEvent(ETwMouseAction _EventType, TwMouseButtonID _Button, int _MouseX, int _MouseY, int _WheelPos)
+// Handles a mouse event once the manager is known to be ready and not drawing
+static int ProcessMouseEvent(ETwMouseAction _EventType, TwMouseButtonID _Button, int _MouseX, int _MouseY, int _WheelPos)
 {
-    CTwFPU fpu; // force fpu precision
-
-    if( g_TwMgr==NULL || g_TwMgr->m_Graph==NULL )
-    {
-        // TwGlobalError(g_ErrNotInit); -> not an error here
-        return 0; // not initialized
-    }
-    if( g_TwMgr->m_WndHeight<=0 || g_TwMgr->m_WndWidth<=0 )
-    {
-        //g_TwMgr->SetLastError(g_ErrBadWndSize);   // not an error, windows not yet ready.
-        return 0;
-    }
-
-    // For multi-thread safety
-    if( !TwFreeAsyncDrawing() )
-        return 0;
-
     if( _MouseX==TW_MOUSE_NOMOTION )
         _MouseX = g_TwMgr->m_LastMouseX;
     else
@@ -5552,25 +8155,36 @@ static int TwMouseEvent(ETwMouseAction _EventType, TwMouseButtonID _Button, int
         g_TwMgr->m_CanRepeatMousePressed = false;
         g_TwMgr->m_IsRepeatingMousePressed = false;
     }
+    if( _EventType==TW_MOUSE_RELEASED )
+        g_TwMgr->m_DragStartedInBar = false;
 
     bool Handled = false;
     bool wasPopup = (g_TwMgr->m_PopupBar!=NULL);
     CTwBar *Bar = NULL;
     int i;
 
-    // search for a bar with mousedrag enabled
-    CTwBar *BarDragging = NULL;
-    for( i=((int)g_TwMgr->m_Bars.size())-1; i>=0; --i )
-    {
-        Bar = g_TwMgr->m_Bars[g_TwMgr->m_Order[i]];
-        if( Bar!=NULL && Bar->m_Visible && Bar->IsDragging() )
-        {
-            BarDragging = Bar;
-            break;
-        }
+    // the bar with mousedrag enabled
+    CTwBar *BarDragging = g_TwMgr->m_DraggingBar;
+    if( BarDragging!=NULL && !BarDragging->m_Visible )
+        BarDragging = NULL;
+
+    // mouse motion is routed to the bar under the cursor through the hit-test index,
+    // unless a bar or a custom widget has captured the mouse
+    bool UseHitTest = (_EventType==TW_MOUSE_MOTION && BarDragging==NULL && g_TwMgr->m_CustomCaptureProxy==NULL);
+    if( UseHitTest )
+    {
+        Bar = g_TwMgr->HitTestBar(_MouseX, _MouseY);
+        CTwBar *HoverBar = g_TwMgr->m_HoverBar;
+        g_TwMgr->m_HoverBar = Bar;
+        if( HoverBar!=NULL && HoverBar!=Bar && HoverBar->m_Visible )
+            HoverBar->MouseMotion(_MouseX, _MouseY); // let the previous bar clear its highlights
+        if( g_TwMgr==NULL ) // Mgr might have been destroyed by the client inside a callback call
+            return 1;
+        if( Bar!=NULL )
+            Handled = Bar->MouseMotion(_MouseX, _MouseY);
+        i = (Bar!=NULL) ? 0 : -1;
     }
-
-    for( i=(int)g_TwMgr->m_Bars.size(); i>=0; --i )
+    else for( i=(int)g_TwMgr->m_Bars.size(); i>=0; --i )
     {
         if( i==(int)g_TwMgr->m_Bars.size() )    // first try the bar with mousedrag enabled (this bar has the focus)
             Bar = BarDragging;
@@ -5598,6 +8212,16 @@ static int TwMouseEvent(ETwMouseAction _EventType, TwMouseButtonID _Button, int
 
     if( g_TwMgr==NULL ) // Mgr might have been destroyed by the client inside a callback call
         return 1;
+    if( _EventType==TW_MOUSE_PRESSED && Handled ) // drags in the application window do not hold back edits
+        g_TwMgr->m_DragStartedInBar = true;
+    if( _EventType==TW_MOUSE_RELEASED ) // end of a drag: commit the edits kept until the release
+    {
+        g_TwMgr->FlushChanges(false);
+        if( g_TwMgr==NULL )
+            return 1;
+    }
+    if( _EventType==TW_MOUSE_MOTION && !UseHitTest ) // all bars have been notified
+        g_TwMgr->m_HoverBar = Handled ? Bar : NULL;
 
     /*
     if( i>=0 && Bar!=NULL && Handled && (_EventType==TW_MOUSE_PRESSED || Bar->IsMinimized()) && i!=((int)g_TwMgr->m_Bars.size())-1 )
@@ -5626,6 +8250,28 @@ static int TwMouseEvent(ETwMouseAction _EventType, TwMouseButtonID _Button, int
     return Handled ? 1 : 0;
 }
 
+static int TwMouseEvent(ETwMouseAction _EventType, TwMouseButtonID _Button, int _MouseX, int _MouseY, int _WheelPos)
+{
+    CTwFPU fpu; // force fpu precision
+
+    if( g_TwMgr==NULL || g_TwMgr->m_Graph==NULL )
+    {
+        // TwGlobalError(g_ErrNotInit); -> not an error here
+        return 0; // not initialized
+    }
+    if( g_TwMgr->m_WndHeight<=0 || g_TwMgr->m_WndWidth<=0 )
+    {
+        //g_TwMgr->SetLastError(g_ErrBadWndSize);   // not an error, windows not yet ready.
+        return 0;
+    }
+
+    // For multi-thread safety
+    if( !TwFreeAsyncDrawing() )
+        return 0;
+
+    return ProcessMouseEvent(_EventType, _Button, _MouseX, _MouseY, _WheelPos);
+}
+
 int ANT_CALL TwMouseButton(ETwMouseAction _EventType, TwMouseButtonID _Button)
 {
     return TwMouseEvent(_EventType, _Button, TW_MOUSE_NOMOTION, TW_MOUSE_NOMOTION, 0);
@@ -5702,25 +8348,9 @@ static int TranslateKey(int _Key, int _Modifiers)
 
 //  ---------------------------------------------------------------------------
 
-static int KeyPressed(int _Key, int _Modifiers, bool _TestOnly)
+// Handles a key event once the manager is known to be ready and not drawing
+static int ProcessKeyPressed(int _Key, int _Modifiers, bool _TestOnly)
 {
-    CTwFPU fpu; // force fpu precision
-
-    if( g_TwMgr==NULL || g_TwMgr->m_Graph==NULL )
-    {
-        // TwGlobalError(g_ErrNotInit); -> not an error here
-        return 0; // not initialized
-    }
-    if( g_TwMgr->m_WndHeight<=0 || g_TwMgr->m_WndWidth<=0 )
-    {
-        //g_TwMgr->SetLastError(g_ErrBadWndSize);   // not an error, windows not yet ready.
-        return 0;
-    }
-
-    // For multi-thread savety
-    if( !TwFreeAsyncDrawing() )
-        return 0;
-
     /*
     // Test for TwDeleteBar
     if( _Key>='0' && _Key<='9' )
@@ -5761,6 +8391,10 @@ static int KeyPressed(int _Key, int _Modifiers, bool _TestOnly)
     int i;
     if( _Key>0 && _Key<TW_KEY_LAST )
     {
+        // A visible var shortcut is enough to know that the key will be handled
+        if( _TestOnly && g_TwMgr->FindShortcut(NULL, _Key, _Modifiers, NULL)!=NULL )
+            return 1;
+
         // First send it to bar which includes the mouse pointer
         int MouseX = g_TwMgr->m_LastMouseX;
         int MouseY = g_TwMgr->m_LastMouseY;
@@ -5840,6 +8474,28 @@ static int KeyPressed(int _Key, int _Modifiers, bool _TestOnly)
     return Handled ? 1 : 0;
 }
 
+static int KeyPressed(int _Key, int _Modifiers, bool _TestOnly)
+{
+    CTwFPU fpu; // force fpu precision
+
+    if( g_TwMgr==NULL || g_TwMgr->m_Graph==NULL )
+    {
+        // TwGlobalError(g_ErrNotInit); -> not an error here
+        return 0; // not initialized
+    }
+    if( g_TwMgr->m_WndHeight<=0 || g_TwMgr->m_WndWidth<=0 )
+    {
+        //g_TwMgr->SetLastError(g_ErrBadWndSize);   // not an error, windows not yet ready.
+        return 0;
+    }
+
+    // For multi-thread savety
+    if( !TwFreeAsyncDrawing() )
+        return 0;
+
+    return ProcessKeyPressed(_Key, _Modifiers, _TestOnly);
+}
+
 int ANT_CALL TwKeyPressed(int _Key, int _Modifiers)
 {
     return KeyPressed(_Key, _Modifiers, false);
@@ -5852,6 +8508,59 @@ int ANT_CALL TwKeyTest(int _Key, int _Modifiers)
 
 //  ---------------------------------------------------------------------------
 
+int ANT_CALL TwProcessEvents(const TwEvent *_Events, int _Count)
+{
+    CTwFPU fpu; // force fpu precision
+
+    if( g_TwMgr==NULL || g_TwMgr->m_Graph==NULL )
+    {
+        // TwGlobalError(g_ErrNotInit); -> not an error here
+        return 0; // not initialized
+    }
+    if( g_TwMgr->m_WndHeight<=0 || g_TwMgr->m_WndWidth<=0 )
+        return 0; // windows not yet ready
+    if( _Events==NULL || _Count<=0 )
+        return 0;
+
+    // For multi-thread safety: checked once for the whole batch, the events
+    // are then dispatched to the handlers that skip this check
+    if( !TwFreeAsyncDrawing() )
+        return 0;
+
+    int NbHandled = 0;
+    for( int i=0; i<_Count && g_TwMgr!=NULL; ++i ) // Mgr might be destroyed by the client inside a callback call
+    {
+        const TwEvent& Event = _Events[i];
+        switch( Event.Type )
+        {
+        case TW_EVENT_MOUSE_MOTION:
+            {
+                // consecutive motion events are coalesced: only the last position matters,
+                // bars are thus hit-tested and updated once per run of motion events
+                int Last = i;
+                while( Last+1<_Count && _Events[Last+1].Type==TW_EVENT_MOUSE_MOTION )
+                    ++Last;
+                if( ProcessMouseEvent(TW_MOUSE_MOTION, TW_MOUSE_NA, _Events[Last].MouseX, _Events[Last].MouseY, 0) )
+                    NbHandled += Last-i+1;
+                i = Last;
+            }
+            break;
+        case TW_EVENT_MOUSE_BUTTON:
+            NbHandled += ProcessMouseEvent(Event.Action, Event.Button, TW_MOUSE_NOMOTION, TW_MOUSE_NOMOTION, 0) ? 1 : 0;
+            break;
+        case TW_EVENT_MOUSE_WHEEL:
+            NbHandled += ProcessMouseEvent(TW_MOUSE_WHEEL, TW_MOUSE_NA, TW_MOUSE_NOMOTION, TW_MOUSE_NOMOTION, Event.WheelPos) ? 1 : 0;
+            break;
+        case TW_EVENT_KEY_PRESSED:
+            NbHandled += ProcessKeyPressed(Event.Key, Event.Modifiers, false) ? 1 : 0;
+            break;
+        }
+    }
+    return NbHandled;
+}
+
+//  ---------------------------------------------------------------------------
+
 struct StructCompare : public binary_function<TwType, TwType, bool>
 {
     bool operator()(const TwType& _Left, const TwType& _Right) const
@@ -5868,6 +8577,27 @@ struct StructCompare : public binary_function<TwType, TwType, bool>
 
 typedef set<TwType, StructCompare> StructSet;
 
+// Struct members of a struct var whose member vars are not created yet
+static void InsertMemberStructs(StructSet& _Set, TwType _Type)
+{
+    const CTwMgr::CStruct& s = g_TwMgr->m_Structs[_Type-TW_TYPE_STRUCT_BASE];
+    for( size_t i=0; i<s.m_Members.size(); ++i )
+    {
+        TwType t = s.m_Members[i].m_Type;
+        if( t>=TW_TYPE_STRUCT_BASE && t<TW_TYPE_STRUCT_BASE+(int)g_TwMgr->m_Structs.size() )
+        {
+            const CTwMgr::CStruct& ms = g_TwMgr->m_Structs[t-TW_TYPE_STRUCT_BASE];
+            for( size_t j=0; ms.m_Name.length()>0 && j<ms.m_Members.size(); ++j )
+                if( ms.m_Members[j].m_Help.length()>0 )
+                {
+                    _Set.insert(t);
+                    break;
+                }
+            InsertMemberStructs(_Set, t);
+        }
+    }
+}
+
 static void InsertUsedStructs(StructSet& _Set, const CTwVarGroup *_Grp)
 {
     assert( g_TwMgr!=NULL && _Grp!=NULL );
@@ -5893,6 +8623,8 @@ static void InsertUsedStructs(StructSet& _Set, const CTwVarGroup *_Grp)
                             }
                     }
                 }
+                if( SubGrp->m_StructPending )
+                    InsertMemberStructs(_Set, SubGrp->m_StructType);
             }
             InsertUsedStructs(_Set, SubGrp);
         }
@@ -5998,7 +8730,7 @@ static int AppendHelpString(CTwVarGroup *_Grp, const char *_String, int _Level,
         SplitString(Split, _String, _Width-DecalWidth, Font);
         for( int i=0; i<(int)Split.size(); ++i )
         {
-            CTwVarAtom *Var = new CTwVarAtom;
+            CTwVarAtom *Var = new(&g_TwMgr->m_HelpBar->m_VarArena) CTwVarAtom;
             Var->m_Name = Decal + Split[i];
             Var->m_Ptr = NULL;
             if( _Type==TW_TYPE_HELP_HEADER )
@@ -6050,7 +8782,7 @@ static int AppendHelp(CTwVarGroup *_Grp, const CTwVarGroup *_ToAppend, int _Leve
 
             if( append )
             {
-                CTwVarAtom *Var = new CTwVarAtom;
+                CTwVarAtom *Var = new(&g_TwMgr->m_HelpBar->m_VarArena) CTwVarAtom;
                 Var->m_Name = Decal;
                 if( _ToAppend->m_Vars[i]->m_Label.size()>0 )
                     Var->m_Name += _ToAppend->m_Vars[i]->m_Label;
@@ -6196,7 +8928,7 @@ void CTwMgr::UpdateHelpBar()
         if( m_Bars[ib]!=NULL && !(m_Bars[ib]->m_IsHelpBar) && m_Bars[ib]!=m_PopupBar && m_Bars[ib]->m_Visible )
         {
             // Create a group
-            CTwVarGroup *Grp = new CTwVarGroup;
+            CTwVarGroup *Grp = new(&m_HelpBar->m_VarArena) CTwVarGroup;
             Grp->m_SummaryCallback = NULL;
             Grp->m_SummaryClientData = NULL;
             Grp->m_StructValuePtr = NULL;
@@ -6225,7 +8957,7 @@ void CTwMgr::UpdateHelpBar()
                 {
                     if( StructGrp==NULL )
                     {
-                        StructGrp = new CTwVarGroup;
+                        StructGrp = new(&m_HelpBar->m_VarArena) CTwVarGroup;
                         StructGrp->m_StructType = TW_TYPE_HELP_STRUCT;  // a special line background color will be used
                         StructGrp->m_Name = "Structures";
                         StructGrp->m_Open = false;
@@ -6233,7 +8965,7 @@ void CTwMgr::UpdateHelpBar()
                         //Grp->m_Vars.push_back(StructGrp);
                         MemberCount = 0;
                     }
-                    CTwVarAtom *Var = new CTwVarAtom;
+                    CTwVarAtom *Var = new(&m_HelpBar->m_VarArena) CTwVarAtom;
                     Var->m_Ptr = NULL;
                     Var->m_Type = TW_TYPE_HELP_GRP;
                     Var->m_DontClip = true;
@@ -6252,7 +8984,7 @@ void CTwMgr::UpdateHelpBar()
                     {
                         if( g_TwMgr->m_Structs[idx].m_Members[im].m_Help.size()>0 )
                         {
-                            CTwVarAtom *Var = new CTwVarAtom;
+                            CTwVarAtom *Var = new(&m_HelpBar->m_VarArena) CTwVarAtom;
                             Var->m_Ptr = NULL;
                             Var->m_Type = TW_TYPE_SHORTCUT;
                             Var->m_Val.m_Shortcut.m_Incr[0] = 0;
@@ -6295,7 +9027,7 @@ void CTwMgr::UpdateHelpBar()
         }
 
     // Append RotoSlider
-    CTwVarGroup *RotoGrp = new CTwVarGroup;
+    CTwVarGroup *RotoGrp = new(&m_HelpBar->m_VarArena) CTwVarGroup;
     RotoGrp->m_SummaryCallback = NULL;
     RotoGrp->m_SummaryClientData = NULL;
     RotoGrp->m_StructValuePtr = NULL;
@@ -6315,6 +9047,43 @@ void CTwMgr::UpdateHelpBar()
 
 //  ---------------------------------------------------------------------------
 
+// Windows other than the master one use the cursors of the master manager
+// if it has already created them (they are released with the master)
+bool CTwMgr::ShareMasterCursors()
+{
+    const CTwMgr *Master = g_TwMasterMgr;
+    if( Master==NULL || Master==this || !Master->m_CursorsCreated )
+        return false;
+    #if defined(ANT_UNIX)
+        if( Master->m_CurrentXDisplay!=m_CurrentXDisplay )
+            return false;
+    #endif
+
+    m_CursorArrow = Master->m_CursorArrow;
+    m_CursorMove = Master->m_CursorMove;
+    m_CursorWE = Master->m_CursorWE;
+    m_CursorNS = Master->m_CursorNS;
+    m_CursorTopLeft = Master->m_CursorTopLeft;
+    m_CursorTopRight = Master->m_CursorTopRight;
+    m_CursorBottomLeft = Master->m_CursorBottomLeft;
+    m_CursorBottomRight = Master->m_CursorBottomRight;
+    m_CursorHelp = Master->m_CursorHelp;
+    m_CursorHand = Master->m_CursorHand;
+    m_CursorCross = Master->m_CursorCross;
+    m_CursorUpArrow = Master->m_CursorUpArrow;
+    m_CursorNo = Master->m_CursorNo;
+    m_CursorIBeam = Master->m_CursorIBeam;
+    for( int i=0; i<NB_ROTO_CURSORS; ++i )
+        m_RotoCursors[i] = Master->m_RotoCursors[i];
+    m_CursorCenter = Master->m_CursorCenter;
+    m_CursorPoint = Master->m_CursorPoint;
+    m_CursorsCreated = true;
+    m_CursorsShared = true;
+    return true;
+}
+
+//  ---------------------------------------------------------------------------
+
 #if defined(ANT_WINDOWS)
 #pragma warning(disable : 4302)
 
@@ -6322,7 +9091,7 @@ void CTwMgr::UpdateHelpBar()
 
 void CTwMgr::CreateCursors()
 {
-    if( m_CursorsCreated )
+    if( m_CursorsCreated || ShareMasterCursors() )
         return;
     m_CursorArrow = ::LoadCursor(NULL ,MAKEINTRESOURCE(IDC_ARROW));
     m_CursorMove = ::LoadCursor(NULL ,MAKEINTRESOURCE(IDC_SIZEALL));
@@ -6407,7 +9176,7 @@ CTwMgr::CCursor CTwMgr::PixmapCursor(int _CurIdx)
 
 void CTwMgr::FreeCursors()
 {
-    if( !g_UseCurRsc )
+    if( !g_UseCurRsc && !m_CursorsShared )
     {
         if( m_CursorCenter!=NULL )
         {
@@ -6427,6 +9196,7 @@ void CTwMgr::FreeCursors()
             }
     }
     m_CursorsCreated = false;
+    m_CursorsShared = false;
 }
 
 void CTwMgr::SetCursor(CTwMgr::CCursor _Cursor)
@@ -6489,7 +9259,7 @@ CTwMgr::CCursor CTwMgr::PixmapCursor(int _CurIdx)
 
 void CTwMgr::CreateCursors()
 {
-    if (m_CursorsCreated)
+    if (m_CursorsCreated || ShareMasterCursors())
         return;
     
     m_CursorArrow        = [[NSCursor arrowCursor] retain];
@@ -6517,6 +9287,12 @@ void CTwMgr::CreateCursors()
 
 void CTwMgr::FreeCursors()
 {
+    if (m_CursorsShared)
+    {
+        m_CursorsCreated = false;
+        m_CursorsShared = false;
+        return;
+    }
     [m_CursorArrow release];
     [m_CursorMove release];
     [m_CursorWE release];
@@ -6620,7 +9396,7 @@ CTwMgr::CCursor CTwMgr::PixmapCursor(int _CurIdx)
 
 void CTwMgr::CreateCursors()
 {
-    if( m_CursorsCreated || !m_CurrentXDisplay || !m_CurrentXWindow )
+    if( m_CursorsCreated || !m_CurrentXDisplay || !m_CurrentXWindow || ShareMasterCursors() )
         return;
 
     IgnoreXErrors();
@@ -6651,6 +9427,12 @@ void CTwMgr::CreateCursors()
 
 void CTwMgr::FreeCursors()
 {
+    if( m_CursorsShared )
+    {
+        m_CursorsCreated = false;
+        m_CursorsShared = false;
+        return;
+    }
     IgnoreXErrors();
     
     XFreeCursor(m_CurrentXDisplay, m_CursorArrow);
@@ -6712,6 +9494,31 @@ void ANT_CALL TwCopyCDStringToClientFunc(TwCopyCDStringToClient copyCDStringToCl
         g_TwMgr->m_CopyCDStringToClient = copyCDStringToClientFunc;
 }
 
+void ANT_CALL TwRasterizeGlyphFunc(TwRasterizeGlyph rasterizeGlyphFunc, void *clientData)
+{
+    g_RasterizeGlyph = rasterizeGlyphFunc;
+    g_RasterizeGlyphClientData = clientData;
+    TwResetGlyphCaches();
+}
+
+void ANT_CALL TwChangeStreamFunc(TwChangeStreamCallback changeStreamFunc, void *clientData)
+{
+    g_ChangeStream = changeStreamFunc;
+    g_ChangeStreamClientData = clientData;
+}
+
+int ANT_CALL TwFlushChanges()
+{
+    if( g_TwMgr==NULL )
+    {
+        TwGlobalError(g_ErrNotInit);
+        return 0; // not initialized
+    }
+
+    g_TwMgr->FlushChanges(true);
+    return 1;
+}
+
 void ANT_CALL TwCopyCDStringToLibrary(char **destinationLibraryStringPtr, const char *sourceClientString)
 {
     if( g_TwMgr==NULL )
@@ -6837,20 +9644,81 @@ bool CRect::Subtract(const vector<CRect>& _Rects, vector<CRect>& _OutRects) cons
         _OutRects.push_back(*this);
         return true;
     }
-    else
+    if( Empty() )
+        return true;
+
+    // Removed parts clipped to this rect. As with the single rect Subtract, 
+    // remaining parts overlap the top and left edges of removed rects by one pixel.
+    vector<CRect> Covers;
+    vector<int> Ys;
+    Covers.reserve(NbRects);
+    Ys.reserve(2*NbRects+2);
+    Ys.push_back(Y);
+    Ys.push_back(Y+H);
+    for( i=0; i<NbRects; ++i )
     {
-        vector<CRect> TmpRects;
-        Subtract(_Rects[0], _OutRects);
-        
-        for( i=1; i<NbRects; i++)
+        const CRect& R = _Rects[i];
+        if( R.Empty() )
+            continue;
+        int X0 = (R.X>X) ? R.X+1 : X;
+        int Y0 = (R.Y>Y) ? R.Y+1 : Y;
+        int X1 = min(R.X+R.W, X+W);
+        int Y1 = min(R.Y+R.H, Y+H);
+        if( X0<X1 && Y0<Y1 )
+        {
+            Covers.push_back(CRect(X0, Y0, X1-X0, Y1-Y0));
+            Ys.push_back(Y0);
+            Ys.push_back(Y1);
+        }
+    }
+    if( Covers.empty() )
+    {
+        _OutRects.push_back(*this);
+        return false;
+    }
+
+    // Sweep horizontal bands delimited by the removed rects edges. Each band scans
+    // all removed rects for its spans, so the cost is O(bands*n), ie. O(n^2) for n
+    // rects; n is the number of bars, which is small. Free spans of a band are
+    // merged with the rects of the previous band when they are identical.
+    sort(Ys.begin(), Ys.end());
+    Ys.erase(unique(Ys.begin(), Ys.end()), Ys.end());
+    vector<pair<int, int> > Spans, Free, PrevFree;
+    size_t FirstOpen = 0;
+    for( i=0; i+1<Ys.size(); ++i )
+    {
+        int B0 = Ys[i], B1 = Ys[i+1];
+        Spans.clear();
+        for( j=0; j<Covers.size(); ++j )
+            if( Covers[j].Y<=B0 && Covers[j].Y+Covers[j].H>=B1 )
+                Spans.push_back(pair<int, int>(Covers[j].X, Covers[j].X+Covers[j].W));
+        sort(Spans.begin(), Spans.end());
+
+        Free.clear();
+        int Cur = X;
+        for( j=0; j<Spans.size(); ++j )
+        {
+            if( Spans[j].first>Cur )
+                Free.push_back(pair<int, int>(Cur, Spans[j].first));
+            Cur = max(Cur, Spans[j].second);
+        }
+        if( Cur<X+W )
+            Free.push_back(pair<int, int>(Cur, X+W));
+
+        if( i>0 && Free==PrevFree )
+        {
+            for( j=0; j<Free.size(); ++j )
+                _OutRects[FirstOpen+j].H += B1-B0;
+        }
+        else
         {
-            for( j=0; j<_OutRects.size(); j++ )
-                _OutRects[j].Subtract(_Rects[i], TmpRects);
-            _OutRects.swap(TmpRects);
-            TmpRects.clear();
+            FirstOpen = _OutRects.size();
+            for( j=0; j<Free.size(); ++j )
+                _OutRects.push_back(CRect(Free[j].first, B0, Free[j].second-Free[j].first, B1-B0));
+            PrevFree.swap(Free);
         }
-        return _OutRects.empty();
     }
+    return _OutRects.empty();
 }
 
 //  ---------------------------------------------------------------------------
@@ -20,17 +20,9 @@
 #include "TwColors.h"
 #include "TwFonts.h"
 #include "TwGraph.h"
+#include "TwStringPool.h"
 #include "AntPerfTimer.h"
 
-
-//#define BENCH // uncomment to activate benchmarks
-
-#ifdef BENCH
-#   define PERF(cmd)    cmd
-#else   // BENCH
-#   define PERF(cmd)
-#endif  // BENCH
-
 #ifdef __MINGW32__ // MinGW patches
 #undef MAKEINTRESOURCE
 #define MAKEINTRESOURCE(a) "a"
@@ -62,6 +54,7 @@ typedef enum ETwState
 //ANT_TWEAK_BAR_API TwState ANT_CALL TwGetVarState(const TwBar *bar, const char *name);
 
 struct CTwVarGroup;
+struct CTwVarAtom;
 typedef void (ANT_CALL *TwStructExtInitCallback)(void *structExtValue, void *clientData);
 typedef void (ANT_CALL *TwCopyVarFromExtCallback)(void *structValue, const void *structExtValue, unsigned int structExtMemberIndex, void *clientData);
 typedef void (ANT_CALL *TwCopyVarToExtCallback)(const void *structValue, void *structExtValue, unsigned int structExtMemberIndex, void *clientData);
@@ -85,17 +78,31 @@ enum EButtonAlign
     BUTTON_ALIGN_RIGHT 
 };
 
+// Clipping helper
+struct CRect 
+{ 
+    int X, Y, W, H;
+    CRect() : X(0), Y(0), W(0), H(0) {}
+    CRect(int _X, int _Y, int _W, int _H) : X(_X), Y(_Y), W(_W), H(_H) {}
+    bool operator==(const CRect& _Rect) { return (Empty() && _Rect.Empty()) || (X==_Rect.X && Y==_Rect.Y && W==_Rect.W && H==_Rect.H); }
+    bool Empty(int _Margin=0) const { return (W<=_Margin || H<=_Margin); }
+    bool Subtract(const CRect& _Rect, std::vector<CRect>& _OutRects) const;
+    bool Subtract(const std::vector<CRect>& _Rects, std::vector<CRect>& _OutRects) const; // band sweep, each of the O(n) bands scans the n rects: O(n^2)
+    bool Intersects(const CRect& _Rect) const { return !Empty() && !_Rect.Empty() && _Rect.X<X+W && _Rect.X+_Rect.W>X && _Rect.Y<Y+H && _Rect.Y+_Rect.H>Y; }
+};
+
 //  ---------------------------------------------------------------------------
 //  AntTweakBar Manager
 //  ---------------------------------------------------------------------------
 
-struct CTwMgr
+struct CTwMgr : CTwAllocated
 {
     ETwGraphAPI         m_GraphAPI;
     void *              m_Device;
     int                 m_WndID;
     class ITwGraph *    m_Graph;
 	void *              m_GraphContext;
+    class CTwGraphRecorder *m_Recorder; // created by the first TwRecord call
     int                 m_WndWidth;
     int                 m_WndHeight;
     const CTexFont *    m_CurrentFont;
@@ -109,6 +116,7 @@ struct CTwMgr
     void                Hide(TwBar *_Bar);
     void                Unhide(TwBar *_Bar);
     void                SetFont(const CTexFont *_Font, bool _ResizeBars);
+    static void         RescaleFonts(bool _Regenerate);
     int                 m_LastMouseX;
     int                 m_LastMouseY;
     int                 m_LastMouseWheelPos;
@@ -122,6 +130,29 @@ struct CTwMgr
     bool                m_Contained;
     EButtonAlign        m_ButtonAlign;
     bool                m_OverlapContent;
+
+    bool                BarsLayoutChanged(std::vector<int>& _Key) const;
+
+    // Visible parts of overlapped bars, indexed by draw order. Recomputed only
+    // when the order, geometry or visibility of bars changes.
+    struct CBarClip     { bool m_Clipped; std::vector<CRect> m_Rects; };
+    std::vector<CBarClip> m_BarClips;
+    std::vector<int>    m_BarClipsKey;
+    void                UpdateBarClips();
+
+    // Grid of bar hit rects used to route mouse motion to the bar under the
+    // cursor. Each cell lists the bars it overlaps, topmost first.
+    struct CHitRect     { CRect m_Rect; TwBar *m_Bar; };
+    std::vector<CHitRect> m_HitRects;       // topmost first
+    std::vector<int>    m_HitCellStart;     // first item of each cell in m_HitCellItems
+    std::vector<int>    m_HitCellItems;     // indices in m_HitRects
+    int                 m_HitNbCellsX;
+    int                 m_HitNbCellsY;
+    bool                m_HitIndexDirty;    // set where bars are moved, resized, shown, hidden, (de)iconified, created, deleted or reordered
+    TwBar *             m_HoverBar;         // bar which received the last routed mouse motion
+    TwBar *             HitTestBar(int _X, int _Y);
+    TwBar *             m_DraggingBar;      // bar whose m_MouseDrag is set
+    TwBar *             m_HighlightBar;     // the only bar which may draw its handles or highlight its title
     bool                m_Terminating;
 
     std::string         m_Help;
@@ -134,6 +165,15 @@ struct CTwMgr
     bool                m_KeyPressedBuildText;
     std::string         m_KeyPressedStr;
     float               m_KeyPressedTime;
+
+    // Keyboard shortcuts of vars (keyincr/keydecr attributes) hashed by key
+    // and modifiers, updated when the attributes are set or the vars deleted.
+    struct CShortcut    { int m_Key; int m_Modifiers; bool m_Incr; CTwVarAtom *m_Atom; TwBar *m_Bar; };
+    enum                { NB_SHORTCUT_BUCKETS = 64 };
+    std::vector<CShortcut> m_Shortcuts[NB_SHORTCUT_BUCKETS];
+    void                AddShortcuts(CTwVarAtom *_Atom, TwBar *_Bar);
+    void                RemoveShortcuts(const CTwVarAtom *_Atom);
+    CTwVarAtom *        FindShortcut(const TwBar *_Bar, int _Key, int _Modifiers, bool *_DoIncr) const; // _Bar==NULL: search visible vars of all visible bars
     void *              m_InfoTextObj;
     bool                m_InfoBuildText;
     int                 m_BarInitColorHue;
@@ -161,6 +201,7 @@ struct CTwMgr
         std::string     m_DefString;
         size_t          m_Size;
         std::string     m_Help;
+        std::vector<std::pair<int, std::string> > m_FormatAttribs;  // display attributes of m_DefString, used to summarize unexpanded struct vars
     };
     struct CStruct
     {
@@ -176,7 +217,8 @@ struct CTwMgr
         TwCopyVarFromExtCallback    m_CopyVarFromExtCallback;
         TwCopyVarToExtCallback      m_CopyVarToExtCallback;
         void *                      m_ExtClientData;
-        CStruct() : m_IsExt(false), m_StructExtInitCallback(NULL), m_CopyVarFromExtCallback(NULL), m_CopyVarToExtCallback(NULL), m_ExtClientData(NULL) {}
+        bool                        m_DeferMembers; // member vars of an instance are created when its group is first opened or looked up
+        CStruct() : m_IsExt(false), m_StructExtInitCallback(NULL), m_CopyVarFromExtCallback(NULL), m_CopyVarToExtCallback(NULL), m_ExtClientData(NULL), m_DeferMembers(false) {}
         static void ANT_CALL        DefaultSummary(char *_SummaryString, size_t _SummaryMaxLength, const void *_Value, void *_ClientData);
         static void *               s_PassProxyAsClientData;
     };
@@ -201,6 +243,7 @@ struct CTwMgr
         int              m_CustomIndexLast;
         CStructProxy();
         ~CStructProxy();
+        void             SetCustomCaptureFocus(bool _Focus);
     };
     struct CMemberProxy
     {
@@ -215,17 +258,106 @@ struct CTwMgr
         static void ANT_CALL GetCB(void *_Value, void *_ClientData);
     };
     std::list<CStructProxy> m_StructProxies;    // elements should not move
+    CStructProxy *      m_CustomCaptureProxy;   // custom widget which has captured the mouse
     std::list<CMemberProxy> m_MemberProxies;    // elements should not move
+    // Array var: a group with a page selector and m_PageSize row vars which
+    // access the elements of the current page only
+    struct CArrayProxy
+    {
+        char *          m_Array;
+        TwType          m_ElementType;
+        unsigned int    m_Count;
+        size_t          m_Stride;
+        unsigned int    m_PageSize;
+        unsigned int    m_Page;
+        bool            m_ReadOnly;
+        CTwBar *        m_Bar;
+        struct CTwVarGroup * m_Group;
+        struct CRow
+        {
+            CArrayProxy *   m_Array;
+            unsigned int    m_Slot;
+        };
+        std::vector<CRow> m_Rows;   // client data of the row vars
+        unsigned int    NbPages() const { return (m_Count+m_PageSize-1)/m_PageSize; }
+        static void ANT_CALL RowSetCB(const void *_Value, void *_ClientData);
+        static void ANT_CALL RowGetCB(void *_Value, void *_ClientData);
+        static void ANT_CALL PageSetCB(const void *_Value, void *_ClientData);
+        static void ANT_CALL PageGetCB(void *_Value, void *_ClientData);
+        static void ANT_CALL SummaryCB(char *_SummaryString, size_t _SummaryMaxLength, const void *_Value, void *_ClientData);
+    };
+    std::list<CArrayProxy>  m_ArrayProxies;     // elements should not move
+    int                 SetArrayPageSize(CArrayProxy *_Array, unsigned int _PageSize);
+    void                SetArrayPage(CArrayProxy *_Array, unsigned int _Page);
+    void                RemoveArrayProxy(CArrayProxy *_Array);
+    struct CPlotProxy
+    {
+        const char *    m_Var;              // NULL if sampled through m_GetCallback
+        TwGetVarCallback m_GetCallback;
+        void *          m_ClientData;
+        TwType          m_Type;
+        std::vector<float> m_History;       // ring buffer of the last samples
+        unsigned int    m_NbSamples;        // samples recorded since creation
+        double          m_Period;           // seconds between samples, 0 to sample at each TwDraw
+        double          m_LastSampleTime;
+        bool            m_AutoRange;
+        double          m_RangeMin;
+        double          m_RangeMax;
+        int             m_Width;            // pixel width the columns are built for
+        unsigned int    m_ColumnSize;       // samples folded into one column
+        std::vector<float> m_ColumnMin;     // min/max of the samples of each column, indexed by (sample/m_ColumnSize)%size
+        std::vector<float> m_ColumnMax;
+        std::vector<int> m_Vertices;        // kept between draws to avoid reallocations
+        std::vector<color32> m_Colors;
+        CTwBar *        m_Bar;
+        struct CTwVarGroup * m_Group;
+        void            Push(float _Val);
+        void            SetWidth(int _Width);
+        void            ColumnRange(unsigned int _Column, float *_Min, float *_Max) const;
+        void            KeptRange(float *_Min, float *_Max) const;
+        void            Draw(ITwGraph *_Graph, int _Width, int _Height, color32 _Color, color32 _BgColor);
+        static void ANT_CALL SummaryCB(char *_SummaryString, size_t _SummaryMaxLength, const void *_Value, void *_ClientData);
+    };
+    std::list<CPlotProxy>   m_PlotProxies;      // elements should not move
+    int                 SetPlotRows(CPlotProxy *_Plot, unsigned int _NbRows);
+    void                SamplePlots();
+    void                RemovePlotProxy(CPlotProxy *_Plot);
     //void              InitVarData(TwType _Type, void *_Data, size_t _Size);
     //void              UninitVarData(TwType _Type, void *_Data, size_t _Size);
 
     struct CEnum
     {
         std::string     m_Name;
-        typedef std::map<unsigned int, std::string> CEntries;
+        typedef std::pair<unsigned int, CTwIString> CEntry;  // labels are interned
+        struct CEntries : public std::vector<CEntry>    // flat array sorted by value
+        {
+            iterator    find(unsigned int _Value);      // binary search
+            std::pair<iterator, bool> insert(const CEntry& _Entry);
+            void        SortByValue();                  // after push_backs; for duplicated values the last one wins
+        };
         CEntries        m_Entries;
+        unsigned int    m_Version;                      // incremented each time m_Entries is rebuilt
+
+        // Lowercased labels of m_Entries, each one followed by '\n', searched by
+        // the type-ahead filter of popup lists
+        std::string     m_LowerLabels;
+        std::vector<unsigned int> m_LowerLabelStarts;   // offset of each label in m_LowerLabels, plus its length
+        unsigned int    m_LowerLabelsVersion;
+        void            IndexLabels();                  // rebuilds m_LowerLabels if m_Entries has changed
+
+        // Entries of an enum defined by TwDefineEnumCB are cached and queried
+        // again from the client only when its generation counter changes
+        TwGetEnumCountCallback m_CountCallback;
+        TwGetEnumValCallback m_ValCallback;
+        const unsigned int * m_Generation;
+        unsigned int    m_SyncedGeneration;
+        bool            m_Synced;
+        void *          m_ClientData;
+                        CEnum();
+        bool            Sync();                         // updates the cached entries, returns true if they have been rebuilt
     };
     std::vector<CEnum>  m_Enums;
+    std::map<std::string, size_t> m_EnumIndex;  // enum name -> index in m_Enums
 
     TwType              m_TypeColor32;
     TwType              m_TypeColor3F;
@@ -236,6 +368,7 @@ struct CTwMgr
     TwType              m_TypeDir3D;
 
     std::vector<char>   m_CSStringBuffer;
+    std::vector<char>   m_StateBuffer;      // returned by TwSaveState
     struct CCDStdString
     {
         std::string *        m_ClientStdStringPtr;
@@ -247,6 +380,31 @@ struct CTwMgr
         static void ANT_CALL GetCB(void *_Value, void *_ClientData);
     };
     std::list<CCDStdString>  m_CDStdStrings;
+    // Vars defined with coalesce=true or a commit mode: their pointer or callbacks
+    // are replaced by a proxy that keeps the last edited value until FlushChanges applies it.
+    enum ECommitMode    { COMMIT_IMMEDIATE, COMMIT_ONDRAW, COMMIT_ONRELEASE, COMMIT_THROTTLE };
+    struct CChangeProxy
+    {
+        CTwVarAtom *         m_Var;
+        TwBar *              m_Bar;
+        void *               m_ClientVar;   // NULL if the client callbacks are used
+        TwSetVarCallback     m_ClientSetCallback;
+        TwGetVarCallback     m_ClientGetCallback;
+        void *               m_ClientData;
+        bool                 m_Pending;
+        double               m_Value[2];    // last edited value, large enough for the coalesced types
+        int                  m_CommitMode;
+        double               m_ThrottlePeriod;  // in seconds
+        double               m_LastCommitTime;
+        static void ANT_CALL SetCB(const void *_Value, void *_ClientData);
+        static void ANT_CALL GetCB(void *_Value, void *_ClientData);
+    };
+    std::list<CChangeProxy>  m_ChangeProxies;
+    std::vector<CChangeProxy *> m_PendingChanges;
+    static bool         CanDeferChanges(const CTwVarAtom *_Atom);
+    int                 SetCommitMode(CTwVarAtom *_Atom, TwBar *_Bar, int _Mode, double _ThrottlePeriod);
+    void                RemoveChangeProxy(CChangeProxy *_Proxy);
+    void                FlushChanges(bool _Force);  // if !_Force, changes waiting for a mouse release or a throttle period are kept
     struct CClientStdString  // Convertion between VC++ Debug/Release std::string
     {
                         CClientStdString();
@@ -282,6 +440,31 @@ struct CTwMgr
     std::vector<CCustom *> m_Customs;
 
     PerfTimer           m_Timer;
+
+    // Frame statistics: frames are accumulated between the end of two TwDraw
+    // calls (updates triggered by events are counted in the next frame).
+    enum                { NB_FRAME_STATS = 128 };
+    TwFrameStats        m_FrameStats[NB_FRAME_STATS]; // ring buffer indexed by Frame%NB_FRAME_STATS
+    TwFrameStats        m_CurFrameStats;
+    TwFrameStatsCallback m_FrameStatsCallback;
+    void *              m_FrameStatsClientData;
+    unsigned int        m_FrameAllocCount;  // g_TwAllocCount at the start of the current frame
+    void                EndFrameStats();
+
+    // Optional built-in bar displaying the frame statistics ("statsbar" parameter)
+    struct CStatsValues
+    {
+        double          m_DrawTime, m_DrawTimeAvg, m_DrawTimeMax;
+        double          m_UpdateTime, m_TextTime, m_SubmitTime;
+        int             m_NbUpdates, m_NbGlyphs, m_NbDrawCalls, m_NbUploadedBytes;
+        int             m_NbAllocs;
+        unsigned int    m_LiveBytes;
+        char            m_DrawHistory[33];  // draw times of the last frames as a text sparkline
+    };
+    TwBar *             m_StatsBar;
+    CStatsValues        m_StatsValues;
+    bool                CreateStatsBar();
+    void                UpdateStatsBar();
     double              m_LastMousePressedTime;
     TwMouseButtonID     m_LastMousePressedButtonID;
     int                 m_LastMousePressedPosition[2];
@@ -289,7 +472,9 @@ struct CTwMgr
     double              m_RepeatMousePressedPeriod;
     bool                m_CanRepeatMousePressed;
     bool                m_IsRepeatingMousePressed;
+    bool                m_DragStartedInBar; // a mouse button pressed on a bar or one of its widgets is not released yet
     double              m_LastDrawTime;
+    int                 m_FontGeneration;   // last g_TwFontGeneration seen by TwDraw
 
     #if defined(ANT_WINDOWS)
         typedef HCURSOR CCursor;
@@ -304,6 +489,8 @@ struct CTwMgr
         CCursor         PixmapCursor(int _CurIdx);
     #endif  // defined(ANT_UNIX)
     bool                m_CursorsCreated;
+    bool                m_CursorsShared;    // cursors belong to the master manager
+    bool                ShareMasterCursors();
     void                CreateCursors();
     void                FreeCursors();
     void                SetCursor(CCursor _Cursor);
@@ -339,6 +526,10 @@ protected:
 };
 
 extern CTwMgr *g_TwMgr;
+extern ITwGraph *g_TwCustomGraph;   // if set before TwInit, used instead of the graphic API back-end (see TwBench.cpp)
+
+extern TwRasterizeGlyph g_RasterizeGlyph;
+extern void *g_RasterizeGlyphClientData;
 
 
 //  ---------------------------------------------------------------------------
@@ -348,6 +539,7 @@ extern CTwMgr *g_TwMgr;
 
 bool TwGetKeyCode(int *_Code, int *_Modif, const char *_String);
 bool TwGetKeyString(std::string *_String, int _Code, int _Modif); 
+int  TwExpandStructVar(CTwBar *_Bar, CTwVarGroup *_StructGrp);
 
 const TwType TW_TYPE_SHORTCUT       = TwType(0xfff1);
 const TwType TW_TYPE_HELP_GRP       = TwType(0xfff2);
@@ -369,18 +561,6 @@ extern "C" int ANT_CALL TwSetLastError(const char *_StaticErrorMessage);
 
 //const TwGraphAPI TW_OPENGL_CORE = (TwGraphAPI)5; // WIP (note: OpenGL Core Profil requires OpenGL 3.2 or later)
 
-// Clipping helper
-struct CRect 
-{ 
-    int X, Y, W, H;
-    CRect() : X(0), Y(0), W(0), H(0) {}
-    CRect(int _X, int _Y, int _W, int _H) : X(_X), Y(_Y), W(_W), H(_H) {}
-    bool operator==(const CRect& _Rect) { return (Empty() && _Rect.Empty()) || (X==_Rect.X && Y==_Rect.Y && W==_Rect.W && H==_Rect.H); }
-    bool Empty(int _Margin=0) const { return (W<=_Margin || H<=_Margin); }
-    bool Subtract(const CRect& _Rect, std::vector<CRect>& _OutRects) const;
-    bool Subtract(const std::vector<CRect>& _Rects, std::vector<CRect>& _OutRects) const;
-};
-
 
 //  ---------------------------------------------------------------------------
 //  Global bar attribs
@@ -399,7 +579,11 @@ enum EMgrAttribs
     MGR_COLOR_SCHEME,
     MGR_CONTAINED,
     MGR_BUTTON_ALIGN,
-    MGR_OVERLAP
+    MGR_OVERLAP,
+    MGR_FONT_SCALING,
+    MGR_FONT_SDF,
+    MGR_FRAME_TIMES,
+    MGR_STATS_BAR
 };
 
 
@@ -175,8 +175,9 @@ static GLuint BindFont(const CTexFont *_Font)
     _glTexImage2D(GL_TEXTURE_2D, 0, 4, _Font->m_TexWidth, _Font->m_TexHeight, 0, GL_ALPHA, GL_UNSIGNED_BYTE, _Font->m_TexBytes);
     _glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
     _glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
-    _glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER,GL_NEAREST);
-    _glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,GL_NEAREST);
+    GLfloat Filter = _Font->m_SDF ? GL_LINEAR : GL_NEAREST; // distance fields are interpolated
+    _glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, Filter);
+    _glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, Filter);
     _glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
     _glBindTexture(GL_TEXTURE_2D, 0);
     _glPixelTransferf(GL_ALPHA_BIAS, 0);
@@ -195,11 +196,42 @@ static void UnbindFont(GLuint _FontTexID)
 
 //  ---------------------------------------------------------------------------
 
+// Returns the texture of _Font, created or updated if needed
+GLuint CTwGraphOpenGL::FontTexture(const CTexFont *_Font)
+{
+    assert(_Font!=NULL);
+    for( size_t i=0; i<m_FontTexs.size(); ++i )
+        if( m_FontTexs[i].m_Font==_Font )
+        {
+            if( m_FontTexs[i].m_Version!=_Font->m_TexVersion )
+            {
+                UnbindFont(m_FontTexs[i].m_TexID);
+                m_FontTexs[i].m_TexID = BindFont(_Font);
+                m_FontTexs[i].m_Version = _Font->m_TexVersion;
+            }
+            return m_FontTexs[i].m_TexID;
+        }
+    CFontTex FontTex;
+    FontTex.m_Font = _Font;
+    FontTex.m_Version = _Font->m_TexVersion;
+    FontTex.m_TexID = BindFont(_Font);
+    m_FontTexs.push_back(FontTex);
+    return FontTex.m_TexID;
+}
+
+void CTwGraphOpenGL::DeleteFontTextures()
+{
+    for( size_t i=0; i<m_FontTexs.size(); ++i )
+        UnbindFont(m_FontTexs[i].m_TexID);
+    m_FontTexs.clear();
+}
+
+//  ---------------------------------------------------------------------------
+
 int CTwGraphOpenGL::Init()
 {
     m_Drawing = false;
-    m_FontTexID = 0;
-    m_FontTex = NULL;
+    m_FontTexs.clear();
     m_MaxClipPlanes = -1;
 
     if( LoadOpenGL()==0 )
@@ -235,7 +267,7 @@ int CTwGraphOpenGL::Shut()
 {
     assert(m_Drawing==false);
 
-    UnbindFont(m_FontTexID);
+    DeleteFontTextures();
 
     int Res = 1;
     if( UnloadOpenGL()==0 )
@@ -558,9 +590,7 @@ bool CTwGraphOpenGL::IsDrawing()
 
 void CTwGraphOpenGL::Restore()
 {
-    UnbindFont(m_FontTexID);
-    m_FontTexID = 0;
-    m_FontTex = NULL;
+    DeleteFontTextures();
 }
 
 
@@ -599,6 +629,8 @@ void CTwGraphOpenGL::DrawLine(int _X0, int _Y0, int _X1, int _Y1, color32 _Color
         //_glVertex2i(_X0, _Y0);
         //_glVertex2i(_X1, _Y1);
     _glEnd();
+    m_NbDrawCalls++;
+    m_NbUploadedBytes += 2*(2*sizeof(GLfloat)+4*sizeof(GLubyte));
     _glDisable(GL_LINE_SMOOTH);
 }
   
@@ -650,6 +682,8 @@ void CTwGraphOpenGL::DrawRect(int _X0, int _Y0, int _X1, int _Y1, color32 _Color
         _glColor4ub(GLubyte(_Color01>>16), GLubyte(_Color01>>8), GLubyte(_Color01), GLubyte(_Color01>>24));
         _glVertex2f((GLfloat)_X0+dx, (GLfloat)_Y1+dy);
     _glEnd();
+    m_NbDrawCalls++;
+    m_NbUploadedBytes += 4*(2*sizeof(GLfloat)+4*sizeof(GLubyte));
 }
 
 //  ---------------------------------------------------------------------------
@@ -675,13 +709,9 @@ void CTwGraphOpenGL::BuildText(void *_TextObj, const std::string *_TextLines, co
     assert(_TextObj!=NULL);
     assert(_Font!=NULL);
 
-    if( _Font != m_FontTex )
-    {
-        UnbindFont(m_FontTexID);
-        m_FontTexID = BindFont(_Font);
-        m_FontTex = _Font;
-    }
     CTextObj *TextObj = static_cast<CTextObj *>(_TextObj);
+    TextObj->m_Font = _Font;    // its texture is bound by DrawText
+    const CTexFont *Atlas = _Font->Atlas(); // owns the glyph UVs (SDF views share it)
     TextObj->m_TextVerts.resize(0);
     TextObj->m_TextUVs.resize(0);
     TextObj->m_BgVerts.resize(0);
@@ -689,7 +719,7 @@ void CTwGraphOpenGL::BuildText(void *_TextObj, const std::string *_TextLines, co
     TextObj->m_BgColors.resize(0);
 
     int x, x1, y, y1, i, Len;
-    unsigned char ch;
+    int ch;
     const unsigned char *Text;
     color32 LineColor = COLOR32_RED;
     for( int Line=0; Line<_NbLines; ++Line )
@@ -702,9 +732,9 @@ void CTwGraphOpenGL::BuildText(void *_TextObj, const std::string *_TextLines, co
         if( _LineColors!=NULL )
             LineColor = (_LineColors[Line]&0xff00ff00) | GLubyte(_LineColors[Line]>>16) | (GLubyte(_LineColors[Line])<<16);
 
-        for( i=0; i<Len; ++i )
+        for( i=0; i<Len; )
         {
-            ch = Text[i];
+            ch = _Font->NextGlyph(Text, Len, &i);
             x1 = x + _Font->m_CharWidth[ch];
 
             TextObj->m_TextVerts.push_back(Vec2(x , y ));
@@ -714,12 +744,12 @@ void CTwGraphOpenGL::BuildText(void *_TextObj, const std::string *_TextLines, co
             TextObj->m_TextVerts.push_back(Vec2(x1, y1));
             TextObj->m_TextVerts.push_back(Vec2(x , y1));
 
-            TextObj->m_TextUVs.push_back(Vec2(_Font->m_CharU0[ch], _Font->m_CharV0[ch]));
-            TextObj->m_TextUVs.push_back(Vec2(_Font->m_CharU1[ch], _Font->m_CharV0[ch]));
-            TextObj->m_TextUVs.push_back(Vec2(_Font->m_CharU0[ch], _Font->m_CharV1[ch]));
-            TextObj->m_TextUVs.push_back(Vec2(_Font->m_CharU1[ch], _Font->m_CharV0[ch]));
-            TextObj->m_TextUVs.push_back(Vec2(_Font->m_CharU1[ch], _Font->m_CharV1[ch]));
-            TextObj->m_TextUVs.push_back(Vec2(_Font->m_CharU0[ch], _Font->m_CharV1[ch]));
+            TextObj->m_TextUVs.push_back(Vec2(Atlas->m_CharU0[ch], Atlas->m_CharV0[ch]));
+            TextObj->m_TextUVs.push_back(Vec2(Atlas->m_CharU1[ch], Atlas->m_CharV0[ch]));
+            TextObj->m_TextUVs.push_back(Vec2(Atlas->m_CharU0[ch], Atlas->m_CharV1[ch]));
+            TextObj->m_TextUVs.push_back(Vec2(Atlas->m_CharU1[ch], Atlas->m_CharV0[ch]));
+            TextObj->m_TextUVs.push_back(Vec2(Atlas->m_CharU1[ch], Atlas->m_CharV1[ch]));
+            TextObj->m_TextUVs.push_back(Vec2(Atlas->m_CharU0[ch], Atlas->m_CharV1[ch]));
 
             if( _LineColors!=NULL )
             {
@@ -786,9 +816,11 @@ void CTwGraphOpenGL::DrawText(void *_TextObj, int _X, int _Y, color32 _Color, co
             _glColor4ub(GLubyte(_BgColor>>16), GLubyte(_BgColor>>8), GLubyte(_BgColor), GLubyte(_BgColor>>24));
         }
         _glDrawArrays(GL_TRIANGLES, 0, (int)TextObj->m_BgVerts.size());
+        m_NbDrawCalls++;
+        m_NbUploadedBytes += (int)(TextObj->m_BgVerts.size()*(sizeof(TextObj->m_BgVerts[0])+sizeof(color32)));
     }
     _glEnable(GL_TEXTURE_2D);
-    _glBindTexture(GL_TEXTURE_2D, m_FontTexID);
+    _glBindTexture(GL_TEXTURE_2D, (TextObj->m_Font!=NULL) ? FontTexture(TextObj->m_Font->Atlas()) : 0);
     _glEnableClientState(GL_TEXTURE_COORD_ARRAY);
     if( TextObj->m_TextVerts.size()>=4 )
     {
@@ -805,7 +837,18 @@ void CTwGraphOpenGL::DrawText(void *_TextObj, int _X, int _Y, color32 _Color, co
             _glColor4ub(GLubyte(_Color>>16), GLubyte(_Color>>8), GLubyte(_Color), GLubyte(_Color>>24));
         }
 
+        // SDF font: keep the fragments inside the glyph edges (no shader with this API)
+        bool SDF = (TextObj->m_Font!=NULL && TextObj->m_Font->m_SDF);
+        if( SDF )
+        {
+            _glEnable(GL_ALPHA_TEST);
+            _glAlphaFunc(GL_GEQUAL, 0.5f);
+        }
         _glDrawArrays(GL_TRIANGLES, 0, (int)TextObj->m_TextVerts.size());
+        m_NbDrawCalls++;
+        m_NbUploadedBytes += (int)(TextObj->m_TextVerts.size()*(sizeof(TextObj->m_TextVerts[0])+sizeof(TextObj->m_TextUVs[0])+sizeof(color32)));
+        if( SDF )
+            _glDisable(GL_ALPHA_TEST);
     }
     
     _glDisableClientState(GL_VERTEX_ARRAY);
@@ -894,6 +937,8 @@ void CTwGraphOpenGL::DrawTriangles(int _NumTriangles, int *_Vertices, color32 *_
         _glVertex2f((GLfloat)_Vertices[2*i+0]+dx, (GLfloat)_Vertices[2*i+1]+dy);
     }
     _glEnd();
+    m_NbDrawCalls++;
+    m_NbUploadedBytes += 3*_NumTriangles*(2*sizeof(GLfloat)+4*sizeof(GLubyte));
 
     _glCullFace(prevCullFaceMode);
     _glFrontFace(prevFrontFace);
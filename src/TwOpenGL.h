@@ -44,8 +44,18 @@ public:
 
 protected:
     bool                m_Drawing;
-    GLuint              m_FontTexID;
-    const CTexFont *    m_FontTex;
+
+    // Font textures are created once per font and shared by the text objects
+    // of all windows (a window may use a different font size than the others)
+    struct CFontTex
+    {
+        const CTexFont *    m_Font;
+        int                 m_Version;
+        GLuint              m_TexID;
+    };
+    std::vector<CFontTex> m_FontTexs;
+    GLuint              FontTexture(const CTexFont *_Font);
+    void                DeleteFontTextures();
     GLfloat             m_PrevLineWidth;
     GLint               m_PrevTexEnv;
     GLint               m_PrevPolygonMode[2];
@@ -82,13 +92,15 @@ protected:
     int                 m_WndHeight;
 
     struct Vec2         { GLfloat x, y; Vec2(){} Vec2(GLfloat _X, GLfloat _Y):x(_X),y(_Y){} Vec2(int _X, int _Y):x(GLfloat(_X)),y(GLfloat(_Y)){} };
-    struct CTextObj
+    struct CTextObj : CTwAllocated
     {
-        std::vector<Vec2>   m_TextVerts;
-        std::vector<Vec2>   m_TextUVs;
-        std::vector<Vec2>   m_BgVerts;
-        std::vector<color32>m_Colors;
-        std::vector<color32>m_BgColors;
+        const CTexFont *    m_Font;
+                            CTextObj() : m_Font(NULL) {}
+        std::vector<Vec2, TTwAllocator<Vec2> > m_TextVerts;
+        std::vector<Vec2, TTwAllocator<Vec2> > m_TextUVs;
+        std::vector<Vec2, TTwAllocator<Vec2> > m_BgVerts;
+        std::vector<color32, TTwAllocator<color32> > m_Colors;
+        std::vector<color32, TTwAllocator<color32> > m_BgColors;
     };
 };
 
@@ -69,8 +69,9 @@ static GLuint BindFont(const CTexFont *_Font)
     _glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, _Font->m_TexWidth, _Font->m_TexHeight, 0, GL_RED, GL_UNSIGNED_BYTE, _Font->m_TexBytes);
     _glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     _glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    _glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER,GL_NEAREST);
-    _glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,GL_NEAREST);
+    GLfloat Filter = _Font->m_SDF ? GL_LINEAR : GL_NEAREST; // distance fields are interpolated
+    _glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, Filter);
+    _glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, Filter);
     _glBindTexture(GL_TEXTURE_2D, 0);
 
     return TexID;
@@ -136,22 +137,211 @@ static GLuint LinkProgram(GLuint program)
 
 //  ---------------------------------------------------------------------------
 
-void CTwGraphOpenGLCore::ResizeTriBuffers(size_t _NewSize)
+static bool HasGLExtension(const char *_Name)
 {
-    m_TriBufferSize = _NewSize;
+    if( _glGetStringi==NULL )
+        return false;
+    GLint NbExt = 0;
+    _glGetIntegerv(GL_NUM_EXTENSIONS, &NbExt);
+    for( GLint i=0; i<NbExt; ++i )
+    {
+        const GLubyte *Ext = _glGetStringi(GL_EXTENSIONS, (GLuint)i);
+        if( Ext!=NULL && strcmp((const char *)Ext, _Name)==0 )
+            return true;
+    }
+    return false;
+}
 
-    _glBindVertexArray(m_TriVArray);
+//  ---------------------------------------------------------------------------
 
-    _glBindBuffer(GL_ARRAY_BUFFER, m_TriVertices);
-    _glBufferData(GL_ARRAY_BUFFER, m_TriBufferSize*sizeof(Vec2), 0, GL_DYNAMIC_DRAW);
+void CTwGraphOpenGLCore::CreateStreamBuffer(GLsizeiptr _RegionSize)
+{
+    m_StreamRegionSize = _RegionSize;
+    m_StreamOffset = 0;
+    m_StreamRegion = 0;
+    m_StreamMapped = NULL;
+    for( int i=0; i<TW_STREAM_NB_REGIONS; ++i )
+        m_StreamFences[i] = NULL;
+
+    _glGenBuffers(1, &m_StreamBuffer);
+    _glBindBuffer(GL_ARRAY_BUFFER, m_StreamBuffer);
+    if( m_StreamPersistent )
+    {
+        const GLbitfield Flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        const GLsizeiptr Size = TW_STREAM_NB_REGIONS*_RegionSize;
+        _glBufferStorage(GL_ARRAY_BUFFER, Size, NULL, Flags);
+        m_StreamMapped = static_cast<unsigned char *>(_glMapBufferRange(GL_ARRAY_BUFFER, 0, Size, Flags));
+        if( m_StreamMapped==NULL )
+        {
+            // persistent mapping failed: fall back to buffer orphaning
+            while( _glGetError()!=0 ) {}
+            _glDeleteBuffers(1, &m_StreamBuffer);
+            _glGenBuffers(1, &m_StreamBuffer);
+            _glBindBuffer(GL_ARRAY_BUFFER, m_StreamBuffer);
+            m_StreamPersistent = false;
+        }
+    }
+    if( !m_StreamPersistent )
+        _glBufferData(GL_ARRAY_BUFFER, _RegionSize, NULL, GL_STREAM_DRAW);
 
-    _glBindBuffer(GL_ARRAY_BUFFER, m_TriUVs);
-    _glBufferData(GL_ARRAY_BUFFER, m_TriBufferSize*sizeof(Vec2), 0, GL_DYNAMIC_DRAW);
+    CHECK_GL_ERROR;
+}
 
-    _glBindBuffer(GL_ARRAY_BUFFER, m_TriColors);
-    _glBufferData(GL_ARRAY_BUFFER, m_TriBufferSize*sizeof(color32), 0, GL_DYNAMIC_DRAW);
+//  ---------------------------------------------------------------------------
 
-    CHECK_GL_ERROR;
+void CTwGraphOpenGLCore::DeleteStreamBuffer()
+{
+    for( int i=0; i<TW_STREAM_NB_REGIONS; ++i )
+        if( m_StreamFences[i]!=NULL )
+        {
+            _glDeleteSync(m_StreamFences[i]);
+            m_StreamFences[i] = NULL;
+        }
+    if( m_StreamMapped!=NULL )
+    {
+        _glBindBuffer(GL_ARRAY_BUFFER, m_StreamBuffer);
+        _glUnmapBuffer(GL_ARRAY_BUFFER);
+        m_StreamMapped = NULL;
+    }
+    // the buffer storage is kept alive by the driver until pending draws are done
+    _glDeleteBuffers(1, &m_StreamBuffer); 
+    m_StreamBuffer = 0;
+}
+
+//  ---------------------------------------------------------------------------
+
+void CTwGraphOpenGLCore::BeginStreamFrame()
+{
+    if( m_StreamPersistent )
+    {
+        // Move to the next region and wait until the GPU has consumed the frame
+        // which used it TW_STREAM_NB_REGIONS frames ago (normally already done)
+        m_StreamRegion = (m_StreamRegion+1) % TW_STREAM_NB_REGIONS;
+        GLsync Fence = m_StreamFences[m_StreamRegion];
+        if( Fence!=NULL )
+        {
+            GLbitfield Flags = GL_SYNC_FLUSH_COMMANDS_BIT;
+            while( _glClientWaitSync(Fence, Flags, 1000000)==GL_TIMEOUT_EXPIRED ) // 1ms
+                Flags = 0;
+            _glDeleteSync(Fence);
+            m_StreamFences[m_StreamRegion] = NULL;
+        }
+    }
+    else
+    {
+        // Orphan the buffer: the driver provides new storage without waiting for the GPU
+        _glBindBuffer(GL_ARRAY_BUFFER, m_StreamBuffer);
+        _glBufferData(GL_ARRAY_BUFFER, m_StreamRegionSize, NULL, GL_STREAM_DRAW);
+    }
+    m_StreamOffset = 0;
+}
+
+//  ---------------------------------------------------------------------------
+
+void CTwGraphOpenGLCore::EndStreamFrame()
+{
+    if( m_StreamPersistent )
+    {
+        assert(m_StreamFences[m_StreamRegion]==NULL);
+        m_StreamFences[m_StreamRegion] = _glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+}
+
+//  ---------------------------------------------------------------------------
+
+static inline GLsizeiptr StreamAlign(GLsizeiptr _Size)
+{
+    return (_Size + 15) & ~GLsizeiptr(15);
+}
+
+// Makes room for _Size bytes (sum of the StreamAlign'ed sizes) in the current
+// frame region. Growing or orphaning the buffer invalidates the offsets already
+// returned by StreamData, so a draw which streams several arrays must reserve
+// them all before its first glVertexAttribPointer.
+void CTwGraphOpenGLCore::StreamReserve(GLsizeiptr _Size)
+{
+    assert(m_Drawing==true);
+    if( m_StreamOffset+_Size > m_StreamRegionSize )
+    {
+        if( m_StreamPersistent || _Size > m_StreamRegionSize )
+        {
+            // region too small for a frame: recreate a larger buffer
+            GLsizeiptr NewRegionSize = 2*m_StreamRegionSize;
+            while( NewRegionSize < _Size )
+                NewRegionSize *= 2;
+            DeleteStreamBuffer();
+            CreateStreamBuffer(NewRegionSize);
+        }
+        else
+        {
+            // orphan again and restart from the beginning
+            _glBindBuffer(GL_ARRAY_BUFFER, m_StreamBuffer);
+            _glBufferData(GL_ARRAY_BUFFER, m_StreamRegionSize, NULL, GL_STREAM_DRAW);
+            m_StreamOffset = 0;
+        }
+    }
+}
+
+//  ---------------------------------------------------------------------------
+
+// Copies _Data to the current frame region of the stream buffer, binds the
+// stream buffer to GL_ARRAY_BUFFER, and returns the offset to be passed to
+// glVertexAttribPointer.
+const GLvoid *CTwGraphOpenGLCore::StreamData(const void *_Data, GLsizeiptr _Size)
+{
+    assert(m_Drawing==true);
+    const GLsizeiptr AlignedSize = StreamAlign(_Size);
+    assert(m_StreamOffset+AlignedSize <= m_StreamRegionSize); // see StreamReserve
+    StreamReserve(AlignedSize);
+
+    _glBindBuffer(GL_ARRAY_BUFFER, m_StreamBuffer);
+    GLintptr Offset;
+    if( m_StreamPersistent )
+    {
+        Offset = m_StreamRegion*m_StreamRegionSize + m_StreamOffset;
+        memcpy(m_StreamMapped + Offset, _Data, _Size);
+    }
+    else
+    {
+        Offset = m_StreamOffset;
+        _glBufferSubData(GL_ARRAY_BUFFER, Offset, _Size, _Data);
+    }
+    m_StreamOffset += AlignedSize;
+    m_NbUploadedBytes += (int)_Size;
+
+    return reinterpret_cast<const GLvoid *>(Offset);
+}
+
+//  ---------------------------------------------------------------------------
+
+// Returns the texture of _Font, created or updated if needed
+GLuint CTwGraphOpenGLCore::FontTexture(const CTexFont *_Font)
+{
+    assert(_Font!=NULL);
+    for( size_t i=0; i<m_FontTexs.size(); ++i )
+        if( m_FontTexs[i].m_Font==_Font )
+        {
+            if( m_FontTexs[i].m_Version!=_Font->m_TexVersion )
+            {
+                UnbindFont(m_FontTexs[i].m_TexID);
+                m_FontTexs[i].m_TexID = BindFont(_Font);
+                m_FontTexs[i].m_Version = _Font->m_TexVersion;
+            }
+            return m_FontTexs[i].m_TexID;
+        }
+    CFontTex FontTex;
+    FontTex.m_Font = _Font;
+    FontTex.m_Version = _Font->m_TexVersion;
+    FontTex.m_TexID = BindFont(_Font);
+    m_FontTexs.push_back(FontTex);
+    return FontTex.m_TexID;
+}
+
+void CTwGraphOpenGLCore::DeleteFontTextures()
+{
+    for( size_t i=0; i<m_FontTexs.size(); ++i )
+        UnbindFont(m_FontTexs[i].m_TexID);
+    m_FontTexs.clear();
 }
 
 //  ---------------------------------------------------------------------------
@@ -159,8 +349,7 @@ void CTwGraphOpenGLCore::ResizeTriBuffers(size_t _NewSize)
 int CTwGraphOpenGLCore::Init()
 {
     m_Drawing = false;
-    m_FontTexID = 0;
-    m_FontTex = NULL;
+    m_FontTexs.clear();
 
     if( LoadOpenGLCore()==0 )
     {
@@ -198,17 +387,8 @@ int CTwGraphOpenGLCore::Init()
     _glBindAttribLocation(m_LineRectProgram, 1, "color");
     LinkProgram(m_LineRectProgram);
 
-    // Create line/rect vertex buffer
-    const GLfloat lineRectInitVertices[] = { 0,0,0, 0,0,0, 0,0,0, 0,0,0 };
-    const color32 lineRectInitColors[] = { 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff };
+    // Create line/rect vertex array
     _glGenVertexArrays(1, &m_LineRectVArray);
-    _glBindVertexArray(m_LineRectVArray);
-    _glGenBuffers(1, &m_LineRectVertices);
-    _glBindBuffer(GL_ARRAY_BUFFER, m_LineRectVertices);
-    _glBufferData(GL_ARRAY_BUFFER, sizeof(lineRectInitVertices), lineRectInitVertices, GL_DYNAMIC_DRAW);
-    _glGenBuffers(1, &m_LineRectColors);
-    _glBindBuffer(GL_ARRAY_BUFFER, m_LineRectColors);
-    _glBufferData(GL_ARRAY_BUFFER, sizeof(lineRectInitColors), lineRectInitColors, GL_DYNAMIC_DRAW);
 
     // Create triangles shaders
     const GLchar *triVS[] = {
@@ -262,15 +442,16 @@ int CTwGraphOpenGLCore::Init()
         "#version 150 core\n"
         "precision highp float;"
         "uniform sampler2D tex;"
+        "uniform float sdfEdge;" // >0 for SDF fonts: smoothing half-width around the 0.5 iso-distance
         "in vec2 fuv;"
         "in vec4 fcolor;"
         "out vec4 outColor;"
 // texture2D is deprecated and replaced by texture with GLSL 3.30 but it seems 
 // that on Mac Lion backward compatibility is not ensured.
 #if defined(ANT_OSX) && (MAC_OS_X_VERSION_MAX_ALLOWED >= 1070)
-        "void main() { outColor.rgb = fcolor.bgr; outColor.a = fcolor.a * texture(tex, fuv).r; }"
+        "void main() { float a = texture(tex, fuv).r; if( sdfEdge>0.0 ) a = smoothstep(0.5-sdfEdge, 0.5+sdfEdge, a); outColor.rgb = fcolor.bgr; outColor.a = fcolor.a * a; }"
 #else
-        "void main() { outColor.rgb = fcolor.bgr; outColor.a = fcolor.a * texture2D(tex, fuv).r; }"
+        "void main() { float a = texture2D(tex, fuv).r; if( sdfEdge>0.0 ) a = smoothstep(0.5-sdfEdge, 0.5+sdfEdge, a); outColor.rgb = fcolor.bgr; outColor.a = fcolor.a * a; }"
 #endif
     };
     m_TriTexFS = _glCreateShader(GL_FRAGMENT_SHADER);
@@ -319,6 +500,7 @@ int CTwGraphOpenGLCore::Init()
     m_TriTexLocationOffset = _glGetUniformLocation(m_TriTexProgram, "offset");
     m_TriTexLocationWndSize = _glGetUniformLocation(m_TriTexProgram, "wndSize");
     m_TriTexLocationTexture = _glGetUniformLocation(m_TriTexProgram, "tex");
+    m_TriTexLocationSDFEdge = _glGetUniformLocation(m_TriTexProgram, "sdfEdge");
 
     m_TriTexUniProgram = _glCreateProgram();
     _glAttachShader(m_TriTexUniProgram, m_TriTexUniVS);
@@ -331,13 +513,15 @@ int CTwGraphOpenGLCore::Init()
     m_TriTexUniLocationWndSize = _glGetUniformLocation(m_TriTexUniProgram, "wndSize");
     m_TriTexUniLocationColor = _glGetUniformLocation(m_TriTexUniProgram, "color");
     m_TriTexUniLocationTexture = _glGetUniformLocation(m_TriTexUniProgram, "tex");
+    m_TriTexUniLocationSDFEdge = _glGetUniformLocation(m_TriTexUniProgram, "sdfEdge");
 
-    // Create tri vertex buffer
+    // Create tri vertex array
     _glGenVertexArrays(1, &m_TriVArray);
-    _glGenBuffers(1, &m_TriVertices);
-    _glGenBuffers(1, &m_TriUVs);
-    _glGenBuffers(1, &m_TriColors);
-    ResizeTriBuffers(16384); // set initial size
+
+    // Create the stream vertex buffer (persistently mapped if ARB_buffer_storage is available)
+    m_StreamPersistent = _glBufferStorage!=NULL && _glMapBufferRange!=NULL && _glFenceSync!=NULL 
+                         && _glClientWaitSync!=NULL && _glDeleteSync!=NULL && HasGLExtension("GL_ARB_buffer_storage");
+    CreateStreamBuffer(256*1024); // set initial region size
 
     CHECK_GL_ERROR;
     return 1;
@@ -349,7 +533,7 @@ int CTwGraphOpenGLCore::Shut()
 {
     assert(m_Drawing==false);
 
-    UnbindFont(m_FontTexID);
+    DeleteFontTextures();
 
     CHECK_GL_ERROR;
 
@@ -370,14 +554,9 @@ int CTwGraphOpenGLCore::Shut()
     _glDeleteProgram(m_TriTexUniProgram); m_TriTexUniProgram = 0;
     _glDeleteShader(m_TriTexUniVS); m_TriTexUniVS = 0;
 
-    _glDeleteBuffers(1, &m_LineRectVertices); m_LineRectVertices = 0;
-    _glDeleteBuffers(1, &m_LineRectColors); m_LineRectColors = 0;
     _glDeleteVertexArrays(1, &m_LineRectVArray); m_LineRectVArray = 0;
-
-    _glDeleteBuffers(1, &m_TriVertices); m_TriVertices = 0;
-    _glDeleteBuffers(1, &m_TriColors); m_TriColors = 0;
-    _glDeleteBuffers(1, &m_TriUVs); m_TriUVs = 0;
     _glDeleteVertexArrays(1, &m_TriVArray); m_TriVArray = 0;
+    DeleteStreamBuffer();
 
     CHECK_GL_ERROR;
 
@@ -456,6 +635,8 @@ void CTwGraphOpenGLCore::BeginDraw(int _WndWidth, int _WndHeight)
     _glGetIntegerv(GL_ACTIVE_TEXTURE, (GLint*)&m_PrevActiveTexture); CHECK_GL_ERROR;
     _glActiveTexture(GL_TEXTURE0);
 
+    BeginStreamFrame();
+
     CHECK_GL_ERROR;
 }
 
@@ -464,6 +645,7 @@ void CTwGraphOpenGLCore::BeginDraw(int _WndWidth, int _WndHeight)
 void CTwGraphOpenGLCore::EndDraw()
 {
     assert(m_Drawing==true);
+    EndStreamFrame();
     m_Drawing = false;
 
     _glLineWidth(m_PrevLineWidth); CHECK_GL_ERROR;
@@ -539,9 +721,7 @@ bool CTwGraphOpenGLCore::IsDrawing()
 
 void CTwGraphOpenGLCore::Restore()
 {
-    UnbindFont(m_FontTexID);
-    m_FontTexID = 0;
-    m_FontTex = NULL;
+    DeleteFontTextures();
 }
 
 //  ---------------------------------------------------------------------------
@@ -579,19 +759,17 @@ void CTwGraphOpenGLCore::DrawLine(int _X0, int _Y0, int _X1, int _Y1, color32 _C
     GLfloat x1 = ToNormScreenX(_X1+dx + m_OffsetX, m_WndWidth);
     GLfloat y1 = ToNormScreenY(_Y1+dy + m_OffsetY, m_WndHeight);
     GLfloat vertices[] = { x0,y0,0,  x1,y1,0 };
-    _glBindBuffer(GL_ARRAY_BUFFER, m_LineRectVertices);
-    _glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
-    _glVertexAttribPointer(0, 3, GL_FLOAT, GL_TRUE, 0, NULL);
+    color32 colors[] = { _Color0, _Color1 };
+    StreamReserve(StreamAlign(sizeof(vertices)) + StreamAlign(sizeof(colors)));
+    _glVertexAttribPointer(0, 3, GL_FLOAT, GL_TRUE, 0, StreamData(vertices, sizeof(vertices)));
     _glEnableVertexAttribArray(0);
 
-    color32 colors[] = { _Color0, _Color1 };
-    _glBindBuffer(GL_ARRAY_BUFFER, m_LineRectColors);
-    _glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(colors), colors);
-    _glVertexAttribPointer(1, GL_BGRA, GL_UNSIGNED_BYTE, GL_TRUE, 0, NULL);
+    _glVertexAttribPointer(1, GL_BGRA, GL_UNSIGNED_BYTE, GL_TRUE, 0, StreamData(colors, sizeof(colors)));
     _glEnableVertexAttribArray(1);
 
     _glUseProgram(m_LineRectProgram);
     _glDrawArrays(GL_LINES, 0, 2);
+    m_NbDrawCalls++;
 
     if( _AntiAliased )
         _glDisable(GL_LINE_SMOOTH);
@@ -623,19 +801,17 @@ void CTwGraphOpenGLCore::DrawRect(int _X0, int _Y0, int _X1, int _Y1, color32 _C
     GLfloat x1 = ToNormScreenX((float)_X1 + m_OffsetX, m_WndWidth);
     GLfloat y1 = ToNormScreenY((float)_Y1 + m_OffsetY, m_WndHeight);
     GLfloat vertices[] = { x0,y0,0, x1,y0,0, x0,y1,0, x1,y1,0 };
-    _glBindBuffer(GL_ARRAY_BUFFER, m_LineRectVertices);
-    _glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(vertices), vertices);
-    _glVertexAttribPointer(0, 3, GL_FLOAT, GL_TRUE, 0, NULL);
+    GLuint colors[] = { _Color00, _Color10, _Color01, _Color11 };
+    StreamReserve(StreamAlign(sizeof(vertices)) + StreamAlign(sizeof(colors)));
+    _glVertexAttribPointer(0, 3, GL_FLOAT, GL_TRUE, 0, StreamData(vertices, sizeof(vertices)));
     _glEnableVertexAttribArray(0);
 
-    GLuint colors[] = { _Color00, _Color10, _Color01, _Color11 };
-    _glBindBuffer(GL_ARRAY_BUFFER, m_LineRectColors);
-    _glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(colors), colors);
-    _glVertexAttribPointer(1, GL_BGRA, GL_UNSIGNED_BYTE, GL_TRUE, 0, NULL);
+    _glVertexAttribPointer(1, GL_BGRA, GL_UNSIGNED_BYTE, GL_TRUE, 0, StreamData(colors, sizeof(colors)));
     _glEnableVertexAttribArray(1);
 
     _glUseProgram(m_LineRectProgram);
     _glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    m_NbDrawCalls++;
 
     CHECK_GL_ERROR;
 }
@@ -663,13 +839,9 @@ void CTwGraphOpenGLCore::BuildText(void *_TextObj, const std::string *_TextLines
     assert(_TextObj!=NULL);
     assert(_Font!=NULL);
 
-    if( _Font != m_FontTex )
-    {
-        UnbindFont(m_FontTexID);
-        m_FontTexID = BindFont(_Font);
-        m_FontTex = _Font;
-    }
     CTextObj *TextObj = static_cast<CTextObj *>(_TextObj);
+    TextObj->m_Font = _Font;    // its texture is bound by DrawText
+    const CTexFont *Atlas = _Font->Atlas(); // owns the glyph UVs (SDF views share it)
     TextObj->m_TextVerts.resize(0);
     TextObj->m_TextUVs.resize(0);
     TextObj->m_BgVerts.resize(0);
@@ -677,7 +849,7 @@ void CTwGraphOpenGLCore::BuildText(void *_TextObj, const std::string *_TextLines
     TextObj->m_BgColors.resize(0);
 
     int x, x1, y, y1, i, Len;
-    unsigned char ch;
+    int ch;
     const unsigned char *Text;
     color32 LineColor = COLOR32_RED;
     for( int Line=0; Line<_NbLines; ++Line )
@@ -690,9 +862,9 @@ void CTwGraphOpenGLCore::BuildText(void *_TextObj, const std::string *_TextLines
         if( _LineColors!=NULL )
             LineColor = (_LineColors[Line]&0xff00ff00) | GLubyte(_LineColors[Line]>>16) | (GLubyte(_LineColors[Line])<<16);
 
-        for( i=0; i<Len; ++i )
+        for( i=0; i<Len; )
         {
-            ch = Text[i];
+            ch = _Font->NextGlyph(Text, Len, &i);
             x1 = x + _Font->m_CharWidth[ch];
 
             TextObj->m_TextVerts.push_back(Vec2(x , y ));
@@ -702,12 +874,12 @@ void CTwGraphOpenGLCore::BuildText(void *_TextObj, const std::string *_TextLines
             TextObj->m_TextVerts.push_back(Vec2(x1, y1));
             TextObj->m_TextVerts.push_back(Vec2(x , y1));
 
-            TextObj->m_TextUVs.push_back(Vec2(_Font->m_CharU0[ch], _Font->m_CharV0[ch]));
-            TextObj->m_TextUVs.push_back(Vec2(_Font->m_CharU1[ch], _Font->m_CharV0[ch]));
-            TextObj->m_TextUVs.push_back(Vec2(_Font->m_CharU0[ch], _Font->m_CharV1[ch]));
-            TextObj->m_TextUVs.push_back(Vec2(_Font->m_CharU1[ch], _Font->m_CharV0[ch]));
-            TextObj->m_TextUVs.push_back(Vec2(_Font->m_CharU1[ch], _Font->m_CharV1[ch]));
-            TextObj->m_TextUVs.push_back(Vec2(_Font->m_CharU0[ch], _Font->m_CharV1[ch]));
+            TextObj->m_TextUVs.push_back(Vec2(Atlas->m_CharU0[ch], Atlas->m_CharV0[ch]));
+            TextObj->m_TextUVs.push_back(Vec2(Atlas->m_CharU1[ch], Atlas->m_CharV0[ch]));
+            TextObj->m_TextUVs.push_back(Vec2(Atlas->m_CharU0[ch], Atlas->m_CharV1[ch]));
+            TextObj->m_TextUVs.push_back(Vec2(Atlas->m_CharU1[ch], Atlas->m_CharV0[ch]));
+            TextObj->m_TextUVs.push_back(Vec2(Atlas->m_CharU1[ch], Atlas->m_CharV1[ch]));
+            TextObj->m_TextUVs.push_back(Vec2(Atlas->m_CharU0[ch], Atlas->m_CharV1[ch]));
 
             if( _LineColors!=NULL )
             {
@@ -760,23 +932,19 @@ void CTwGraphOpenGLCore::DrawText(void *_TextObj, int _X, int _Y, color32 _Color
     if( (_BgColor!=0 || TextObj->m_BgColors.size()==TextObj->m_BgVerts.size()) && TextObj->m_BgVerts.size()>=4 )
     {
         size_t numBgVerts = TextObj->m_BgVerts.size();
-        if( numBgVerts > m_TriBufferSize )
-            ResizeTriBuffers(numBgVerts + 2048);
+        bool BgColors = TextObj->m_BgColors.size()==TextObj->m_BgVerts.size() && _BgColor==0;
+        StreamReserve(StreamAlign(numBgVerts*sizeof(Vec2)) + (BgColors ? StreamAlign(numBgVerts*sizeof(color32)) : 0));
   
         _glBindVertexArray(m_TriVArray);
 
-        _glBindBuffer(GL_ARRAY_BUFFER, m_TriVertices);
-        _glBufferSubData(GL_ARRAY_BUFFER, 0, numBgVerts*sizeof(Vec2), &(TextObj->m_BgVerts[0]));
-        _glVertexAttribPointer(0, 2, GL_FLOAT, GL_TRUE, 0, NULL);
+        _glVertexAttribPointer(0, 2, GL_FLOAT, GL_TRUE, 0, StreamData(&(TextObj->m_BgVerts[0]), numBgVerts*sizeof(Vec2)));
         _glEnableVertexAttribArray(0);
         _glDisableVertexAttribArray(1);
         _glDisableVertexAttribArray(2);
 
-        if( TextObj->m_BgColors.size()==TextObj->m_BgVerts.size() && _BgColor==0 )
+        if( BgColors )
         {
-            _glBindBuffer(GL_ARRAY_BUFFER, m_TriColors);
-            _glBufferSubData(GL_ARRAY_BUFFER, 0, numBgVerts*sizeof(color32), &(TextObj->m_BgColors[0]));
-            _glVertexAttribPointer(1, GL_BGRA, GL_UNSIGNED_BYTE, GL_TRUE, 0, NULL);
+            _glVertexAttribPointer(1, GL_BGRA, GL_UNSIGNED_BYTE, GL_TRUE, 0, StreamData(&(TextObj->m_BgColors[0]), numBgVerts*sizeof(color32)));
             _glEnableVertexAttribArray(1);
 
             _glUseProgram(m_TriProgram);
@@ -792,41 +960,38 @@ void CTwGraphOpenGLCore::DrawText(void *_TextObj, int _X, int _Y, color32 _Color
         }
         
         _glDrawArrays(GL_TRIANGLES, 0, (GLsizei)TextObj->m_BgVerts.size());
+        m_NbDrawCalls++;
     }
 
     // draw character triangles
     if( TextObj->m_TextVerts.size()>=4 )
     {
         _glActiveTexture(GL_TEXTURE0);
-        _glBindTexture(GL_TEXTURE_2D, m_FontTexID);
+        _glBindTexture(GL_TEXTURE_2D, (TextObj->m_Font!=NULL) ? FontTexture(TextObj->m_Font->Atlas()) : 0);
+        GLfloat SDFEdge = (TextObj->m_Font!=NULL && TextObj->m_Font->m_SDF) ? TextObj->m_Font->SDFEdgeWidth() : 0.0f;
         size_t numTextVerts = TextObj->m_TextVerts.size();
-        if( numTextVerts > m_TriBufferSize )
-            ResizeTriBuffers(numTextVerts + 2048);
+        bool TextColors = TextObj->m_Colors.size()==TextObj->m_TextVerts.size() && _Color==0;
+        StreamReserve(2*StreamAlign(numTextVerts*sizeof(Vec2)) + (TextColors ? StreamAlign(numTextVerts*sizeof(color32)) : 0));
         
         _glBindVertexArray(m_TriVArray);
         _glDisableVertexAttribArray(2);
 
-        _glBindBuffer(GL_ARRAY_BUFFER, m_TriVertices);
-        _glBufferSubData(GL_ARRAY_BUFFER, 0, numTextVerts*sizeof(Vec2), &(TextObj->m_TextVerts[0]));
-        _glVertexAttribPointer(0, 2, GL_FLOAT, GL_TRUE, 0, NULL);
+        _glVertexAttribPointer(0, 2, GL_FLOAT, GL_TRUE, 0, StreamData(&(TextObj->m_TextVerts[0]), numTextVerts*sizeof(Vec2)));
         _glEnableVertexAttribArray(0);
 
-        _glBindBuffer(GL_ARRAY_BUFFER, m_TriUVs);
-        _glBufferSubData(GL_ARRAY_BUFFER, 0, numTextVerts*sizeof(Vec2), &(TextObj->m_TextUVs[0]));
-        _glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, NULL);
+        _glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 0, StreamData(&(TextObj->m_TextUVs[0]), numTextVerts*sizeof(Vec2)));
         _glEnableVertexAttribArray(1);
 
-        if( TextObj->m_Colors.size()==TextObj->m_TextVerts.size() && _Color==0 )
+        if( TextColors )
         {
-            _glBindBuffer(GL_ARRAY_BUFFER, m_TriColors);
-            _glBufferSubData(GL_ARRAY_BUFFER, 0, numTextVerts*sizeof(color32), &(TextObj->m_Colors[0]));
-            _glVertexAttribPointer(2, GL_BGRA, GL_UNSIGNED_BYTE, GL_TRUE, 0, NULL);
+            _glVertexAttribPointer(2, GL_BGRA, GL_UNSIGNED_BYTE, GL_TRUE, 0, StreamData(&(TextObj->m_Colors[0]), numTextVerts*sizeof(color32)));
             _glEnableVertexAttribArray(2);
 
             _glUseProgram(m_TriTexProgram);
             _glUniform2f(m_TriTexLocationOffset, (float)_X, (float)_Y);
             _glUniform2f(m_TriTexLocationWndSize, (float)m_WndWidth, (float)m_WndHeight);
             _glUniform1i(m_TriTexLocationTexture, 0);
+            _glUniform1f(m_TriTexLocationSDFEdge, SDFEdge);
         }
         else
         {
@@ -835,9 +1000,11 @@ void CTwGraphOpenGLCore::DrawText(void *_TextObj, int _X, int _Y, color32 _Color
             _glUniform2f(m_TriTexUniLocationOffset, (float)_X, (float)_Y);
             _glUniform2f(m_TriTexUniLocationWndSize, (float)m_WndWidth, (float)m_WndHeight);
             _glUniform1i(m_TriTexUniLocationTexture, 0);
+            _glUniform1f(m_TriTexUniLocationSDFEdge, SDFEdge);
         }
         
         _glDrawArrays(GL_TRIANGLES, 0, (GLsizei)TextObj->m_TextVerts.size());
+        m_NbDrawCalls++;
     }
 
     CHECK_GL_ERROR;
@@ -904,20 +1071,16 @@ void CTwGraphOpenGLCore::DrawTriangles(int _NumTriangles, int *_Vertices, color3
     _glDisableVertexAttribArray(2);
 
     size_t numVerts = 3*_NumTriangles;
-    if( numVerts > m_TriBufferSize )
-        ResizeTriBuffers(numVerts + 2048);
+    StreamReserve(StreamAlign(numVerts*2*sizeof(int)) + StreamAlign(numVerts*sizeof(color32)));
   
-    _glBindBuffer(GL_ARRAY_BUFFER, m_TriVertices);
-    _glBufferSubData(GL_ARRAY_BUFFER, 0, numVerts*2*sizeof(int), _Vertices);
-    _glVertexAttribPointer(0, 2, GL_INT, GL_FALSE, 0, NULL);
+    _glVertexAttribPointer(0, 2, GL_INT, GL_FALSE, 0, StreamData(_Vertices, numVerts*2*sizeof(int)));
     _glEnableVertexAttribArray(0);
 
-    _glBindBuffer(GL_ARRAY_BUFFER, m_TriColors);
-    _glBufferSubData(GL_ARRAY_BUFFER, 0, numVerts*sizeof(color32), _Colors);
-    _glVertexAttribPointer(1, GL_BGRA, GL_UNSIGNED_BYTE, GL_TRUE, 0, NULL);
+    _glVertexAttribPointer(1, GL_BGRA, GL_UNSIGNED_BYTE, GL_TRUE, 0, StreamData(_Colors, numVerts*sizeof(color32)));
     _glEnableVertexAttribArray(1);
         
     _glDrawArrays(GL_TRIANGLES, 0, (GLsizei)numVerts);
+    m_NbDrawCalls++;
 
     // Reset states
     _glCullFace(prevCullFaceMode);
@@ -44,8 +44,18 @@ public:
 
 protected:
     bool                m_Drawing;
-    GLuint              m_FontTexID;
-    const CTexFont *    m_FontTex;
+
+    // Font textures are created once per font and shared by the text objects
+    // of all windows (a window may use a different font size than the others)
+    struct CFontTex
+    {
+        const CTexFont *    m_Font;
+        int                 m_Version;
+        GLuint              m_TexID;
+    };
+    std::vector<CFontTex> m_FontTexs;
+    GLuint              FontTexture(const CTexFont *_Font);
+    void                DeleteFontTextures();
     
     GLfloat             m_PrevLineWidth;
     GLint               m_PrevActiveTexture;
@@ -66,8 +76,6 @@ protected:
     GLuint              m_LineRectFS;
     GLuint              m_LineRectProgram;
     GLuint              m_LineRectVArray;
-    GLuint              m_LineRectVertices;
-    GLuint              m_LineRectColors;
     GLuint              m_TriVS;
     GLuint              m_TriFS;
     GLuint              m_TriProgram;
@@ -81,9 +89,6 @@ protected:
     GLuint              m_TriTexUniFS;
     GLuint              m_TriTexUniProgram;
     GLuint              m_TriVArray;
-    GLuint              m_TriVertices;
-    GLuint              m_TriUVs;
-    GLuint              m_TriColors;
     GLint               m_TriLocationOffset;
     GLint               m_TriLocationWndSize;
     GLint               m_TriUniLocationOffset;
@@ -92,11 +97,25 @@ protected:
     GLint               m_TriTexLocationOffset;
     GLint               m_TriTexLocationWndSize;
     GLint               m_TriTexLocationTexture;
+    GLint               m_TriTexLocationSDFEdge;
     GLint               m_TriTexUniLocationOffset;
     GLint               m_TriTexUniLocationWndSize;
     GLint               m_TriTexUniLocationColor;
     GLint               m_TriTexUniLocationTexture;
-    size_t              m_TriBufferSize;
+    GLint               m_TriTexUniLocationSDFEdge;
+
+    // Streaming vertex buffer shared by all draw calls. It is split into
+    // TW_STREAM_NB_REGIONS regions used in turn by successive frames, each
+    // region being protected by a fence. With ARB_buffer_storage the buffer
+    // is persistently mapped; otherwise it is orphaned at each frame.
+    enum                { TW_STREAM_NB_REGIONS = 3 };
+    GLuint              m_StreamBuffer;
+    bool                m_StreamPersistent;
+    unsigned char *     m_StreamMapped;
+    GLsizeiptr          m_StreamRegionSize;
+    GLintptr            m_StreamOffset;
+    int                 m_StreamRegion;
+    GLsync              m_StreamFences[TW_STREAM_NB_REGIONS];
 
     int                 m_WndWidth;
     int                 m_WndHeight;
@@ -104,15 +123,22 @@ protected:
     int                 m_OffsetY;
 
     struct Vec2         { GLfloat x, y; Vec2(){} Vec2(GLfloat _X, GLfloat _Y):x(_X),y(_Y){} Vec2(int _X, int _Y):x(GLfloat(_X)),y(GLfloat(_Y)){} };
-    struct CTextObj
+    struct CTextObj : CTwAllocated
     {
-        std::vector<Vec2>   m_TextVerts;
-        std::vector<Vec2>   m_TextUVs;
-        std::vector<Vec2>   m_BgVerts;
-        std::vector<color32>m_Colors;
-        std::vector<color32>m_BgColors;
+        const CTexFont *    m_Font;
+                            CTextObj() : m_Font(NULL) {}
+        std::vector<Vec2, TTwAllocator<Vec2> > m_TextVerts;
+        std::vector<Vec2, TTwAllocator<Vec2> > m_TextUVs;
+        std::vector<Vec2, TTwAllocator<Vec2> > m_BgVerts;
+        std::vector<color32, TTwAllocator<color32> > m_Colors;
+        std::vector<color32, TTwAllocator<color32> > m_BgColors;
     };
-    void                ResizeTriBuffers(size_t _NewSize);
+    void                CreateStreamBuffer(GLsizeiptr _RegionSize);
+    void                DeleteStreamBuffer();
+    void                BeginStreamFrame();
+    void                EndStreamFrame();
+    void                StreamReserve(GLsizeiptr _Size);
+    const GLvoid *      StreamData(const void *_Data, GLsizeiptr _Size);
 };
 
 //  ---------------------------------------------------------------------------
@@ -27,6 +27,7 @@
 #include <cassert>
 #include <cmath>
 #include <cfloat>
+#include <climits>
 #include <cstring>
 #include <cstdlib>
 #include <memory.h>
@@ -40,6 +41,7 @@
 #include <map>
 #include <list>
 #include <set>
+#include <algorithm>
 #if defined(_MSC_VER) && _MSC_VER<=1200
 #   pragma warning(pop)
 #endif
@@ -52,6 +54,10 @@
 #   include <X11/Xatom.h>
 #   include <unistd.h>
 #   include <malloc.h>
+#   include <fcntl.h>
+#   include <sys/stat.h>
+#   include <sys/mman.h>
+#   include <pthread.h>
 #   undef _WIN32
 #   undef WIN32
 #   undef _WIN64
@@ -62,6 +68,10 @@
 #elif defined(_MACOSX)
 #   define ANT_OSX
 #   include <unistd.h>
+#   include <fcntl.h>
+#   include <sys/stat.h>
+#   include <sys/mman.h>
+#   include <pthread.h>
 #   include <Foundation/Foundation.h>
 #   include <AppKit/NSImage.h>
 #   include <AppKit/NSCursor.h>
@@ -0,0 +1,204 @@
+//  ---------------------------------------------------------------------------
+//
+//  @file       TwStringPool.cpp
+//  @author     Philippe Decaudin
+//  @license    This file is part of the AntTweakBar library.
+//              For conditions of distribution and use, see License.txt
+//
+//  ---------------------------------------------------------------------------
+
+
+#include "TwPrecomp.h"
+#include "TwStringPool.h"
+#include "TwAlloc.h"
+
+using namespace std;
+
+
+// The pool tables use the library allocator, the characters of the pooled
+// strings are allocated by std::string
+struct CTwStringPool : CTwAllocated
+{
+    typedef CTwIString::Id  Id;
+    deque<string, TTwAllocator<string> > m_Strings; // a deque keeps the strings in place when it grows
+    vector<string *, TTwAllocator<string *> > m_StringPtrs;
+    vector<unsigned int, TTwAllocator<unsigned int> > m_Hashes;
+    vector<unsigned int, TTwAllocator<unsigned int> > m_RefCounts;
+    vector<Id, TTwAllocator<Id> > m_Next;   // next id of the same bucket, 0 ends the list
+    vector<Id, TTwAllocator<Id> > m_Buckets; // first id of each bucket (number of buckets is a power of 2)
+    vector<Id, TTwAllocator<Id> > m_FreeIds;
+    size_t                  m_NbStrings;
+
+    CTwStringPool() : m_NbStrings(0)
+    {
+        // id 0 is the empty string, it is never hashed nor released
+        m_Strings.push_back(string());
+        m_StringPtrs.push_back(&m_Strings.back());
+        m_Hashes.push_back(0);
+        m_RefCounts.push_back(0);
+        m_Next.push_back(0);
+        m_Buckets.resize(256, 0);
+    }
+    Id                      Find(const char *_Str, size_t _Len, unsigned int _Hash) const;
+    void                    Rehash();
+};
+
+static string s_EmptyString;
+static string *s_EmptyStringPtr = &s_EmptyString;
+static CTwStringPool *s_Pool = NULL;    // created with the first pooled string, deleted with the last one
+string **CTwIString::s_Strings = &s_EmptyStringPtr;
+
+static inline unsigned int HashString(const char *_Str, size_t _Len)
+{
+    unsigned int h = 2166136261u;   // FNV-1a
+    for( size_t i=0; i<_Len; ++i )
+        h = (h ^ (unsigned char)_Str[i]) * 16777619u;
+    return h;
+}
+
+//  ---------------------------------------------------------------------------
+
+CTwIString::Id CTwStringPool::Find(const char *_Str, size_t _Len, unsigned int _Hash) const
+{
+    for( Id id=m_Buckets[_Hash&(m_Buckets.size()-1)]; id!=0; id=m_Next[id] )
+        if( m_Hashes[id]==_Hash && m_StringPtrs[id]->length()==_Len && memcmp(m_StringPtrs[id]->c_str(), _Str, _Len)==0 )
+            return id;
+    return 0;
+}
+
+void CTwStringPool::Rehash()
+{
+    m_Buckets.assign(2*m_Buckets.size(), 0);
+    for( Id id=1; id<(Id)m_Strings.size(); ++id )
+        if( m_RefCounts[id]>0 )
+        {
+            Id& First = m_Buckets[m_Hashes[id]&(m_Buckets.size()-1)];
+            m_Next[id] = First;
+            First = id;
+        }
+}
+
+//  ---------------------------------------------------------------------------
+
+CTwIString::Id CTwIString::Intern(const char *_Str, size_t _Len)
+{
+    if( _Len==0 )
+        return 0;
+    if( s_Pool==NULL )
+        s_Pool = new CTwStringPool;
+
+    unsigned int Hash = HashString(_Str, _Len);
+    Id id = s_Pool->Find(_Str, _Len, Hash);
+    if( id!=0 )
+    {
+        ++s_Pool->m_RefCounts[id];
+        return id;
+    }
+
+    string Str(_Str, _Len);
+    if( !s_Pool->m_FreeIds.empty() )
+    {
+        id = s_Pool->m_FreeIds.back();
+        s_Pool->m_FreeIds.pop_back();
+        s_Pool->m_Strings[id].swap(Str);
+    }
+    else
+    {
+        id = (Id)s_Pool->m_Strings.size();
+        s_Pool->m_Strings.push_back(string());
+        s_Pool->m_Strings.back().swap(Str);
+        s_Pool->m_StringPtrs.push_back(&s_Pool->m_Strings.back());
+        s_Pool->m_Hashes.push_back(0);
+        s_Pool->m_RefCounts.push_back(0);
+        s_Pool->m_Next.push_back(0);
+        s_Strings = &(s_Pool->m_StringPtrs[0]);
+    }
+    s_Pool->m_Hashes[id] = Hash;
+    s_Pool->m_RefCounts[id] = 1;
+    Id& First = s_Pool->m_Buckets[Hash&(s_Pool->m_Buckets.size()-1)];
+    s_Pool->m_Next[id] = First;
+    First = id;
+    if( ++s_Pool->m_NbStrings>s_Pool->m_Buckets.size() )
+        s_Pool->Rehash();
+    return id;
+}
+
+void CTwIString::AddRef(Id _Id)
+{
+    if( _Id!=0 )
+        ++s_Pool->m_RefCounts[_Id];
+}
+
+void CTwIString::Release(Id _Id)
+{
+    if( _Id==0 || --s_Pool->m_RefCounts[_Id]>0 )
+        return;
+
+    Id *Link = &(s_Pool->m_Buckets[s_Pool->m_Hashes[_Id]&(s_Pool->m_Buckets.size()-1)]);
+    while( *Link!=_Id )
+        Link = &(s_Pool->m_Next[*Link]);
+    *Link = s_Pool->m_Next[_Id];
+    string().swap(s_Pool->m_Strings[_Id]);
+    s_Pool->m_FreeIds.push_back(_Id);
+    if( --s_Pool->m_NbStrings==0 )
+    {
+        delete s_Pool;
+        s_Pool = NULL;
+        s_Strings = &s_EmptyStringPtr;
+    }
+}
+
+bool CTwIString::FindId(const char *_Str, Id *_Id)
+{
+    size_t Len = strlen(_Str);
+    if( Len==0 )
+    {
+        *_Id = 0;
+        return true;
+    }
+    if( s_Pool==NULL )
+        return false;
+    *_Id = s_Pool->Find(_Str, Len, HashString(_Str, Len));
+    return *_Id!=0;
+}
+
+//  ---------------------------------------------------------------------------
+
+CTwIString& CTwIString::operator=(const CTwIString& _Str)
+{
+    AddRef(_Str.m_Id);
+    Release(m_Id);
+    m_Id = _Str.m_Id;
+    return *this;
+}
+
+CTwIString& CTwIString::operator=(const char *_Str)
+{
+    Id NewId = Intern(_Str, strlen(_Str));
+    Release(m_Id);
+    m_Id = NewId;
+    return *this;
+}
+
+CTwIString& CTwIString::operator=(const std::string& _Str)
+{
+    Id NewId = Intern(_Str.c_str(), _Str.length());
+    Release(m_Id);
+    m_Id = NewId;
+    return *this;
+}
+
+CTwIString& CTwIString::operator+=(const std::string& _Str)
+{
+    return *this = Str() + _Str;
+}
+
+CTwIString& CTwIString::operator+=(const char *_Str)
+{
+    return *this = Str() + _Str;
+}
+
+CTwIString& CTwIString::operator+=(char _Char)
+{
+    return *this = Str() + _Char;
+}
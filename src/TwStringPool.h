@@ -0,0 +1,77 @@
+//  ---------------------------------------------------------------------------
+//
+//  @file       TwStringPool.h
+//  @brief      Interned strings
+//  @author     Philippe Decaudin
+//  @license    This file is part of the AntTweakBar library.
+//              For conditions of distribution and use, see License.txt
+//
+//  note:       Private header
+//              A CTwIString is the id of a string stored once in a global
+//              pool. Equal strings share the same id, so copies are cheap
+//              and equality tests are integer compares. Pooled strings are
+//              reference counted and released with their last handle.
+//
+//  ---------------------------------------------------------------------------
+
+
+#if !defined ANT_TW_STRING_POOL_INCLUDED
+#define ANT_TW_STRING_POOL_INCLUDED
+
+#include <deque>
+
+
+class CTwIString
+{
+public:
+    typedef unsigned int    Id;                 // 0 is the empty string
+                            CTwIString() : m_Id(0) {}
+                            CTwIString(const CTwIString& _Str) : m_Id(_Str.m_Id) { AddRef(m_Id); }
+                            CTwIString(const char *_Str) : m_Id(Intern(_Str, strlen(_Str))) {}
+                            CTwIString(const std::string& _Str) : m_Id(Intern(_Str.c_str(), _Str.length())) {}
+                            ~CTwIString() { Release(m_Id); }
+    CTwIString&             operator=(const CTwIString& _Str);
+    CTwIString&             operator=(const char *_Str);
+    CTwIString&             operator=(const std::string& _Str);
+    CTwIString&             operator+=(const std::string& _Str);
+    CTwIString&             operator+=(const char *_Str);
+    CTwIString&             operator+=(char _Char);
+
+    const std::string&      Str() const { return *s_Strings[m_Id]; }
+                            operator const std::string&() const { return *s_Strings[m_Id]; }
+    const char *            c_str() const { return s_Strings[m_Id]->c_str(); }
+    size_t                  length() const { return s_Strings[m_Id]->length(); }
+    size_t                  size() const { return s_Strings[m_Id]->size(); }
+    bool                    empty() const { return m_Id==0; }
+    Id                      GetId() const { return m_Id; }
+    static bool             FindId(const char *_Str, Id *_Id);  // look up a string without adding it to the pool
+
+    bool                    operator==(const CTwIString& _Str) const { return m_Id==_Str.m_Id; }
+    bool                    operator!=(const CTwIString& _Str) const { return m_Id!=_Str.m_Id; }
+
+private:
+    Id                      m_Id;
+    static std::string **   s_Strings;          // pooled strings indexed by id, they do not move
+    static Id               Intern(const char *_Str, size_t _Len);
+    static void             AddRef(Id _Id);
+    static void             Release(Id _Id);
+    friend struct CTwStringPool;
+};
+
+inline bool operator==(const CTwIString& _A, const std::string& _B) { return _A.Str()==_B; }
+inline bool operator==(const std::string& _A, const CTwIString& _B) { return _A==_B.Str(); }
+inline bool operator==(const CTwIString& _A, const char *_B)        { return strcmp(_A.c_str(), _B)==0; }
+inline bool operator!=(const CTwIString& _A, const std::string& _B) { return _A.Str()!=_B; }
+inline bool operator!=(const std::string& _A, const CTwIString& _B) { return _A!=_B.Str(); }
+inline bool operator!=(const CTwIString& _A, const char *_B)        { return strcmp(_A.c_str(), _B)!=0; }
+inline std::string operator+(const std::string& _A, const CTwIString& _B) { return _A + _B.Str(); }
+inline std::string operator+(const CTwIString& _A, const std::string& _B) { return _A.Str() + _B; }
+inline std::string operator+(const char *_A, const CTwIString& _B)        { return _A + _B.Str(); }
+inline std::string operator+(const CTwIString& _A, const char *_B)        { return _A.Str() + _B; }
+inline std::ostream& operator<<(std::ostream& _S, const CTwIString& _A)   { return _S << _A.Str(); }
+
+
+//  ---------------------------------------------------------------------------
+
+
+#endif // !defined ANT_TW_STRING_POOL_INCLUDED